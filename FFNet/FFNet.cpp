@@ -33,6 +33,7 @@
 */
 
 #include "FFNet.h"
+#include "MelderThread.h"
 #include "FFNet_Matrix.h"
 #include "Matrix_extensions.h"
 #include "TableOfReal_extensions.h"
@@ -412,6 +413,140 @@ void FFNet_computeDerivative (FFNet me) {
 				my dwi [k] = - my error [i] * my activity [node];
 }
 
+/*
+	The weights of a layer form a matrix with a row per unit, the bias weight last,
+	exactly as they are stored in w, so that they can be used without copying.
+	The patterns are divided into blocks that are handled on several threads;
+	within a block, the patterns go through the layers in batches, so that each weight matrix
+	is used for a whole batch while it is in the cache.
+	The sums of the blocks are added in block order, so that the result does not depend on the number of threads.
+*/
+double FFNet_getCostsAndDerivatives (FFNet me, constMATVU const& input, constMATVU const& target, VEC const& out_dw) {
+	const integer numberOfPatterns = input.nrow;
+	Melder_assert (input.ncol == my numberOfInputs && target.ncol == my numberOfOutputs);
+	Melder_assert (target.nrow == numberOfPatterns && out_dw.size == my numberOfWeights);
+	constexpr integer batchSize = 32, minimumNumberOfPatternsPerBlock = 64, maximumNumberOfBlocks = 64;
+	const integer numberOfBlocks = Melder_clipped (1_integer, numberOfPatterns / minimumNumberOfPatternsPerBlock, maximumNumberOfBlocks);
+	/*
+		Layer 0 is the input layer. The activities of layer l are in columns firstColumn [l] + 1 .. firstColumn [l] + numberOfUnits [l],
+		followed by a column with the bias activity 1.
+	*/
+	const integer numberOfLayers = my numberOfLayers;
+	autoINTVEC numberOfUnits = raw_INTVEC (numberOfLayers + 1);   // numberOfUnits [l + 1] for layer l
+	autoINTVEC firstColumn = raw_INTVEC (numberOfLayers + 1), firstWeight = raw_INTVEC (numberOfLayers + 1);
+	numberOfUnits [1] = my numberOfInputs;
+	firstColumn [1] = firstWeight [1] = 0;
+	for (integer ilayer = 1; ilayer <= numberOfLayers; ilayer ++) {
+		numberOfUnits [ilayer + 1] = my numberOfUnitsInLayer [ilayer];
+		firstColumn [ilayer + 1] = firstColumn [ilayer] + numberOfUnits [ilayer] + 1;
+		firstWeight [ilayer + 1] = firstWeight [ilayer] + numberOfUnits [ilayer + 1] * (numberOfUnits [ilayer] + 1);   // first weight of the next layer
+	}
+	Melder_assert (firstWeight [numberOfLayers + 1] == my numberOfWeights);
+	const integer numberOfColumns = firstColumn [numberOfLayers + 1] + numberOfUnits [numberOfLayers + 1] + 1;
+	auto weightsOfLayer = [&] (VEC const& weights, integer ilayer) -> MAT {
+		return MAT (weights.cells + firstWeight [ilayer], numberOfUnits [ilayer + 1], numberOfUnits [ilayer] + 1);
+	};
+	const bool crossEntropy = ( my costFunctionType == FFNet_COST_MCE );
+
+	autoMAT derivativesOfBlock = zero_MAT (numberOfBlocks, my numberOfWeights);
+	autoVEC costsOfBlock = zero_VEC (numberOfBlocks);
+	MelderThread_runTasks (numberOfBlocks, [&] (integer iblock) {
+		const integer firstPattern = 1 + (iblock - 1) * numberOfPatterns / numberOfBlocks;
+		const integer lastPattern = iblock * numberOfPatterns / numberOfBlocks;
+		autoMAT activity = raw_MAT (batchSize, numberOfColumns);
+		autoMAT deriv = raw_MAT (batchSize, numberOfColumns);
+		autoMAT error = raw_MAT (batchSize, numberOfColumns);
+		autoVEC backpropagated = raw_VEC (numberOfColumns);
+		const VEC dw = derivativesOfBlock.row (iblock);
+		longdouble cost = 0.0;
+		for (integer firstInBatch = firstPattern; firstInBatch <= lastPattern; firstInBatch += batchSize) {
+			const integer numberInBatch = std::min (batchSize, lastPattern - firstInBatch + 1);
+			/*
+				Step (1): forward.
+			*/
+			for (integer ipattern = 1; ipattern <= numberInBatch; ipattern ++) {
+				activity.row (ipattern).part (1, my numberOfInputs)  <<=  input.row (firstInBatch - 1 + ipattern);
+				activity [ipattern] [my numberOfInputs + 1] = 1.0;
+			}
+			for (integer ilayer = 1; ilayer <= numberOfLayers; ilayer ++) {
+				const constMAT w = weightsOfLayer (my w.get(), ilayer);
+				const integer numberOfInputsOfLayer = numberOfUnits [ilayer] + 1;
+				const bool linear = ( ilayer == numberOfLayers && my outputsAreLinear );
+				for (integer ipattern = 1; ipattern <= numberInBatch; ipattern ++) {
+					const double *input_layer = & activity [ipattern] [firstColumn [ilayer] + 1];
+					double *activity_layer = & activity [ipattern] [firstColumn [ilayer + 1]];
+					double *deriv_layer = & deriv [ipattern] [firstColumn [ilayer + 1]];
+					for (integer iunit = 1; iunit <= w.nrow; iunit ++) {
+						const double *w_unit = & w [iunit] [1];
+						double act = 0.0;
+						for (integer k = 0; k < numberOfInputsOfLayer; k ++)
+							act += w_unit [k] * input_layer [k];
+						if (linear) {
+							activity_layer [iunit] = act;
+							deriv_layer [iunit] = 1.0;
+						} else
+							activity_layer [iunit] = my nonLinearity (me, act, & deriv_layer [iunit]);
+					}
+					activity_layer [w.nrow + 1] = 1.0;
+				}
+			}
+			/*
+				Step (2): errors at the output units; see minimumSquaredError () and minimumCrossEntropy ().
+			*/
+			const integer outputColumn = firstColumn [numberOfLayers + 1];
+			for (integer ipattern = 1; ipattern <= numberInBatch; ipattern ++) {
+				const constVECVU target_pattern = target.row (firstInBatch - 1 + ipattern);
+				for (integer ioutput = 1; ioutput <= my numberOfOutputs; ioutput ++) {
+					const double o = activity [ipattern] [outputColumn + ioutput], t = target_pattern [ioutput];
+					double e;
+					if (crossEntropy) {
+						cost -= t * log (o) + (1.0 - t) * log (1.0 - o);
+						e = - (1.0 - t) / (1.0 - o) + t / o;
+					} else {
+						e = t - o;
+						cost += 0.5 * e * e;
+					}
+					error [ipattern] [outputColumn + ioutput] = e * deriv [ipattern] [outputColumn + ioutput];
+				}
+			}
+			/*
+				Steps (3) and (4): backpropagation and derivatives.
+			*/
+			for (integer ilayer = numberOfLayers; ilayer >= 1; ilayer --) {
+				const constMAT w = weightsOfLayer (my w.get(), ilayer);
+				const MAT dw_layer = weightsOfLayer (dw, ilayer);
+				const integer numberOfInputsOfLayer = numberOfUnits [ilayer] + 1;
+				for (integer ipattern = 1; ipattern <= numberInBatch; ipattern ++) {
+					const double *input_layer = & activity [ipattern] [firstColumn [ilayer] + 1];
+					const double *error_layer = & error [ipattern] [firstColumn [ilayer + 1]];
+					for (integer iunit = 1; iunit <= w.nrow; iunit ++) {
+						const double e = error_layer [iunit];
+						double *dw_unit = & dw_layer [iunit] [1];
+						for (integer k = 0; k < numberOfInputsOfLayer; k ++)
+							dw_unit [k] -= e * input_layer [k];
+					}
+					if (ilayer > 1) {
+						const VEC sum = backpropagated.part (1, numberOfUnits [ilayer]);
+						sum  <<=  0.0;
+						for (integer iunit = 1; iunit <= w.nrow; iunit ++)
+							sum  +=  error_layer [iunit]  *  w.row (iunit).part (1, numberOfUnits [ilayer]);
+						for (integer k = 1; k <= numberOfUnits [ilayer]; k ++)
+							error [ipattern] [firstColumn [ilayer] + k] = sum [k] * deriv [ipattern] [firstColumn [ilayer] + k];
+					}
+				}
+			}
+		}
+		costsOfBlock [iblock] = double (cost);
+	});
+	out_dw  <<=  0.0;
+	longdouble cost = 0.0;
+	for (integer iblock = 1; iblock <= numberOfBlocks; iblock ++) {
+		out_dw  +=  derivativesOfBlock.row (iblock);
+		cost += costsOfBlock [iblock];
+	}
+	return double (cost);
+}
+
 /******* end operation ******************************************************/
 
 integer FFNet_getWinningUnit (FFNet me, integer labeling) {
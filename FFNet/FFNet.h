@@ -128,6 +128,7 @@ autostring32 FFNet_createNameFromTopology (FFNet me);
 */
 
 #define FFNet_COST_MSE 1
+#define FFNet_COST_MCE 2
 
 void FFNet_setCostFunction (FFNet me, int type);
 
@@ -174,6 +175,11 @@ void FFNet_computeDerivative (FFNet me);
 /* step (4) compute derivative in my dwi */
 /* Precondition: step (3) */
 
+double FFNet_getCostsAndDerivatives (FFNet me, constMATVU const& input, constMATVU const& target, VEC const& out_dw);
+/* steps (1) to (4) for all the patterns (rows) in input at once, in batches and on several threads */
+/* returns the total costs and puts the summed derivatives for all weights in out_dw */
+/* does not change my activity, my error or my dwi */
+
 integer FFNet_getWinningUnit (FFNet me, integer labeling);
 /* labeling = 1 : winner-takes-all */
 /* labeling = 2 : stochastic */
@@ -31,23 +31,12 @@ static double func (Daata object, VEC const& p) {
 	FFNet me = (FFNet) object;
 	const Minimizer thee = my minimizer.get();
 
-	for (integer j = 1, k = 1; k <= my numberOfWeights; k ++) {
-		my dw [k] = 0.0;
+	for (integer j = 1, k = 1; k <= my numberOfWeights; k ++)
 		if (my wSelected [k])
 			my w [k] = p [j ++];
-	}
-	longdouble fp = 0.0;
-	for (integer i = 1; i <= my numberOfPatterns; i ++) {
-		FFNet_propagate (me, my inputPattern.row (i), nullptr);
-		fp += FFNet_computeError (me, my targetActivation.row (i));
-		FFNet_computeDerivative (me);
-		/*
-			Derivative (cumulative)
-		*/
-		my dw.part (1, my numberOfWeights)  +=  my dwi.part (1, my numberOfWeights);
-	}
+	const double fp = FFNet_getCostsAndDerivatives (me, my inputPattern, my targetActivation, my dw.part (1, my numberOfWeights));
 	thy numberOfFunctionCalls ++;
-	return (double) fp;
+	return fp;
 }
 
 static void dfunc_optimized (Daata object, VEC const& /* p */, VEC const& dp) {
@@ -148,17 +137,65 @@ void FFNet_PatternList_ActivationList_learnSM (FFNet me, PatternList p, Activati
 	_FFNet_PatternList_ActivationList_learn (me, p, a, maxNumOfEpochs, tolerance, costFunctionType, resetMinimizer);
 }
 
+void FFNet_PatternList_ActivationList_learnMiniBatch (FFNet me, PatternList p, ActivationList a, integer numberOfEpochs, integer batchSize, double learningRate, double momentum, int costFunctionType) {
+	_FFNet_PatternList_ActivationList_checkDimensions (me, p, a);
+	Melder_require (numberOfEpochs > 0,
+		U"The number of epochs should be positive.");
+	Melder_require (batchSize > 0,
+		U"The batch size should be positive.");
+	FFNet_setCostFunction (me, costFunctionType);
+	const integer numberOfPatterns = p -> ny;
+	batchSize = std::min (batchSize, numberOfPatterns);
+	autoINTVEC order = to_INTVEC (numberOfPatterns);
+	autoMAT input = raw_MAT (batchSize, my numberOfInputs);
+	autoMAT target = raw_MAT (batchSize, my numberOfOutputs);
+	autoVEC dw = raw_VEC (my numberOfWeights);
+	autoVEC velocity = zero_VEC (my numberOfWeights);
+	/*
+		The weights will change behind the back of the minimizer.
+	*/
+	my minimizer. reset();
+	autoMelderProgress progress (U"Mini-batch learning...");
+	for (integer iepoch = 1; iepoch <= numberOfEpochs; iepoch ++) {
+		/*
+			A new random order of the patterns in every epoch (Fisher-Yates).
+		*/
+		for (integer i = numberOfPatterns; i > 1; i --)
+			std::swap (order [i], order [NUMrandomInteger (1, i)]);
+		longdouble cost = 0.0;
+		for (integer firstInBatch = 1; firstInBatch <= numberOfPatterns; firstInBatch += batchSize) {
+			const integer numberInBatch = std::min (batchSize, numberOfPatterns - firstInBatch + 1);
+			for (integer i = 1; i <= numberInBatch; i ++) {
+				input.row (i)  <<=  p -> z.row (order [firstInBatch - 1 + i]);
+				target.row (i)  <<=  a -> z.row (order [firstInBatch - 1 + i]);
+			}
+			cost += FFNet_getCostsAndDerivatives (me, input.horizontalBand (1, numberInBatch),
+					target.horizontalBand (1, numberInBatch), dw.get());
+			const double stepSize = learningRate / numberInBatch;
+			for (integer k = 1; k <= my numberOfWeights; k ++) {
+				if (my wSelected [k]) {
+					velocity [k] = momentum * velocity [k] - stepSize * dw [k];
+					my w [k] += velocity [k];
+				}
+			}
+		}
+		try {
+			Melder_progress ((double) iepoch / numberOfEpochs,
+				U"Epoch: ", iepoch, U" of ", numberOfEpochs, U", costs: ", Melder_single (double (cost)));
+		} catch (MelderError) {
+			Melder_clearError ();   // interrupted, no error: keep the weights learned until now
+			break;
+		}
+	}
+}
+
 double FFNet_PatternList_ActivationList_getCosts_total (FFNet me, PatternList p, ActivationList a, int costFunctionType) {
 	try {
 		_FFNet_PatternList_ActivationList_checkDimensions (me, p, a);
 		FFNet_setCostFunction (me, costFunctionType);
 
-		double cost = 0.0;
-		for (integer i = 1; i <= p -> ny; i ++) {
-			FFNet_propagate (me, p -> z.row (i), nullptr);
-			cost += FFNet_computeError (me, a -> z.row (i));
-		}
-		return cost;
+		autoVEC dw = raw_VEC (my numberOfWeights);
+		return FFNet_getCostsAndDerivatives (me, p -> z.get(), a -> z.get(), dw.get());
 	} catch (MelderError) {
 		return undefined;
 	}
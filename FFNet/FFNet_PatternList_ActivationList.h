@@ -38,6 +38,11 @@ void FFNet_PatternList_ActivationList_learnSD (FFNet me, PatternList p, Activati
 void FFNet_PatternList_ActivationList_learnSM (FFNet me, PatternList p, ActivationList a, integer maxNumOfEpochs,
     double tolerance, int costFunctionType);
 
+void FFNet_PatternList_ActivationList_learnMiniBatch (FFNet me, PatternList p, ActivationList a, integer numberOfEpochs,
+    integer batchSize, double learningRate, double momentum, int costFunctionType);
+/* Stochastic gradient descent with momentum on random batches of batchSize patterns;
+	the patterns are put in a new random order in every epoch, so the result depends only on the random seed. */
+
 double FFNet_PatternList_ActivationList_getCosts_total (FFNet me, PatternList p, ActivationList a, int costFunctionType);
 double FFNet_PatternList_ActivationList_getCosts_average (FFNet me, PatternList p, ActivationList a, int costFunctionType);
 
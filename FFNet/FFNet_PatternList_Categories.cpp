@@ -67,6 +67,12 @@ void FFNet_PatternList_Categories_learnSM (FFNet me, PatternList p, Categories c
 	FFNet_PatternList_ActivationList_learnSM (me, p, activation.get(), maxNumOfEpochs, tolerance, costFunctionType);
 }
 
+void FFNet_PatternList_Categories_learnMiniBatch (FFNet me, PatternList p, Categories c, integer numberOfEpochs, integer batchSize, double learningRate, double momentum, int costFunctionType) {
+	_FFNet_PatternList_Categories_checkDimensions (me, p, c);
+	autoActivationList activation = FFNet_Categories_to_ActivationList (me, c);
+	FFNet_PatternList_ActivationList_learnMiniBatch (me, p, activation.get(), numberOfEpochs, batchSize, learningRate, momentum, costFunctionType);
+}
+
 autoCategories FFNet_PatternList_to_Categories (FFNet me, PatternList thee, int labeling) {
 	try {
 		Melder_require (my outputCategories, 
@@ -37,6 +37,10 @@ void FFNet_PatternList_Categories_learnSM (FFNet me, PatternList p, Categories c
     double tolerance, int costFunctionType);
 /* Conj. Gradient vdSmagt */
 
+void FFNet_PatternList_Categories_learnMiniBatch (FFNet me, PatternList p, Categories c, integer numberOfEpochs,
+    integer batchSize, double learningRate, double momentum, int costFunctionType);
+/* Stochastic gradient descent on mini-batches */
+
 double FFNet_PatternList_Categories_getCosts_total (FFNet me, PatternList p, Categories c, int costFunctionType);
 double FFNet_PatternList_Categories_getCosts_average (FFNet me, PatternList p, Categories c, int costFunctionType);
 
@@ -185,6 +185,7 @@ LIST_ITEM (U"\\bu @@Create FFNet...@")
 ENTRY (U"Learning:")
 LIST_ITEM (U"\\bu @@FFNet & PatternList & Categories: Learn...@")
 LIST_ITEM (U"\\bu @@FFNet & PatternList & Categories: Learn slow...@")
+LIST_ITEM (U"\\bu @@FFNet & PatternList & Categories: Learn (mini-batch)...@")
 ENTRY (U"Classification:")
 LIST_ITEM (U"\\bu @@FFNet & PatternList: To Categories...@")
 ENTRY (U"Drawing:")
@@ -421,6 +422,32 @@ NORMAL (U"The minimization procedure is a variant of conjugate gradient minimiza
 	"see for example @@Press et al. (1992)@, chapter 10, or @@Nocedal & Wright (1999)@, chapter 5.")
 MAN_END
 
+MAN_BEGIN (U"FFNet & PatternList & Categories: Learn (mini-batch)...", U"djmw", 20261018)
+INTRO (U"You can choose this command after selecting one @PatternList, one @Categories and one @FFNet.")
+NORMAL (U"Instead of computing the costs for all the patterns before changing the weights, as "
+	"@@FFNet & PatternList & Categories: Learn...@ does, the weights are changed after every small batch of patterns. "
+	"With many patterns, this will often reach low costs in a much shorter time.")
+ENTRY (U"Settings")
+TERM (U"##Number of epochs")
+DEFINITION (U"the number of times that the complete #PatternList dataset will be presented to the neural net.")
+TERM (U"##Batch size")
+DEFINITION (U"the number of patterns after which the weights are changed.")
+TERM (U"##Learning rate")
+DEFINITION (U"the size of a step in the direction of steepest descent of the average costs of a batch.")
+TERM (U"##Momentum")
+DEFINITION (U"the fraction of the previous change of the weights that is added to the current change.")
+TERM (U"##Cost function")
+DEFINITION (U"see @@FFNet & PatternList & Categories: Learn...@.")
+ENTRY (U"Algorithm")
+NORMAL (U"In every epoch, the patterns are put in a random order and divided into batches. "
+	"For every batch, the derivatives of the costs with respect to the weights are computed, "
+	"and every selected weight %w is changed by %v, where %v = %momentum \\.c %v - %learningRate \\.c \\su__%batch_ %dcosts/%dw / %batchSize.")
+NORMAL (U"Since the random order is the only random element, you will get the same weights again "
+	"if you start from the same weights and set the random seed with ##random_initializeWithSeedUnsafelyButPredictably# beforehand.")
+NORMAL (U"The patterns are sent through the network together, layer by layer, and large numbers of patterns are divided over several threads; "
+	"this also speeds up the other learning commands.")
+MAN_END
+
 MAN_BEGIN (U"FFNet & PatternList & Categories: Get total costs...", U"djmw", 20041118)
 INTRO (U"Query the selected @FFNet, @PatternList and @Categories for the total costs.")
 ENTRY (U"Algorithm")
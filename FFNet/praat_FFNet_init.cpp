@@ -477,6 +477,21 @@ DO
 	MODIFY_FIRST_OF_ONE_AND_ONE_AND_ONE_END	
 }
 
+FORM (MODIFY_FIRST_OF_ONE_AND_ONE_AND_ONE__FFNet_PatternList_ActivationList_learnMiniBatch, U"FFNet & PatternList & ActivationList: Learn (mini-batch)", nullptr) {
+	NATURAL (numberOfEpochs, U"Number of epochs", U"100")
+	NATURAL (batchSize, U"Batch size", U"32")
+	POSITIVE (learningRate, U"Learning rate", U"0.5")
+	REAL (momentum, U"Momentum", U"0.9")
+	CHOICE (costFunctionType, U"Cost function", 1)
+		OPTION (U"minimum-squared-error")
+		OPTION (U"minimum-cross-entropy")
+	OK
+DO
+	MODIFY_FIRST_OF_ONE_AND_ONE_AND_ONE (FFNet, PatternList, ActivationList)
+		FFNet_PatternList_ActivationList_learnMiniBatch (me, you, him, numberOfEpochs, batchSize, learningRate, momentum, costFunctionType);
+	MODIFY_FIRST_OF_ONE_AND_ONE_AND_ONE_END
+}
+
 /*********** FFNet & PatternList & Categories **********************************/
 
 FORM (QUERY_ONE_AND_ONE_AND_ONE_FOR_REAL__FFNet_PatternList_Categories_getTotalCosts, U"FFNet & PatternList & Categories: Get total costs", U"FFNet & PatternList & Categories: Get total costs...") {
@@ -530,6 +545,21 @@ DO
 	MODIFY_FIRST_OF_ONE_AND_ONE_AND_ONE_END
 }
 
+FORM (MODIFY_FIRST_OF_ONE_AND_ONE_AND_ONE__FFNet_PatternList_Categories_learnMiniBatch, U"FFNet & PatternList & Categories: Learn (mini-batch)", U"FFNet & PatternList & Categories: Learn (mini-batch)...") {
+	NATURAL (numberOfEpochs, U"Number of epochs", U"100")
+	NATURAL (batchSize, U"Batch size", U"32")
+	POSITIVE (learningRate, U"Learning rate", U"0.5")
+	REAL (momentum, U"Momentum", U"0.9")
+	CHOICE (costFunctionType, U"Cost function", 1)
+		OPTION (U"minimum-squared-error")
+		OPTION (U"minimum-cross-entropy")
+	OK
+DO
+	MODIFY_FIRST_OF_ONE_AND_ONE_AND_ONE (FFNet, PatternList, Categories)
+		FFNet_PatternList_Categories_learnMiniBatch (me, you, him, numberOfEpochs, batchSize, learningRate, momentum, costFunctionType);
+	MODIFY_FIRST_OF_ONE_AND_ONE_AND_ONE_END
+}
+
 /*********** FFNet & PCA **********************************/
 
 FORM (GRAPHICS_ONE_AND_ONE__FFNet_PCA_drawDecisionPlaneInEigenspace, U"FFNet & PCA: Draw decision plane", nullptr) {
@@ -668,6 +698,8 @@ void praat_uvafon_FFNet_init () {
 			MODIFY_FIRST_OF_ONE_AND_ONE_AND_ONE__FFNet_PatternList_ActivationList_learn);
 	praat_addAction3 (classFFNet, 1, classPatternList, 1, classActivationList, 1, U"Learn slow...", nullptr, 0,
 			MODIFY_FIRST_OF_ONE_AND_ONE_AND_ONE__FFNet_PatternList_ActivationList_learnSlow);
+	praat_addAction3 (classFFNet, 1, classPatternList, 1, classActivationList, 1, U"Learn (mini-batch)...", nullptr, 0,
+			MODIFY_FIRST_OF_ONE_AND_ONE_AND_ONE__FFNet_PatternList_ActivationList_learnMiniBatch);
 
 	praat_addAction3 (classFFNet, 1, classPatternList, 1, classCategories, 1, U"Get total costs...", nullptr, 0,
 			QUERY_ONE_AND_ONE_AND_ONE_FOR_REAL__FFNet_PatternList_Categories_getTotalCosts);
@@ -678,6 +710,8 @@ void praat_uvafon_FFNet_init () {
 			MODIFY_FIRST_OF_ONE_AND_ONE_AND_ONE__FFNet_PatternList_Categories_learn);
 	praat_addAction3 (classFFNet, 1, classPatternList, 1, classCategories, 1, U"Learn slow...", nullptr, 0,
 			MODIFY_FIRST_OF_ONE_AND_ONE_AND_ONE__FFNet_PatternList_Categories_learnSlow);
+	praat_addAction3 (classFFNet, 1, classPatternList, 1, classCategories, 1, U"Learn (mini-batch)...", nullptr, 0,
+			MODIFY_FIRST_OF_ONE_AND_ONE_AND_ONE__FFNet_PatternList_Categories_learnMiniBatch);
 	
 	praat_addAction2 (classFFNet, 1, classPCA, 1, U"Draw decision plane...", nullptr, 0,
 			GRAPHICS_ONE_AND_ONE__FFNet_PCA_drawDecisionPlaneInEigenspace);
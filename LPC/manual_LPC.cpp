@@ -1084,7 +1084,7 @@ ENTRY (U"Algorithm")
 NORMAL (U"Burg's algorithm is described in @@Anderson (1978)@")
 MAN_END
 
-MAN_BEGIN (U"Sound: To MFCC...", U"djmw", 20141022)
+MAN_BEGIN (U"Sound: To MFCC...", U"djmw", 20261018)
 INTRO (U"A command that creates a @MFCC object from every selected @Sound "
 	"object.")
 NORMAL (U"The analysis proceeds in two steps:")
@@ -1092,6 +1092,10 @@ LIST_ITEM (U"1.  We perform a spectrum analysis on a mel frequency scale "
 	"(see @@Sound: To MelSpectrogram...@ for details).")
 LIST_ITEM (U"2.  We convert the melspectrogram values to mel frequency cepstral "
 	"coefficients (see @@MelSpectrogram: To MFCC...@ for details).")
+NORMAL (U"Both steps are taken for one frame at a time, and the frames may be analysed in parallel, "
+	"so that no @MelSpectrogram is created. The result is the same as that of these two commands in succession.")
+NORMAL (U"For speech recognition, you can append the deltas and accelerations of the coefficients with "
+	"@@MFCC: To TableOfReal (deltas)...@.")
 MAN_END
 
 MAN_BEGIN (U"Spectrum: To PowerCepstrum", U"djmw", 20190908)
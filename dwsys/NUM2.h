@@ -977,6 +977,15 @@ void NUMfft_backward (NUMfft_Table table, VEC data);
 	sequence by n.
 */
 
+void NUMfft_forward (NUMfft_Table table, MAT const& frames);
+void NUMfft_backward (NUMfft_Table table, MAT const& frames);
+/*
+	Batched versions of the above: every row of `frames` is a frame of table.n samples
+	that is transformed in place. Several frames are processed in one pass through the butterflies,
+	which lets the compiler vectorize across frames; the result for each frame is identical
+	to that of the one-frame version.
+*/
+
 /**** Compatibility with NR fft's */
 
 void NUMforwardRealFastFourierTransform (VEC data);
@@ -1006,6 +1015,20 @@ void NUMreverseRealFastFourierTransform (VEC data);
 */
 void NUMrealft (VEC data, integer direction);
 
+/*
+	NUMforwardRealFastFourierTransform, NUMreverseRealFastFourierTransform and NUMrealft
+	take their twiddle factors from a thread-safe cache of FFT plans, keyed by the data size,
+	so that repeated transforms of the same size do not recompute them.
+	The least recently used plans are discarded if the cache exceeds its maximum memory use
+	(default 64 MB); a maximum of 0 switches the cache off.
+	Clearing the cache also resets its statistics.
+*/
+void NUMfft_setPlanCacheMaximumMemoryUse (integer numberOfBytes);
+integer NUMfft_getPlanCacheMaximumMemoryUse ();
+void NUMfft_clearPlanCache ();
+void NUMfft_getPlanCacheStatistics (integer *out_numberOfPlans, integer *out_memoryUse,
+	integer *out_numberOfHits, integer *out_numberOfMisses, integer *out_numberOfEvictions);
+
 void VECsmooth_gaussian_inplace (VECVU const& in_out, double sigma);
 void VECsmooth_gaussian_inplace (VECVU const& in_out, double sigma, NUMfft_Table fftTable);
 void VECsmooth_gaussian (VECVU const& out, constVECVU const& in, double sigma, NUMfft_Table fftTable);
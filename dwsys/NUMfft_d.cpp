@@ -22,15 +22,132 @@
  */
 
 #include "NUM2.h"
-#include "melder.h"
+#include "ReadOnlyCache.h"
+
+/*
+	The butterflies in NUMfft_core.h are templates over the type of the data.
+	Besides `double`, they are instantiated for NUMfft_Lanes, a small fixed-size bundle of doubles
+	that holds the same sample of several frames (a structure-of-arrays layout).
+	All arithmetic on lanes is element-wise and in the same order as for a single double,
+	so each frame in a batch gets exactly the same result as it would in a one-frame transform,
+	but the compiler can now map every butterfly onto SIMD instructions (SSE2, AVX, NEON)
+	without any platform-specific code.
+*/
+constexpr integer NUMfft_numberOfLanes = 4;
+
+struct NUMfft_Lanes {
+	double x [NUMfft_numberOfLanes];
+};
+
+inline NUMfft_Lanes operator+ (NUMfft_Lanes const& a, NUMfft_Lanes const& b) {
+	NUMfft_Lanes result;
+	for (integer i = 0; i < NUMfft_numberOfLanes; i ++)
+		result.x [i] = a.x [i] + b.x [i];
+	return result;
+}
+inline NUMfft_Lanes operator- (NUMfft_Lanes const& a, NUMfft_Lanes const& b) {
+	NUMfft_Lanes result;
+	for (integer i = 0; i < NUMfft_numberOfLanes; i ++)
+		result.x [i] = a.x [i] - b.x [i];
+	return result;
+}
+inline NUMfft_Lanes operator- (NUMfft_Lanes const& a) {
+	NUMfft_Lanes result;
+	for (integer i = 0; i < NUMfft_numberOfLanes; i ++)
+		result.x [i] = - a.x [i];
+	return result;
+}
+inline NUMfft_Lanes operator* (double factor, NUMfft_Lanes const& a) {
+	NUMfft_Lanes result;
+	for (integer i = 0; i < NUMfft_numberOfLanes; i ++)
+		result.x [i] = factor * a.x [i];
+	return result;
+}
+inline NUMfft_Lanes operator* (NUMfft_Lanes const& a, double factor) {
+	NUMfft_Lanes result;
+	for (integer i = 0; i < NUMfft_numberOfLanes; i ++)
+		result.x [i] = a.x [i] * factor;
+	return result;
+}
+inline NUMfft_Lanes& operator+= (NUMfft_Lanes& a, NUMfft_Lanes const& b) {
+	for (integer i = 0; i < NUMfft_numberOfLanes; i ++)
+		a.x [i] += b.x [i];
+	return a;
+}
+inline NUMfft_Lanes& operator-= (NUMfft_Lanes& a, NUMfft_Lanes const& b) {
+	for (integer i = 0; i < NUMfft_numberOfLanes; i ++)
+		a.x [i] -= b.x [i];
+	return a;
+}
 
-#define FFT_DATA_TYPE double
 #include "NUMfft_core.h"
 
+/*
+	The one-shot transforms share a cache of FFT plans, keyed by the data size n.
+	A plan consists of the twiddle factors and the factorization of n.
+	The scratch space that the transforms need is not part of the plan but is allocated per call.
+	The size of a plan in the cache is its memory use in bytes.
+*/
+struct NUMfft_Plan {
+	std::vector <double> twiddles;   // 2 * n
+	std::vector <integer> factors;   // 32
+};
+
+static ReadOnlyCache <integer, NUMfft_Plan> thePlanCache (64 * 1024 * 1024);
+
+static std::shared_ptr <const NUMfft_Plan> NUMfft_getPlan (integer n) {
+	const integer memoryUse = integer (2 * n * sizeof (double) + 32 * sizeof (integer));
+	return thePlanCache.get (n, memoryUse, [n] () {
+		std::shared_ptr <NUMfft_Plan> plan = std::make_shared <NUMfft_Plan> ();
+		plan -> twiddles. resize (uinteger (2 * n));
+		plan -> factors. resize (32);
+		drfti1 (n, plan -> twiddles. data (), plan -> factors. data ());
+		return plan;
+	});
+}
+
+void NUMfft_setPlanCacheMaximumMemoryUse (integer numberOfBytes) {
+	thePlanCache.setMaximumSize (numberOfBytes);
+}
+
+integer NUMfft_getPlanCacheMaximumMemoryUse () {
+	return thePlanCache.getMaximumSize ();
+}
+
+void NUMfft_clearPlanCache () {
+	thePlanCache.clear ();
+}
+
+void NUMfft_getPlanCacheStatistics (integer *out_numberOfPlans, integer *out_memoryUse,
+	integer *out_numberOfHits, integer *out_numberOfMisses, integer *out_numberOfEvictions)
+{
+	thePlanCache.getStatistics (out_numberOfPlans, out_memoryUse, out_numberOfHits, out_numberOfMisses, out_numberOfEvictions);
+}
+
+static void NUMfft_forward_cached (VEC data) {
+	if (data.size <= 1)
+		return;
+	std::shared_ptr <const NUMfft_Plan> plan = NUMfft_getPlan (data.size);
+	autoVEC scratch = raw_VEC (data.size);
+	drftf1 (data.size, data.asArgumentToFunctionThatExpectsZeroBasedArray(),
+		scratch.asArgumentToFunctionThatExpectsZeroBasedArray(),
+		plan -> twiddles. data (), plan -> factors. data ()
+	);
+}
+
+static void NUMfft_backward_cached (VEC data) {
+	if (data.size <= 1)
+		return;
+	std::shared_ptr <const NUMfft_Plan> plan = NUMfft_getPlan (data.size);
+	autoVEC scratch = raw_VEC (data.size);
+	drftb1 (data.size, data.asArgumentToFunctionThatExpectsZeroBasedArray(),
+		scratch.asArgumentToFunctionThatExpectsZeroBasedArray(),
+		plan -> twiddles. data (), plan -> factors. data ()
+	);
+}
+
 void NUMforwardRealFastFourierTransform (VEC data) {
-	autoNUMfft_Table table;
-	NUMfft_Table_init (& table, data.size);
-	NUMfft_forward (& table, data);
+	NUMfft_forward_cached (data);
 	if (data.size > 1) {
 		/*
 			To be compatible with old behaviour.
@@ -43,7 +160,6 @@ void NUMforwardRealFastFourierTransform (VEC data) {
 }
 
 void NUMreverseRealFastFourierTransform (VEC data) {
-	autoNUMfft_Table table;
 	if (data.size > 1) {
 		/*
 			To be compatible with old behaviour.
@@ -53,8 +169,7 @@ void NUMreverseRealFastFourierTransform (VEC data) {
 			data [i] = data [i + 1];
 		data [data.size] = tmp;
 	}
-	NUMfft_Table_init (& table, data.size);
-	NUMfft_backward (& table, data);
+	NUMfft_backward_cached (data);
 }
 
 void NUMfft_forward (NUMfft_Table me, VEC data) {
@@ -79,6 +194,53 @@ void NUMfft_backward (NUMfft_Table me, VEC data) {
 	);
 }
 
+/*
+	Transforms the rows of `frames` in groups of NUMfft_numberOfLanes;
+	the rows that do not fill a complete group are transformed one by one.
+*/
+template <bool forward>
+static void NUMfft_batch (NUMfft_Table me, MAT const& frames) {
+	Melder_assert (frames.ncol == my n);
+	if (my n == 1)
+		return;
+	const double *twiddles = my trigcache.asArgumentToFunctionThatExpectsZeroBasedArray() + my n;
+	integer *factors = my splitcache.asArgumentToFunctionThatExpectsZeroBasedArray();
+	const integer numberOfCompleteGroups = frames.nrow / NUMfft_numberOfLanes;
+	if (numberOfCompleteGroups > 0) {
+		autovector <NUMfft_Lanes> data = newvectorraw <NUMfft_Lanes> (my n);
+		autovector <NUMfft_Lanes> scratch = newvectorraw <NUMfft_Lanes> (my n);
+		for (integer igroup = 0; igroup < numberOfCompleteGroups; igroup ++) {
+			const integer firstRow = igroup * NUMfft_numberOfLanes + 1;
+			for (integer i = 1; i <= my n; i ++)
+				for (integer ilane = 0; ilane < NUMfft_numberOfLanes; ilane ++)
+					data [i]. x [ilane] = frames [firstRow + ilane] [i];
+			if (forward)
+				drftf1 (my n, data.asArgumentToFunctionThatExpectsZeroBasedArray(),
+					scratch.asArgumentToFunctionThatExpectsZeroBasedArray(), twiddles, factors);
+			else
+				drftb1 (my n, data.asArgumentToFunctionThatExpectsZeroBasedArray(),
+					scratch.asArgumentToFunctionThatExpectsZeroBasedArray(), twiddles, factors);
+			for (integer i = 1; i <= my n; i ++)
+				for (integer ilane = 0; ilane < NUMfft_numberOfLanes; ilane ++)
+					frames [firstRow + ilane] [i] = data [i]. x [ilane];
+		}
+	}
+	for (integer irow = numberOfCompleteGroups * NUMfft_numberOfLanes + 1; irow <= frames.nrow; irow ++) {
+		if (forward)
+			NUMfft_forward (me, frames.row (irow));
+		else
+			NUMfft_backward (me, frames.row (irow));
+	}
+}
+
+void NUMfft_forward (NUMfft_Table me, MAT const& frames) {
+	NUMfft_batch <true> (me, frames);
+}
+
+void NUMfft_backward (NUMfft_Table me, MAT const& frames) {
+	NUMfft_batch <false> (me, frames);
+}
+
 void NUMfft_Table_init (NUMfft_Table me, integer n) {
 	my n = n;
 	my trigcache = zero_VEC (3 * n);
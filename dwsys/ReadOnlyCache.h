@@ -0,0 +1,128 @@
+#ifndef _ReadOnlyCache_h_
+#define _ReadOnlyCache_h_
+/* ReadOnlyCache.h
+ *
+ * Copyright (C) 2026 David Weenink
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "melder.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*
+	A thread-safe cache of items that are computed once and never changed afterwards,
+	such as the plans of an FFT or the interpolation tables of an analysis,
+	so that several threads (and analyses) can use the same item at the same time.
+	The items are handed out as shared pointers, so an item that is evicted lives on until its last user has finished.
+	Each item has a size, in units of the owner's choice; if the total size exceeds the maximum,
+	the least recently used items are evicted. A maximum of 0 switches the cache off.
+	A cache is meant to live as long as the process, so its items should be kept in std:: containers
+	rather than in Melder-allocated memory, which would show up as leaks in Praat's memory statistics.
+*/
+template <typename Key, typename Item>
+class ReadOnlyCache {
+	struct Entry {
+		Key key;
+		std::shared_ptr <const Item> item;
+		integer size;
+	};
+	std::mutex mutex;
+	std::vector <Entry> entries;   // the most recently used last
+	integer totalSize = 0, maximumSize;
+	integer numberOfHits = 0, numberOfMisses = 0, numberOfEvictions = 0;
+
+	void shrink () {   // precondition: the mutex is locked
+		integer numberOfEntriesToEvict = 0;
+		while (totalSize > maximumSize)
+			totalSize -= entries [uinteger (numberOfEntriesToEvict ++)]. size;
+		entries. erase (entries. begin (), entries. begin () + numberOfEntriesToEvict);
+		numberOfEvictions += numberOfEntriesToEvict;
+	}
+public:
+	explicit ReadOnlyCache (integer maximumSize_) : maximumSize (maximumSize_) { }
+
+	/*
+		Returns the item for `key`, calling `compute ()` if it is not in the cache.
+		The item is computed outside the lock; if another thread computes the same item in the meantime,
+		one of the two copies simply disappears.
+	*/
+	template <typename Compute>
+	std::shared_ptr <const Item> get (Key const& key, integer size, Compute compute) {
+		{
+			std::lock_guard <std::mutex> lock (mutex);
+			for (auto it = entries. begin (); it != entries. end (); ++ it) {
+				if (it -> key == key) {
+					numberOfHits += 1;
+					std::rotate (it, it + 1, entries. end ());   // make it the most recently used
+					return entries. back (). item;
+				}
+			}
+			numberOfMisses += 1;
+		}
+		std::shared_ptr <const Item> item = compute ();
+		std::lock_guard <std::mutex> lock (mutex);
+		if (size > maximumSize)
+			return item;   // too large to cache, or the cache is switched off
+		for (Entry const& entry : entries)
+			if (entry. key == key)
+				return entry. item;
+		entries. push_back ({ key, item, size });
+		totalSize += size;
+		shrink ();
+		return item;
+	}
+
+	void setMaximumSize (integer newMaximumSize) {
+		std::lock_guard <std::mutex> lock (mutex);
+		maximumSize = std::max (0_integer, newMaximumSize);
+		shrink ();
+	}
+
+	integer getMaximumSize () {
+		std::lock_guard <std::mutex> lock (mutex);
+		return maximumSize;
+	}
+
+	/*
+		Removes all items and resets the statistics.
+	*/
+	void clear () {
+		std::lock_guard <std::mutex> lock (mutex);
+		entries. clear ();
+		totalSize = numberOfHits = numberOfMisses = numberOfEvictions = 0;
+	}
+
+	void getStatistics (integer *out_numberOfItems, integer *out_totalSize,
+		integer *out_numberOfHits, integer *out_numberOfMisses, integer *out_numberOfEvictions)
+	{
+		std::lock_guard <std::mutex> lock (mutex);
+		if (out_numberOfItems)
+			*out_numberOfItems = uinteger_to_integer (entries. size ());
+		if (out_totalSize)
+			*out_totalSize = totalSize;
+		if (out_numberOfHits)
+			*out_numberOfHits = numberOfHits;
+		if (out_numberOfMisses)
+			*out_numberOfMisses = numberOfMisses;
+		if (out_numberOfEvictions)
+			*out_numberOfEvictions = numberOfEvictions;
+	}
+};
+
+/* End of file ReadOnlyCache.h */
+#endif
@@ -25,6 +25,8 @@
  */
 
 #include "CCs_to_DTW.h"
+#include "NUMsorting.h"
+#include "MelderThread.h"
 
 static void regression (const VEC r, const CC me, const integer frameNumber, const integer numberOfCoefficients) {
 
@@ -148,4 +150,292 @@ trace(6);
 	}
 }
 
+/*
+	The features of all frames as the rows of a matrix, weighted in such a way that the distance
+	between two frames as in CCs_to_DTW () is the Euclidean distance between their rows.
+	Near the edges, where no regression can be computed, the regression features are zero.
+*/
+static integer getNumberOfWeightedFeatures (integer maximumNumberOfCoefficients, double coefficientWeight, double logEnergyWeight,
+	double coefficientRegressionWeight, double logEnergyRegressionWeight)
+{
+	return ( coefficientWeight != 0.0 ? maximumNumberOfCoefficients : 0 ) + ( logEnergyWeight != 0.0 ? 1 : 0 ) +
+			( coefficientRegressionWeight != 0.0 ? maximumNumberOfCoefficients : 0 ) + ( logEnergyRegressionWeight != 0.0 ? 1 : 0 );
+}
+
+static void CC_getWeightedFeatures (CC me, MATVU const& features, double coefficientWeight, double logEnergyWeight,
+	double coefficientRegressionWeight, double logEnergyRegressionWeight, integer numberOfRegressionFrames)
+{
+	Melder_assert (features.nrow == my nx);
+	const double sumOfWeights = coefficientWeight + logEnergyWeight + coefficientRegressionWeight + logEnergyRegressionWeight;
+	const integer numberOfCoefficients = my maximumNumberOfCoefficients;
+	const bool regressionIsNeeded = ( coefficientRegressionWeight != 0.0 || logEnergyRegressionWeight != 0.0 );
+	autoVEC r = raw_VEC (numberOfCoefficients + 1);
+	features  <<=  0.0;
+	for (integer iframe = 1; iframe <= my nx; iframe ++) {
+		const CC_Frame frame = & my frame [iframe];
+		if (regressionIsNeeded) {
+			r.all()  <<=  0.0;
+			regression (r.get(), me, iframe, numberOfRegressionFrames);
+		}
+		integer ifeature = 0;
+		if (coefficientWeight != 0.0) {
+			const double weight = sqrt (coefficientWeight / sumOfWeights);
+			for (integer k = 1; k <= frame -> numberOfCoefficients; k ++)
+				features [iframe] [ifeature + k] = weight * frame -> c [k];
+			ifeature += numberOfCoefficients;
+		}
+		if (logEnergyWeight != 0.0)
+			features [iframe] [++ ifeature] = sqrt (logEnergyWeight / sumOfWeights) * frame -> c0;
+		if (coefficientRegressionWeight != 0.0) {
+			const double weight = sqrt (coefficientRegressionWeight / sumOfWeights);
+			for (integer k = 1; k <= frame -> numberOfCoefficients; k ++)
+				features [iframe] [ifeature + k] = weight * r [k + 1];
+			ifeature += numberOfCoefficients;
+		}
+		if (logEnergyRegressionWeight != 0.0)
+			features [iframe] [++ ifeature] = sqrt (logEnergyRegressionWeight / sumOfWeights) * r [1];
+	}
+}
+
+static double frameDistance (constVECVU const& x, constVECVU const& y) {
+	double sum = 0.0;
+	for (integer k = 1; k <= x.size; k ++) {
+		const double d = x [k] - y [k];
+		sum += d * d;
+	}
+	return sqrt (sum);
+}
+
+/*
+	As in DTW_to_Polygon (): if the relative duration conflicts with the slope constraint,
+	the path is searched without band and without slope constraint.
+*/
+static void relaxConstraints (double xDuration, double yDuration, double *inout_band, integer *inout_slope) {
+	const double maximumSlope [5] = { 0.0, 1e308, 3.0, 2.0, 1.5 };
+	double dtw_slope = (yDuration - *inout_band) / (xDuration - *inout_band);
+	bool constraintsCanBeMet = ! (dtw_slope == 0.0 && *inout_slope != 1);
+	if (dtw_slope < 1.0)
+		dtw_slope = 1.0 / dtw_slope;
+	constraintsCanBeMet = constraintsCanBeMet && dtw_slope <= maximumSlope [*inout_slope];
+	if (! constraintsCanBeMet) {
+		*inout_band = 0.0;
+		*inout_slope = 1;
+	}
+}
+
+/*
+	A lower bound for the weighted distance of the DTW of the query (rows) and the template (columns),
+	after Keogh & Ratanamahatana (2005).
+	For each column, the rows between lowestRow and highestRow contain all cells within the Sakoe-Chiba band;
+	the slope constraint can only make this region smaller.
+	Every column from `firstColumn` on has at least one cell on the path, and the distance in that cell
+	is at least the distance between the template frame and the envelope of the query frames in the window of its column.
+	The windows move up monotonically, so that the envelopes can be computed with one pass through the query per feature.
+*/
+static double getLowerBound (constMATVU const& query, constMATVU const& templ, double band, double ymin, double ymax, double dy, double y1,
+	double xmin, double xmax, double dx, double x1, integer firstColumn)
+{
+	const integer ny = query.nrow, nx = templ.nrow, numberOfFeatures = query.ncol;
+	const double xDuration = xmax - xmin, yDuration = ymax - ymin;
+	const bool isWithinBand = ( band > 0.0 && band < xDuration && band < yDuration );
+	const double bandSlope = ( isWithinBand ? (yDuration - band) / (xDuration - band) : 0.0 );
+	const double dtw_slope = yDuration / xDuration;
+	autoINTVEC lowestRow = raw_INTVEC (nx), highestRow = raw_INTVEC (nx);
+	for (integer ix = 1; ix <= nx; ix ++) {
+		integer lowest = 1, highest = ny;
+		if (isWithinBand) {
+			const double x = x1 + (ix - 1) * dx;
+			const double ylow = ( x <= xmin + band ? ymin : ymin + (x - xmin - band) * bandSlope );
+			const double yhigh = ( x >= xmax - band ? ymax : ymin + band + (x - xmin) * bandSlope );
+			const integer diagonalRow = Melder_ifloor (dtw_slope * ix * (dx / dy)) + 1;   // where DTW_Polygon_getBand () starts
+			lowest = std::min (Melder_ifloor ((ylow - y1) / dy), diagonalRow - 1);
+			highest = std::max (Melder_iceiling ((yhigh - y1) / dy) + 2, diagonalRow + 1);
+		}
+		lowestRow [ix] = Melder_clipped (integer (1), lowest, ny);
+		highestRow [ix] = Melder_clipped (integer (1), highest, ny);
+	}
+	autoVEC squaredGaps = zero_VEC (nx);
+	autoINTVEC maximumQueue = raw_INTVEC (ny), minimumQueue = raw_INTVEC (ny);
+	for (integer ifeature = 1; ifeature <= numberOfFeatures; ifeature ++) {
+		integer maximumHead = 1, maximumTail = 0, minimumHead = 1, minimumTail = 0, nextRow = 1;
+		for (integer ix = 1; ix <= nx; ix ++) {
+			for (; nextRow <= highestRow [ix]; nextRow ++) {
+				const double value = query [nextRow] [ifeature];
+				while (maximumTail >= maximumHead && query [maximumQueue [maximumTail]] [ifeature] <= value)
+					maximumTail --;
+				maximumQueue [++ maximumTail] = nextRow;
+				while (minimumTail >= minimumHead && query [minimumQueue [minimumTail]] [ifeature] >= value)
+					minimumTail --;
+				minimumQueue [++ minimumTail] = nextRow;
+			}
+			while (maximumQueue [maximumHead] < lowestRow [ix])
+				maximumHead ++;
+			while (minimumQueue [minimumHead] < lowestRow [ix])
+				minimumHead ++;
+			const double upper = query [maximumQueue [maximumHead]] [ifeature];
+			const double lower = query [minimumQueue [minimumHead]] [ifeature];
+			const double value = templ [ix] [ifeature];
+			const double gap = ( value > upper ? value - upper : value < lower ? lower - value : 0.0 );
+			squaredGaps [ix] += gap * gap;
+		}
+	}
+	double sum = 0.0;
+	for (integer ix = firstColumn; ix <= nx; ix ++)
+		sum += sqrt (squaredGaps [ix]);
+	return sum / (nx + ny);
+}
+
+autoTable CC_CCs_to_Table_dtw (CC me, OrderedOf<structCC>* thee,
+	const double coefficientWeight, const double logEnergyWeight,
+	const double coefficientRegressionWeight, const double logEnergyRegressionWeight,
+	const double regressionWindowLength, const double sakoeChibaBand, const int slope, const integer numberOfBestMatches
+) {
+	try {
+		const integer numberOfTemplates = thy size;
+		Melder_require (numberOfTemplates > 0,
+			U"There should be at least one template.");
+		Melder_require (coefficientWeight >= 0.0 && logEnergyWeight >= 0.0 && coefficientRegressionWeight >= 0.0 && logEnergyRegressionWeight >= 0.0,
+			U"The weights should not be negative.");
+		Melder_require (coefficientWeight + logEnergyWeight + coefficientRegressionWeight + logEnergyRegressionWeight > 0.0,
+			U"At least one of the weights should be positive.");
+		Melder_require (slope >= 1 && slope <= 4,
+			U"Invalid slope constraint.");
+		Melder_require (numberOfBestMatches >= 0,
+			U"The number of best matches should not be negative.");
+		for (integer itemplate = 1; itemplate <= numberOfTemplates; itemplate ++)
+			Melder_require (thy at [itemplate] -> maximumNumberOfCoefficients == my maximumNumberOfCoefficients,
+				U"The maximum number of coefficients of template ", itemplate, U" should be equal to that of the query.");
+		integer numberOfRegressionFrames = Melder_ifloor (regressionWindowLength / my dx);
+		Melder_require (! ((coefficientRegressionWeight != 0.0 || logEnergyRegressionWeight != 0.0) && numberOfRegressionFrames < 2),
+			U"Time window for regression is too small.");
+		if (numberOfRegressionFrames % 2 == 0)
+			numberOfRegressionFrames ++;
+
+		/*
+			The features of the query, and those of all templates in one matrix, template after template.
+			Each frame's features are computed only once, and so are the regressions.
+		*/
+		const integer numberOfFeatures = getNumberOfWeightedFeatures (my maximumNumberOfCoefficients,
+				coefficientWeight, logEnergyWeight, coefficientRegressionWeight, logEnergyRegressionWeight);
+		autoMAT queryFeatures = raw_MAT (my nx, numberOfFeatures);
+		CC_getWeightedFeatures (me, queryFeatures.get(), coefficientWeight, logEnergyWeight,
+				coefficientRegressionWeight, logEnergyRegressionWeight, numberOfRegressionFrames);
+		autoINTVEC firstFrame = raw_INTVEC (numberOfTemplates + 1);
+		firstFrame [1] = 1;
+		for (integer itemplate = 1; itemplate <= numberOfTemplates; itemplate ++)
+			firstFrame [itemplate + 1] = firstFrame [itemplate] + thy at [itemplate] -> nx;
+		autoMAT templateFeatures = raw_MAT (firstFrame [numberOfTemplates + 1] - 1, numberOfFeatures);
+		auto featuresOfTemplate = [&] (integer itemplate) -> MATVU {
+			return templateFeatures.horizontalBand (firstFrame [itemplate], firstFrame [itemplate + 1] - 1);
+		};
+
+		/*
+			The band and slope constraint per template, and the lower bounds, on all threads.
+		*/
+		autoVEC band = raw_VEC (numberOfTemplates);
+		autoINTVEC slopeConstraint = raw_INTVEC (numberOfTemplates);
+		autoVEC lowerBound = raw_VEC (numberOfTemplates);
+		const integer numberOfThreads = MelderThread_getNumberOfThreads ();
+		const integer numberOfTasks = std::min (numberOfThreads, numberOfTemplates);
+		MelderThread_runTasks (numberOfTasks, [&] (integer itask) {
+			const integer firstTemplate = 1 + (itask - 1) * numberOfTemplates / numberOfTasks;
+			const integer lastTemplate = itask * numberOfTemplates / numberOfTasks;
+			for (integer itemplate = firstTemplate; itemplate <= lastTemplate; itemplate ++) {
+				const CC templ = thy at [itemplate];
+				CC_getWeightedFeatures (templ, featuresOfTemplate (itemplate), coefficientWeight, logEnergyWeight,
+						coefficientRegressionWeight, logEnergyRegressionWeight, numberOfRegressionFrames);
+				band [itemplate] = sakoeChibaBand;
+				slopeConstraint [itemplate] = slope;
+				relaxConstraints (templ -> xmax - templ -> xmin, my xmax - my xmin, & band [itemplate], & slopeConstraint [itemplate]);
+				/*
+					Without slope constraint, the path can start anywhere in the first row
+					within 10 percent of the shortest duration, as in DTW_findPathInBand ().
+				*/
+				const integer firstColumn = ( slopeConstraint [itemplate] == 1 ?
+						Melder_clipped (integer (1), std::min (templ -> nx, my nx) / 10, templ -> nx) : 1 );
+				lowerBound [itemplate] = getLowerBound (queryFeatures.get(), featuresOfTemplate (itemplate), band [itemplate],
+						my xmin, my xmax, my dx, my x1, templ -> xmin, templ -> xmax, templ -> dx, templ -> x1, firstColumn);
+			}
+		});
+
+		/*
+			The exact distances, in the order of the lower bounds if we want only the best matches.
+			A template whose lower bound is above the distance of the current k-th best match cannot be among the k best,
+			and neither can all templates after it.
+			The templates are handled a few at a time, on all threads; for each template, only the distances
+			within its band are computed, and the cumulative distances are kept for the band only,
+			so that no DTW with a full distance matrix is needed.
+		*/
+		autoINTVEC order = ( numberOfBestMatches > 0 ? newINTVECindex (lowerBound.get()) : to_INTVEC (numberOfTemplates) );
+		autoVEC distance = raw_VEC (numberOfTemplates);
+		distance.all()  <<=  undefined;
+		autoVEC bestDistances = raw_VEC (numberOfBestMatches);
+		integer numberOfBestDistances = 0;
+		const integer numberOfTemplatesPerRound = 2 * numberOfThreads;
+		autoINTVEC templateInRound = raw_INTVEC (numberOfTemplatesPerRound);
+		autoMelderProgress progress (U"DTW distances");
+		integer nextTemplate = 1;
+		bool pruned = false;
+		while (nextTemplate <= numberOfTemplates && ! pruned) {
+			integer numberOfTemplatesInRound = 0;
+			while (nextTemplate <= numberOfTemplates && numberOfTemplatesInRound < numberOfTemplatesPerRound) {
+				const integer itemplate = order [nextTemplate ++];
+				if (numberOfBestDistances == numberOfBestMatches && numberOfBestMatches > 0 &&
+					lowerBound [itemplate] > bestDistances [numberOfBestMatches])
+				{
+					pruned = true;
+					break;
+				}
+				templateInRound [++ numberOfTemplatesInRound] = itemplate;
+			}
+			MelderThread_runTasks (numberOfTemplatesInRound, [&] (integer iround) {
+				const integer itemplate = templateInRound [iround];
+				const CC templ = thy at [itemplate];
+				const constMATVU templateFrames = featuresOfTemplate (itemplate);
+				autoINTVEC lowestRow = raw_INTVEC (templ -> nx), highestRow = raw_INTVEC (templ -> nx);
+				NUMgetDtwBand (my xmin, my xmax, my nx, my dx, my x1, templ -> xmin, templ -> xmax, templ -> nx, templ -> dx, templ -> x1,
+						band [itemplate], slopeConstraint [itemplate], lowestRow.get(), highestRow.get());
+				integer numberOfCellsInBand = 0;
+				for (integer ix = 1; ix <= templ -> nx; ix ++)
+					numberOfCellsInBand += std::max (highestRow [ix] - lowestRow [ix] + 1, integer (0));
+				autoVEC bandDistances = raw_VEC (numberOfCellsInBand);
+				integer icell = 0;
+				for (integer ix = 1; ix <= templ -> nx; ix ++)
+					for (integer iy = lowestRow [ix]; iy <= highestRow [ix]; iy ++)
+						bandDistances [++ icell] = frameDistance (queryFeatures.row (iy), templateFrames [ix]);
+				const double lastDistance = frameDistance (queryFeatures.row (my nx), templateFrames [templ -> nx]);
+				distance [itemplate] = NUMgetDtwDistanceInBand (my nx, lowestRow.get(), highestRow.get(),
+						bandDistances.get(), lastDistance, slopeConstraint [itemplate]);
+			});
+			for (integer iround = 1; iround <= numberOfTemplatesInRound; iround ++) {
+				const double d = distance [templateInRound [iround]];
+				if (numberOfBestMatches > 0) {
+					/*
+						Keep the best distances sorted.
+					*/
+					if (numberOfBestDistances < numberOfBestMatches)
+						bestDistances [++ numberOfBestDistances] = d;
+					else if (d < bestDistances [numberOfBestMatches])
+						bestDistances [numberOfBestMatches] = d;
+					for (integer i = numberOfBestDistances; i > 1 && bestDistances [i] < bestDistances [i - 1]; i --)
+						std::swap (bestDistances [i], bestDistances [i - 1]);
+				}
+			}
+			Melder_progress ((nextTemplate - 1.0) / numberOfTemplates, U"DTW distances: template ", nextTemplate - 1, U" of ", numberOfTemplates, U".");
+		}
+
+		conststring32 columnNames [] = { U"template", U"lowerBound", U"distance" };
+		autoTable him = Table_createWithColumnNames (numberOfTemplates, ARRAY_TO_STRVEC (columnNames));
+		for (integer itemplate = 1; itemplate <= numberOfTemplates; itemplate ++) {
+			const CC templ = thy at [itemplate];
+			Table_setStringValue (him.get(), itemplate, 1, templ -> name ? templ -> name.get() : U"");
+			Table_setNumericValue (him.get(), itemplate, 2, lowerBound [itemplate]);
+			Table_setNumericValue (him.get(), itemplate, 3, distance [itemplate]);
+		}
+		return him;
+	} catch (MelderError) {
+		Melder_throw (me, U": no Table with DTW distances created.");
+	}
+}
+
 /* End of file CCs_to_DTW.cpp */
@@ -27,6 +27,7 @@
 
 #include "CC.h"
 #include "DTW.h"
+#include "Table.h"
 
 
 autoDTW CCs_to_DTW (CC me, CC thee, double coefficientWeight, double logEnergyWeight, double coefficientRegressionWeight, double logEnergyRegressionWeight, double regressionWindowLength);
@@ -49,4 +50,16 @@ autoDTW CCs_to_DTW (CC me, CC thee, double coefficientWeight, double logEnergyWe
 	at least one of the four weights != 0
 */
 
+autoTable CC_CCs_to_Table_dtw (CC me, OrderedOf<structCC>* thee, double coefficientWeight, double logEnergyWeight,
+	double coefficientRegressionWeight, double logEnergyRegressionWeight, double regressionWindowLength,
+	double sakoeChibaBand, int slope, integer numberOfBestMatches);
+/*
+	The weighted DTW distance between the query (me) and each of the templates (thee), with frame distances
+	as in CCs_to_DTW () and the path found as in DTW_findPath_bandAndSlope ().
+	The Table has a row for each template, with its name, the lower bound and the distance.
+	If numberOfBestMatches > 0, the templates are searched in the order of their lower bounds,
+	and the search stops when the lower bound of the next template exceeds the distance of the k-th best match;
+	the remaining templates get an undefined distance.
+*/
+
 #endif /* _CCs_to_DTW_h_ */
@@ -41,6 +41,8 @@
 #include "Sound_extensions.h"
 #include "NUM2.h"
 #include "NUMmachar.h"
+#include "MelderThread.h"
+#include <optional>
 
 #include "oo_DESTROY.h"
 #include "DTW_def.h"
@@ -793,32 +795,47 @@ autoDTW Matrices_to_DTW (Matrix me, Matrix thee, bool matchStart, bool matchEnd,
 			U"Column sizes should be equal.");
 
 		autoDTW him = DTW_create (my xmin, my xmax, my nx, my dx, my x1, thy xmin, thy xmax, thy nx, thy dx, thy x1);
+		/*
+			The frames are the columns of the matrices; copy them to rows, so that each frame is contiguous.
+		*/
+		autoMAT myFrames = transpose_MAT (my z.get()), thyFrames = transpose_MAT (thy z.get());
+		const integer numberOfFeatures = my ny;
 		autoMelderProgress progess (U"Calculate distances");
-		for (integer i = 1; i <= my nx; i ++) {
-			for (integer j = 1; j <= thy nx; j ++) {
-				/*
-					First divide distance by maximum to prevent overflow when metric
-					is a large number.
-					d = (x^n)^(1/n) may overflow if x>1 & n >>1 even if d would not overflow!
-				*/
-				double dmax = 0.0, d = 0.0;
-				for (integer k = 1; k <= my ny; k ++) {
-					const double dtmp = fabs (my z [k] [i] - thy z [k] [j]);
-					if (dtmp > dmax)
-						dmax = dtmp;
-				}
-				if (dmax > 0) {
-					for (integer k = 1; k <= my ny; k ++) {
-						const double dtmp = fabs (my z [k] [i] - thy z [k] [j]) / dmax;
-						d +=  pow (dtmp, metric);
+		/*
+			The rows of the distance matrix are computed on separate threads,
+			a chunk of rows at a time, so that we can show the progress in between.
+		*/
+		const integer chunkSize = 10 * MelderThread_getNumberOfThreads ();
+		for (integer ifirst = 1; ifirst <= my nx; ifirst += chunkSize) {
+			const integer numberOfRowsInChunk = std::min (chunkSize, my nx - ifirst + 1);
+			MelderThread_runTasks (numberOfRowsInChunk, [&] (integer itask) {
+				const integer i = ifirst + itask - 1;
+				const constVEC myFrame = myFrames.row (i);
+				for (integer j = 1; j <= thy nx; j ++) {
+					const constVEC thyFrame = thyFrames.row (j);
+					/*
+						First divide distance by maximum to prevent overflow when metric
+						is a large number.
+						d = (x^n)^(1/n) may overflow if x>1 & n >>1 even if d would not overflow!
+					*/
+					double dmax = 0.0, d = 0.0;
+					for (integer k = 1; k <= numberOfFeatures; k ++) {
+						const double dtmp = fabs (myFrame [k] - thyFrame [k]);
+						if (dtmp > dmax)
+							dmax = dtmp;
+					}
+					if (dmax > 0) {
+						for (integer k = 1; k <= numberOfFeatures; k ++) {
+							const double dtmp = fabs (myFrame [k] - thyFrame [k]) / dmax;
+							d +=  pow (dtmp, metric);
+						}
 					}
+					d = dmax * pow (d, 1.0 / metric);
+					his z [i] [j] = d / numberOfFeatures; // == d * dy / ymax
 				}
-				d = dmax * pow (d, 1.0 / metric);
-				his z [i] [j] = d / my ny; // == d * dy / ymax
-			}
-			if ((i % 10) == 1) {
-				Melder_progress (0.999 * i / my nx, U"Calculate distances: column ", i, U" from ", my nx, U".");
-			}
+			});
+			Melder_progress (0.999 * (ifirst + numberOfRowsInChunk - 1) / my nx, U"Calculate distances: column ",
+					ifirst + numberOfRowsInChunk - 1, U" from ", my nx, U".");
 		}
 		DTW_findPath (him.get(), matchStart, matchEnd, slope);
 		return him;
@@ -1021,51 +1038,68 @@ static void DTW_checkSlopeConstraints (DTW me, double band, int slope) {
     }
 }
 
-static void DTW_Polygon_setUnreachableParts (DTW me, Polygon thee, INTMAT const& psi) {
+/*
+	For each column ix, the rows between which a path can go inside the Polygon:
+	we go up and down from the diagonal of the DTW until we find a cell outside the Polygon.
+	If `withinGivenRows` is true, lowestRow and highestRow come in with a window of rows for each column,
+	and we look only at the cells in that window, which is correct for a convex Polygon such as that of DTW_to_Polygon ().
+*/
+static void getBandInsidePolygon (
+	double xmin, double xmax, integer nx, double dx, double x1, double ymin, double ymax, integer ny, double dy, double y1,
+	constVEC const& vertexX, constVEC const& vertexY, INTVEC const& lowestRow, INTVEC const& highestRow, bool withinGivenRows)
+{
+	const double eps = dx / 100.0;   // safe enough
+	const double dtw_slope = (ymax - ymin) / (xmax - xmin);
+
+	// if the Polygon and the DTW don't overlap everything is unreachable!
+	Melder_require (! (NUMmax_e (vertexX) <= xmin || NUMmin_e (vertexX) >= xmax || NUMmax_e (vertexY) <= ymin || NUMmin_e (vertexY) >= ymax),
+		U"DTW and Polygon don't overlap.");
+
+	// find border "above" polygon
+	for (integer ix = 1; ix <= nx; ix ++) {
+		const double x = x1 + (ix - 1) * dx;
+		const integer iystart = Melder_ifloor (dtw_slope * ix * (dx / dy)) + 1;
+		const integer iyfrom = ( withinGivenRows ? std::max (iystart + 1, lowestRow [ix]) : iystart + 1 );
+		const integer iyto = ( withinGivenRows ? highestRow [ix] : ny );
+		highestRow [ix] = iyto;
+		for (integer iy = iyfrom; iy <= iyto; iy ++) {
+			const double y = y1 + (iy - 1) * dy;
+			if (NUMgetLocationOfPointInPolygon (vertexX, vertexY, x, y, eps) == Polygon_OUTSIDE) {
+				highestRow [ix] = iy - 1;
+				break;
+			}
+		}
+	}
+	// find border "below" polygon
+	if (! withinGivenRows)
+		lowestRow [1] = 1;
+	for (integer ix = 2; ix <= nx; ix ++) {
+		const double x = x1 + (ix - 1) * dx;
+		integer iystart = Melder_ifloor (dtw_slope * ix * (dx / dy));   // start 1 lower
+		if (iystart > ny)
+			iystart = ny;
+		const integer iyfrom = ( withinGivenRows ? std::min (iystart - 1, highestRow [ix]) : iystart - 1 );
+		const integer iyto = ( withinGivenRows ? lowestRow [ix] : 1 );
+		lowestRow [ix] = iyto;
+		for (integer iy = iyfrom; iy >= iyto; iy --) {
+			const double y = y1 + (iy - 1) * dy;
+			if (NUMgetLocationOfPointInPolygon (vertexX, vertexY, x, y, eps) == Polygon_OUTSIDE) {
+				lowestRow [ix] = iy + 1;
+				break;
+			}
+		}
+	}
+}
+
+void DTW_Polygon_getBand (DTW me, Polygon thee, INTVEC const& lowestRow, INTVEC const& highestRow, bool withinGivenRows) {
     try {
-        const double eps = my dx / 100.0;   // safe enough
-        const double dtw_slope = (my ymax - my ymin) / (my xmax - my xmin);
-
-        double xmin, xmax, ymin, ymax;
-        Polygon_getExtrema (thee, & xmin, & xmax, & ymin, & ymax);
-        // if the Polygon and the DTW don't overlap everything is unreachable!
-		Melder_require (! (xmax <= my xmin || xmin >= my xmax || ymax <= my ymin || ymin >= my ymax),
-			U"DTW and Polygon don't overlap.");
-
-        // find border "above" polygon
-        for (integer ix = 1; ix <= my nx; ix ++) {
-            const double x = my x1 + (ix - 1) * my dx;
-            const integer iystart = Melder_ifloor (dtw_slope * ix * (my dx / my dy)) + 1;
-            for (integer iy = iystart + 1; iy <= my ny; iy ++) {
-				const double y = my y1 + (iy - 1) * my dy;
-                if (Polygon_getLocationOfPoint (thee, x, y, eps) == Polygon_OUTSIDE) {
-                    for (integer k = iy; k <= my ny; k ++)
-                        psi [k] [ix] = DTW_UNREACHABLE;
-                    break;
-                }
-            }
-        }
-        // find border "below" polygon
-        for (integer ix = 2; ix <= my nx; ix ++) {
-            const double x = my x1 + (ix - 1) * my dx;
-            integer iystart = Melder_ifloor (dtw_slope * ix * (my dx / my dy));   // start 1 lower
-            if (iystart > my ny)
-				iystart = my ny;
-            for (integer iy = iystart - 1; iy >= 1; iy --) {
-                const double y = my y1 + (iy - 1) * my dy;
-                if (Polygon_getLocationOfPoint (thee, x, y, eps) == Polygon_OUTSIDE) {
-                    for (integer k = iy; k >= 1; k --)
-                        psi [k] [ix] = DTW_UNREACHABLE;
-                    break;
-                }
-            }
-        }
+		getBandInsidePolygon (my xmin, my xmax, my nx, my dx, my x1, my ymin, my ymax, my ny, my dy, my y1,
+				thy x.part (1, thy numberOfPoints), thy y.part (1, thy numberOfPoints), lowestRow, highestRow, withinGivenRows);
     } catch (MelderError) {
         Melder_throw (me, U" cannot set unreachable parts.");
     }
 }
 
-#define DTW_ISREACHABLE(y,x) ((psi [y] [x] != DTW_UNREACHABLE) && (psi [y] [x] != DTW_FORBIDDEN))
 static void DTW_findPath_special (DTW me, bool /* matchStart */, bool /* matchEnd */, int slope, autoMatrix *cumulativeDists) {
 	try {
 		autoPolygon thee = DTW_to_Polygon (me, 0.0, slope);
@@ -1084,6 +1118,112 @@ static void getIntersectionPoint (double x1, double y1, double x2, double y2, do
 	*y3 = a * *x3 + y1 - a * x1;
 }
 
+/*
+	The vertices of the Polygon of DTW_to_Polygon (), for the time domains of a DTW only.
+	vertexX and vertexY should have room for 8 vertices; returns the number of vertices.
+*/
+static integer getVerticesOfBandPolygon (double xmin, double xmax, double ymin, double ymax, double band, int slope,
+	VEC const& vertexX, VEC const& vertexY)
+{
+	Melder_assert (vertexX.size >= 8 && vertexY.size >= 8);
+    double slopes [5] = { DTW_BIG, DTW_BIG, 3.0, 2.0, 1.5 } ;
+    if (band <= 0) {
+        if (slope == 1) {
+            vertexX [1] = xmin;
+			vertexY [1] = ymin;
+            vertexX [2] = xmin;
+			vertexY [2] = ymax;
+            vertexX [3] = xmax;
+			vertexY [3] = ymax;
+            vertexX [4] = xmax;
+			vertexY [4] = ymin;
+            return 4;
+        } else {
+            vertexX [1] = xmin;
+			vertexY [1] = ymin;
+            vertexX [3] = xmax;
+			vertexY [3] = ymax;
+            double x, y;
+            getIntersectionPoint (xmin, ymin, xmax, ymax, slopes [slope], & x, & y);
+            if (x < xmin)
+				x = xmin;
+            if (x > xmax)
+				x = xmax;
+            if (y < ymin)
+				y = ymin;
+            if (y > ymax)
+				y = ymax;
+            vertexX [2] = x;
+            vertexY [2] = y;
+            getIntersectionPoint (xmin, ymin, xmax, ymax, 1.0 / slopes [slope], & x, & y);
+            if (x < xmin)
+				x = xmin;
+            if (x > xmax)
+				x = xmax;
+            if (y < ymin)
+				y = ymin;
+            if (y > ymax)
+				y = ymax;
+            vertexX [4] = x;
+            vertexY [4] = y;
+            return 4;
+        }
+    } else {
+        if (slope == 1) {
+            vertexX [1] = xmin;
+			vertexY [1] = ymin;
+            vertexX [2] = xmin;
+			vertexY [2] = ymin + band;
+            vertexX [3] = xmax - band;
+			vertexY [3] = ymax;
+            vertexX [4] = xmax;
+			vertexY [4] = ymax;
+            vertexX [5] = xmax;
+			vertexY [5] = ymax - band;
+            vertexX [6] = xmin + band;
+			vertexY [6] = ymin;
+            return 6;
+        } else {
+            double x, y;
+            vertexX [1] = xmin;
+			vertexY [1] = ymin;
+            vertexX [2] = xmin;
+			vertexY [2] = ymin + band;
+            getIntersectionPoint (xmin, ymin + band, xmax - band, ymax, slopes [slope], & x, & y);
+            if (x < xmin)
+				x = xmin;
+            if (x > xmax)
+				x = xmax;
+            if (y < ymin)
+				y = ymin;
+            if (y > ymax)
+				y = ymax;
+            vertexX [3] = x;
+            vertexY [3] = y;
+            vertexX [4] = xmax - band;
+			vertexY [4] = ymax;
+            vertexX [5] = xmax;
+			vertexY [5]= ymax;
+            vertexX [6] = xmax;
+			vertexY [6] = ymax - band;
+            getIntersectionPoint (xmin + band, ymin, xmax, ymax - band, 1.0 / slopes [slope], & x, & y);
+            if (x < xmin)
+				x = xmin;
+            if (x > xmax)
+				x = xmax;
+            if (y < ymin)
+				y = ymin;
+            if (y > ymax)
+				y = ymax;
+            vertexX [7] = x;
+            vertexY [7] = y;
+            vertexX [8] = xmin + band;
+			vertexY [8] = ymin;
+            return 8;
+        }
+    }
+}
+
 autoPolygon DTW_to_Polygon (DTW me, double band, int slope) {
     try {
 		try {
@@ -1092,107 +1232,13 @@ autoPolygon DTW_to_Polygon (DTW me, double band, int slope) {
 			DTW_relaxConstraints (me, band, slope, & band, & slope);
 			Melder_flushError ();
 		}
-			
-        double slopes [5] = { DTW_BIG, DTW_BIG, 3.0, 2.0, 1.5 } ;
-        if (band <= 0) {
-            if (slope == 1) {
-                autoPolygon thee = Polygon_create (4);
-                thy x [1] = my xmin;
-				thy y [1] = my ymin;
-                thy x [2] = my xmin;
-				thy y [2] = my ymax;
-                thy x [3] = my xmax;
-				thy y [3] = my ymax;
-                thy x [4] = my xmax;
-				thy y [4] = my ymin;
-                return thee;
-            } else {
-                autoPolygon thee = Polygon_create (4);
-                thy x [1] = my xmin;
-				thy y [1] = my ymin;
-                thy x [3] = my xmax;
-				thy y [3] = my ymax;
-                double x, y;
-                getIntersectionPoint (my xmin, my ymin, my xmax, my ymax, slopes [slope], & x, & y);
-                if (x < my xmin)
-					x = my xmin;
-                if (x > my xmax)
-					x = my xmax;
-                if (y < my ymin)
-					y = my ymin;
-                if (y > my ymax)
-					y = my ymax;
-                thy x [2] = x;
-                thy y [2] = y;
-                getIntersectionPoint (my xmin, my ymin, my xmax, my ymax, 1.0 / slopes [slope], & x, & y);
-                if (x < my xmin)
-					x = my xmin;
-                if (x > my xmax)
-					x = my xmax;
-                if (y < my ymin)
-					y = my ymin;
-                if (y > my ymax)
-					y = my ymax;
-                thy x [4] = x;
-                thy y [4] = y;
-                return thee;
-            }
-        } else {
-            if (slope == 1) {
-                autoPolygon thee = Polygon_create (6);
-                thy x [1] = my xmin;
-				thy y [1] = my ymin;
-                thy x [2] = my xmin;
-				thy y [2] = my ymin + band;
-                thy x [3] = my xmax - band;
-				thy y [3] = my ymax;
-                thy x [4] = my xmax;
-				thy y [4] = my ymax;
-                thy x [5] = my xmax;
-				thy y [5] = my ymax - band;
-                thy x [6] = my xmin + band;
-				thy y [6] = my ymin;
-                return thee;
-            } else {
-                autoPolygon thee = Polygon_create (8);
-                double x, y;
-                thy x [1] = my xmin;
-				thy y [1] = my ymin;
-                thy x [2] = my xmin;
-				thy y [2] = my ymin + band;
-                getIntersectionPoint (my xmin, my ymin + band, my xmax - band, my ymax, slopes [slope], & x, & y);
-                if (x < my xmin)
-					x = my xmin;
-                if (x > my xmax)
-					x = my xmax;
-                if (y < my ymin)
-					y = my ymin;
-                if (y > my ymax)
-					y = my ymax;
-                thy x [3] = x;
-                thy y [3] = y;
-                thy x [4] = my xmax - band;
-				thy y [4] = my ymax;
-                thy x [5] = my xmax;
-				thy y [5]= my ymax;
-                thy x [6] = my xmax;
-				thy y [6] = my ymax - band;
-                getIntersectionPoint (my xmin + band, my ymin, my xmax, my ymax - band, 1.0 / slopes [slope], & x, & y);
-                if (x < my xmin)
-					x = my xmin;
-                if (x > my xmax)
-					x = my xmax;
-                if (y < my ymin)
-					y = my ymin;
-                if (y > my ymax)
-					y = my ymax;
-                thy x [7] = x;
-                thy y [7] = y;
-                thy x [8] = my xmin + band;
-				thy y [8] = my ymin;
-                return thee;
-            }
-        }
+		double x [8], y [8];
+		const integer numberOfPoints = getVerticesOfBandPolygon (my xmin, my xmax, my ymin, my ymax, band, slope,
+				VEC (x, 8), VEC (y, 8));
+		autoPolygon thee = Polygon_create (numberOfPoints);
+		thy x.all()  <<=  constVEC (x, numberOfPoints);
+		thy y.all()  <<=  constVEC (y, numberOfPoints);
+		return thee;
     } catch (MelderError) {
         Melder_throw (me, U" no Polygon created.");
     }
@@ -1217,221 +1263,411 @@ void DTW_findPath_bandAndSlope (DTW me, double sakoeChibaBand, int localSlope, a
     }
 }
 
-void DTW_Polygon_findPathInside (DTW me, Polygon thee, int localSlope, autoMatrix *cumulativeDists) {
-	try {
-		const double slopes [5] = { DTW_BIG, DTW_BIG, 3.0, 2.0, 1.5 };
-		// if localSlope == 1 start of path is within 10% of minimum duration. Starts farther away
-		integer delta_xy = std::min (my nx, my ny) / 10; // if localSlope == 1 start within 10% of
+static integer getLengthOfBeginPart (integer n, integer nx, integer ny, int localSlope) {
+	const double slopes [5] = { DTW_BIG, DTW_BIG, 3.0, 2.0, 1.5 };
+	const integer delta_xy = std::min (nx, ny) / 10;   // if localSlope == 1 start of path is within 10% of minimum duration
+	return std::min (( localSlope != 1 ? Melder_ifloor (slopes [localSlope]) + 1 : delta_xy ), n);
+}
 
-		Melder_require (localSlope > 0 && localSlope < 5,
-			U"Local slope parameter ", localSlope, U" not supported.");
+/*
+	Column ix of the band starts at element bandOffset [ix] + lowestRow [ix]; returns the number of cells in the band.
+*/
+static integer getBandOffsets (constINTVEC const& lowestRow, constINTVEC const& highestRow, INTVEC const& bandOffset) {
+	integer numberOfCellsInBand = 0;
+	for (integer ix = 1; ix <= bandOffset.size; ix ++) {
+		bandOffset [ix] = numberOfCellsInBand - lowestRow [ix] + 1;
+		numberOfCellsInBand += std::max (highestRow [ix] - lowestRow [ix] + 1, integer (0));
+	}
+	return numberOfCellsInBand;
+}
 
-		autoMAT delta = copy_MAT (my z.get());
-		autoINTMAT psi = zero_INTMAT (my ny, my nx);
-		/*
-			Start by making the outside unreachable.
-		*/
-		for (integer j = 1; j <= my nx; j ++)
-			psi [1] [j] = DTW_UNREACHABLE;
-		for (integer i = 1; i <= my ny; i ++)
-			psi [i] [1] = DTW_UNREACHABLE;
+/*
+	The search for the path considers, in each column ix, only the cells between the rows lowestRow [ix] and highestRow [ix].
+	The cumulative distances and the directions are kept for these cells only,
+	so that the memory needed grows with the width of the band rather than with the size of the distance matrix.
+	A cell outside the band is unreachable, and its cumulative distance is its distance.
+	The distance of a cell is `z (iy, ix)`; the forward pass asks for it only in the band, in the begin parts
+	of the first row and column, and in the top right cell.
+	Returns the minimum cumulative distance in the last column, and the row where it lies.
+*/
+template <typename Distance>
+static double findCumulativeDistancesInBand (integer nx, integer ny, constINTVEC const& lowestRow, constINTVEC const& highestRow,
+	constINTVEC const& bandOffset, int localSlope, Distance z, VEC const& bandDelta, vector <int8> const& bandPsi,
+	bool showProgress, integer *out_lastRow)
+{
+	auto isInBand = [&] (integer iy, integer ix) -> bool {
+		return iy >= lowestRow [ix] && iy <= highestRow [ix];
+	};
+	auto delta = [&] (integer iy, integer ix) -> double& {
+		return bandDelta [bandOffset [ix] + iy];
+	};
+	auto psiInBand = [&] (integer iy, integer ix) -> int8& {
+		return bandPsi [bandOffset [ix] + iy];
+	};
+	auto psi = [&] (integer iy, integer ix) -> int {
+		return isInBand (iy, ix) ? psiInBand (iy, ix) : DTW_UNREACHABLE;
+	};
+	auto isReachable = [&] (integer iy, integer ix) -> bool {
+		return psi (iy, ix) != DTW_UNREACHABLE && psi (iy, ix) != DTW_FORBIDDEN;
+	};
+	auto cumulativeDistance = [&] (integer iy, integer ix) -> double {
+		return isInBand (iy, ix) ? delta (iy, ix) : z (iy, ix);
+	};
 
-		/*
-			Make begin part of first column reachable.
-		*/
-		const integer rowto = ( localSlope != 1 ? Melder_ifloor (slopes [localSlope]) + 1 : delta_xy );
-		for (integer iy = 2; iy <= rowto; iy ++) {
-			if (localSlope != 1) {
-				delta [iy] [1] = delta [iy - 1] [1] + my z [iy] [1];
-				psi [iy] [1] = DTW_Y;
-			} else {
-				psi [iy] [1] = DTW_START;   // will be adapted by DTW_Polygon_setUnreachableParts
-			}
+	/*
+		Start by making the first row and the first column unreachable.
+	*/
+	for (integer ix = 1; ix <= nx; ix ++) {
+		for (integer iy = lowestRow [ix]; iy <= highestRow [ix]; iy ++) {
+			delta (iy, ix) = z (iy, ix);
+			psiInBand (iy, ix) = ( iy == 1 || ix == 1 ? DTW_UNREACHABLE : 0 );
 		}
-		/*
-			Make begin part of first row reachable.
-		*/
-		const integer colto = ( localSlope != 1 ? Melder_ifloor (slopes [localSlope]) + 1 : delta_xy );
-		for (integer ix = 2; ix <= colto; ix ++) {
-			if (localSlope != 1) {
-				delta [1] [ix] = delta [1] [ix -1] + my z [1] [ix];
-				psi [1] [ix] = DTW_X;
-			} else {
-				psi [1] [ix] = DTW_START;   // will be adapted by DTW_Polygon_setUnreachableParts
-			}
+	}
+
+	/*
+		Make begin part of first column reachable.
+	*/
+	const integer rowto = getLengthOfBeginPart (ny, nx, ny, localSlope);
+	double beginDistance = z (1, 1);
+	for (integer iy = 2; iy <= rowto; iy ++) {
+		beginDistance += z (iy, 1);
+		if (! isInBand (iy, 1))
+			continue;
+		if (localSlope != 1) {
+			delta (iy, 1) = beginDistance;
+			psiInBand (iy, 1) = DTW_Y;
+		} else {
+			psiInBand (iy, 1) = DTW_START;
+		}
+	}
+	/*
+		Make begin part of first row reachable.
+	*/
+	const integer colto = getLengthOfBeginPart (nx, nx, ny, localSlope);
+	beginDistance = z (1, 1);
+	for (integer ix = 2; ix <= colto; ix ++) {
+		beginDistance += z (1, ix);
+		if (! isInBand (1, ix))
+			continue;
+		if (localSlope != 1) {
+			delta (1, ix) = beginDistance;
+			psiInBand (1, ix) = DTW_X;
+		} else {
+			psiInBand (1, ix) = DTW_START;
 		}
+	}
 
-		/*
-			Now we can set the unreachable parts from the Polygon.
-		*/
-		DTW_Polygon_setUnreachableParts (me, thee, psi.get());
+	/*
+		Forward pass.
+	*/
+	integer numberOfIsolatedPoints = 0;
+	std::optional <autoMelderProgress> progress;   // only the interactive caller shows progress; the others may run on several threads
+	if (showProgress)
+		progress.emplace (U"Find path");
+	for (integer j = 2; j <= nx; j ++) {
+		for (integer i = std::max (lowestRow [j], integer (2)); i <= highestRow [j]; i ++) {
+			double g, gmin = DTW_BIG;
+			integer direction = 0;
+			if (isReachable (i - 1, j - 1)) {
+				gmin = delta (i - 1, j - 1) + 2.0 * z (i, j);
+				direction = DTW_XANDY;
+			} else if (isReachable (i, j - 1)) {
+				gmin = delta (i, j - 1) + z (i, j);
+				direction = DTW_X;
+			} else if (isReachable (i - 1, j)) {
+				gmin = delta (i - 1, j) + z (i, j);
+				direction = DTW_Y;
+			} else {
+				numberOfIsolatedPoints ++;
+				continue;
+			}
 
-		/*
-			Forward pass.
-		*/
-		integer numberOfIsolatedPoints = 0;
-		autoMelderProgress progress (U"Find path");
-		for (integer j = 2; j <= my nx; j ++) {
-			for (integer i = 2; i <= my ny; i ++) {
-				if (! DTW_ISREACHABLE (i, j))
-					continue;
-				double g, gmin = DTW_BIG;
-				integer direction = 0;
-				if (DTW_ISREACHABLE (i - 1, j - 1)) {
-					gmin = delta [i - 1] [j - 1] + 2.0 * my z [i] [j];
-					direction = DTW_XANDY;
-				} else if (DTW_ISREACHABLE (i, j - 1)) {
-					gmin = delta [i] [j - 1] + my z [i] [j];
+			switch (localSlope) {
+			case 1:  {   // no restriction
+				if (isReachable (i, j - 1) && ((g = delta (i, j - 1) + z (i, j)) < gmin)) {
+					gmin = g;
 					direction = DTW_X;
-				} else if (DTW_ISREACHABLE (i - 1, j)) {
-					gmin = delta [i - 1] [j] + my z [i] [j];
+				}
+				if (isReachable (i - 1, j) && ((g = delta (i - 1, j) + z (i, j)) < gmin)) {
+					gmin = g;
 					direction = DTW_Y;
-				} else {
-					numberOfIsolatedPoints ++;
-					continue;
 				}
-
-				switch (localSlope) {
-				case 1:  {   // no restriction
-					if (DTW_ISREACHABLE (i, j - 1) && ((g = delta [i] [j - 1] + my z [i] [j]) < gmin)) {
-						gmin = g;
-						direction = DTW_X;
-					}
-					if (DTW_ISREACHABLE (i - 1, j) && ((g = delta [i - 1] [j] + my z [i] [j]) < gmin)) {
-						gmin = g;
-						direction = DTW_Y;
-					}
+			}
+			break;
+
+			/*
+				Sakoe & Chiba (1978) define the slope constraint measure as P = n / m, 
+					where n is the number of steps in the diagonal and 
+					m the number of steps in one of the other directions.
+					
+				P = 1/2
+			*/
+			case 2: {   // P = 1/2
+				if (j >= 4 && isReachable (i - 1, j - 3) && psi (i, j - 1) == DTW_X && psi (i, j - 2) == DTW_XANDY &&
+					(g = delta (i-1, j-3) + 2.0 * z (i, j-2) + z (i, j-1) + z (i, j)) < gmin) {
+					gmin = g;
+					direction = DTW_X;
 				}
-				break;
-
-				/*
-					Sakoe & Chiba (1978) define the slope constraint measure as P = n / m, 
-						where n is the number of steps in the diagonal and 
-						m the number of steps in one of the other directions.
-						
-					P = 1/2
-				*/
-				case 2: {   // P = 1/2
-					if (j >= 4 && DTW_ISREACHABLE (i - 1, j - 3) && psi [i] [j - 1] == DTW_X && psi [i] [j - 2] == DTW_XANDY &&
-						(g = delta [i-1] [j-3] + 2.0 * my z [i] [j-2] + my z [i] [j-1] + my z [i] [j]) < gmin) {
-						gmin = g;
-						direction = DTW_X;
-					}
-					if (j >= 3 && DTW_ISREACHABLE (i - 1, j - 2) && psi [i] [j - 1] == DTW_XANDY &&
-						(g = delta [i - 1] [j - 2] + 2.0 * my z [i] [j - 1] + my z [i] [j]) < gmin) {
-						gmin = g;
-						direction = DTW_X;
-					}
-					if (i >= 3 && DTW_ISREACHABLE (i - 2, j - 1) && psi [i - 1] [j] == DTW_XANDY &&
-						(g = delta [i - 2] [j - 1] + 2.0 * my z [i - 1] [j] + my z [i] [j]) < gmin) {
-						gmin = g;
-						direction = DTW_Y;
-					}
-					if (i >= 4 && DTW_ISREACHABLE (i - 3, j - 1) && psi [i - 1] [j] == DTW_Y && psi [i - 2] [j] == DTW_XANDY &&
-						(g = delta [i-3] [j-1] + 2.0 * my z [i-2] [j] + my z [i-1] [j] + my z [i] [j]) < gmin) {
-						gmin = g;
-						direction = DTW_Y;
-					}
+				if (j >= 3 && isReachable (i - 1, j - 2) && psi (i, j - 1) == DTW_XANDY &&
+					(g = delta (i - 1, j - 2) + 2.0 * z (i, j - 1) + z (i, j)) < gmin) {
+					gmin = g;
+					direction = DTW_X;
 				}
-				break;
+				if (i >= 3 && isReachable (i - 2, j - 1) && psi (i - 1, j) == DTW_XANDY &&
+					(g = delta (i - 2, j - 1) + 2.0 * z (i - 1, j) + z (i, j)) < gmin) {
+					gmin = g;
+					direction = DTW_Y;
+				}
+				if (i >= 4 && isReachable (i - 3, j - 1) && psi (i - 1, j) == DTW_Y && psi (i - 2, j) == DTW_XANDY &&
+					(g = delta (i-3, j-1) + 2.0 * z (i-2, j) + z (i-1, j) + z (i, j)) < gmin) {
+					gmin = g;
+					direction = DTW_Y;
+				}
+			}
+			break;
 
-				// P = 1
+			// P = 1
 
-				case 3: {
-					if (j >= 3 && DTW_ISREACHABLE (i - 1, j - 2) && psi [i] [j - 1] == DTW_XANDY &&
-							(g = delta [i - 1] [j - 2] + 2.0 * my z [i] [j - 1] + my z [i] [j]) < gmin)
-					{
-						gmin = g;
-						direction = DTW_X;
-					}
-					if (i >= 3 && DTW_ISREACHABLE (i - 2, j - 1) && psi [i - 1] [j] == DTW_XANDY &&
-							(g = delta [i - 2] [j - 1] + 2.0 * my z [i - 1] [j] + my z [i] [j]) < gmin)
-					{
-						gmin = g;
-						direction = DTW_Y;
-					}
+			case 3: {
+				if (j >= 3 && isReachable (i - 1, j - 2) && psi (i, j - 1) == DTW_XANDY &&
+						(g = delta (i - 1, j - 2) + 2.0 * z (i, j - 1) + z (i, j)) < gmin)
+				{
+					gmin = g;
+					direction = DTW_X;
 				}
-				break;
+				if (i >= 3 && isReachable (i - 2, j - 1) && psi (i - 1, j) == DTW_XANDY &&
+						(g = delta (i - 2, j - 1) + 2.0 * z (i - 1, j) + z (i, j)) < gmin)
+				{
+					gmin = g;
+					direction = DTW_Y;
+				}
+			}
+			break;
 
-                // P = 2
+			// P = 2
 
-				case 4: {
-					if (i >= 3 && j >= 4 && DTW_ISREACHABLE (i - 2, j - 3) && psi [i] [j - 1] == DTW_XANDY && psi [i - 1] [j - 2] == DTW_XANDY &&
-							(g = delta [i-2] [j-3] + 2.0 * my z [i-1] [j-2] + 2.0 * my z [i] [j-1] + my z [i] [j]) < gmin)
-					{
-						gmin = g;
-						direction = DTW_X;
-					}
-					if (i >= 4 && j >= 3 && DTW_ISREACHABLE (i - 3, j - 2) && psi [i - 1] [j] == DTW_XANDY && psi [i - 2] [j - 1] == DTW_XANDY &&
-							(g = delta [i-3] [j-2] + 2.0 * my z [i-2] [j-1] + 2.0 * my z [i-1] [j] + my z [i] [j]) < gmin)
-					{
-						gmin = g;
-						direction = DTW_Y;
-					}
+			case 4: {
+				if (i >= 3 && j >= 4 && isReachable (i - 2, j - 3) && psi (i, j - 1) == DTW_XANDY && psi (i - 1, j - 2) == DTW_XANDY &&
+						(g = delta (i-2, j-3) + 2.0 * z (i-1, j-2) + 2.0 * z (i, j-1) + z (i, j)) < gmin)
+				{
+					gmin = g;
+					direction = DTW_X;
 				}
-				break;
-				default:
-				break;
+				if (i >= 4 && j >= 3 && isReachable (i - 3, j - 2) && psi (i - 1, j) == DTW_XANDY && psi (i - 2, j - 1) == DTW_XANDY &&
+						(g = delta (i-3, j-2) + 2.0 * z (i-2, j-1) + 2.0 * z (i-1, j) + z (i, j)) < gmin)
+				{
+					gmin = g;
+					direction = DTW_Y;
 				}
-				Melder_assert (direction != 0);
-				psi [i] [j] = direction;
-				delta [i] [j] = gmin;
 			}
-			if (j % 10 == 2)
-				Melder_progress (0.999 * j / my nx, U"Calculate time warp: frame ", j, U" from ", my nx, U".");
+			break;
+			default:
+			break;
+			}
+			Melder_assert (direction != 0);
+			psiInBand (i, j) = direction;
+			delta (i, j) = gmin;
 		}
+		if (showProgress && j % 10 == 2)
+			Melder_progress (0.999 * j / nx, U"Calculate time warp: frame ", j, U" from ", nx, U".");
+	}
 
-		/*
-			Find minimum at end of path and trace back.
-		*/
-		integer iy = my ny;
-		double minimum = delta [iy] [my nx];
-		for (integer i = my ny - 1; i > 0; i --) {
-			if (! DTW_ISREACHABLE (i, my nx)) {
-				break;   // we're in unreachable places
-			} else if (delta [i] [my nx] < minimum) {
-				minimum = delta [iy = i] [my nx];
-			}
+	/*
+		Find minimum at end of path.
+	*/
+	integer iy = ny;
+	double minimum = cumulativeDistance (iy, nx);
+	for (integer i = ny - 1; i > 0; i --) {
+		if (! isReachable (i, nx)) {
+			break;   // we're in unreachable places
+		} else if (delta (i, nx) < minimum) {
+			minimum = delta (iy = i, nx);
 		}
+	}
+	*out_lastRow = iy;
+	return minimum;
+}
 
-		integer pathIndex = my nx + my ny - 1;   // maximum path length
-		my weightedDistance = minimum / (my nx + my ny);
+void DTW_findPathInBand (DTW me, constINTVEC const& lowestRow, constINTVEC const& highestRow, int localSlope, autoMatrix *cumulativeDists, bool showProgress) {
+	Melder_require (localSlope > 0 && localSlope < 5,
+		U"Local slope parameter ", localSlope, U" not supported.");
+
+	autoINTVEC bandOffset = raw_INTVEC (my nx);
+	const integer numberOfCellsInBand = getBandOffsets (lowestRow, highestRow, bandOffset.get());
+	autoVEC bandDelta = raw_VEC (numberOfCellsInBand);
+	autovector <int8> bandPsi = newvectorraw <int8> (numberOfCellsInBand);
+	auto delta = [&] (integer iy, integer ix) -> double& {
+		return bandDelta [bandOffset [ix] + iy];
+	};
+	auto psi = [&] (integer iy, integer ix) -> int {
+		return iy >= lowestRow [ix] && iy <= highestRow [ix] ? bandPsi [bandOffset [ix] + iy] : DTW_UNREACHABLE;
+	};
+	integer iy;
+	const double minimum = findCumulativeDistancesInBand (my nx, my ny, lowestRow, highestRow, bandOffset.get(), localSlope,
+		[&] (integer jy, integer jx) -> double { return my z [jy] [jx]; },
+		bandDelta.get(), bandPsi.get(), showProgress, & iy
+	);
+
+	/*
+		Trace back.
+	*/
+	integer pathIndex = my nx + my ny - 1;   // maximum path length
+	my path.resize (pathIndex);   // a copied or read DTW has room only for its previous path
+	my weightedDistance = minimum / (my nx + my ny);
+	my path [pathIndex]. y = iy;
+	integer ix = my path [pathIndex]. x = my nx;
+
+	/*
+		Fill path backwards.
+	*/
+	while (ix > 1) {
+		const int psi_iy_ix = psi (iy, ix);
+		if (psi_iy_ix == DTW_XANDY) {
+			ix --;
+			iy --;
+		} else if (psi_iy_ix == DTW_X) {
+			ix --;
+		} else if (psi_iy_ix == DTW_Y) {
+			iy --;
+		} else if (psi_iy_ix == DTW_START) {
+			break;
+		}
+		if (pathIndex < 2 || iy < 1)
+			break;
+		//Melder_assert (pathIndex > 1 && iy > 0);
+		my path [-- pathIndex]. x = ix;
 		my path [pathIndex]. y = iy;
-		integer ix = my path [pathIndex]. x = my nx;
+	}
 
-		/*
-			Fill path backwards.
-		*/
-		while (ix > 1) {
-			if (psi [iy] [ix] == DTW_XANDY) {
-				ix --;
-				iy --;
-			} else if (psi [iy] [ix] == DTW_X) {
-				ix --;
-			} else if (psi [iy] [ix] == DTW_Y) {
-				iy --;
-			} else if (psi [iy] [ix] == DTW_START) {
-				break;
-			}
-			if (pathIndex < 2 || iy < 1)
-				break;
-			//Melder_assert (pathIndex > 1 && iy > 0);
-			my path [-- pathIndex]. x = ix;
-			my path [pathIndex]. y = iy;
+	my pathLength = my nx + my ny - 1 - pathIndex + 1;
+	if (pathIndex > 1)
+		for (integer j = 1; j <= my pathLength; j ++)
+			my path [j] = my path [pathIndex ++];
+	my path.resize (my pathLength);   // maintain invariant
+	DTW_Path_recode (me);
+	if (cumulativeDists) {
+		autoMatrix him = Matrix_create (my xmin, my xmax, my nx, my dx, my x1,
+				my ymin, my ymax, my ny, my dy, my y1);
+		his z.all()  <<=  my z.all();
+		if (localSlope != 1) {
+			const integer rowto = getLengthOfBeginPart (my ny, my nx, my ny, localSlope);
+			const integer colto = getLengthOfBeginPart (my nx, my nx, my ny, localSlope);
+			/*
+				The begin parts of the first column and row, also where they lie outside the band.
+			*/
+			for (integer jy = 2; jy <= rowto; jy ++)
+				his z [jy] [1] = his z [jy - 1] [1] + my z [jy] [1];
+			for (integer jx = 2; jx <= colto; jx ++)
+				his z [1] [jx] = his z [1] [jx - 1] + my z [1] [jx];
 		}
+		for (integer jx = 1; jx <= my nx; jx ++)
+			for (integer jy = lowestRow [jx]; jy <= highestRow [jx]; jy ++)
+				his z [jy] [jx] = delta (jy, jx);
+		*cumulativeDists = him.move();
+	}
+}
 
-		my pathLength = my nx + my ny - 1 - pathIndex + 1;
-		if (pathIndex > 1)
-			for (integer j = 1; j <= my pathLength; j ++)
-				my path [j] = my path [pathIndex ++];
-		my path.resize (my pathLength);   // maintain invariant
-		DTW_Path_recode (me);
-		if (cumulativeDists) {
-			autoMatrix him = Matrix_create (my xmin, my xmax, my nx, my dx, my x1,
-					my ymin, my ymax, my ny, my dy, my y1);
-			his z.all()  <<=  delta.all();
-			*cumulativeDists = him.move();
+void NUMgetDtwBand (double tminp, double tmaxp, integer ntp, double dtp, double t1p,
+	double tminc, double tmaxc, integer ntc, double dtc, double t1c,
+	double sakoeChibaBand, int slope, INTVEC const& lowestRow, INTVEC const& highestRow)
+{
+	Melder_assert (lowestRow.size == ntc && highestRow.size == ntc);
+	double vertexX [8], vertexY [8];
+	const integer numberOfVertices = getVerticesOfBandPolygon (tminc, tmaxc, tminp, tmaxp, sakoeChibaBand, slope,
+			VEC (vertexX, 8), VEC (vertexY, 8));
+	getBandInsidePolygon (tminc, tmaxc, ntc, dtc, t1c, tminp, tmaxp, ntp, dtp, t1p,
+			constVEC (vertexX, numberOfVertices), constVEC (vertexY, numberOfVertices), lowestRow, highestRow, false);
+}
+
+double NUMgetDtwDistanceInBand (integer ny, constINTVEC const& lowestRow, constINTVEC const& highestRow,
+	constVEC const& bandDistances, double lastDistance, int localSlope)
+{
+	Melder_require (localSlope > 0 && localSlope < 5,
+		U"Local slope parameter ", localSlope, U" not supported.");
+	const integer nx = lowestRow.size;
+	autoINTVEC bandOffset = raw_INTVEC (nx);
+	const integer numberOfCellsInBand = getBandOffsets (lowestRow, highestRow, bandOffset.get());
+	Melder_assert (bandDistances.size == numberOfCellsInBand);
+	autoVEC bandDelta = raw_VEC (numberOfCellsInBand);
+	autovector <int8> bandPsi = newvectorraw <int8> (numberOfCellsInBand);
+	integer lastRow;
+	const double minimum = findCumulativeDistancesInBand (nx, ny, lowestRow, highestRow, bandOffset.get(), localSlope,
+		[&] (integer iy, integer ix) -> double {
+			if (iy >= lowestRow [ix] && iy <= highestRow [ix])
+				return bandDistances [bandOffset [ix] + iy];
+			return ( iy == ny && ix == nx ? lastDistance : 0.0 );
+		},
+		bandDelta.get(), bandPsi.get(), false, & lastRow
+	);
+	return minimum / (nx + ny);
+}
+
+void DTW_Polygon_findPathInside (DTW me, Polygon thee, int localSlope, autoMatrix *cumulativeDists) {
+	try {
+		autoINTVEC lowestRow = raw_INTVEC (my nx), highestRow = raw_INTVEC (my nx);
+		DTW_Polygon_getBand (me, thee, lowestRow.get(), highestRow.get(), false);
+		DTW_findPathInBand (me, lowestRow.get(), highestRow.get(), localSlope, cumulativeDists, true);
+	} catch (MelderError) {
+		Melder_throw (me, U": cannot find path.");
+	}
+}
+
+/*
+	A DTW with half the number of frames in both directions,
+	whose distances are the averages of the distances in blocks of two by two cells.
+*/
+static autoDTW DTW_halve (DTW me) {
+	const integer nx = (my nx + 1) / 2, ny = (my ny + 1) / 2;
+	autoDTW thee = DTW_create (my ymin, my ymax, ny, 2.0 * my dy, my y1 + 0.5 * my dy,
+			my xmin, my xmax, nx, 2.0 * my dx, my x1 + 0.5 * my dx);
+	for (integer iy = 1; iy <= ny; iy ++) {
+		const integer iyfrom = 2 * iy - 1, iyto = std::min (2 * iy, my ny);
+		for (integer ix = 1; ix <= nx; ix ++) {
+			const integer ixfrom = 2 * ix - 1, ixto = std::min (2 * ix, my nx);
+			double sum = 0.0;
+			for (integer jy = iyfrom; jy <= iyto; jy ++)
+				for (integer jx = ixfrom; jx <= ixto; jx ++)
+					sum += my z [jy] [jx];
+			thy z [iy] [ix] = sum / ((iyto - iyfrom + 1) * (ixto - ixfrom + 1));
+		}
+	}
+	return thee;
+}
+
+void DTW_findPath_multiscale (DTW me, integer radius, int localSlope, autoMatrix *cumulativeDists) {
+	try {
+		Melder_require (radius >= 0,
+			U"The radius should not be negative.");
+		autoPolygon thee = DTW_to_Polygon (me, 0.0, localSlope);
+		autoINTVEC lowestRow = raw_INTVEC (my nx), highestRow = raw_INTVEC (my nx);
+		const integer minimumNumberOfFrames = std::max (radius + 2, integer (20));
+		if ((std::min (my nx, my ny) + 1) / 2 >= minimumNumberOfFrames) {
+			/*
+				Find the path at half the resolution,
+				and search only the cells within `radius` of the cells that this coarse path goes through.
+			*/
+			autoDTW coarse = DTW_halve (me);
+			DTW_findPath_multiscale (coarse.get(), radius, localSlope, nullptr);
+			for (integer ix = 1; ix <= my nx; ix ++) {
+				lowestRow [ix] = my ny + 1;
+				highestRow [ix] = 0;
+			}
+			for (integer ipath = 1; ipath <= coarse -> pathLength; ipath ++) {
+				const integer ixfrom = std::max (2 * coarse -> path [ipath]. x - 1 - radius, integer (1));
+				const integer ixto = std::min (2 * coarse -> path [ipath]. x + radius, my nx);
+				const integer iyfrom = std::max (2 * coarse -> path [ipath]. y - 1 - radius, integer (1));
+				const integer iyto = std::min (2 * coarse -> path [ipath]. y + radius, my ny);
+				for (integer ix = ixfrom; ix <= ixto; ix ++) {
+					lowestRow [ix] = std::min (lowestRow [ix], iyfrom);
+					highestRow [ix] = std::max (highestRow [ix], iyto);
+				}
+			}
+			highestRow [my nx] = my ny;   // the path can end anywhere in the last column
+			DTW_Polygon_getBand (me, thee.get(), lowestRow.get(), highestRow.get(), true);
+		} else {
+			DTW_Polygon_getBand (me, thee.get(), lowestRow.get(), highestRow.get(), false);
 		}
+		DTW_findPathInBand (me, lowestRow.get(), highestRow.get(), localSlope, cumulativeDists, true);
 	} catch (MelderError) {
 		Melder_throw (me, U": cannot find path.");
 	}
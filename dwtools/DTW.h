@@ -53,6 +53,13 @@ autoDTW DTW_swapAxes (DTW me);
 
 void DTW_findPath_bandAndSlope (DTW me, double sakoeChibaBand, int localSlope, autoMatrix *cumulativeDists);
 
+void DTW_findPath_multiscale (DTW me, integer radius, int localSlope, autoMatrix *cumulativeDists);
+/*
+	Finds the path first in a DTW with half the number of frames (recursively),
+	and then searches only the cells within `radius` frames of that coarse path.
+	With a large enough radius, the result is that of DTW_findPath_bandAndSlope with a band of 0.
+*/
+
 void DTW_findPath (DTW me, bool matchStart, bool matchEnd, int slope); // deprecated
 /* Obsolete
 	Function:
@@ -107,6 +114,37 @@ autoPolygon DTW_to_Polygon (DTW me, double band, int slope);
 
 void DTW_Polygon_findPathInside (DTW me, Polygon thee, int localSlope, autoMatrix *cumulativeDists);
 
+void DTW_Polygon_getBand (DTW me, Polygon thee, INTVEC const& lowestRow, INTVEC const& highestRow, bool withinGivenRows);
+/*
+	For each column, the lowest and highest row of the cells inside the Polygon.
+	Uses only the times of the DTW, not its distances.
+*/
+
+void DTW_findPathInBand (DTW me, constINTVEC const& lowestRow, constINTVEC const& highestRow, int localSlope, autoMatrix *cumulativeDists, bool showProgress);
+/*
+	Searches the path only between lowestRow [ix] and highestRow [ix] in each column ix.
+	Without cumulativeDists, the only distances used are those in the band and the one in the top right cell.
+	With showProgress off, this can run on several threads at once, each with its own DTW.
+*/
+
+void NUMgetDtwBand (double tminp, double tmaxp, integer ntp, double dtp, double t1p,
+	double tminc, double tmaxc, integer ntc, double dtc, double t1c,
+	double sakoeChibaBand, int slope, INTVEC const& lowestRow, INTVEC const& highestRow);
+/*
+	The rows that DTW_Polygon_getBand () finds in each column for the Polygon of DTW_to_Polygon (sakoeChibaBand, slope),
+	for a DTW_create () with the same times, but without creating the DTW or the Polygon.
+	The band and the slope should meet the constraints that DTW_to_Polygon () checks.
+*/
+
+double NUMgetDtwDistanceInBand (integer ny, constINTVEC const& lowestRow, constINTVEC const& highestRow,
+	constVEC const& bandDistances, double lastDistance, int localSlope);
+/*
+	The weighted distance that DTW_findPathInBand () finds for a DTW with ny rows whose distances are
+	`bandDistances` in the band and zero outside it, except for the top right cell, which has `lastDistance`.
+	`bandDistances` holds the cells lowestRow [ix] .. highestRow [ix] of column 1, then those of column 2, and so on.
+	No path and no distance matrix are made, so this can run on several threads at once.
+*/
+
 autoMatrix DTW_to_Matrix_distances (DTW me);
 
 autoMatrix DTW_to_Matrix_cumulativeDistances (DTW me, double sakoeChibaBand, int slope);
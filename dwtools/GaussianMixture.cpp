@@ -24,6 +24,7 @@
 #include "NUMmachar.h"
 #include "NUM2.h"
 #include "Strings_extensions.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "GaussianMixture_def.h"
@@ -155,49 +156,118 @@ static void GaussianMixture_getResponsibilities (GaussianMixture me, constMATVU
 	MATnormalizeRows_inplace (responsibilities, 1.0, 1.0);
 }
 
-static void GaussianMixture_updateComponent (GaussianMixture me, integer component, MATVU const& data, MATVU const& responsibilities) {
-	integer numberOfData = data.nrow;
-	Melder_require (my dimension == data.ncol,
+/*
+	The rows of the data are handled in blocks, on several threads.
+	The number of blocks depends only on the number of rows, and sums over the blocks are added in block order,
+	so that the results do not depend on the number of threads.
+*/
+static integer getNumberOfRowBlocks (integer numberOfRows) {
+	constexpr integer minimumNumberOfRowsPerBlock = 1000, maximumNumberOfBlocks = 64;
+	return Melder_clipped (1_integer, numberOfRows / minimumNumberOfRowsPerBlock, maximumNumberOfBlocks);
+}
+
+static integer getFirstRowOfBlock (integer iblock, integer numberOfBlocks, integer numberOfRows) {
+	return 1 + (iblock - 1) * numberOfRows / numberOfBlocks;
+}
+
+static void GaussianMixture_updateComponents (GaussianMixture me, integer fromComponent, integer toComponent, constMATVU const& data, constMATVU const& responsibilities) {
+	const integer numberOfData = data.nrow, dimension = my dimension;
+	Melder_require (dimension == data.ncol,
 		U"The number of columns in the data and the dimension of the GaussianMixture should be equal.");
 	Melder_require (my numberOfComponents == responsibilities.ncol,
 		U"The number of components and the number of columns in the responsibilities should conform.");
 	Melder_require (responsibilities.nrow == data.nrow,
 		U"The number of rows in the data and the responsibilities should conform.");
-	Melder_require (component > 0 && component <= my numberOfComponents,
-		U"The component number should be in the range from 1 to ", my numberOfComponents, U".");
-	
-	const Covariance thee = my covariances->at [component];
+	Melder_require (fromComponent > 0 && toComponent <= my numberOfComponents && fromComponent <= toComponent,
+		U"The component numbers should be in the range from 1 to ", my numberOfComponents, U".");
+	const integer numberOfComponentsToUpdate = toComponent - fromComponent + 1;
+	const bool diagonal = ( my covariances->at [fromComponent] -> numberOfRows == 1 );
+	const integer numberOfBlocks = getNumberOfRowBlocks (numberOfData);
+	autoMAT responsibilitySums = zero_MAT (numberOfBlocks, numberOfComponentsToUpdate);
+	autoTEN3 centroidSums = zero_TEN3 (numberOfBlocks, numberOfComponentsToUpdate, dimension);
+	/*
+		Only the upper triangle of a full covariance matrix is summed, row after row.
+	*/
+	autoTEN3 covarianceSums = zero_TEN3 (numberOfBlocks, numberOfComponentsToUpdate, ( diagonal ? dimension : dimension * dimension ));
 	/*
 		Update the means: Bishop eq. 9.24
 	*/
-	thy centroid.all()  <<=  0.0;
-	for (integer irow = 1; irow <= numberOfData; irow ++)
-		thy centroid.get()  +=  responsibilities [irow] [component]  *  data.row (irow);
-	
-	const double totalComponentResponsibility = NUMsum (responsibilities.column (component));
-	thy centroid.get ()  /=  totalComponentResponsibility;
+	MelderThread_runTasks (numberOfBlocks, [&] (integer iblock) {
+		const integer firstRow = getFirstRowOfBlock (iblock, numberOfBlocks, numberOfData);
+		const integer lastRow = getFirstRowOfBlock (iblock + 1, numberOfBlocks, numberOfData) - 1;
+		for (integer irow = firstRow; irow <= lastRow; irow ++) {
+			for (integer ic = 1; ic <= numberOfComponentsToUpdate; ic ++) {
+				const double responsibility = responsibilities [irow] [fromComponent - 1 + ic];
+				if (responsibility == 0.0)
+					continue;
+				responsibilitySums [iblock] [ic] += responsibility;
+				centroidSums [iblock] [ic]  +=  responsibility  *  data.row (irow);
+			}
+		}
+	});
+	autoVEC totalComponentResponsibility = zero_VEC (numberOfComponentsToUpdate);
+	for (integer ic = 1; ic <= numberOfComponentsToUpdate; ic ++) {
+		const Covariance thee = my covariances->at [fromComponent - 1 + ic];
+		thy centroid.all()  <<=  0.0;
+		for (integer iblock = 1; iblock <= numberOfBlocks; iblock ++) {
+			totalComponentResponsibility [ic] += responsibilitySums [iblock] [ic];
+			thy centroid.all()  +=  centroidSums [iblock] [ic];
+		}
+		thy centroid.all()  /=  totalComponentResponsibility [ic];
+	}
 	/*
-		update covariance with the new mean: Bishop eq. 9.25
+		Update the covariances with the new means: Bishop eq. 9.25
 	*/
-	thy data.all()  <<=  0.0;
-	autoVEC dif = raw_VEC (thy numberOfColumns);
-	if (thy numberOfRows == 1) { // 1xn covariance
-		autoVEC variance = raw_VEC (thy numberOfColumns);
-		for (integer irow = 1; irow <= numberOfData; irow ++) {
-			dif.all()  <<=  data.row (irow)  -  thy centroid.get();
-			variance.all()  <<=  dif.all()  *  dif.all();
-			thy data.row (1)  +=  responsibilities [irow] [component]  *  variance.get();
+	MelderThread_runTasks (numberOfBlocks, [&] (integer iblock) {
+		const integer firstRow = getFirstRowOfBlock (iblock, numberOfBlocks, numberOfData);
+		const integer lastRow = getFirstRowOfBlock (iblock + 1, numberOfBlocks, numberOfData) - 1;
+		autoVEC dif = raw_VEC (dimension);
+		for (integer irow = firstRow; irow <= lastRow; irow ++) {
+			for (integer ic = 1; ic <= numberOfComponentsToUpdate; ic ++) {
+				const double responsibility = responsibilities [irow] [fromComponent - 1 + ic];
+				if (responsibility == 0.0)
+					continue;
+				dif.all()  <<=  data.row (irow)  -  my covariances->at [fromComponent - 1 + ic] -> centroid.all();
+				const VECVU sums = covarianceSums [iblock] [ic];
+				if (diagonal) {
+					for (integer j = 1; j <= dimension; j ++)
+						sums [j] += responsibility * dif [j] * dif [j];
+				} else {
+					for (integer i = 1; i <= dimension; i ++) {
+						const double weightedDif_i = responsibility * dif [i];
+						const VECVU sums_i = sums.part ((i - 1) * dimension + 1, i * dimension);
+						for (integer j = i; j <= dimension; j ++)
+							sums_i [j] += weightedDif_i * dif [j];
+					}
+				}
+			}
 		}
-	} else { // nxn covariance
-		autoMAT covar = raw_MAT (thy numberOfColumns, thy numberOfColumns);
-		for (integer irow = 1; irow <= numberOfData; irow ++) {
-			dif.all()  <<=  data.row (irow)  -  thy centroid.get();
-			outer_MAT_out (covar.get(), dif.get(), dif.get());
-			thy data.get()  +=  responsibilities [irow] [component]  *  covar.get();
+	});
+	for (integer ic = 1; ic <= numberOfComponentsToUpdate; ic ++) {
+		const integer component = fromComponent - 1 + ic;
+		const Covariance thee = my covariances->at [component];
+		thy data.all()  <<=  0.0;
+		for (integer iblock = 1; iblock <= numberOfBlocks; iblock ++) {
+			const constVECVU sums = covarianceSums [iblock] [ic];
+			if (diagonal) {
+				thy data.row (1)  +=  sums;
+			} else {
+				for (integer i = 1; i <= dimension; i ++)
+					for (integer j = i; j <= dimension; j ++)
+						thy data [i] [j] += sums [(i - 1) * dimension + j];
+			}
 		}
+		if (! diagonal)
+			for (integer i = 2; i <= dimension; i ++)
+				for (integer j = 1; j < i; j ++)
+					thy data [i] [j] = thy data [j] [i];
+		thy data.all()  /=  totalComponentResponsibility [ic];
+		thy numberOfObservations = my mixingProbabilities [component] * numberOfData;
 	}
-	thy data.get()  /=  totalComponentResponsibility;
-	thy numberOfObservations = my mixingProbabilities [component] * numberOfData;
+}
+
+static void GaussianMixture_updateComponent (GaussianMixture me, integer component, constMATVU const& data, constMATVU const& responsibilities) {
+	GaussianMixture_updateComponents (me, component, component, data, responsibilities);
 }
 
 static void GaussianMixture_setDefaultMixtureNames (GaussianMixture me) {
@@ -806,16 +876,28 @@ void GaussianMixture_TableOfReal_getComponentProbabilities (GaussianMixture me,
 
 		const integer fromComponent = componentToUpdate == 0 ? 1 : componentToUpdate;
 		const integer toComponent = componentToUpdate == 0 ? my numberOfComponents : componentToUpdate;
-		
-		for (integer component = fromComponent; component <= toComponent; component ++) {
-			const Covariance covi = my covariances->at [component];
-			SSCP_expandWithLowerCholeskyInverse (covi);
-
-			for (integer irow = 1; irow <= thy numberOfRows; irow++) {
-				const double dsq = NUMmahalanobisDistanceSquared (covi -> lowerCholeskyInverse.get(), thy data.row (irow), covi -> centroid.get());
-				probabilities [irow] [component] = std::max (1e-300, exp (- 0.5 * (ln2pid + covi -> lnd + dsq))); // prevent probabilities from being zero
+		/*
+			The Cholesky factors are computed once, before the rows are divided over the threads.
+		*/
+		for (integer component = fromComponent; component <= toComponent; component ++)
+			SSCP_expandWithLowerCholeskyInverse (my covariances->at [component]);
+		const integer numberOfBlocks = getNumberOfRowBlocks (thy numberOfRows);
+		MelderThread_runTasks (numberOfBlocks, [&] (integer iblock) {
+			const integer firstRow = getFirstRowOfBlock (iblock, numberOfBlocks, thy numberOfRows);
+			const integer lastRow = getFirstRowOfBlock (iblock + 1, numberOfBlocks, thy numberOfRows) - 1;
+			for (integer irow = firstRow; irow <= lastRow; irow ++) {
+				for (integer component = fromComponent; component <= toComponent; component ++) {
+					const Covariance covi = my covariances->at [component];
+					/*
+						A diagonal covariance has its inverse standard deviations in the first row.
+					*/
+					const constMAT lowerCholeskyInverse = ( covi -> numberOfRows == 1 ?
+							constMAT (covi -> lowerCholeskyInverse.cells, 1, my dimension) : covi -> lowerCholeskyInverse.get() );
+					const double dsq = NUMmahalanobisDistanceSquared (lowerCholeskyInverse, thy data.row (irow), covi -> centroid.get());
+					probabilities [irow] [component] = std::max (1e-300, exp (- 0.5 * (ln2pid + covi -> lnd + dsq))); // prevent probabilities from being zero
+				}
 			}
-		}
+		});
 	} catch (MelderError) {
 		Melder_throw (me, U" & ", thee, U": no component probabilies could be calculated.");
 	}
@@ -908,10 +990,9 @@ void GaussianMixture_TableOfReal_improveLikelihood (GaussianMixture me, TableOfR
 				/*
 					M-step: 1. new means & covariances
 				*/
-				for (integer component = 1; component <= my numberOfComponents; component ++) {
-					GaussianMixture_updateComponent (me, component, thy data.get(), responsibilities.get());
+				GaussianMixture_updateComponents (me, 1, my numberOfComponents, thy data.get(), responsibilities.get());
+				for (integer component = 1; component <= my numberOfComponents; component ++)
 					GaussianMixture_addCovarianceFraction (me, component, covg.get(), lambda);
-				}
 
 				/*
 					M-step: 2. new mixingProbabilities
@@ -934,7 +1015,7 @@ void GaussianMixture_TableOfReal_improveLikelihood (GaussianMixture me, TableOfR
 		for (integer component = 1; component <= my numberOfComponents; component ++) {
 			const Covariance cov = my covariances->at [component];
 			if (cov -> numberOfObservations > 1.5)
-				cov -> data.row (1)  *=  cov -> numberOfObservations / (cov -> numberOfObservations - 1.0);
+				cov -> data.all()  *=  cov -> numberOfObservations / (cov -> numberOfObservations - 1.0);
 		}
 	} catch (MelderError) {
 		Melder_throw (me, U" & ", thee, U": likelihood cannot be improved.");
@@ -24,6 +24,7 @@
 #include "Index.h"
 #include "NUM2.h"
 #include "Strings_extensions.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "HMM_def.h"
@@ -923,6 +924,217 @@ static void HMM_HMMObservationSequenceBag_learn_notHidden (HMM me, HMMObservatio
 }
 
 
+/*
+	The observation sequences of a bag, as symbol numbers, split into stretches without unknown symbols
+	(an unknown symbol ends a sequence).
+	The stretches are grouped into blocks of about the same number of symbols;
+	the blocks depend only on the data, not on the number of threads.
+*/
+struct HMMTrainingData {
+	autoINTVEC symbols;   // all stretches, one after the other
+	autoINTVEC stretchStart;   // stretch i runs from stretchStart [i] to stretchStart [i + 1] - 1
+	autoINTVEC blockStart;   // block b consists of stretches blockStart [b] to blockStart [b + 1] - 1
+	integer numberOfStretches, numberOfBlocks;
+};
+
+static HMMTrainingData HMM_HMMObservationSequenceBag_getTrainingData (HMM me, HMMObservationSequenceBag thee) {
+	constexpr integer numberOfSymbolsPerBlock = 4096;
+	HMMTrainingData data;
+	integer numberOfSymbols = 0;
+	for (integer iseq = 1; iseq <= thy size; iseq ++)
+		numberOfSymbols += thy at [iseq] -> rows.size;
+	data.symbols = raw_INTVEC (numberOfSymbols);
+	data.stretchStart = raw_INTVEC (numberOfSymbols + 1);
+	data.blockStart = raw_INTVEC (numberOfSymbols + 1);
+	integer isymbol = 0, istretch = 0, iblock = 0, numberOfSymbolsInBlock = numberOfSymbolsPerBlock;
+	for (integer iseq = 1; iseq <= thy size; iseq ++) {
+		autoStringsIndex si = HMM_HMMObservationSequence_to_StringsIndex (me, thy at [iseq]);
+		constINTVEC obs = si -> classIndex.get();
+		for (integer it = 1; it <= obs.size; it ++) {
+			if (obs [it] == 0)
+				continue;
+			if (it == 1 || obs [it - 1] == 0) {
+				if (numberOfSymbolsInBlock >= numberOfSymbolsPerBlock) {
+					data.blockStart [++ iblock] = istretch + 1;
+					numberOfSymbolsInBlock = 0;
+				}
+				data.stretchStart [++ istretch] = isymbol + 1;
+			}
+			data.symbols [++ isymbol] = obs [it];
+			numberOfSymbolsInBlock ++;
+		}
+	}
+	data.symbols.resize (isymbol);
+	data.numberOfStretches = istretch;
+	data.stretchStart.resize (istretch + 1);
+	data.stretchStart [istretch + 1] = isymbol + 1;
+	data.numberOfBlocks = iblock;
+	data.blockStart.resize (iblock + 1);
+	data.blockStart [iblock + 1] = istretch + 1;
+	return data;
+}
+
+/*
+	The expected counts of the E-step, per block of stretches.
+*/
+struct HMMBaumWelchBlockSums {
+	autoMAT gammaAtStart;   // [block] [state]
+	autoMAT gammaSumExceptLast;
+	autoMAT gammaAtEnd;
+	autoTEN3 xiSum;   // [block] [state] [state]
+	autoTEN3 gammaSumPerSymbol;   // [block] [state] [symbol]
+	autoVEC lnProb;   // [block]
+};
+
+/*
+	Forward-backward for one stretch of symbols, with scaled alphas and betas.
+	The betas are not stored: the backward pass adds the gammas and xis to the sums of the block
+	at the same time, so only the alphas need memory proportional to the length of the stretch.
+	The alphas are stored time by time (a row per time), and the emission probabilities
+	are looked up in rows of `emissionsPerSymbol`, so that all inner loops go through contiguous memory.
+*/
+static void HMM_addExpectedCountsOfStretch (HMM me, constMAT const& emissionsPerSymbol, constINTVEC const& obs,
+	MAT const& alpha, VEC const& scale, HMMBaumWelchBlockSums& sums, integer iblock)
+{
+	const integer numberOfStates = my numberOfStates, numberOfTimes = obs.size;
+	Melder_assert (alpha.nrow >= numberOfTimes && scale.size >= numberOfTimes);
+	/*
+		Forward.
+	*/
+	for (integer js = 1; js <= numberOfStates; js ++)
+		alpha [1] [js] = my initialStateProbs [js] * emissionsPerSymbol [obs [1]] [js];
+	scale [1] = NUMsum (alpha.row (1));
+	alpha.row (1)  /=  scale [1];
+	for (integer it = 2; it <= numberOfTimes; it ++) {
+		const VECVU alpha_it = alpha.row (it);
+		alpha_it  <<=  0.0;
+		for (integer is = 1; is <= numberOfStates; is ++) {
+			const double alpha_is = alpha [it - 1] [is];
+			if (alpha_is == 0.0)
+				continue;
+			const double *transitions = & my transitionProbs [is] [1];
+			for (integer js = 1; js <= numberOfStates; js ++)
+				alpha_it [js] += alpha_is * transitions [js - 1];
+		}
+		alpha_it  *=  emissionsPerSymbol.row (obs [it]);
+		scale [it] = NUMsum (alpha_it);
+		alpha_it  /=  scale [it];
+	}
+	longdouble lnProb = 0.0;
+	for (integer it = 1; it <= numberOfTimes; it ++)
+		lnProb += log (scale [it]);
+	sums.lnProb [iblock] += double (lnProb);
+	/*
+		Backward, with gamma (t) = alpha (t) * beta (t), normalized,
+		and xi (t) [is] [js] = alpha (t) [is] * transitionProbs [is] [js] * emission (t+1) [js] * beta (t + 1) [js], normalized.
+		At the end the betas are 1 / scale [numberOfTimes]; as gamma and xi are normalized, we can start with 1.
+	*/
+	const MATVU xiSum = sums.xiSum [iblock];
+	const MATVU gammaSumPerSymbol = sums.gammaSumPerSymbol [iblock];
+	autoVEC beta = raw_VEC (numberOfStates), betaTimesEmission = raw_VEC (numberOfStates), gamma = raw_VEC (numberOfStates);
+	beta.all()  <<=  1.0;
+	gamma.all()  <<=  alpha.row (numberOfTimes);
+	gamma.all()  /=  NUMsum (gamma.all());
+	sums.gammaAtEnd.row (iblock)  +=  gamma.all();
+	gammaSumPerSymbol.column (obs [numberOfTimes])  +=  gamma.all();
+	for (integer it = numberOfTimes - 1; it >= 1; it --) {
+		betaTimesEmission.all()  <<=  beta.all()  *  emissionsPerSymbol.row (obs [it + 1]);
+		const constVECVU alpha_it = alpha.row (it);
+		longdouble sum = 0.0;
+		for (integer is = 1; is <= numberOfStates; is ++) {
+			const double *transitions = & my transitionProbs [is] [1];
+			double beta_is = 0.0;
+			for (integer js = 1; js <= numberOfStates; js ++)
+				beta_is += transitions [js - 1] * betaTimesEmission [js];
+			beta [is] = beta_is;
+			sum += alpha_it [is] * beta_is;
+		}
+		const double normalization = 1.0 / double (sum);
+		for (integer is = 1; is <= numberOfStates; is ++) {
+			const double alpha_is = alpha_it [is] * normalization;
+			if (alpha_is == 0.0)
+				continue;
+			const double *transitions = & my transitionProbs [is] [1];
+			double *xiSum_is = & xiSum [is] [1];
+			for (integer js = 1; js <= numberOfStates; js ++)
+				xiSum_is [js - 1] += alpha_is * transitions [js - 1] * betaTimesEmission [js];
+		}
+		gamma.all()  <<=  alpha_it  *  beta.all();
+		gamma.all()  *=  normalization;
+		sums.gammaSumExceptLast.row (iblock)  +=  gamma.all();
+		gammaSumPerSymbol.column (obs [it])  +=  gamma.all();
+		/*
+			Rescale the betas, so that they stay within range for long stretches.
+		*/
+		beta.all()  /=  scale [it];
+	}
+	sums.gammaAtStart.row (iblock)  +=  gamma.all();
+}
+
+/*
+	The E-step over all stretches: the blocks are divided over the threads,
+	each block adds to its own sums, and the sums of the blocks are added in their fixed order,
+	so that the result does not depend on the number of threads.
+*/
+static void HMM_HMMBaumWelch_addExpectedCounts (HMM me, HMMBaumWelch thee, HMMTrainingData const& data) {
+	const integer numberOfStates = my numberOfStates, numberOfSymbols = my numberOfObservationSymbols;
+	autoMAT emissionsPerSymbol = transpose_MAT (my emissionProbs.get());
+	HMMBaumWelchBlockSums sums;
+	sums.gammaAtStart = zero_MAT (data.numberOfBlocks, numberOfStates);
+	sums.gammaSumExceptLast = zero_MAT (data.numberOfBlocks, numberOfStates);
+	sums.gammaAtEnd = zero_MAT (data.numberOfBlocks, numberOfStates);
+	sums.xiSum = zero_TEN3 (data.numberOfBlocks, numberOfStates, numberOfStates);
+	sums.gammaSumPerSymbol = zero_TEN3 (data.numberOfBlocks, numberOfStates, numberOfSymbols);
+	sums.lnProb = zero_VEC (data.numberOfBlocks);
+	MelderThread_runTasks (data.numberOfBlocks, [&] (integer iblock) {
+		const integer firstStretch = data.blockStart [iblock], lastStretch = data.blockStart [iblock + 1] - 1;
+		integer longestStretch = 0;
+		for (integer istretch = firstStretch; istretch <= lastStretch; istretch ++)
+			longestStretch = std::max (longestStretch, data.stretchStart [istretch + 1] - data.stretchStart [istretch]);
+		autoMAT alpha = raw_MAT (longestStretch, numberOfStates);
+		autoVEC scale = raw_VEC (longestStretch);
+		for (integer istretch = firstStretch; istretch <= lastStretch; istretch ++) {
+			const constINTVEC obs = data.symbols.part (data.stretchStart [istretch], data.stretchStart [istretch + 1] - 1);
+			HMM_addExpectedCountsOfStretch (me, emissionsPerSymbol.get(), obs, alpha.get(), scale.get(), sums, iblock);
+		}
+	});
+	/*
+		Merge, with the same conditions as in HMM_HMMBaumWelch_addEstimate ().
+	*/
+	thy totalNumberOfSequences += data.numberOfStretches;
+	for (integer iblock = 1; iblock <= data.numberOfBlocks; iblock ++) {
+		thy lnProb += sums.lnProb [iblock];
+		for (integer is = 1; is <= numberOfStates; is ++) {
+			if (my initialStateProbs [is] > 0.0)
+				thy aij_num_p0 [is] += sums.gammaAtStart [iblock] [is];
+			const double gammaSumExceptLast = sums.gammaSumExceptLast [iblock] [is];
+			for (integer js = 1; js <= numberOfStates; js ++) {
+				if (my transitionProbs [is] [js] > 0.0) {
+					thy aij_num [is] [js] += sums.xiSum [iblock] [is] [js];
+					thy aij_denom [is] [js] += gammaSumExceptLast;
+				}
+			}
+			if (! my notHidden) {
+				const double gammaSum = gammaSumExceptLast + sums.gammaAtEnd [iblock] [is];
+				for (integer k = 1; k <= numberOfSymbols; k ++) {
+					if (my emissionProbs [is] [k] > 0.0) {
+						thy bik_num [is] [k] += sums.gammaSumPerSymbol [iblock] [is] [k];
+						thy bik_denom [is] [k] += gammaSum;
+					}
+				}
+			}
+			if (my leftToRight)
+				thy aij_num [is] [numberOfStates + 1] += sums.gammaAtEnd [iblock] [is];
+		}
+	}
+	for (integer is = 1; is <= numberOfStates; is ++) {
+		if (my initialStateProbs [is] > 0.0)
+			thy aij_denom_p0 [is] += data.numberOfStretches;
+		if (my leftToRight)
+			thy aij_denom [is] [numberOfStates + 1] += data.numberOfStretches;
+	}
+}
+
 void HMM_HMMObservationSequenceBag_learn (HMM me, HMMObservationSequenceBag thee, double delta_lnp, double minProb, int info) {
 	try {
 		if (my notHidden) {
@@ -930,10 +1142,17 @@ void HMM_HMMObservationSequenceBag_learn (HMM me, HMMObservationSequenceBag thee
 			HMM_HMMObservationSequenceBag_learn_notHidden (me, thee, minProb);
 			return;
 		}
-		// act as if all observation sequences are in memory
-		const integer capacity = HMMObservationSequenceBag_getLongestSequence (thee);
-		autoHMMBaumWelch bw = HMMBaumWelch_create (my numberOfStates, my numberOfObservationSymbols, capacity);
+		const HMMTrainingData data = HMM_HMMObservationSequenceBag_getTrainingData (me, thee);
+		Melder_require (data.numberOfStretches > 0,
+			U"There are no known observations.");
+		/*
+			Only the sums of the Baum-Welch object are used; the alphas are computed per block.
+		*/
+		autoHMMBaumWelch bw = HMMBaumWelch_create (my numberOfStates, my numberOfObservationSymbols, 1);
 		bw -> minProb = minProb;
+		integer longestStretch = 0;
+		for (integer istretch = 1; istretch <= data.numberOfStretches; istretch ++)
+			longestStretch = std::max (longestStretch, data.stretchStart [istretch + 1] - data.stretchStart [istretch]);
 		if (info)
 			MelderInfo_open (); 
 		integer iter = 0;
@@ -941,34 +1160,7 @@ void HMM_HMMObservationSequenceBag_learn (HMM me, HMMObservationSequenceBag thee
 		do {
 			lnp = bw -> lnProb;
 			HMMBaumWelch_reInit (bw.get());
-			for (integer iseq = 1; iseq <= thy size; iseq ++) {
-				const HMMObservationSequence hmm_os = thy at [iseq];
-				autoStringsIndex si = HMM_HMMObservationSequence_to_StringsIndex (me, hmm_os); // TODO outside the loop or more efficiently
-				INTVEC obs = si -> classIndex.get();
-				const integer nobs = si -> numberOfItems; // convenience
-
-				// Interpretation of unknowns: end of sequence
-
-				integer istart = 1, iend = nobs;
-				while (istart <= nobs) {
-					while (istart <= nobs && obs [istart] == 0)
-						istart ++;
-					if (istart > nobs) break;
-
-					iend = istart + 1;
-					while (iend <= nobs && obs [iend] != 0)
-						iend ++;
-					iend --;
-					bw -> numberOfTimes = iend - istart + 1;
-					bw -> totalNumberOfSequences ++;
-					HMM_HMMBaumWelch_forward (me, bw.get(), obs.part (istart, nobs)); // get new alphas
-					HMM_HMMBaumWelch_backward (me, bw.get(), obs.part (istart, nobs)); // get new betas
-					HMMBaumWelch_getGamma (bw.get());
-					HMM_HMMBaumWelch_getXi (me, bw.get(), obs.part (istart, nobs));
-					HMM_HMMBaumWelch_addEstimate (me, bw.get(), obs.part (istart, nobs));
-					istart = iend + 1;
-				}
-			}
+			HMM_HMMBaumWelch_addExpectedCounts (me, bw.get(), data);
 			// we have processed all observation sequences, now it is time to estimate new probabilities.
 			iter ++;
 			HMM_HMMBaumWelch_reestimate (me, bw.get());
@@ -980,7 +1172,7 @@ void HMM_HMMObservationSequenceBag_learn (HMM me, HMMObservationSequenceBag thee
 			MelderInfo_writeLine (U"  Processed ", thy size, U" sequence", ( thy size > 1 ? U"s," : U"," ));
 			MelderInfo_writeLine (U"  consisting of ", bw -> totalNumberOfSequences, U" observation sequence",
 			( bw -> totalNumberOfSequences > 1 ? U"s." : U"." ));
-			MelderInfo_writeLine (U"  Longest observation sequence had ", capacity, U" items.");
+			MelderInfo_writeLine (U"  Longest observation sequence had ", longestStretch, U" items.");
 			MelderInfo_close();
 		}
 	} catch (MelderError) {
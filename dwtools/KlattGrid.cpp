@@ -35,7 +35,7 @@
 #include "Graphics_extensions.h"
 #include "KlattGrid.h"
 #include "KlattTable.h"
-#include "Resonator.h"
+#include "MelderThread.h"
 #include "Pitch_to_PitchTier.h"
 #include "PitchTier_to_Sound.h"
 #include "PitchTier_to_PointProcess.h"
@@ -318,41 +318,6 @@ static void _Sounds_add_inplace (Sound me, Sound thee) {
 		my z [1] [i] += thy z [1] [i];
 }
 
-static autoSound _Sound_diff (Sound me, int scale) {
-	try {
-		autoSound thee = Data_copy (me);
-
-		// extremum
-		double amax1 = -1.0e34, amax2 = amax1, val, pval = 0.0;
-		if (scale) {
-			for (integer i = 1; i <= thy nx; i ++) {
-				val = fabs (thy z [1] [i]);
-				if (val > amax1)
-					amax1 = val;
-			}
-		}
-		// x [n]-x [n-1]
-		for (integer i = 1; i <= thy nx; i ++) {
-			val = thy z [1] [i];
-			thy z [1] [i] -=  pval;
-			pval = val;
-		}
-		if (scale) {
-			for (integer i = 1; i <= thy nx; i ++) {
-				val = fabs (thy z [1] [i]);
-				if (val > amax2)
-					amax2 = val;
-			}
-			// scale
-			for (integer i = 1; i <= thy nx; i ++)
-				thy z [1] [i] *= amax1 / amax2;
-		}
-		return thee;
-	} catch (MelderError) {
-		Melder_throw (me, U": not differenced.");
-	}
-}
-
 /*static void _Sounds_addDifferentiated_inplace (Sound me, Sound thee)
 {
 	double pval = 0, dx = my dx;
@@ -464,6 +429,284 @@ static void drawLinesInBox (Graphics g, double xmin, double xmax, double ymin, d
 
 /************************ Sound & FormantGrid *********************************************/
 
+/*
+	The formant filters of a vocal tract or of the frication part of a KlattGrid.
+	Each section is a resonator or an antiresonator whose frequency, bandwidth and (optionally) amplitude
+	follow the tiers of a FormantGrid. The sections are ordered in groups:
+	in a cascade group each section filters the output of the previous one,
+	in a parallel group each section filters the input of the group and the outputs are added
+	(or subtracted, for `negative` sections). The outputs of the groups are added.
+
+	All sections run over the samples together, a block of samples at a time.
+	For each block the frequencies, bandwidths and amplitudes of all sections are computed once,
+	by walking forward through the points of the tiers instead of searching them for every sample,
+	and the filter coefficients are only recomputed when these values change.
+	The result is the same, sample by sample, as filtering with one formant at a time.
+*/
+
+#define FormantFilters_BLOCK_SIZE  256
+
+struct FormantSection {
+	RealTier frequencies, bandwidths;
+	RealTier amplitudes;   // in dB; null if the section has no amplitude control
+	bool antiformant, normaliseAtDC, negative;
+	integer group;
+	/*
+		The state of the filter.
+	*/
+	integer frequencyIndex, bandwidthIndex, amplitudeIndex;
+	double frequency, bandwidth, amplitude;   // the values that determined a, b and c
+	double a, b, c, p1, p2;
+};
+
+struct FormantSectionGroup {
+	bool cascade, differentiatedInput;
+};
+
+Thing_define (FormantFilters, Thing) {
+	autovector <FormantSectionGroup> groups;
+	autovector <FormantSection> sections;
+	autoFormantGrid ownedFormantGrid;   // e.g. the oral formants with the open-phase corrections
+	bool hasDifferentiatedInput;
+
+	void addGroup (bool cascade, bool differentiatedInput) {
+		groups. resize (groups.size + 1);
+		groups [groups.size]. cascade = cascade;
+		groups [groups.size]. differentiatedInput = differentiatedInput;
+		if (differentiatedInput)
+			hasDifferentiatedInput = true;
+	}
+	void addSection (RealTier frequencies, RealTier bandwidths, RealTier amplitudes, bool antiformant, bool normaliseAtDC, bool negative) {
+		Melder_assert (groups.size > 0);
+		sections. resize (sections.size + 1);
+		FormantSection& section = sections [sections.size];
+		section. frequencies = frequencies;
+		section. bandwidths = bandwidths;
+		section. amplitudes = amplitudes;
+		section. antiformant = antiformant;
+		section. normaliseAtDC = normaliseAtDC;
+		section. negative = negative;
+		section. group = groups.size;
+	}
+};
+
+Thing_implement (FormantFilters, Thing, 0);
+
+static autoFormantFilters FormantFilters_create () {
+	try {
+		autoFormantFilters me = Thing_new (FormantFilters);
+		return me;
+	} catch (MelderError) {
+		Melder_throw (U"FormantFilters not created.");
+	}
+}
+
+/*
+	The same as RealTier_getValueAtTime (), for times that do not decrease from one call to the next.
+	*inout_lowIndex is the index of the last point at or before the previous time (initially 1).
+*/
+static double RealTier_getValueAtTime_fromIndex (constRealTier me, double t, integer *inout_lowIndex) {
+	const integer n = my points.size;
+	if (n == 0)
+		return undefined;
+	const RealPoint firstPoint = my points.at [1];
+	if (t <= firstPoint -> number)
+		return firstPoint -> value;   // constant extrapolation
+	const RealPoint lastPoint = my points.at [n];
+	if (t >= lastPoint -> number)
+		return lastPoint -> value;   // constant extrapolation
+	integer ileft = *inout_lowIndex;
+	while (my points.at [ileft + 1] -> number <= t)
+		ileft ++;
+	*inout_lowIndex = ileft;
+	const RealPoint pointLeft = my points.at [ileft];
+	const RealPoint pointRight = my points.at [ileft + 1];
+	const double tleft = pointLeft -> number, fleft = pointLeft -> value;
+	const double tright = pointRight -> number, fright = pointRight -> value;
+	return t == tright ? fright
+		: tleft == tright ? 0.5 * (fleft + fright)
+		: fleft + (t - tleft) * (fright - fleft) / (tright - tleft);
+}
+
+static void FormantSection_reset (FormantSection *me) {
+	my frequencyIndex = my bandwidthIndex = my amplitudeIndex = 1;
+	my frequency = my bandwidth = my amplitude = undefined;
+	my a = 1.0;   // all-pass
+	my b = my c = 0.0;
+	my p1 = my p2 = 0.0;
+}
+
+/*
+	As in Resonator.cpp, with the amplitude of the parallel formants as in Klatt (1980).
+*/
+static void FormantSection_setCoefficients (FormantSection *me, double frequency, double bandwidth, double amplitude, double samplingPeriod) {
+	if (my antiformant && frequency <= 0.0 && bandwidth <= 0.0) {
+		my a = 1.0;
+		my b = -2.0;
+		my c = 1.0;   // all-pass except dc
+	} else {
+		const double r = exp (-NUMpi * samplingPeriod * bandwidth);
+		my c = -(r * r);
+		my b = 2.0 * r * cos (2.0 * NUMpi * frequency * samplingPeriod);
+		if (my antiformant)
+			my a = 1.0 / (1.0 - my b - my c);
+		else if (my normaliseAtDC)
+			my a = 1.0 - my b - my c;   // H(0) = 0 dB
+		else
+			my a = (1.0 + my c) * sin (2.0 * NUMpi * frequency * samplingPeriod);   // H(f) = 0 dB
+	}
+	if (my amplitudes && isdefined (amplitude))
+		my a *= DB_to_A (amplitude);
+	my frequency = frequency;
+	my bandwidth = bandwidth;
+	my amplitude = amplitude;
+}
+
+/*
+	Filters the samples first..last in place.
+*/
+static void FormantSection_filterBlock (FormantSection *me, VEC const& x, integer first, double x1, double dx,
+	VEC const& a, VEC const& b, VEC const& c)
+{
+	const double nyquist = 0.5 / dx;
+	for (integer i = 1; i <= x.size; i ++) {
+		const double t = x1 + (first + i - 2) * dx;
+		const double frequency = RealTier_getValueAtTime_fromIndex (my frequencies, t, & my frequencyIndex);
+		const double bandwidth = RealTier_getValueAtTime_fromIndex (my bandwidths, t, & my bandwidthIndex);
+		if (frequency <= nyquist && isdefined (bandwidth)) {
+			const double amplitude = ( my amplitudes ? RealTier_getValueAtTime_fromIndex (my amplitudes, t, & my amplitudeIndex) : 0.0 );
+			if (frequency != my frequency || bandwidth != my bandwidth || amplitude != my amplitude)
+				FormantSection_setCoefficients (me, frequency, bandwidth, amplitude, dx);
+		}
+		a [i] = my a;
+		b [i] = my b;
+		c [i] = my c;
+	}
+	double p1 = my p1, p2 = my p2;
+	if (my antiformant) {
+		for (integer i = 1; i <= x.size; i ++) {   // y [n] = a * (x [n] - b * x [n-1] - c * x [n-2])
+			const double input = x [i];
+			x [i] = a [i] * (input - b [i] * p1 - c [i] * p2);
+			p2 = p1;
+			p1 = input;
+		}
+	} else {
+		for (integer i = 1; i <= x.size; i ++) {   // y [n] = a * x [n] + b * y [n-1] + c * y [n-2]
+			const double output = a [i] * x [i] + b [i] * p1 + c [i] * p2;
+			p2 = p1;
+			p1 = x [i] = output;
+		}
+	}
+	my p1 = p1;
+	my p2 = p2;
+}
+
+/*
+	The first difference, scaled to the same absolute extremum as the input.
+	Klatt (1980) uses it for the higher parallel formants, to remove low-frequency energy from them.
+*/
+static void VECdifferentiate_scaled (VEC const& target, constVEC const& x) {
+	Melder_assert (target.size == x.size);
+	double amax1 = -1.0e34, amax2 = amax1, pval = 0.0;
+	for (integer i = 1; i <= x.size; i ++)
+		amax1 = std::max (amax1, fabs (x [i]));
+	for (integer i = 1; i <= x.size; i ++) {
+		target [i] = x [i] - pval;
+		pval = x [i];
+	}
+	for (integer i = 1; i <= x.size; i ++)
+		amax2 = std::max (amax2, fabs (target [i]));
+	if (amax2 > 0.0)   // otherwise the input is all zeros
+		for (integer i = 1; i <= x.size; i ++)
+			target [i] *= amax1 / amax2;
+}
+
+static void FormantFilters_filterChannel (FormantFilters me, constVEC const& input, constVEC const& differentiatedInput,
+	VEC const& output, double x1, double dx)
+{
+	for (integer isection = 1; isection <= my sections.size; isection ++)
+		FormantSection_reset (& my sections [isection]);
+	if (my groups.size == 0) {
+		output  <<=  input;
+		return;
+	}
+	autoVEC groupOutput = raw_VEC (FormantFilters_BLOCK_SIZE), sectionOutput = raw_VEC (FormantFilters_BLOCK_SIZE);
+	autoVEC a = raw_VEC (FormantFilters_BLOCK_SIZE), b = raw_VEC (FormantFilters_BLOCK_SIZE), c = raw_VEC (FormantFilters_BLOCK_SIZE);
+	for (integer first = 1; first <= input.size; first += FormantFilters_BLOCK_SIZE) {
+		const integer last = std::min (first + FormantFilters_BLOCK_SIZE - 1, input.size), blockSize = last - first + 1;
+		const VEC out = output.part (first, last);
+		const VEC aa = a.part (1, blockSize), bb = b.part (1, blockSize), cc = c.part (1, blockSize);
+		for (integer igroup = 1; igroup <= my groups.size; igroup ++) {
+			const FormantSectionGroup& group = my groups [igroup];
+			const constVEC in = ( group.differentiatedInput ? differentiatedInput : input ).part (first, last);
+			const VEC sum = ( igroup == 1 ? out : groupOutput.part (1, blockSize) );
+			if (group.cascade)
+				sum  <<=  in;
+			else
+				sum  <<=  0.0;
+			for (integer isection = 1; isection <= my sections.size; isection ++) {
+				FormantSection *section = & my sections [isection];
+				if (section -> group != igroup)
+					continue;
+				if (group.cascade) {
+					FormantSection_filterBlock (section, sum, first, x1, dx, aa, bb, cc);
+				} else {
+					const VEC y = sectionOutput.part (1, blockSize);
+					y  <<=  in;
+					FormantSection_filterBlock (section, y, first, x1, dx, aa, bb, cc);
+					for (integer i = 1; i <= blockSize; i ++)
+						sum [i] += ( section -> negative ? - y [i] : y [i] );
+				}
+			}
+			if (igroup > 1)
+				out  +=  sum;
+		}
+	}
+}
+
+/*
+	Thread-safe.
+*/
+static autoSound Sound_FormantFilters_filter (Sound me, FormantFilters thee) {
+	try {
+		autoSound him = Sound_create (my ny, my xmin, my xmax, my nx, my dx, my x1);
+		autoVEC differentiated = ( thy hasDifferentiatedInput ? raw_VEC (my nx) : autoVEC () );
+		for (integer ichan = 1; ichan <= my ny; ichan ++) {
+			if (thy hasDifferentiatedInput)
+				VECdifferentiate_scaled (differentiated.get(), my z.row (ichan));
+			FormantFilters_filterChannel (thee, my z.row (ichan), differentiated.get(), his z.row (ichan), my x1, my dx);
+		}
+		return him;
+	} catch (MelderError) {
+		Melder_throw (me, U": not filtered.");
+	}
+}
+
+/*
+	The formants iformantb..iformante (all formants if iformantb > iformante) as a parallel group,
+	with signs that alternate if alternatingSign is not 0 (1 or -1 is the sign of the first formant).
+*/
+static void FormantFilters_addParallelFormants (FormantFilters me, FormantGrid thee, OrderedOf<structIntensityTier>* amplitudes,
+	integer iformantb, integer iformante, int alternatingSign, bool differentiatedInput)
+{
+	if (iformantb > iformante) {
+		iformantb = 1;
+		iformante = thy formants.size;
+	}
+	Melder_require (iformantb > 0 && iformantb <= thy formants.size ,
+		U"From formant ", iformantb, U" not defined.");
+	Melder_require (iformante > 0 && iformante <= thy formants.size ,
+		U"To formant ", iformante, U" not defined.");
+	my addGroup (false, differentiatedInput);
+	for (integer iformant = iformantb; iformant <= iformante; iformant ++) {
+		if (FormantGrid_Intensities_isFormantDefined (thee, amplitudes, iformant)) {
+			my addSection (thy formants.at [iformant], thy bandwidths.at [iformant], amplitudes -> at [iformant], false, false, alternatingSign < 0);
+			if (alternatingSign != 0)
+				alternatingSign = - alternatingSign;
+		}
+	}
+}
+
 static void _Sound_FormantGrid_filterWithOneFormant_inplace (Sound me, FormantGrid thee, integer iformant, bool antiformant) {
 	if (iformant < 1 || iformant > thy formants.size) {
 		Melder_warning (U"Formant ", iformant, U" does not exist.");
@@ -475,21 +718,11 @@ static void _Sound_FormantGrid_filterWithOneFormant_inplace (Sound me, FormantGr
 		return;
 	Melder_require (ftier -> points.size != 0 && btier -> points.size != 0,
 		U"Tier should not be empty,");
-	const double nyquist = 0.5 / my dx;
-	autoFilter r;
-	if (antiformant)
-		r = AntiResonator_create (my dx);
-	else
-		r = Resonator_create (my dx, true);
-
-	for (integer is = 1; is <= my nx; is ++) {
-		const double t = my x1 + (is - 1) * my dx;
-		const double f = RealTier_getValueAtTime (ftier, t);
-		const double b = RealTier_getValueAtTime (btier, t);
-		if (f <= nyquist && isdefined (b))
-			Filter_setCoefficients (r.get(), f, b);
-		my z [1] [is] = Filter_getOutput (r.get(), my z [1] [is]);
-	}
+	autoFormantFilters filters = FormantFilters_create ();
+	filters -> addGroup (true, false);
+	filters -> addSection (ftier, btier, nullptr, antiformant, true, false);
+	autoSound him = Sound_FormantFilters_filter (me, filters.get());
+	my z.all()  <<=  his z.all();
 }
 
 void Sound_FormantGrid_filterWithOneAntiFormant_inplace (Sound me, FormantGrid thee, integer iformant) {
@@ -503,28 +736,16 @@ void Sound_FormantGrid_filterWithOneFormant_inplace (Sound me, FormantGrid thee,
 void Sound_FormantGrid_Intensities_filterWithOneFormant_inplace (Sound me, FormantGrid thee, OrderedOf<structIntensityTier>* amplitudes, integer iformant) {
 	try {
 		Melder_require (iformant > 0 && iformant <= thy formants.size, U"Formant ", iformant, U" not defined.");
-		
-		const double nyquist = 0.5 / my dx;
-
 		const RealTier ftier = thy formants.at [iformant];
 		const RealTier btier = thy bandwidths.at [iformant];
 		const IntensityTier atier = amplitudes->at [iformant];
-
 		if (ftier -> points.size == 0 || btier -> points.size == 0 || atier -> points.size == 0)
 			return;    // nothing to do
-		autoResonator r = Resonator_create (my dx, false);
-		for (integer is = 1; is <= my nx; is ++) {
-			const double t = my x1 + (is - 1) * my dx;
-			const double f = RealTier_getValueAtTime (ftier, t);
-			const double b = RealTier_getValueAtTime (btier, t);
-			if (f <= nyquist && isdefined (b)) {
-				Filter_setCoefficients (r.get(), f, b);
-				const double a = RealTier_getValueAtTime (atier, t);
-				if (isdefined (a))
-					r -> a *= DB_to_A (a);
-			}
-			my z [1] [is] = Filter_getOutput (r.get(), my z [1] [is]);
-		}
+		autoFormantFilters filters = FormantFilters_create ();
+		filters -> addGroup (true, false);
+		filters -> addSection (ftier, btier, atier, false, false, false);
+		autoSound him = Sound_FormantFilters_filter (me, filters.get());
+		my z.all()  <<=  his z.all();
 	} catch (MelderError) {
 		Melder_throw (me, U": not filtered with one formant filter.");
 	}
@@ -532,28 +753,9 @@ void Sound_FormantGrid_Intensities_filterWithOneFormant_inplace (Sound me, Forma
 
 autoSound Sound_FormantGrid_Intensities_filter (Sound me, FormantGrid thee, OrderedOf<structIntensityTier>* amplitudes, integer iformantb, integer iformante, int alternatingSign) {
 	try {
-		if (iformantb > iformante) {
-			iformantb = 1;
-			iformante = thy formants.size;
-		}
-		Melder_require (iformantb > 0 && iformantb <= thy formants.size ,
-			U"From formant ", iformantb, U" not defined.");
-		Melder_require (iformante > 0 && iformante <= thy formants.size ,
-			U"To formant ", iformante, U" not defined.");
-
-		autoSound him = Sound_create (my ny, my xmin, my xmax, my nx, my dx, my x1);
-
-		for (integer iformant = iformantb; iformant <= iformante; iformant ++) {
-			if (FormantGrid_Intensities_isFormantDefined (thee, amplitudes, iformant)) {
-				autoSound tmp = Data_copy (me);
-				Sound_FormantGrid_Intensities_filterWithOneFormant_inplace (tmp.get(), thee, amplitudes, iformant);
-				for (integer is = 1; is <= my nx; is ++)
-					his z [1] [is] += ( alternatingSign >= 0 ? tmp -> z [1] [is] : - tmp -> z [1] [is] );
-				if (alternatingSign != 0)
-					alternatingSign = - alternatingSign;
-			}
-		}
-		return him;
+		autoFormantFilters filters = FormantFilters_create ();
+		FormantFilters_addParallelFormants (filters.get(), thee, amplitudes, iformantb, iformante, alternatingSign, false);
+		return Sound_FormantFilters_filter (me, filters.get());
 	} catch (MelderError) {
 		Melder_throw (me, U": not filtered.");
 	}
@@ -1506,18 +1708,17 @@ static void VocalTractGrid_CouplingGrid_draw (VocalTractGrid me, CouplingGrid th
 	Graphics_unsetInner (g);
 }
 
-static autoSound Sound_VocalTractGrid_CouplingGrid_filter_cascade (Sound me, VocalTractGrid thee, CouplingGrid coupling) {
+static autoFormantFilters VocalTractGrid_CouplingGrid_getFormantFilters_cascade (VocalTractGrid me, CouplingGrid coupling) {
 	try {
-		const VocalTractGridPlayOptions pv = thy options.get();
+		const VocalTractGridPlayOptions pv = my options.get();
 		const CouplingGridPlayOptions pc = coupling -> options.get();
 		const bool useOpenGlottisInfo = pc -> openglottis && coupling && coupling -> glottis && coupling -> glottis -> points.size > 0;
-		const FormantGrid oral_formants = thy oral_formants.get();
-		const FormantGrid nasal_formants = thy nasal_formants.get();
-		const FormantGrid nasal_antiformants = thy nasal_antiformants.get();
+		const FormantGrid nasal_formants = my nasal_formants.get();
+		const FormantGrid nasal_antiformants = my nasal_antiformants.get();
 		const FormantGrid tracheal_formants = coupling -> tracheal_formants.get();
 		const FormantGrid tracheal_antiformants = coupling -> tracheal_antiformants.get();
 
-		const integer numberOfFormants = oral_formants -> formants.size;
+		const integer numberOfFormants = my oral_formants -> formants.size;
 		const integer numberOfTrachealFormants = tracheal_formants -> formants.size;
 		const integer numberOfTrachealAntiFormants = tracheal_antiformants -> formants.size;
 		const integer numberOfNasalFormants = nasal_formants -> formants.size;
@@ -1528,19 +1729,19 @@ static autoSound Sound_VocalTractGrid_CouplingGrid_filter_cascade (Sound me, Voc
 		check_formants (numberOfNasalAntiFormants, & pv -> startNasalAntiFormant, & pv -> endNasalAntiFormant);
 		check_formants (numberOfTrachealAntiFormants, & pc -> startTrachealAntiFormant, & pc -> endTrachealAntiFormant);
 
-		autoSound him = Data_copy (me);
+		autoFormantFilters thee = FormantFilters_create ();
+		thy addGroup (true, false);
 
-		autoFormantGrid formants;
 		if (useOpenGlottisInfo) {
-			formants = Data_copy (thy oral_formants.get());
-			FormantGrid_CouplingGrid_updateOpenPhases (formants.get(), coupling);
+			thy ownedFormantGrid = Data_copy (my oral_formants.get());
+			FormantGrid_CouplingGrid_updateOpenPhases (thy ownedFormantGrid.get(), coupling);
 		}
 
 		integer nasal_formant_warning = 0, any_warning = 0;
 		if (pv -> endNasalFormant > 0) {   // nasal formants
 			for (integer iformant = pv -> startNasalFormant; iformant <= pv -> endNasalFormant; iformant ++) {
-				if (FormantGrid_isFormantDefined (thy nasal_formants.get(), iformant)) {
-					_Sound_FormantGrid_filterWithOneFormant_inplace (him.get(), thy nasal_formants.get(), iformant, false);
+				if (FormantGrid_isFormantDefined (nasal_formants, iformant)) {
+					thy addSection (nasal_formants -> formants.at [iformant], nasal_formants -> bandwidths.at [iformant], nullptr, false, true, false);
 				} else {
 					// Melder_warning ("Nasal formant", iformant, ": frequency and/or bandwidth missing.");
 					nasal_formant_warning ++;
@@ -1552,8 +1753,8 @@ static autoSound Sound_VocalTractGrid_CouplingGrid_filter_cascade (Sound me, Voc
 		integer nasal_antiformant_warning = 0;
 		if (pv -> endNasalAntiFormant > 0) {   // nasal antiformants
 			for (integer iformant = pv -> startNasalAntiFormant; iformant <= pv -> endNasalAntiFormant; iformant ++) {
-				if (FormantGrid_isFormantDefined (thy nasal_antiformants.get(), iformant)) {
-					_Sound_FormantGrid_filterWithOneFormant_inplace (him.get(), thy nasal_antiformants.get(), iformant, true);
+				if (FormantGrid_isFormantDefined (nasal_antiformants, iformant)) {
+					thy addSection (nasal_antiformants -> formants.at [iformant], nasal_antiformants -> bandwidths.at [iformant], nullptr, true, true, false);
 				} else {
 					// Melder_warning ("Nasal antiformant", iformant, ": frequency and/or bandwidth missing.");
 					nasal_antiformant_warning ++;
@@ -1566,7 +1767,7 @@ static autoSound Sound_VocalTractGrid_CouplingGrid_filter_cascade (Sound me, Voc
 		if (pc -> endTrachealFormant > 0) {   // tracheal formants
 			for (integer iformant = pc -> startTrachealFormant; iformant <= pc -> endTrachealFormant; iformant ++) {
 				if (FormantGrid_isFormantDefined (tracheal_formants, iformant)) {
-					_Sound_FormantGrid_filterWithOneFormant_inplace (him.get(), tracheal_formants, iformant, false);
+					thy addSection (tracheal_formants -> formants.at [iformant], tracheal_formants -> bandwidths.at [iformant], nullptr, false, true, false);
 				} else {
 					// Melder_warning ("Tracheal formant", iformant, ": frequency and/or bandwidth missing.");
 					tracheal_formant_warning ++;
@@ -1579,7 +1780,7 @@ static autoSound Sound_VocalTractGrid_CouplingGrid_filter_cascade (Sound me, Voc
 		if (pc -> endTrachealAntiFormant > 0) {   // tracheal antiformants
 			for (integer iformant = pc -> startTrachealAntiFormant; iformant <= pc -> endTrachealAntiFormant; iformant ++) {
 				if (FormantGrid_isFormantDefined (tracheal_antiformants, iformant)) {
-					_Sound_FormantGrid_filterWithOneFormant_inplace (him.get(), tracheal_antiformants, iformant, true);
+					thy addSection (tracheal_antiformants -> formants.at [iformant], tracheal_antiformants -> bandwidths.at [iformant], nullptr, true, true, false);
 				} else {
 					// Melder_warning ("Tracheal antiformant", iformant, ": frequency and/or bandwidth missing.");
 					tracheal_antiformant_warning ++;
@@ -1590,12 +1791,10 @@ static autoSound Sound_VocalTractGrid_CouplingGrid_filter_cascade (Sound me, Voc
 
 		integer oral_formant_warning = 0;
 		if (pv -> endOralFormant > 0) {   // oral formants
-			if (! formants)
-				formants = Data_copy (thy oral_formants.get());
-
+			const FormantGrid formants = ( thy ownedFormantGrid ? thy ownedFormantGrid.get() : my oral_formants.get() );
 			for (integer iformant = pv -> startOralFormant; iformant <= pv -> endOralFormant; iformant ++) {
-				if (FormantGrid_isFormantDefined (formants.get(), iformant)) {
-					_Sound_FormantGrid_filterWithOneFormant_inplace (him.get(), formants.get(), iformant, false);
+				if (FormantGrid_isFormantDefined (formants, iformant)) {
+					thy addSection (formants -> formants.at [iformant], formants -> bandwidths.at [iformant], nullptr, false, true, false);
 				} else {
 					// Melder_warning ("Oral formant", iformant, ": frequency and/or bandwidth missing.");
 					oral_formant_warning ++;
@@ -1619,24 +1818,22 @@ static autoSound Sound_VocalTractGrid_CouplingGrid_filter_cascade (Sound me, Voc
 			MelderInfo_write (U"\nWarning:\n", warning.string);
 			MelderInfo_drain ();
 		}
-		return him;
+		return thee;
 	} catch (MelderError) {
-		Melder_throw (me, U": not filtered by vocaltract and coupling grid.");
+		Melder_throw (me, U": no cascade filters created.");
 	}
 }
 
-static autoSound Sound_VocalTractGrid_CouplingGrid_filter_parallel (Sound me, VocalTractGrid thee, CouplingGrid coupling) {
+static autoFormantFilters VocalTractGrid_CouplingGrid_getFormantFilters_parallel (VocalTractGrid me, CouplingGrid coupling) {
 	try {
-		const VocalTractGridPlayOptions pv = thy options.get();
+		const VocalTractGridPlayOptions pv = my options.get();
 		const CouplingGridPlayOptions pc = coupling -> options.get();
-		autoSound him;
-		FormantGrid oral_formants = thy oral_formants.get();
-		autoFormantGrid aof;
+		autoFormantFilters thee = FormantFilters_create ();
+		FormantGrid oral_formants = my oral_formants.get();
 		int alternatingSign = 0; // 0: no alternating signs in parallel adding of filter outputs, 1/-1 start sign
 		const bool useOpenGlottisInfo = pc -> openglottis && coupling -> glottis && coupling -> glottis -> points.size > 0;
-		int scale = 1;
-		const integer numberOfFormants = thy oral_formants -> formants.size;
-		const integer numberOfNasalFormants = thy nasal_formants -> formants.size;
+		const integer numberOfFormants = my oral_formants -> formants.size;
+		const integer numberOfNasalFormants = my nasal_formants -> formants.size;
 		const integer numberOfTrachealFormants = coupling -> tracheal_formants -> formants.size;
 
 		check_formants (numberOfFormants, & (pv -> startOralFormant), & (pv -> endOralFormant));
@@ -1644,27 +1841,29 @@ static autoSound Sound_VocalTractGrid_CouplingGrid_filter_parallel (Sound me, Vo
 		check_formants (numberOfTrachealFormants, & (pc -> startTrachealFormant), & (pc -> endTrachealFormant));
 
 		if (useOpenGlottisInfo) {
-			aof = Data_copy (thy oral_formants.get());
-			oral_formants = aof.get();
+			thy ownedFormantGrid = Data_copy (my oral_formants.get());
+			oral_formants = thy ownedFormantGrid.get();
 			FormantGrid_CouplingGrid_updateOpenPhases (oral_formants, coupling);
 		}
 
-		if (pv -> endOralFormant > 0) {
-			if (pv -> startOralFormant == 1) {
-				him = Data_copy (me);
-				if (oral_formants -> formants.size > 0)
-					Sound_FormantGrid_Intensities_filterWithOneFormant_inplace (him.get(), oral_formants, & thy oral_formants_amplitudes, 1);
+		/*
+			The first formant filters the source itself.
+		*/
+		if (pv -> endOralFormant > 0 && pv -> startOralFormant == 1) {
+			thy addGroup (true, false);
+			if (oral_formants -> formants.size > 0) {
+				const RealTier ftier = oral_formants -> formants.at [1];
+				const RealTier btier = oral_formants -> bandwidths.at [1];
+				const IntensityTier atier = my oral_formants_amplitudes.at [1];
+				if (ftier -> points.size > 0 && btier -> points.size > 0 && atier -> points.size > 0)
+					thy addSection (ftier, btier, atier, false, false, false);
 			}
 		}
 
 		if (pv -> endNasalFormant > 0) {
 			alternatingSign = 0;
-			autoSound nasal = Sound_FormantGrid_Intensities_filter (me, thy nasal_formants.get(), & thy nasal_formants_amplitudes, pv -> startNasalFormant, pv -> endNasalFormant, alternatingSign);
-
-			if (! him)
-				him = Data_copy (nasal.get());
-			else
-				_Sounds_add_inplace (him.get(), nasal.get());
+			FormantFilters_addParallelFormants (thee.get(), my nasal_formants.get(), & my nasal_formants_amplitudes,
+					pv -> startNasalFormant, pv -> endNasalFormant, alternatingSign, false);
 		}
 
 		// Formants 2 and up, with alternating signs.
@@ -1673,45 +1872,38 @@ static autoSound Sound_VocalTractGrid_CouplingGrid_filter_parallel (Sound me, Vo
 		// energy from them. This energy would otherwise distort the spectrum in the region of F1 during the synthesis
 		// of some vowels.
 
-		autoSound me_diff = _Sound_diff (me, scale);
-
 		if (pv -> endOralFormant >= 2) {
 			const integer startOralFormant2 = ( pv -> startOralFormant > 2 ? pv -> startOralFormant : 2 );
 			alternatingSign = ( startOralFormant2 % 2 == 0 ? -1 : 1 );   // 2 starts with negative sign
-			if (startOralFormant2 <= oral_formants -> formants.size) {
-				autoSound vocalTract = Sound_FormantGrid_Intensities_filter (me_diff.get(), oral_formants, & thy oral_formants_amplitudes, startOralFormant2, pv -> endOralFormant, alternatingSign);
-
-				if (! him)
-					him = Data_copy (vocalTract.get());
-				else
-					_Sounds_add_inplace (him.get(), vocalTract.get());
-			}
+			if (startOralFormant2 <= oral_formants -> formants.size)
+				FormantFilters_addParallelFormants (thee.get(), oral_formants, & my oral_formants_amplitudes,
+						startOralFormant2, pv -> endOralFormant, alternatingSign, true);
 		}
 
 		if (pc -> endTrachealFormant > 0) {   // tracheal formants
 			alternatingSign = 0;
-			autoSound trachea = Sound_FormantGrid_Intensities_filter (me_diff.get(), coupling -> tracheal_formants.get(),
-				& coupling -> tracheal_formants_amplitudes,
-				pc -> startTrachealFormant, pc -> endTrachealFormant, alternatingSign);
-
-			if (! him)
-				him = Data_copy (trachea.get());
-			else
-				_Sounds_add_inplace (him.get(), trachea.get());
+			FormantFilters_addParallelFormants (thee.get(), coupling -> tracheal_formants.get(), & coupling -> tracheal_formants_amplitudes,
+					pc -> startTrachealFormant, pc -> endTrachealFormant, alternatingSign, true);
 		}
-
-		if (! him)
-			him = Data_copy (me);
-		return him;
+		return thee;
 	} catch (MelderError) {
-		Melder_throw (me, U": not filtered in parallel.");
+		Melder_throw (me, U": no parallel filters created.");
 	}
 }
 
+static autoFormantFilters VocalTractGrid_CouplingGrid_getFormantFilters (VocalTractGrid me, CouplingGrid coupling) {
+	return my options -> filterModel == kKlattGridFilterModel::CASCADE ?
+	       VocalTractGrid_CouplingGrid_getFormantFilters_cascade (me, coupling) :
+	       VocalTractGrid_CouplingGrid_getFormantFilters_parallel (me, coupling);
+}
+
 autoSound Sound_VocalTractGrid_CouplingGrid_filter (Sound me, VocalTractGrid thee, CouplingGrid coupling) {
-	return thy options -> filterModel == kKlattGridFilterModel::CASCADE ?
-	       Sound_VocalTractGrid_CouplingGrid_filter_cascade (me, thee, coupling) :
-	       Sound_VocalTractGrid_CouplingGrid_filter_parallel (me, thee, coupling);
+	try {
+		autoFormantFilters filters = VocalTractGrid_CouplingGrid_getFormantFilters (thee, coupling);
+		return Sound_FormantFilters_filter (me, filters.get());
+	} catch (MelderError) {
+		Melder_throw (me, U": not filtered by vocaltract and coupling grid.");
+	}
 }
 
 /********************** CouplingGridPlayOptions **********************/
@@ -1965,7 +2157,7 @@ void FricationGrid_draw (FricationGrid me, Graphics g) {
 	Graphics_unsetInner (g);
 }
 
-autoSound FricationGrid_to_Sound (FricationGrid me, double samplingFrequency) {
+static autoSound FricationGrid_to_Sound_noise (FricationGrid me, double samplingFrequency) {
 	try {
 		autoSound thee = Sound_createEmptyMono (my xmin, my xmax, samplingFrequency);
 
@@ -1981,42 +2173,51 @@ autoSound FricationGrid_to_Sound (FricationGrid me, double samplingFrequency) {
 			lastval = (val += 0.75 * lastval); // TODO: soft low-pass coefficient should be Fs dependent!
 			thy z [1] [i] = val * a;
 		}
-
-		autoSound him = Sound_FricationGrid_filter (thee.get(), me);
-		return him;
+		return thee;
 	} catch (MelderError) {
-		Melder_throw (me, U": no frication Sound created.");
+		Melder_throw (me, U": no frication noise created.");
 	}
 }
 
 /************************ Sound & FricationGrid *********************************************/
 
-autoSound Sound_FricationGrid_filter (Sound me, FricationGrid thee) {
+static autoFormantFilters FricationGrid_getFormantFilters (FricationGrid me) {
 	try {
-		const FricationGridPlayOptions pf = thy options.get();
-		autoSound him;
-		const integer numberOfFricationFormants = thy frication_formants -> formants.size;
+		const FricationGridPlayOptions pf = my options.get();
+		autoFormantFilters thee = FormantFilters_create ();
+		const integer numberOfFricationFormants = my frication_formants -> formants.size;
 
 		check_formants (numberOfFricationFormants, & (pf -> startFricationFormant), & (pf -> endFricationFormant));
 
 		if (pf -> endFricationFormant > 1) {
 			const integer startFricationFormant2 = pf -> startFricationFormant > 2 ? pf -> startFricationFormant : 2;
 			int alternatingSign = ( startFricationFormant2 % 2 == 0 ? 1 : -1 ); // 2 starts with positive sign
-			him = Sound_FormantGrid_Intensities_filter (me, thy frication_formants.get(), & thy frication_formants_amplitudes, startFricationFormant2, pf -> endFricationFormant, alternatingSign);
+			FormantFilters_addParallelFormants (thee.get(), my frication_formants.get(), & my frication_formants_amplitudes,
+					startFricationFormant2, pf -> endFricationFormant, alternatingSign, false);
 		}
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (me, U": no frication filters created.");
+	}
+}
 
-		if (! him)
-			him = Data_copy (me);
-
-		if (pf -> bypass) {
+/*
+	Thread-safe.
+*/
+static autoSound Sound_FricationGrid_FormantFilters_filter (Sound me, FricationGrid thee, FormantFilters filters) {
+	try {
+		autoSound him = Sound_FormantFilters_filter (me, filters);
+		if (thy options -> bypass) {
+			integer bypassIndex = 1;
 			for (integer is = 1; is <= his nx; is ++) {	// Bypass
 				const double t = his x1 + (is - 1) * his dx;
 				double ab = 0.0;
 				if (thy bypass -> points.size > 0) {
-					const double val = RealTier_getValueAtTime (thy bypass.get(), t);
+					const double val = RealTier_getValueAtTime_fromIndex (thy bypass.get(), t, & bypassIndex);
 					ab = ( isundef (val) ? 0.0 : DB_to_A (val) );
 				}
-				his z [1] [is] += my z [1] [is] * ab;
+				for (integer ichan = 1; ichan <= his ny; ichan ++)
+					his z [ichan] [is] += my z [ichan] [is] * ab;
 			}
 		}
 		return him;
@@ -2025,6 +2226,21 @@ autoSound Sound_FricationGrid_filter (Sound me, FricationGrid thee) {
 	}
 }
 
+autoSound Sound_FricationGrid_filter (Sound me, FricationGrid thee) {
+	autoFormantFilters filters = FricationGrid_getFormantFilters (thee);
+	return Sound_FricationGrid_FormantFilters_filter (me, thee, filters.get());
+}
+
+autoSound FricationGrid_to_Sound (FricationGrid me, double samplingFrequency) {
+	try {
+		autoSound thee = FricationGrid_to_Sound_noise (me, samplingFrequency);
+		autoSound him = Sound_FricationGrid_filter (thee.get(), me);
+		return him;
+	} catch (MelderError) {
+		Melder_throw (me, U": no frication Sound created.");
+	}
+}
+
 /********************** KlattGridPlayOptions **********************/
 
 Thing_implement (KlattGridPlayOptions, Daata, 0);
@@ -2747,9 +2963,26 @@ autoSound KlattGrid_to_Sound_phonation (KlattGrid me) {
 	return PhonationGrid_to_Sound (my phonation.get(), 0, my options -> samplingFrequency);
 }
 
-autoSound KlattGrid_to_Sound (KlattGrid me) {
+/*
+	A KlattGrid is synthesized in two steps.
+	First the sources are generated and the filters are collected, on the calling thread,
+	because the noise sources draw random numbers and the filters may write warnings.
+	Then the sources are filtered; for several KlattGrids this can be done at the same time, on several threads.
+	The result is the same as when the KlattGrids are synthesized one after the other.
+*/
+Thing_define (KlattGridSynthesis, Thing) {
+	KlattGrid klattGrid;
+	autoSound phonation, frication;
+	autoFormantFilters vocalTractFilters, fricationFilters;
+	autoSound result;
+};
+
+Thing_implement (KlattGridSynthesis, Thing, 0);
+
+static autoKlattGridSynthesis KlattGrid_startSynthesis (KlattGrid me) {
 	try {
-		autoSound thee;
+		autoKlattGridSynthesis thee = Thing_new (KlattGridSynthesis);
+		thy klattGrid = me;
 		const PhonationGridPlayOptions pp = my phonation -> options.get();
 		const FricationGridPlayOptions pf = my frication -> options.get();
 		const double samplingFrequency = my options -> samplingFrequency;
@@ -2758,30 +2991,83 @@ autoSound KlattGrid_to_Sound (KlattGrid me) {
 			KlattGrid_setGlottisCoupling (me);
 
 		if (pp -> aspiration || pp -> voicing) { // No vocal tract filtering if no glottal source signal present
-			autoSound source = PhonationGrid_to_Sound (my phonation.get(), my coupling.get(), samplingFrequency);
-			thee = Sound_VocalTractGrid_CouplingGrid_filter (source.get(), my vocalTract.get(), my coupling.get());
+			thy phonation = PhonationGrid_to_Sound (my phonation.get(), my coupling.get(), samplingFrequency);
+			thy vocalTractFilters = VocalTractGrid_CouplingGrid_getFormantFilters (my vocalTract.get(), my coupling.get());
 		}
 
 		if (pf -> endFricationFormant > 0 || pf -> bypass) {
-			autoSound frication = FricationGrid_to_Sound (my frication.get(), samplingFrequency);
-			if (thee)
-				_Sounds_add_inplace (thee.get(), frication.get());
+			thy frication = FricationGrid_to_Sound_noise (my frication.get(), samplingFrequency);
+			thy fricationFilters = FricationGrid_getFormantFilters (my frication.get());
+		}
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (me, U": synthesis not started.");
+	}
+}
+
+/*
+	Thread-safe.
+*/
+static void KlattGridSynthesis_finish (KlattGridSynthesis me) {
+	const KlattGrid klattGrid = my klattGrid;
+	try {
+		if (my phonation)
+			my result = Sound_FormantFilters_filter (my phonation.get(), my vocalTractFilters.get());
+
+		if (my frication) {
+			autoSound frication = Sound_FricationGrid_FormantFilters_filter (my frication.get(), klattGrid -> frication.get(), my fricationFilters.get());
+			if (my result)
+				_Sounds_add_inplace (my result.get(), frication.get());
 			else
-				thee = frication.move();
+				my result = frication.move();
 		}
 
-		if (! thee)
-			thee = Sound_createEmptyMono (my xmin, my xmax, samplingFrequency);
+		if (! my result)
+			my result = Sound_createEmptyMono (klattGrid -> xmin, klattGrid -> xmax, klattGrid -> options -> samplingFrequency);
 
-		if (my options -> scalePeak)
-			Vector_scale (thee.get(), 0.99);
+		if (klattGrid -> options -> scalePeak)
+			Vector_scale (my result.get(), 0.99);
+	} catch (MelderError) {
+		Melder_throw (klattGrid, U": no Sound created.");
+	}
+}
 
-		return thee;
+autoSound KlattGrid_to_Sound (KlattGrid me) {
+	try {
+		autoKlattGridSynthesis synthesis = KlattGrid_startSynthesis (me);
+		KlattGridSynthesis_finish (synthesis.get());
+		return synthesis -> result.move();
 	} catch (MelderError) {
 		Melder_throw (me, U": no Sound created.");
 	}
 }
 
+autoSoundList KlattGrids_to_Sounds (OrderedOf<structKlattGrid>* me) {
+	try {
+		autoSoundList thee = SoundList_create ();
+		/*
+			A few KlattGrids at a time, so that not all sources have to be in memory at once.
+		*/
+		const integer numberOfKlattGridsPerRound = 2 * MelderThread_getNumberOfThreads ();
+		autoMelderProgress progress (U"Synthesizing...");
+		for (integer first = 1; first <= my size; first += numberOfKlattGridsPerRound) {
+			const integer last = std::min (first + numberOfKlattGridsPerRound - 1, my size);
+			OrderedOf<structKlattGridSynthesis> syntheses;
+			for (integer igrid = first; igrid <= last; igrid ++)
+				syntheses. addItem_move (KlattGrid_startSynthesis (my at [igrid]));
+			MelderThread_runTasks (syntheses.size, [&] (integer isynthesis) {
+				KlattGridSynthesis_finish (syntheses.at [isynthesis]);
+			});
+			for (integer isynthesis = 1; isynthesis <= syntheses.size; isynthesis ++)
+				thy addItem_move (syntheses.at [isynthesis] -> result.move());
+			Melder_progress (double (last) / my size, U"Synthesized ", last, U" of ", my size, U" KlattGrids.");
+		}
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (U"KlattGrids: no Sounds created.");
+	}
+}
+
 void KlattGrid_playSpecial (KlattGrid me, Sound_PlayCallback callback, Thing boss) {
 	try {
 		autoSound thee = KlattGrid_to_Sound (me);
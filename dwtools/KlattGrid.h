@@ -214,6 +214,12 @@ void KlattGrid_setDefaultPlayOptions (KlattGrid me);
 
 autoSound KlattGrid_to_Sound (KlattGrid me);
 
+autoSoundList KlattGrids_to_Sounds (OrderedOf<structKlattGrid>* me);
+/*
+	The same Sounds as KlattGrid_to_Sound () on each KlattGrid in turn,
+	but the filtering of several KlattGrids is done at the same time, on several threads.
+*/
+
 autoSound KlattGrid_to_Sound_phonation (KlattGrid me);
 
 int KlattGrid_synthesize (KlattGrid me, double t1, double t2, double samplingFrequency, double maximumPeriod);
@@ -82,6 +82,53 @@ autoTableOfReal MFCC_to_TableOfReal (MFCC me, bool includeC0) {
 	}
 }
 
+/*
+	The regression over 2 * numberOfFramesAround + 1 frames, with the first and last frames repeated at the edges.
+*/
+static void MAT_columnDeltas (MATVU const& target, constMATVU const& x, integer numberOfFramesAround) {
+	const integer numberOfFrames = x.nrow;
+	double denominator = 0.0;
+	for (integer n = 1; n <= numberOfFramesAround; n ++)
+		denominator += 2.0 * n * n;
+	for (integer iframe = 1; iframe <= numberOfFrames; iframe ++) {
+		for (integer icol = 1; icol <= x.ncol; icol ++) {
+			longdouble sum = 0.0;
+			for (integer n = 1; n <= numberOfFramesAround; n ++) {
+				const integer next = std::min (iframe + n, numberOfFrames), previous = std::max (iframe - n, 1_integer);
+				sum += n * (x [next] [icol] - x [previous] [icol]);
+			}
+			target [iframe] [icol] = double (sum) / denominator;
+		}
+	}
+}
+
+autoTableOfReal MFCC_to_TableOfReal_deltas (MFCC me, bool includeC0, integer numberOfFramesAround, bool includeAccelerations) {
+	try {
+		Melder_require (numberOfFramesAround > 0,
+			U"The number of frames around should be positive.");
+		autoTableOfReal coefficients = MFCC_to_TableOfReal (me, includeC0);
+		const integer numberOfCoefficients = coefficients -> numberOfColumns;
+		const integer numberOfColumns = ( includeAccelerations ? 3 : 2 ) * numberOfCoefficients;
+		autoTableOfReal thee = TableOfReal_create (my nx, numberOfColumns);
+		const MATVU statics = thy data.verticalBand (1, numberOfCoefficients);
+		const MATVU deltas = thy data.verticalBand (numberOfCoefficients + 1, 2 * numberOfCoefficients);
+		statics  <<=  coefficients -> data.all();
+		MAT_columnDeltas (deltas, statics, numberOfFramesAround);
+		if (includeAccelerations)
+			MAT_columnDeltas (thy data.verticalBand (2 * numberOfCoefficients + 1, numberOfColumns), deltas, numberOfFramesAround);
+		for (integer icol = 1; icol <= numberOfCoefficients; icol ++) {
+			conststring32 label = coefficients -> columnLabels [icol].get();
+			TableOfReal_setColumnLabel (thee.get(), icol, label);
+			TableOfReal_setColumnLabel (thee.get(), numberOfCoefficients + icol, Melder_cat (U"d", label));
+			if (includeAccelerations)
+				TableOfReal_setColumnLabel (thee.get(), 2 * numberOfCoefficients + icol, Melder_cat (U"dd", label));
+		}
+		return thee;
+	} catch (MelderError) {
+		Melder_throw (me, U": not converted to TableOfReal.");
+	}
+}
+
 // as_Sound not to_Sound
 autoSound MFCC_to_Sound (MFCC me) {
 	try {
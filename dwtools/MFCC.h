@@ -65,6 +65,12 @@ void MFCC_lifter (MFCC me, integer lifter);
 
 autoTableOfReal MFCC_to_TableOfReal (MFCC me, bool includeC0);
 
+autoTableOfReal MFCC_to_TableOfReal_deltas (MFCC me, bool includeC0, integer numberOfFramesAround, bool includeAccelerations);
+/*
+	The columns of MFCC_to_TableOfReal, followed by their deltas (d c [i] / dt in frames, estimated by a regression over
+	2 * numberOfFramesAround + 1 frames) and optionally by the deltas of the deltas.
+*/
+
 autoSound MFCC_to_Sound (MFCC me);
 
 autoSound MFCCs_crossCorrelate (MFCC me, MFCC thee, enum kSounds_convolve_scaling scaling, enum kSounds_convolve_signalOutsideTimeDomain signalOutsideTimeDomain);
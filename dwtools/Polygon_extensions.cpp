@@ -1117,36 +1117,38 @@ autoPolygon Polygons_union (Polygon me, Polygon thee) {
 	}
 }
 
-#define CROSSING (my y [i] < y0) != (my y [ip1] < y0)
-#define AREA { a = (my x [i]-x0)*(my y [ip1]-y0) - (my x [ip1]-x0)*(my y [i]-y0); if (fabs (a) <= eps) return Polygon_EDGE; }
-#define RIGHT_CROSSING (a > 0) == (my y [ip1] > my y [i])
-#define MODIFY_CROSSING_NUMBER { if (my y [ip1] > my y [i]) nup ++; else nup--; }
-
-int Polygon_getLocationOfPoint (Polygon me, double x0, double y0, double eps) {
-	if (my y [1] == y0 and my x [1] == x0) {
+#define CROSSING (y [i] < y0) != (y [ip1] < y0)
+#define AREA { a = (x [i]-x0)*(y [ip1]-y0) - (x [ip1]-x0)*(y [i]-y0); if (fabs (a) <= eps) return Polygon_EDGE; }
+#define RIGHT_CROSSING (a > 0) == (y [ip1] > y [i])
+#define MODIFY_CROSSING_NUMBER { if (y [ip1] > y [i]) nup ++; else nup--; }
+
+int NUMgetLocationOfPointInPolygon (constVEC const& x, constVEC const& y, double x0, double y0, double eps) {
+	Melder_assert (y.size == x.size);
+	const integer numberOfPoints = x.size;
+	if (y [1] == y0 and x [1] == x0) {
 		return Polygon_VERTEX;
 	}
 
 	integer nup = 0;
-	for (integer i = 1; i <= my numberOfPoints; i ++) {
+	for (integer i = 1; i <= numberOfPoints; i ++) {
 		double a;
-		integer ip1 = ( i < my numberOfPoints ? i + 1 : 1 );
-		if (my y [ip1] == y0) {
-			if (my x [ip1] == x0) {
+		integer ip1 = ( i < numberOfPoints ? i + 1 : 1 );
+		if (y [ip1] == y0) {
+			if (x [ip1] == x0) {
 				return Polygon_VERTEX;
-			} else if (my y [i] == y0 && ( my x [ip1] > x0 ) == ( my x [i] < x0 )) {
+			} else if (y [i] == y0 && ( x [ip1] > x0 ) == ( x [i] < x0 )) {
 				return Polygon_EDGE;
 			}
 		}
 		if (CROSSING) {
-			if (my x [i] >= x0) {
-				if (my x [ip1] > x0) MODIFY_CROSSING_NUMBER
+			if (x [i] >= x0) {
+				if (x [ip1] > x0) MODIFY_CROSSING_NUMBER
 					else {
 						AREA
 						if (RIGHT_CROSSING) MODIFY_CROSSING_NUMBER
 						}
 			} else {
-				if (my x [ip1] > x0) {
+				if (x [ip1] > x0) {
 					AREA
 					if (RIGHT_CROSSING) MODIFY_CROSSING_NUMBER
 					}
@@ -1156,6 +1158,10 @@ int Polygon_getLocationOfPoint (Polygon me, double x0, double y0, double eps) {
 	return ( nup % 2 == 0 ? Polygon_OUTSIDE : Polygon_INSIDE );
 }
 
+int Polygon_getLocationOfPoint (Polygon me, double x0, double y0, double eps) {
+	return NUMgetLocationOfPointInPolygon (my x.part (1, my numberOfPoints), my y.part (1, my numberOfPoints), x0, y0, eps);
+}
+
 static inline double cross (double x1, double y1, double x2, double y2, double x3, double y3) {
   return (x2 - x1) * (y3 - y1) - (y2 - y1) * (x3 - x1);
 }
@@ -57,6 +57,10 @@ autoPolygon Polygon_circularPermutation (Polygon me, integer nshift);
 
 // Is point (x,y) Inside, Outside, Boundary (Edge or Vertex) ?
 int Polygon_getLocationOfPoint (Polygon me, double x0, double y0, double eps);
+int NUMgetLocationOfPointInPolygon (constVEC const& x, constVEC const& y, double x0, double y0, double eps);
+/*
+	The same for the polygon with vertices (x [1], y [1]) .. (x [n], y [n]), without a Polygon object.
+*/
 
 void Polygon_Categories_draw (Polygon me, Categories thee, Graphics graphics, double xmin, double xmax, double ymin, double ymax, bool garnish);
 /* reverse axis when min > max */
@@ -18,7 +18,7 @@
 
 #include "SampledToSampledWorkspace.h"
 #include "Sound_extensions.h"
-#include <thread>
+#include "MelderThread.h"
 #include <atomic>
 #include "NUM2.h"
 
@@ -97,11 +97,11 @@ void SampledToSampledWorkspace_replaceOutput (mutableSampledToSampledWorkspace m
 
 
 void SampledToSampledWorkspace_getThreadingInfo (constSampledToSampledWorkspace me, integer *out_numberOfThreads) {
-	const integer numberOfProcessors = std::thread::hardware_concurrency ();
 	/*
-		Our processes are compute bound, therefore it probably makes no sense to start more than two threads on one processor
+		Our processes are compute bound, therefore it probably makes no sense to have more than two chunks of frames
+		per thread of the pool; having more chunks than threads helps balancing the load, though.
 	*/
-	integer maximumNumberOfThreads = 2 * numberOfProcessors;
+	integer maximumNumberOfThreads = 2 * MelderThread_getNumberOfThreads ();
 	if (my maximumNumberOfThreads > 0)
 		 maximumNumberOfThreads = std::min (my maximumNumberOfThreads, maximumNumberOfThreads);
 	const integer numberOfFrames = my output -> nx;
@@ -111,58 +111,64 @@ void SampledToSampledWorkspace_getThreadingInfo (constSampledToSampledWorkspace
 		*out_numberOfThreads = numberOfThreads;
 }
 
-void SampledToSampledWorkspace_analyseThreaded (mutableSampledToSampledWorkspace me)
-{
-	try {
-
-		my allocateOutputFrames ();
+static void analyseInRounds (mutableSampledToSampledWorkspace me, conststring32 progressMessage) {
+	my allocateOutputFrames ();
 
-		const integer numberOfFrames = my output -> nx;
-		
-		std::atomic<integer> globalFrameErrorCount (0);
-		
+	const integer numberOfFrames = my output -> nx;
+	
+	std::atomic<integer> globalFrameErrorCount (0);
+	
+	integer numberOfThreads = 1;
+	if (my useMultiThreading)
+		SampledToSampledWorkspace_getThreadingInfo (me, & numberOfThreads);
+	/*
+		We have to reserve all the needed working memory for each thread beforehand.
+	*/
+	OrderedOf<structSampledToSampledWorkspace> workspaces;
+	if (my useMultiThreading) {
+		for (integer ithread = 1; ithread <= numberOfThreads; ithread ++) {
+			autoSampledToSampledWorkspace threadWorkspace = Data_copy (me);
+			workspaces.addItem_move (threadWorkspace.move());
+		}
+	}
+	/*
+		With a progress message, the frames are analysed in rounds,
+		so that the progress can be shown, and the analysis can be cancelled, in between.
+	*/
+	const integer numberOfFramesPerRound = ( progressMessage ?
+			10 * my minimumNumberOfFramesPerThread * numberOfThreads : numberOfFrames );
+	for (integer firstFrameOfRound = 1; firstFrameOfRound <= numberOfFrames; firstFrameOfRound += numberOfFramesPerRound) {
+		const integer lastFrameOfRound = std::min (firstFrameOfRound + numberOfFramesPerRound - 1, numberOfFrames);
 		if (my useMultiThreading) {
-			integer numberOfThreads;
-			SampledToSampledWorkspace_getThreadingInfo (me, & numberOfThreads);
-			const integer numberOfFramesPerThread = my minimumNumberOfFramesPerThread;
-			/*
-				We have to reserve all the needed working memory for each thread beforehand.
-			*/
-			OrderedOf<structSampledToSampledWorkspace> workspaces;
-			for (integer ithread = 1; ithread <= numberOfThreads; ithread ++) {
-				autoSampledToSampledWorkspace threadWorkspace = Data_copy (me);
-				workspaces.addItem_move (threadWorkspace.move());
-			}
-		
-			autovector<std::thread> threads = autovector<std::thread> (numberOfThreads, MelderArray::kInitializationType::ZERO);
-			
-			try {
-				for (integer ithread = 1; ithread <= numberOfThreads; ithread ++) {
-					SampledToSampledWorkspace threadWorkspace = workspaces.at [ithread];
-					const integer firstFrame = 1 + (ithread - 1) * numberOfFramesPerThread;
-					const integer lastFrame = ( ithread == numberOfThreads ? numberOfFrames : firstFrame + numberOfFramesPerThread - 1 );
-					
-					auto analyseFrames = [&globalFrameErrorCount] (SampledToSampledWorkspace threadWorkspace, integer fromFrame, integer toFrame) {
-						threadWorkspace -> inputFramesToOutputFrames (fromFrame, toFrame);
-						globalFrameErrorCount += threadWorkspace -> globalFrameErrorCount;
-					};
-
-					threads [ithread] = std::thread (analyseFrames, threadWorkspace, firstFrame, lastFrame);
-				}
-				
-				for (integer ithread = 1; ithread <= numberOfThreads; ithread ++)
-					threads [ithread]. join ();
-				
-			} catch (MelderError) {
-				for (integer ithread = 1; ithread <= numberOfThreads; ithread ++)
-					if (threads [ithread]. joinable ())
-						threads [ithread]. join ();
-				Melder_clearError ();
-				throw;
-			}
-			my globalFrameErrorCount = globalFrameErrorCount;
+			const integer numberOfFramesInRound = lastFrameOfRound - firstFrameOfRound + 1;
+			MelderThread_runTasks (numberOfThreads, [&] (integer ithread) {
+				SampledToSampledWorkspace threadWorkspace = workspaces.at [ithread];
+				/*
+					Distribute the frames evenly over the threads (the numbers of frames differ by at most one).
+				*/
+				const integer firstFrame = firstFrameOfRound + (ithread - 1) * numberOfFramesInRound / numberOfThreads;
+				const integer lastFrame = firstFrameOfRound - 1 + ithread * numberOfFramesInRound / numberOfThreads;
+				threadWorkspace -> inputFramesToOutputFrames (firstFrame, lastFrame);
+				globalFrameErrorCount += threadWorkspace -> globalFrameErrorCount;
+			});
+		} else {
+			my inputFramesToOutputFrames (firstFrameOfRound, lastFrameOfRound); // no threading
+			globalFrameErrorCount += my globalFrameErrorCount;
+		}
+		if (progressMessage)
+			Melder_progress (lastFrameOfRound / (numberOfFrames + 1.0),
+				progressMessage, U": analysis of frame ", lastFrameOfRound, U" out of ", numberOfFrames);
+	}
+	my globalFrameErrorCount = globalFrameErrorCount;
+}
+
+void SampledToSampledWorkspace_analyseThreaded (mutableSampledToSampledWorkspace me, conststring32 progressMessage) {
+	try {
+		if (progressMessage) {
+			autoMelderProgress progress (progressMessage);
+			analyseInRounds (me, progressMessage);
 		} else {
-			my inputFramesToOutputFrames (1, numberOfFrames); // no threading
+			analyseInRounds (me, nullptr);
 		}
 	} catch (MelderError) {
 		Melder_throw (me, U"The Sampled analysis could not be done.");
@@ -41,7 +41,10 @@ void SampledToSampledWorkspace_replaceInput (mutableSampledToSampledWorkspace me
 		my output -> nx   == thy nx && my output -> dx   == thy dx && my output -> x1   == thy x1
 */
 
-void SampledToSampledWorkspace_analyseThreaded (mutableSampledToSampledWorkspace me);
+void SampledToSampledWorkspace_analyseThreaded (mutableSampledToSampledWorkspace me, conststring32 progressMessage = nullptr);
+/*
+	With a progress message, the frames are analysed in rounds, with the progress shown after each round.
+*/
 
 inline void Sampled_requireEqualSampling (constSampled me,  constSampled thee) {
 	Melder_assert (me && thee);
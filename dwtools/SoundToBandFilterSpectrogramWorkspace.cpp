@@ -0,0 +1,190 @@
+/* SoundToBandFilterSpectrogramWorkspace.cpp
+ *
+ * Copyright (C) 2026 David Weenink
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SoundToBandFilterSpectrogramWorkspace.h"
+#include "Sound_and_Spectrogram_extensions.h"
+#include "Sound_extensions.h"
+#include "Spectrum.h"
+
+#include "oo_DESTROY.h"
+#include "SoundToBandFilterSpectrogramWorkspace_def.h"
+#include "oo_COPY.h"
+#include "SoundToBandFilterSpectrogramWorkspace_def.h"
+#include "oo_EQUAL.h"
+#include "SoundToBandFilterSpectrogramWorkspace_def.h"
+#include "oo_CAN_WRITE_AS_ENCODING.h"
+#include "SoundToBandFilterSpectrogramWorkspace_def.h"
+#include "oo_WRITE_TEXT.h"
+#include "SoundToBandFilterSpectrogramWorkspace_def.h"
+#include "oo_WRITE_BINARY.h"
+#include "SoundToBandFilterSpectrogramWorkspace_def.h"
+#include "oo_READ_TEXT.h"
+#include "SoundToBandFilterSpectrogramWorkspace_def.h"
+#include "oo_READ_BINARY.h"
+#include "SoundToBandFilterSpectrogramWorkspace_def.h"
+#include "oo_DESCRIPTION.h"
+#include "SoundToBandFilterSpectrogramWorkspace_def.h"
+
+Thing_implement (SoundToBandFilterSpectrogramWorkspace, SampledToSampledWorkspace, 0);
+
+void structSoundToBandFilterSpectrogramWorkspace :: getInputFrame () {
+	constSound sound = reinterpret_cast<constSound> (input);
+	const double t = Sampled_indexToX (output, currentFrame);
+	const integer startSample = Sampled_xToNearestIndex (input, t - 0.5 * windowDuration);
+	for (integer j = 1; j <= windowSize; j ++) {
+		const integer i = startSample - 1 + j;
+		fftData [j] = ( i < 1 || i > sound -> nx ? 0.0 : sound -> z [1] [i] ) * window [j];
+	}
+	fftData.part (windowSize + 1, fftSize)  <<=  0.0;
+}
+
+bool structSoundToBandFilterSpectrogramWorkspace :: inputFrameToOutputFrame () {
+	NUMfft_forward (& fftTable, fftData.get());   // fftData := complex spectrum
+	/*
+		The power spectrum, with the amplitudes scaled as in Sound_to_Spectrum;
+		the frequency bins at 0 Hz and at the Nyquist frequency don't count for two.
+	*/
+	double re = fftData [1] * samplingPeriod;
+	powerSpectrum [1] = 0.5 * (powerScaling * (re * re));
+	for (integer i = 2; i < numberOfPowerValues; i ++) {
+		re = fftData [i + i - 2] * samplingPeriod;
+		const double im = fftData [i + i - 1] * samplingPeriod;
+		powerSpectrum [i] = powerScaling * (re * re + im * im);
+	}
+	re = fftData [fftSize] * samplingPeriod;
+	powerSpectrum [numberOfPowerValues] = 0.5 * (powerScaling * (re * re));
+
+	for (integer ifilter = 1; ifilter <= numberOfFilters; ifilter ++) {
+		longdouble power = 0.0;
+		for (integer i = firstPowerValue [ifilter], k = firstWeight [ifilter]; i <= lastPowerValue [ifilter]; i ++, k ++)
+			power += weights [k] * powerSpectrum [i];
+		filterOutput [ifilter] = double (power) / windowCorrection;
+	}
+	return true;
+}
+
+void structSoundToBandFilterSpectrogramWorkspace :: saveOutputFrame () {
+	BandFilterSpectrogram thee = reinterpret_cast<BandFilterSpectrogram> (output);
+	for (integer ifilter = 1; ifilter <= numberOfFilters; ifilter ++)
+		thy z [ifilter] [currentFrame] = filterOutput [ifilter];
+}
+
+void SoundToBandFilterSpectrogramWorkspace_init (SoundToBandFilterSpectrogramWorkspace me, double windowDuration) {
+	const double samplingFrequency = 1.0 / my input -> dx;
+	autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
+	Melder_require (window -> nx > 1,
+		U"The window should contain more than one sample.");
+	my windowDuration = windowDuration;
+	my windowSize = window -> nx;
+	my window = copy_VEC (window -> z.row (1));
+	my windowCorrection = Spectrogram_getGaussianWindowCorrection (my windowSize);
+	my samplingPeriod = window -> dx;
+	my fftSize = Melder_iroundUpToPowerOfTwo (my windowSize);
+	my fftData = zero_VEC (my fftSize);
+	my numberOfPowerValues = my fftSize / 2 + 1;
+	my powerSpectrum = zero_VEC (my numberOfPowerValues);
+	const double binWidth = 1.0 / (my samplingPeriod * my fftSize);
+	my powerScaling = 2.0 * binWidth / (window -> xmax - window -> xmin);
+	NUMfft_Table_init (& my fftTable, my fftSize);
+}
+
+/*
+	The frequencies of the power values are those of the Spectrum that Sound_to_Spectrum would give.
+*/
+static autoSpectrum SoundToBandFilterSpectrogramWorkspace_createSpectrum (SoundToBandFilterSpectrogramWorkspace me) {
+	autoSpectrum thee = Spectrum_create (0.5 / my samplingPeriod, my numberOfPowerValues);
+	thy dx = 1.0 / (my samplingPeriod * my fftSize);
+	return thee;
+}
+
+static void SoundToBandFilterSpectrogramWorkspace_initFilters (SoundToBandFilterSpectrogramWorkspace me, integer numberOfFilters,
+	constINTVEC const& firstPowerValue, constINTVEC const& lastPowerValue)
+{
+	my numberOfFilters = numberOfFilters;
+	my firstPowerValue = copy_INTVEC (firstPowerValue);
+	my lastPowerValue = copy_INTVEC (lastPowerValue);
+	my firstWeight = raw_INTVEC (numberOfFilters);
+	my numberOfWeights = 0;
+	for (integer ifilter = 1; ifilter <= numberOfFilters; ifilter ++) {
+		my firstWeight [ifilter] = my numberOfWeights + 1;
+		my numberOfWeights += std::max (lastPowerValue [ifilter] - firstPowerValue [ifilter] + 1, 0_integer);
+	}
+	my weights = zero_VEC (my numberOfWeights);
+	my filterOutput = zero_VEC (numberOfFilters);
+}
+
+void SoundToBandFilterSpectrogramWorkspace_initMelFilters (SoundToBandFilterSpectrogramWorkspace me, integer numberOfFilters, double f1_mel, double df_mel) {
+	autoSpectrum spectrum = SoundToBandFilterSpectrogramWorkspace_createSpectrum (me);
+	autoINTVEC firstPowerValue = raw_INTVEC (numberOfFilters), lastPowerValue = raw_INTVEC (numberOfFilters);
+	for (integer ifilter = 1; ifilter <= numberOfFilters; ifilter ++) {
+		const double fc_mel = f1_mel + (ifilter - 1) * df_mel;
+		const double fl_hz = NUMmelToHertz2 (std::max (fc_mel - df_mel, 0.0));
+		const double fh_hz = NUMmelToHertz2 (std::min (fc_mel + df_mel, spectrum -> xmax));
+		Sampled_getWindowSamples (spectrum.get(), fl_hz, fh_hz, & firstPowerValue [ifilter], & lastPowerValue [ifilter]);
+	}
+	SoundToBandFilterSpectrogramWorkspace_initFilters (me, numberOfFilters, firstPowerValue.get(), lastPowerValue.get());
+	for (integer ifilter = 1; ifilter <= numberOfFilters; ifilter ++) {
+		/*
+			Bin with a triangular filter the power (= amplitude-squared)
+		*/
+		const double fc_mel = f1_mel + (ifilter - 1) * df_mel;
+		const double fc_hz = NUMmelToHertz2 (fc_mel);
+		const double fl_hz = NUMmelToHertz2 (std::max (fc_mel - df_mel, 0.0));
+		const double fh_hz = NUMmelToHertz2 (std::min (fc_mel + df_mel, spectrum -> xmax));
+		for (integer i = firstPowerValue [ifilter], k = my firstWeight [ifilter]; i <= lastPowerValue [ifilter]; i ++, k ++) {
+			const double f = spectrum -> x1 + (i - 1) * spectrum -> dx;
+			my weights [k] = NUMtriangularfilter_amplitude (fl_hz, fc_hz, fh_hz, f);
+		}
+	}
+}
+
+void SoundToBandFilterSpectrogramWorkspace_initBarkFilters (SoundToBandFilterSpectrogramWorkspace me, integer numberOfFilters, double f1_bark, double df_bark) {
+	autoSpectrum spectrum = SoundToBandFilterSpectrogramWorkspace_createSpectrum (me);
+	autoINTVEC firstPowerValue = raw_INTVEC (numberOfFilters), lastPowerValue = raw_INTVEC (numberOfFilters);
+	for (integer ifilter = 1; ifilter <= numberOfFilters; ifilter ++) {
+		firstPowerValue [ifilter] = 1;
+		lastPowerValue [ifilter] = my numberOfPowerValues;
+	}
+	SoundToBandFilterSpectrogramWorkspace_initFilters (me, numberOfFilters, firstPowerValue.get(), lastPowerValue.get());
+	for (integer ifilter = 1; ifilter <= numberOfFilters; ifilter ++) {
+		const double z0 = f1_bark + (ifilter - 1) * df_bark;
+		for (integer i = 1, k = my firstWeight [ifilter]; i <= my numberOfPowerValues; i ++, k ++) {
+			/*
+				Sekey & Hanson filter is defined in the power domain.
+				We therefore multiply the power with a (and not a^2).
+			*/
+			const double frequency_Hz = spectrum -> x1 + (i - 1) * spectrum -> dx;
+			my weights [k] = NUMsekeyhansonfilter_amplitude (z0, NUMhertzToBark (frequency_Hz));
+		}
+	}
+}
+
+autoSoundToBandFilterSpectrogramWorkspace SoundToBandFilterSpectrogramWorkspace_create (constSound input,
+	mutableBandFilterSpectrogram output, double windowDuration)
+{
+	try {
+		autoSoundToBandFilterSpectrogramWorkspace me = Thing_new (SoundToBandFilterSpectrogramWorkspace);
+		SampledToSampledWorkspace_init (me.get(), input, output);
+		SoundToBandFilterSpectrogramWorkspace_init (me.get(), windowDuration);
+		return me;
+	} catch (MelderError) {
+		Melder_throw (U"SoundToBandFilterSpectrogramWorkspace not created.");
+	}
+}
+
+/* End of file SoundToBandFilterSpectrogramWorkspace.cpp */
@@ -0,0 +1,60 @@
+#ifndef _SoundToBandFilterSpectrogramWorkspace_h_
+#define _SoundToBandFilterSpectrogramWorkspace_h_
+/* SoundToBandFilterSpectrogramWorkspace.h
+ *
+ * Copyright (C) 2026 David Weenink
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Sound.h"
+#include "Spectrogram_extensions.h"
+#include "NUM2.h"
+#include "SampledToSampledWorkspace.h"
+
+#include "SoundToBandFilterSpectrogramWorkspace_def.h"
+
+/*
+	Workspace for the frame-by-frame filter bank analysis of Sound_to_MelSpectrogram and Sound_to_BarkSpectrogram.
+	A frame of the first channel is multiplied by a Gaussian window of windowDuration,
+	its power spectrum is computed as by Sound_to_Spectrum, and each filter sums the weighted power values.
+	The filter weights are computed once, not for every frame,
+	and the threaded analysis gives exactly the same results as a single-threaded one.
+*/
+
+void SoundToBandFilterSpectrogramWorkspace_init (SoundToBandFilterSpectrogramWorkspace me, double windowDuration);
+
+void SoundToBandFilterSpectrogramWorkspace_initMelFilters (SoundToBandFilterSpectrogramWorkspace me,
+	integer numberOfFilters, double f1_mel, double df_mel
+);
+/*
+	Triangular filters on the mel scale, with their centres at f1_mel + (i - 1) * df_mel
+	and their sides at the centres of their neighbours.
+*/
+
+void SoundToBandFilterSpectrogramWorkspace_initBarkFilters (SoundToBandFilterSpectrogramWorkspace me,
+	integer numberOfFilters, double f1_bark, double df_bark
+);
+/*
+	Sekey & Hanson filters on the bark scale, with their centres at f1_bark + (i - 1) * df_bark.
+*/
+
+autoSoundToBandFilterSpectrogramWorkspace SoundToBandFilterSpectrogramWorkspace_create (constSound input,
+	mutableBandFilterSpectrogram output, double windowDuration
+);
+/*
+	The filters still have to be initialized, in accordance with the frequencies of the output.
+*/
+
+#endif /* _SoundToBandFilterSpectrogramWorkspace_h_ */
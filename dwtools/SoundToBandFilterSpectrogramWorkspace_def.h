@@ -0,0 +1,69 @@
+/* SoundToBandFilterSpectrogramWorkspace_def.h
+ *
+ * Copyright (C) 2026 David Weenink
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define ooSTRUCT SoundToBandFilterSpectrogramWorkspace
+oo_DEFINE_CLASS (SoundToBandFilterSpectrogramWorkspace, SampledToSampledWorkspace)
+
+	oo_DOUBLE (windowDuration)
+	oo_INTEGER (windowSize)
+	oo_VEC (window, windowSize)					// Gaussian
+	oo_DOUBLE (windowCorrection)				// the power of the window relative to a rectangular window
+	oo_DOUBLE (samplingPeriod)					// of the frame
+	oo_INTEGER (fftSize)						// a power of two, at least windowSize
+	oo_VEC (fftData, fftSize)
+	oo_INTEGER (numberOfPowerValues)			// fftSize / 2 + 1
+	oo_VEC (powerSpectrum, numberOfPowerValues)
+	oo_DOUBLE (powerScaling)					// 2 * (width of a frequency bin) / windowDuration
+
+	/*
+		The filters as a sparse matrix: the weights of filter i are
+		weights [firstWeight [i] .. firstWeight [i] + lastPowerValue [i] - firstPowerValue [i]],
+		for powerSpectrum [firstPowerValue [i] .. lastPowerValue [i]].
+	*/
+	oo_INTEGER (numberOfFilters)
+	oo_INTVEC (firstPowerValue, numberOfFilters)
+	oo_INTVEC (lastPowerValue, numberOfFilters)
+	oo_INTVEC (firstWeight, numberOfFilters)
+	oo_INTEGER (numberOfWeights)
+	oo_VEC (weights, numberOfWeights)
+	oo_VEC (filterOutput, numberOfFilters)		// the power in each filter, corrected for the window
+
+	#if oo_DECLARING
+
+		/*
+			Each thread needs its own FFT table;
+			it is not part of the persistent data because it can always be recomputed from the fftSize.
+		*/
+		autoNUMfft_Table fftTable;
+
+		void getInputFrame () override;
+		bool inputFrameToOutputFrame () override;
+		void saveOutputFrame () override;
+
+	#endif
+
+	#if oo_COPYING
+
+		NUMfft_Table_init (& thy fftTable, thy fftSize);
+
+	#endif
+
+oo_END_CLASS (SoundToBandFilterSpectrogramWorkspace)
+#undef ooSTRUCT
+
+/* End of file SoundToBandFilterSpectrogramWorkspace_def.h */
@@ -0,0 +1,80 @@
+/* SoundToMFCCWorkspace.cpp
+ *
+ * Copyright (C) 2026 David Weenink
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SoundToMFCCWorkspace.h"
+
+#include "oo_DESTROY.h"
+#include "SoundToMFCCWorkspace_def.h"
+#include "oo_COPY.h"
+#include "SoundToMFCCWorkspace_def.h"
+#include "oo_EQUAL.h"
+#include "SoundToMFCCWorkspace_def.h"
+#include "oo_CAN_WRITE_AS_ENCODING.h"
+#include "SoundToMFCCWorkspace_def.h"
+#include "oo_WRITE_TEXT.h"
+#include "SoundToMFCCWorkspace_def.h"
+#include "oo_WRITE_BINARY.h"
+#include "SoundToMFCCWorkspace_def.h"
+#include "oo_READ_TEXT.h"
+#include "SoundToMFCCWorkspace_def.h"
+#include "oo_READ_BINARY.h"
+#include "SoundToMFCCWorkspace_def.h"
+#include "oo_DESCRIPTION.h"
+#include "SoundToMFCCWorkspace_def.h"
+
+Thing_implement (SoundToMFCCWorkspace, SoundToBandFilterSpectrogramWorkspace, 0);
+
+void structSoundToMFCCWorkspace :: allocateOutputFrames () {
+	MFCC thee = reinterpret_cast<MFCC> (output);
+	for (integer iframe = 1; iframe <= thy nx; iframe ++)
+		CC_Frame_init (& thy frame [iframe], numberOfCoefficients);
+}
+
+void structSoundToMFCCWorkspace :: saveOutputFrame () {
+	/*
+		As in BandFilterSpectrogram_into_CC: cosine transform of the dB-spectrum.
+	*/
+	for (integer ifilter = 1; ifilter <= numberOfFilters; ifilter ++)
+		dBSpectrum [ifilter] = ( filterOutput [ifilter] > 0.0 ? 10.0 * log10 (filterOutput [ifilter] / 4e-10) : -300.0 );
+	VECcosineTransform_preallocated (cepstrum.get(), dBSpectrum.get(), cosinesTable.get());
+	MFCC thee = reinterpret_cast<MFCC> (output);
+	const CC_Frame ccframe = & thy frame [currentFrame];
+	ccframe -> c.all()  <<=  cepstrum.part (2, numberOfCoefficients + 1);
+	ccframe -> c0 = cepstrum [1];
+}
+
+autoSoundToMFCCWorkspace SoundToMFCCWorkspace_create (constSound input, mutableMFCC output, double windowDuration,
+	integer numberOfFilters, double f1_mel, double df_mel, integer numberOfCoefficients)
+{
+	try {
+		Melder_assert (numberOfCoefficients > 0 && numberOfCoefficients < numberOfFilters);
+		autoSoundToMFCCWorkspace me = Thing_new (SoundToMFCCWorkspace);
+		SampledToSampledWorkspace_init (me.get(), input, output);
+		SoundToBandFilterSpectrogramWorkspace_init (me.get(), windowDuration);
+		SoundToBandFilterSpectrogramWorkspace_initMelFilters (me.get(), numberOfFilters, f1_mel, df_mel);
+		my numberOfCoefficients = numberOfCoefficients;
+		my cosinesTable = MATcosinesTable (numberOfFilters);
+		my dBSpectrum = zero_VEC (numberOfFilters);
+		my cepstrum = zero_VEC (numberOfFilters);
+		return me;
+	} catch (MelderError) {
+		Melder_throw (U"SoundToMFCCWorkspace not created.");
+	}
+}
+
+/* End of file SoundToMFCCWorkspace.cpp */
@@ -0,0 +1,35 @@
+#ifndef _SoundToMFCCWorkspace_h_
+#define _SoundToMFCCWorkspace_h_
+/* SoundToMFCCWorkspace.h
+ *
+ * Copyright (C) 2026 David Weenink
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MFCC.h"
+#include "SoundToBandFilterSpectrogramWorkspace.h"
+
+#include "SoundToMFCCWorkspace_def.h"
+
+/*
+	Workspace for Sound_to_MFCC: the filter bank output of a frame is converted to dB and cosine transformed
+	right away, as MelSpectrogram_to_MFCC would do, so that no MelSpectrogram is needed.
+*/
+
+autoSoundToMFCCWorkspace SoundToMFCCWorkspace_create (constSound input, mutableMFCC output, double windowDuration,
+	integer numberOfFilters, double f1_mel, double df_mel, integer numberOfCoefficients
+);
+
+#endif /* _SoundToMFCCWorkspace_h_ */
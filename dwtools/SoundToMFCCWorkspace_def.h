@@ -0,0 +1,37 @@
+/* SoundToMFCCWorkspace_def.h
+ *
+ * Copyright (C) 2026 David Weenink
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define ooSTRUCT SoundToMFCCWorkspace
+oo_DEFINE_CLASS (SoundToMFCCWorkspace, SoundToBandFilterSpectrogramWorkspace)
+
+	oo_INTEGER (numberOfCoefficients)
+	oo_MAT (cosinesTable, numberOfFilters, numberOfFilters)
+	oo_VEC (dBSpectrum, numberOfFilters)
+	oo_VEC (cepstrum, numberOfFilters)
+
+	#if oo_DECLARING
+
+		void saveOutputFrame () override;
+		void allocateOutputFrames () override;
+
+	#endif
+
+oo_END_CLASS (SoundToMFCCWorkspace)
+#undef ooSTRUCT
+
+/* End of file SoundToMFCCWorkspace_def.h */
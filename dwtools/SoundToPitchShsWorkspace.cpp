@@ -0,0 +1,404 @@
+/* SoundToPitchShsWorkspace.cpp
+ *
+ * Copyright (C) 2026 David Weenink
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SoundToPitchShsWorkspace.h"
+#include "Sound_extensions.h"
+#include "Pitch_extensions.h"
+#include "ReadOnlyCache.h"
+#include <tuple>
+
+#include "oo_DESTROY.h"
+#include "SoundToPitchShsWorkspace_def.h"
+#include "oo_COPY.h"
+#include "SoundToPitchShsWorkspace_def.h"
+#include "oo_EQUAL.h"
+#include "SoundToPitchShsWorkspace_def.h"
+#include "oo_CAN_WRITE_AS_ENCODING.h"
+#include "SoundToPitchShsWorkspace_def.h"
+#include "oo_WRITE_TEXT.h"
+#include "SoundToPitchShsWorkspace_def.h"
+#include "oo_WRITE_BINARY.h"
+#include "SoundToPitchShsWorkspace_def.h"
+#include "oo_READ_TEXT.h"
+#include "SoundToPitchShsWorkspace_def.h"
+#include "oo_READ_BINARY.h"
+#include "SoundToPitchShsWorkspace_def.h"
+#include "oo_DESCRIPTION.h"
+#include "SoundToPitchShsWorkspace_def.h"
+
+Thing_implement (SoundToPitchShsWorkspace, SampledToSampledWorkspace, 0);
+
+/*
+	The tables are stored in std::vectors (1-based, element 0 unused), as ReadOnlyCache requires.
+*/
+struct SoundToPitchShsTables {
+	integer numberOfSpectralValues, numberOfFrequencyPoints;
+	double minimumLog2Frequency, log2FrequencyStep;
+	/*
+		The elimination of the tridiagonal system for the second derivatives of the natural cubic spline
+		through the amplitude spectrum (as in NUMcubicSplineInterpolation_getSecondDerivatives),
+		as far as it depends on the log2 frequencies of the spectrum only.
+	*/
+	std::vector <double> step;   // x [i + 1] - x [i]
+	std::vector <double> span;   // x [i + 1] - x [i - 1]
+	std::vector <double> sig, pivot, backFactor;   // sig, p and (sig - 1) / p
+	/*
+		For each point on the regular log2 frequency scale: the spline segment it lies in
+		and the weights of the segment's end points (as in NUMcubicSplineInterpolation).
+	*/
+	std::vector <integer> lowIndex;
+	std::vector <double> a, b, a3, b3, hSquared;
+	/*
+		The frequency selectivity of the auditory system on the log2 scale,
+		and the shifts of the spectrum for the subharmonics.
+	*/
+	std::vector <double> auditoryWeight;
+	std::vector <integer> harmonicShift;
+};
+
+static std::shared_ptr <const SoundToPitchShsTables> SoundToPitchShsTables_create (integer fftSize, double pitchFloor,
+	double maximumFrequency, integer numberOfPointsPerOctave, integer numberOfHarmonics)
+{
+	std::shared_ptr <SoundToPitchShsTables> me = std::make_shared <SoundToPitchShsTables> ();
+
+	const double samplingFrequency = 2.0 * maximumFrequency;
+	const double df = samplingFrequency / fftSize;
+	const integer n = my numberOfSpectralValues = fftSize / 2 + 1;
+	const double fminl2 = NUMlog2 (pitchFloor), fmaxl2 = NUMlog2 (maximumFrequency);
+	const integer numberOfFrequencyPoints = my numberOfFrequencyPoints = Melder_ifloor ((fmaxl2 - fminl2) * numberOfPointsPerOctave);
+	const double dfl2 = (fmaxl2 - fminl2) / (numberOfFrequencyPoints - 1);
+	my minimumLog2Frequency = fminl2;
+	my log2FrequencyStep = dfl2;
+	/*
+		For the cubic spline interpolation we need the frequencies on an octave
+		scale, i.e., a log2 scale. All frequencies should be DIFFERENT, otherwise
+		the cubic spline interpolation will give corrupt results.
+		Because log2(f==0) is not defined, we use the heuristic: f [2] - f [1] == f [3] - f [2].
+	*/
+	std::vector <double> x (uinteger (n + 1));
+	for (integer i = 2; i <= n; i ++)
+		x [i] = NUMlog2 ((i - 1) * df);
+	x [1] = 2.0 * x [2] - x [3];
+
+	my step. resize (uinteger (n + 1));
+	my span. resize (uinteger (n + 1));
+	my sig. resize (uinteger (n + 1));
+	my pivot. resize (uinteger (n + 1));
+	my backFactor. resize (uinteger (n + 1));
+	for (integer i = 1; i <= n - 1; i ++)
+		my step [i] = x [i + 1] - x [i];
+	my backFactor [1] = 0.0;   // natural spline: zero second derivative at the first point
+	for (integer i = 2; i <= n - 1; i ++) {
+		my span [i] = x [i + 1] - x [i - 1];
+		my sig [i] = (x [i] - x [i - 1]) / my span [i];
+		my pivot [i] = my sig [i] * my backFactor [i - 1] + 2.0;
+		my backFactor [i] = (my sig [i] - 1.0) / my pivot [i];
+	}
+
+	my lowIndex. resize (uinteger (numberOfFrequencyPoints + 1));
+	my a. resize (uinteger (numberOfFrequencyPoints + 1));
+	my b. resize (uinteger (numberOfFrequencyPoints + 1));
+	my a3. resize (uinteger (numberOfFrequencyPoints + 1));
+	my b3. resize (uinteger (numberOfFrequencyPoints + 1));
+	my hSquared. resize (uinteger (numberOfFrequencyPoints + 1));
+	for (integer j = 1; j <= numberOfFrequencyPoints; j ++) {
+		const double f = fminl2 + (j - 1) * dfl2;
+		integer klo = 1, khi = n;
+		while (khi - klo > 1) {
+			const integer k = (khi + klo) >> 1;
+			if (x [k] > f)
+				khi = k;
+			else
+				klo = k;
+		}
+		const double h = x [khi] - x [klo];
+		Melder_assert (h != 0.0);
+		my lowIndex [j] = klo;
+		const double aj = my a [j] = (x [khi] - f) / h;
+		const double bj = my b [j] = (f - x [klo]) / h;
+		my a3 [j] = aj * aj * aj - aj;
+		my b3 [j] = bj * bj * bj - bj;
+		my hSquared [j] = h * h;
+	}
+
+	const double atans = numberOfPointsPerOctave * NUMlog2 (65.0 / 50.0) - 1.0;
+	my auditoryWeight. resize (uinteger (numberOfFrequencyPoints + 1));
+	for (integer i = 1; i <= numberOfFrequencyPoints; i ++)
+		my auditoryWeight [i] = 0.5 + atan (3.0 * (i - atans) / numberOfPointsPerOctave) / NUMpi;
+
+	my harmonicShift. resize (uinteger (numberOfHarmonics + 1));
+	for (integer m = 1; m <= numberOfHarmonics; m ++)
+		my harmonicShift [m] = Melder_ifloor (numberOfPointsPerOctave * NUMlog2 (m));
+	return me;
+}
+
+/*
+	The tables depend on the analysis parameters only, so they are shared between threads and analyses.
+	Each set of tables has size 1 in the cache, so the eight most recently used sets are kept.
+*/
+static ReadOnlyCache <std::tuple <integer, double, double, integer, integer>, SoundToPitchShsTables> theTablesCache (8);
+
+static std::shared_ptr <const SoundToPitchShsTables> SoundToPitchShsTables_get (integer fftSize, double pitchFloor,
+	double maximumFrequency, integer numberOfPointsPerOctave, integer numberOfHarmonics)
+{
+	return theTablesCache.get (std::make_tuple (fftSize, pitchFloor, maximumFrequency, numberOfPointsPerOctave, numberOfHarmonics), 1,
+		[=] () {
+			return SoundToPitchShsTables_create (fftSize, pitchFloor, maximumFrequency, numberOfPointsPerOctave, numberOfHarmonics);
+		}
+	);
+}
+
+static double Sound_approximateLocalSampleMean (constSound me, double fromTime, double toTime) {
+	const integer n1 = Melder_clippedLeft (1_integer, Sampled_xToNearestIndex (me, fromTime));
+	const integer n2 = Melder_clippedRight (Sampled_xToNearestIndex (me, toTime), my nx);
+	return n1 <= n2 ? NUMmean (my z [1].part (n1, n2)) : undefined;
+}
+
+static void spec_enhance_SHS (VEC const& a, INTVEC const& posmax) {
+	Melder_assert (a.size >= 2);
+	Melder_assert (posmax.size >= (a.size + 1) / 2);
+
+	integer nmax = 0;
+	if (a [1] > a [2])
+		posmax [++ nmax] = 1;
+
+	for (integer i = 2; i <= a.size - 1; i ++)
+		if (a [i] > a [i - 1] && a [i] >= a [i + 1])
+			posmax [++ nmax] = i;
+
+	if (a [a.size] > a [a.size - 1])
+		posmax [++ nmax] = a.size;
+
+	if (nmax == 1) {
+		a.part (1, posmax [1] - 3)  <<=  0.0;
+		a.part (posmax [1] + 3, a.size)  <<=  0.0;
+	} else {
+		for (integer i = 2; i <= nmax; i ++)
+			a.part (posmax [i - 1] + 3, posmax [i] - 3)  <<=  0.0;
+	}
+}
+
+static void spec_smoooth_SHS (VEC const& a) {
+	/*
+		Convolve in-place with the small symmetric moving-average
+		kernel { 0.25, 0.5, 0.25 }, aligned around its second element.
+		The basic equation for an output element a_new [i] is:
+			a_new [i] := 0.25 * (a [i - 1] + 2.0 * a [i] + a [i + 1])
+
+		The procedure is performed in place, i.e., the vector a_new []
+		appears as the new version of the vector a [], so that care has
+		to be taken to timely save elements that will be overwritten.
+		At the edges we perform "same" convolution, meaning that
+		the output vector has the same number of elements as the
+		input vector (this is a natural situation in case of in-place
+		filtering). The elements just beyond the edges of the vector,
+		namely a [0] and a [a.size + 1], are assumed to be zero.
+	*/
+	double a_i_minus_1 = 0.0;   // save a [i - 1], for i == 1
+	for (integer i = 1; i <= a.size - 1; i ++) {
+		const double a_i = a [i];   // save a [i]
+		a [i] = 0.25 * (a_i_minus_1 + 2.0 * a_i + a [i + 1]);
+		a_i_minus_1 = a_i;
+	}
+	a [a.size] = 0.25 * (a_i_minus_1 + 2.0 * a [a.size]);
+}
+
+void structSoundToPitchShsWorkspace :: getInputFrame () {
+	/*
+		Copy a frame from the sound, apply a Hamming window. Get the local 'intensity'.
+	*/
+	constSound sound = reinterpret_cast<constSound> (input);
+	const double tmid = Sampled_indexToX (output, currentFrame);
+	const integer index = Sampled_xToNearestIndex (input, tmid - halfWindow);
+	for (integer i = 1; i <= windowSize; i ++) {
+		const integer j = index - 1 + i;
+		fftData [i] = ( j < 1 || j > sound -> nx ? 0.0 : sound -> z [1] [j] ) * window [i];
+	}
+	fftData.part (windowSize + 1, fftSize)  <<=  0.0;
+	const double localMean = Sound_approximateLocalSampleMean (sound, tmid - 3.0 * halfWindow, tmid + 3.0 * halfWindow);
+	const double localPeak = Sound_localPeak (sound, tmid - halfWindow, tmid + halfWindow, localMean);
+	intensity = ( localPeak > globalPeak ? 1.0 : localPeak / globalPeak );
+}
+
+bool structSoundToPitchShsWorkspace :: inputFrameToOutputFrame () {
+	const SoundToPitchShsTables & table = *tables;
+	/*
+		From the complex spectrum (scaled as in Sound_to_Spectrum) to the amplitude spectrum.
+	*/
+	NUMfft_forward (& fftTable, fftData.get());
+	const integer n = numberOfSpectralValues;
+	amplitudeSpectrum [1] = hypot (fftData [1] * samplingPeriod, 0.0);
+	for (integer i = 2; i < n; i ++)
+		amplitudeSpectrum [i] = hypot (fftData [i + i - 2] * samplingPeriod, fftData [i + i - 1] * samplingPeriod);
+	amplitudeSpectrum [n] = hypot (fftData [fftSize] * samplingPeriod, 0.0);
+	/*
+		Enhance the peaks in the spectrum, and smooth the enhanced spectrum.
+	*/
+	spec_enhance_SHS (amplitudeSpectrum.get(), peakPositions.get());
+	spec_smoooth_SHS (amplitudeSpectrum.get());
+	/*
+		Go to a logarithmic scale and perform cubic spline interpolation to get
+		spectral values for the increased number of frequency points.
+		Only the parts of the spline computation that depend on the amplitudes are left.
+	*/
+	const constVEC y = amplitudeSpectrum.get();
+	const VEC u = splineWork.get(), y2 = secondDerivatives.get();
+	u [1] = 0.0;
+	for (integer i = 2; i <= n - 1; i ++) {
+		const double d = (y [i + 1] - y [i]) / table.step [i] - (y [i] - y [i - 1]) / table.step [i - 1];
+		u [i] = (6.0 * d / table.span [i] - table.sig [i] * u [i - 1]) / table.pivot [i];
+	}
+	y2 [n] = 0.0;
+	for (integer k = n - 1; k >= 1; k --)
+		y2 [k] = table.backFactor [k] * y2 [k + 1] + u [k];
+	/*
+		Interpolate, and multiply by the frequency selectivity of the auditory system.
+	*/
+	for (integer j = 1; j <= numberOfFrequencyPoints; j ++) {
+		const integer klo = table.lowIndex [j], khi = klo + 1;
+		const double value = table.a [j] * y [klo] + table.b [j] * y [khi] +
+				(table.a3 [j] * y2 [klo] + table.b3 [j] * y2 [khi]) * table.hSquared [j] / 6.0;
+		logSpectrum [j] = ( value > 0.0 ? value * table.auditoryWeight [j] : 0.0 );
+	}
+	/*
+		The subharmonic summation. Shift spectra in octaves and sum.
+	*/
+	subharmonicSum.all()  <<=  0.0;
+	for (integer m = 1; m <= numberOfHarmonics; m ++) {
+		const integer shift = table.harmonicShift [m];
+		const integer numberOfTerms = numberOfFrequencyPoints - shift;
+		if (numberOfTerms <= 0)
+			break;   // the shifts only increase
+		const double weight = harmonicWeights [m];
+		double *sum = & subharmonicSum [1];
+		const double *shifted = & logSpectrum [1 + shift];
+		for (integer k = 0; k < numberOfTerms; k ++)
+			sum [k] += shifted [k] * weight;
+	}
+	return true;
+}
+
+void structSoundToPitchShsWorkspace :: saveOutputFrame () {
+	Pitch thee = reinterpret_cast<Pitch> (output);
+	constSound sound = reinterpret_cast<constSound> (input);
+	const Pitch_Frame pitchFrame = & thy frames [currentFrame];
+	const double tmid = Sampled_indexToX (output, currentFrame);
+	pitchFrame -> intensity = intensity;
+	Pitch_Frame_init (pitchFrame, maximumNumberOfCandidates);
+	pitchFrame -> candidates. resize (pitchFrame -> nCandidates = 0);   // !!!!!
+	/*
+		First register the voiceless candidate (always present).
+	*/
+	Pitch_Frame_addPitch (pitchFrame, 0.0, 0.0, maximumNumberOfCandidates);
+	/*
+		Get the best local estimates for the pitch as the maxima of the
+		subharmonic sum spectrum by parabolic interpolation on three points:
+		The formula for a parabola with a maximum is:
+			y(x) = a - b (x - c)^2 with a, b, c >= 0
+		The three points are (-x, y1), (0, y2) and (x, y3).
+		The solution for a (the maximum) and c (the position) is:
+		a = (2 y1 (4 y2 + y3) - y1^2 - (y3 - 4 y2)^2)/( 8 (y1 - 2 y2 + y3)
+		c = dx (y1 - y3) / (2 (y1 - 2 y2 + y3))
+		(b = (2 y2 - y1 - y3) / (2 dx^2) )
+	*/
+	for (integer k = 2; k <= numberOfFrequencyPoints - 1; k ++) {
+		const double y1 = subharmonicSum [k - 1], y2 = subharmonicSum [k], y3 = subharmonicSum [k + 1];
+		if (y2 > y1 && y2 >= y3) {
+			const double denum = y1 - 2.0 * y2 + y3, tmp = y3 - 4.0 * y2;
+			const double x = log2FrequencyStep * (y1 - y3) / (2.0 * denum);
+			const double f = pow (2.0, minimumLog2Frequency + (k - 1) * log2FrequencyStep + x);
+			const double strength = (2.0 * y1 * (4.0 * y2 + y3) - y1 * y1 - tmp * tmp) / (8.0 * denum);
+			Pitch_Frame_addPitch (pitchFrame, f, strength, maximumNumberOfCandidates);
+		}
+	}
+	/*
+		Check whether f0 corresponds to an actual periodicity T = 1 / f0:
+		correlate two signal periods of duration T, one starting at the
+		middle of the interval and one starting T seconds before.
+		If there is periodicity the correlation coefficient should be high.
+
+		However, some sounds do not show any regularity, or very low
+		frequency and regularity, and nevertheless have a definite
+		pitch, e.g. Shepard sounds.
+	*/
+	double pitch_strength, f0;
+	Pitch_Frame_getPitch (pitchFrame, & f0, & pitch_strength);
+	const double correlation = ( f0 > 0.0 ? Sound_correlateParts (sound, tmid - 1.0 / f0, tmid, 1.0 / f0) : 0.0 );
+	/*
+		Base V/UV decision on the correlation coefficient.
+		Resize the pitch strengths w.r.t. the correlation.
+	*/
+	constexpr double vuvCriterion = 0.52;
+	Pitch_Frame_resizeStrengths (pitchFrame, correlation, vuvCriterion);
+}
+
+autoSoundToPitchShsWorkspace SoundToPitchShsWorkspace_create (constSound input, mutablePitch output,
+	double windowDuration, double pitchFloor, double maximumFrequency, integer maxnSubharmonics,
+	integer maxnCandidates, double compressionFactor, integer numberOfPointsPerOctave)
+{
+	try {
+		autoSoundToPitchShsWorkspace me = Thing_new (SoundToPitchShsWorkspace);
+		SampledToSampledWorkspace_init (me.get(), input, output);
+		const double samplingFrequency = 2.0 * maximumFrequency;
+		/*
+			Number of speech samples in the downsampled signal in each frame:
+			100 for windowDuration == 0.04 and samplingFrequency == 2500
+		*/
+		const integer numberOfSamples = Melder_iround (windowDuration * samplingFrequency);
+		const double frameDuration = numberOfSamples / samplingFrequency;
+		my halfWindow = 0.5 * windowDuration;
+		my samplingPeriod = 1.0 / samplingFrequency;
+		autoSound hamming = Sound_createHamming (frameDuration, samplingFrequency);
+		Melder_assert (hamming -> nx == numberOfSamples);
+		my windowSize = numberOfSamples;
+		my window = copy_VEC (hamming -> z.row (1));
+		my fftSize = Melder_clippedLeft (256_integer /* the minimum number of points for the FFT */, Melder_iroundUpToPowerOfTwo (numberOfSamples));
+		my fftData = zero_VEC (my fftSize);
+		NUMfft_Table_init (& my fftTable, my fftSize);
+		my numberOfSpectralValues = my fftSize / 2 + 1;
+		my amplitudeSpectrum = zero_VEC (my numberOfSpectralValues);
+		my secondDerivatives = zero_VEC (my numberOfSpectralValues);
+		my splineWork = zero_VEC (my numberOfSpectralValues);
+		my peakPositions = zero_INTVEC (my numberOfSpectralValues);
+
+		my numberOfHarmonics = maxnSubharmonics + 1;
+		my tables = SoundToPitchShsTables_get (my fftSize, pitchFloor, maximumFrequency, numberOfPointsPerOctave, my numberOfHarmonics);
+		my numberOfFrequencyPoints = my tables -> numberOfFrequencyPoints;
+		my minimumLog2Frequency = my tables -> minimumLog2Frequency;
+		my log2FrequencyStep = my tables -> log2FrequencyStep;
+		my logSpectrum = zero_VEC (my numberOfFrequencyPoints);
+		my subharmonicSum = zero_VEC (my numberOfFrequencyPoints);
+		my harmonicWeights = raw_VEC (my numberOfHarmonics);
+		double hm = 1.0;
+		for (integer m = 1; m <= my numberOfHarmonics; m ++) {
+			my harmonicWeights [m] = hm;
+			hm *= compressionFactor;
+		}
+		my maximumNumberOfCandidates = maxnCandidates;
+		/*
+			The absolute value of the globally largest amplitude w.r.t. the global mean.
+		*/
+		const double globalMean = Sound_approximateLocalSampleMean (input, input -> xmin, input -> xmax);
+		my globalPeak = Sound_localPeak (input, input -> xmin, input -> xmax, globalMean);
+		return me;
+	} catch (MelderError) {
+		Melder_throw (U"SoundToPitchShsWorkspace not created.");
+	}
+}
+
+/* End of file SoundToPitchShsWorkspace.cpp */
@@ -0,0 +1,45 @@
+#ifndef _SoundToPitchShsWorkspace_h_
+#define _SoundToPitchShsWorkspace_h_
+/* SoundToPitchShsWorkspace.h
+ *
+ * Copyright (C) 2026 David Weenink
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Sound.h"
+#include "Pitch.h"
+#include "NUM2.h"
+#include "SampledToSampledWorkspace.h"
+#include <memory>
+
+struct SoundToPitchShsTables;
+
+#include "SoundToPitchShsWorkspace_def.h"
+
+/*
+	Workspace for Sound_to_Pitch_shs (Hermes 1988). The input is the Sound, already resampled
+	to twice the maximum frequency; the output is the Pitch.
+	The frequencies of the spectrum on the log2 scale, the positions and weights of the cubic spline
+	interpolation onto the regular log2 frequency grid, the auditory weighting and the shifts
+	of the subharmonics only depend on the analysis parameters. They are computed once and kept in a
+	small cache, so that they are shared by all frames and by later analyses with the same parameters.
+*/
+
+autoSoundToPitchShsWorkspace SoundToPitchShsWorkspace_create (constSound input, mutablePitch output,
+	double windowDuration, double pitchFloor, double maximumFrequency, integer maxnSubharmonics,
+	integer maxnCandidates, double compressionFactor, integer numberOfPointsPerOctave
+);
+
+#endif /* _SoundToPitchShsWorkspace_h_ */
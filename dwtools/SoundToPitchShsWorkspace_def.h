@@ -0,0 +1,70 @@
+/* SoundToPitchShsWorkspace_def.h
+ *
+ * Copyright (C) 2026 David Weenink
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define ooSTRUCT SoundToPitchShsWorkspace
+oo_DEFINE_CLASS (SoundToPitchShsWorkspace, SampledToSampledWorkspace)
+
+	oo_DOUBLE (halfWindow)
+	oo_DOUBLE (samplingPeriod)							// of the analysis frame
+	oo_INTEGER (windowSize)								// the number of samples in the analysis frame
+	oo_VEC (window, windowSize)							// Hamming
+	oo_INTEGER (fftSize)								// a power of two, at least 256 and at least windowSize
+	oo_VEC (fftData, fftSize)
+	oo_INTEGER (numberOfSpectralValues)					// fftSize / 2 + 1
+	oo_VEC (amplitudeSpectrum, numberOfSpectralValues)
+	oo_VEC (secondDerivatives, numberOfSpectralValues)	// of the cubic spline through the amplitude spectrum
+	oo_VEC (splineWork, numberOfSpectralValues)
+	oo_INTVEC (peakPositions, numberOfSpectralValues)
+	oo_INTEGER (numberOfFrequencyPoints)				// on the log2 frequency scale
+	oo_DOUBLE (minimumLog2Frequency)
+	oo_DOUBLE (log2FrequencyStep)
+	oo_VEC (logSpectrum, numberOfFrequencyPoints)
+	oo_VEC (subharmonicSum, numberOfFrequencyPoints)
+	oo_INTEGER (numberOfHarmonics)						// maximum number of subharmonics + 1
+	oo_VEC (harmonicWeights, numberOfHarmonics)			// powers of the compression factor
+	oo_INTEGER (maximumNumberOfCandidates)
+	oo_DOUBLE (globalPeak)
+	oo_DOUBLE (intensity)								// of the current frame, relative to the global peak
+
+	#if oo_DECLARING
+
+		/*
+			The interpolation tables only depend on the analysis parameters; they are shared
+			(read-only) by all the threads and are not part of the persistent data.
+			Each thread needs its own FFT table.
+		*/
+		std::shared_ptr <const SoundToPitchShsTables> tables;
+		autoNUMfft_Table fftTable;
+
+		void getInputFrame () override;
+		bool inputFrameToOutputFrame () override;
+		void saveOutputFrame () override;
+
+	#endif
+
+	#if oo_COPYING
+
+		thy tables = tables;
+		NUMfft_Table_init (& thy fftTable, thy fftSize);
+
+	#endif
+
+oo_END_CLASS (SoundToPitchShsWorkspace)
+#undef ooSTRUCT
+
+/* End of file SoundToPitchShsWorkspace_def.h */
@@ -0,0 +1,139 @@
+/* SoundToSpectrogramWorkspace.cpp
+ *
+ * Copyright (C) 2024 David Weenink
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SoundToSpectrogramWorkspace.h"
+
+#include "oo_DESTROY.h"
+#include "SoundToSpectrogramWorkspace_def.h"
+#include "oo_COPY.h"
+#include "SoundToSpectrogramWorkspace_def.h"
+#include "oo_EQUAL.h"
+#include "SoundToSpectrogramWorkspace_def.h"
+#include "oo_CAN_WRITE_AS_ENCODING.h"
+#include "SoundToSpectrogramWorkspace_def.h"
+#include "oo_WRITE_TEXT.h"
+#include "SoundToSpectrogramWorkspace_def.h"
+#include "oo_WRITE_BINARY.h"
+#include "SoundToSpectrogramWorkspace_def.h"
+#include "oo_READ_TEXT.h"
+#include "SoundToSpectrogramWorkspace_def.h"
+#include "oo_READ_BINARY.h"
+#include "SoundToSpectrogramWorkspace_def.h"
+#include "oo_DESCRIPTION.h"
+#include "SoundToSpectrogramWorkspace_def.h"
+
+Thing_implement (SoundToSpectrogramWorkspace, SampledToSampledWorkspace, 0);
+
+void structSoundToSpectrogramWorkspace :: getInputFrame () {
+	/*
+		The channels are windowed one by one in inputFrameToOutputFrame.
+	*/
+	return;
+}
+
+bool structSoundToSpectrogramWorkspace :: inputFrameToOutputFrame () {
+	constSound sound = reinterpret_cast<constSound> (input);
+	const double t = Sampled_indexToX (output, currentFrame);
+	const integer leftSample = Sampled_xToLowIndex (input, t), rightSample = leftSample + 1;
+	const integer startSample = rightSample - halfWindowSize;
+	const integer endSample = leftSample + halfWindowSize;
+	Melder_assert (startSample >= 1);
+	Melder_assert (endSample <= input -> nx);
+
+	powerSpectrum.all()  <<=  0.0;
+	/*
+		For multichannel sounds, the power spectrogram should represent the
+		average power in the channels,
+		so that the result for a stereo sound in which the
+		left channel has the same waveform as the right channel,
+		is identical to the result for the corresponding mono (= averaged) sound.
+		Averaging starts by adding up the powers of the channels.
+	*/
+	const integer half_fftSize = fftSize / 2;
+	for (integer channel = 1; channel <= sound -> ny; channel ++) {
+		for (integer j = 1, i = startSample; j <= windowSize; j ++)
+			fftData [j] = sound -> z [channel] [i ++] * window [j];
+		for (integer j = windowSize + 1; j <= fftSize; j ++)
+			fftData [j] = 0.0;
+
+		NUMfft_forward (& fftTable, fftData.get());   // fftData := complex spectrum
+		/*
+			Convert from complex to power spectrum,
+			accumulating the power spectra of the channels.
+		*/
+		powerSpectrum [1] += fftData [1] * fftData [1];   // DC component
+		for (integer i = 2; i <= half_fftSize; i ++)
+			powerSpectrum [i] += fftData [i + i - 2] * fftData [i + i - 2] + fftData [i + i - 1] * fftData [i + i - 1];
+		powerSpectrum [half_fftSize + 1] += fftData [fftSize] * fftData [fftSize];   // Nyquist frequency. Correct??
+	}
+	/*
+		Power averaging ends by dividing the summed power by the number of channels.
+	*/
+	if (sound -> ny > 1)
+		powerSpectrum.all()  /=  sound -> ny;
+	return true;
+}
+
+void structSoundToSpectrogramWorkspace :: saveOutputFrame () {
+	Spectrogram thee = reinterpret_cast<Spectrogram> (output);
+	for (integer iband = 1; iband <= thy ny; iband ++) {
+		const integer lowerSample = (iband - 1) * binWidth_samples + 1;
+		const integer higherSample = lowerSample + binWidth_samples;
+		const double power = NUMsum (powerSpectrum.part (lowerSample, higherSample - 1));
+		thy z [iband] [currentFrame] = power * oneByBinWidth;
+	}
+}
+
+void SoundToSpectrogramWorkspace_init (SoundToSpectrogramWorkspace me,
+	constVEC const& window, integer fftSize, integer binWidth_samples, double oneByBinWidth)
+{
+	Melder_assert (window.size % 2 == 0);
+	Melder_assert (fftSize >= window.size);
+	my windowSize = window.size;
+	my halfWindowSize = my windowSize / 2;
+	my window = copy_VEC (window);
+	my fftSize = fftSize;
+	my fftData = zero_VEC (my fftSize);
+	my numberOfPowerValues = my fftSize / 2 + 1;
+	my powerSpectrum = zero_VEC (my numberOfPowerValues);
+	my binWidth_samples = binWidth_samples;
+	my oneByBinWidth = oneByBinWidth;
+	NUMfft_Table_init (& my fftTable, my fftSize);
+}
+
+autoSoundToSpectrogramWorkspace SoundToSpectrogramWorkspace_createSkeleton (constSound input, mutableSpectrogram output) {
+	autoSoundToSpectrogramWorkspace me = Thing_new (SoundToSpectrogramWorkspace);
+	SampledToSampledWorkspace_init (me.get(), input, output);
+	return me;
+}
+
+autoSoundToSpectrogramWorkspace SoundToSpectrogramWorkspace_create (constSound input, mutableSpectrogram output,
+	constVEC const& window, integer fftSize, integer binWidth_samples, double oneByBinWidth)
+{
+	try {
+		Sampled_assertEqualDomains (input, output);
+		Melder_assert (output -> ny * binWidth_samples <= fftSize / 2 + 1);
+		autoSoundToSpectrogramWorkspace me = SoundToSpectrogramWorkspace_createSkeleton (input, output);
+		SoundToSpectrogramWorkspace_init (me.get(), window, fftSize, binWidth_samples, oneByBinWidth);
+		return me;
+	} catch (MelderError) {
+		Melder_throw (U"SoundToSpectrogramWorkspace not created.");
+	}
+}
+
+/* End of file SoundToSpectrogramWorkspace.cpp */
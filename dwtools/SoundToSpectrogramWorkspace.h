@@ -0,0 +1,45 @@
+#ifndef _SoundToSpectrogramWorkspace_h_
+#define _SoundToSpectrogramWorkspace_h_
+/* SoundToSpectrogramWorkspace.h
+ *
+ * Copyright (C) 2024 David Weenink
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Sound.h"
+#include "Spectrogram.h"
+#include "NUM2.h"
+#include "SampledToSampledWorkspace.h"
+
+#include "SoundToSpectrogramWorkspace_def.h"
+
+/*
+	Workspace for the frame-by-frame power spectrogram analysis of Sound_to_Spectrogram.
+	The output Spectrogram determines the frame times and the number of frequency bands;
+	the window (of even size), the FFT size and the binning are determined by the caller,
+	so that the threaded analysis gives exactly the same results as a single-threaded one.
+*/
+
+void SoundToSpectrogramWorkspace_init (SoundToSpectrogramWorkspace me,
+	constVEC const& window, integer fftSize, integer binWidth_samples, double oneByBinWidth
+);
+
+autoSoundToSpectrogramWorkspace SoundToSpectrogramWorkspace_createSkeleton (constSound input, mutableSpectrogram output);
+
+autoSoundToSpectrogramWorkspace SoundToSpectrogramWorkspace_create (constSound input, mutableSpectrogram output,
+	constVEC const& window, integer fftSize, integer binWidth_samples, double oneByBinWidth
+);
+
+#endif /* _SoundToSpectrogramWorkspace_h_ */
@@ -0,0 +1,55 @@
+/* SoundToSpectrogramWorkspace_def.h
+ *
+ * Copyright (C) 2024 David Weenink
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define ooSTRUCT SoundToSpectrogramWorkspace
+oo_DEFINE_CLASS (SoundToSpectrogramWorkspace, SampledToSampledWorkspace)
+
+	oo_INTEGER (halfWindowSize)					// windowSize = 2 * halfWindowSize
+	oo_INTEGER (windowSize)
+	oo_VEC (window, windowSize)
+	oo_INTEGER (fftSize)						// a power of two, at least windowSize
+	oo_VEC (fftData, fftSize)
+	oo_INTEGER (numberOfPowerValues)			// fftSize / 2 + 1
+	oo_VEC (powerSpectrum, numberOfPowerValues)	// averaged over the channels
+	oo_INTEGER (binWidth_samples)
+	oo_DOUBLE (oneByBinWidth)					// 1 / (sum of squared window values * binWidth_samples)
+
+	#if oo_DECLARING
+
+		/*
+			Each thread needs its own FFT table;
+			it is not part of the persistent data because it can always be recomputed from the fftSize.
+		*/
+		autoNUMfft_Table fftTable;
+
+		void getInputFrame () override;
+		bool inputFrameToOutputFrame () override;
+		void saveOutputFrame () override;
+
+	#endif
+
+	#if oo_COPYING
+
+		NUMfft_Table_init (& thy fftTable, thy fftSize);
+
+	#endif
+
+oo_END_CLASS (SoundToSpectrogramWorkspace)
+#undef ooSTRUCT
+
+/* End of file SoundToSpectrogramWorkspace_def.h */
@@ -31,6 +31,7 @@
 #include "Sound_to_Pitch.h"
 #include "Vector.h"
 #include "NUM2.h"
+#include "SoundToBandFilterSpectrogramWorkspace.h"
 
 autoSound BandFilterSpectrogram_as_Sound (BandFilterSpectrogram me, int to_dB);
 
@@ -43,7 +44,7 @@ autoSound BandFilterSpectrogram_as_Sound (BandFilterSpectrogram me, int to_dB);
 	where erf(x) = 1 - erfc(x) and n is the windowLength in samples.
 	To compare with the rectangular window we need to divide this by the window width (n -1) x 1^2.
 */
-static void _Spectrogram_windowCorrection (Spectrogram me, integer numberOfSamples_window) {
+double Spectrogram_getGaussianWindowCorrection (integer numberOfSamples_window) {
 	double windowFactor = 1.0;
 	if (numberOfSamples_window > 1) {
 		const double e12 = exp (-12);
@@ -54,7 +55,11 @@ static void _Spectrogram_windowCorrection (Spectrogram me, integer numberOfSampl
 		const double p1 = 4 * NUMsqrtpi * NUMsqrt3 * e12 * (1 - NUMerfcc (arg1)) * (numberOfSamples_window + 1);
 		windowFactor =  (p2 - p1 + 24 * (numberOfSamples_window - 1) * e12 * e12) / denum;
 	}
-	my z.get()  /=  windowFactor;
+	return windowFactor;
+}
+
+static void _Spectrogram_windowCorrection (Spectrogram me, integer numberOfSamples_window) {
+	my z.get()  /=  Spectrogram_getGaussianWindowCorrection (numberOfSamples_window);
 }
 
 static autoSpectrum Sound_to_Spectrum_power (Sound me) {
@@ -83,33 +88,6 @@ static autoSpectrum Sound_to_Spectrum_power (Sound me) {
 	}
 }
 
-static void Sound_into_BarkSpectrogram_frame (Sound me, BarkSpectrogram thee, integer frame) {
-	autoSpectrum him = Sound_to_Spectrum_power (me);
-	integer numberOfFrequencies = his nx;
-
-	autoVEC z = raw_VEC (numberOfFrequencies);
-	for (integer ifreq = 1; ifreq <= numberOfFrequencies; ifreq ++) {
-		const double frequency_Hz = his x1 + (ifreq - 1) * his dx;
-		z [ifreq] = thy v_hertzToFrequency (frequency_Hz);
-	}
-
-	for (integer i = 1; i <= thy ny; i ++) {
-		const double z0 = thy y1 + (i - 1) * thy dy;
-		constVEC pow = his z.row (1); // TODO ??
-		longdouble p = 0.0;
-		for (integer ifreq = 1; ifreq <= numberOfFrequencies; ifreq ++) {
-			/*
-				Sekey & Hanson filter is defined in the power domain.
-				We therefore multiply the power with a (and not a^2).
-				integral (F(z),z=0..25) = 1.58/9
-			*/
-			const double a = NUMsekeyhansonfilter_amplitude (z0, z [ifreq]);
-			p += a * pow [ifreq] ;
-		}
-		thy z [i] [frame] = double (p);
-	}
-}
-
 autoBarkSpectrogram Sound_to_BarkSpectrogram (Sound me, double analysisWidth, double dt, double f1_bark, double fmax_bark, double df_bark) {
 	try {
 		const double samplingFrequency = 1.0 / my dx, nyquist = 0.5 * samplingFrequency;
@@ -134,101 +112,61 @@ autoBarkSpectrogram Sound_to_BarkSpectrogram (Sound me, double analysisWidth, do
 		integer numberOfFrames;
 		double t1;
 		Sampled_shortTermAnalysis (me, windowDuration, dt, & numberOfFrames, & t1);
-		autoSound sframe = Sound_createSimple (1, windowDuration, samplingFrequency);
-		autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
 		autoBarkSpectrogram thee = BarkSpectrogram_create (my xmin, my xmax, numberOfFrames, dt, t1, fmin_bark, fmax_bark, numberOfFilters, df_bark, f1_bark);
-
-		autoMelderProgress progess (U"BarkSpectrogram analysis");
-
-		for (integer iframe = 1; iframe <= numberOfFrames; iframe ++) {
-			const double t = Sampled_indexToX (thee.get(), iframe);
-
-			Sound_into_Sound (me, sframe.get(), t - windowDuration / 2.0);
-			Sounds_multiply (sframe.get(), window.get());
-			Sound_into_BarkSpectrogram_frame (sframe.get(), thee.get(), iframe);
-
-			if (iframe % 10 == 1)
-				Melder_progress ( (double) iframe / numberOfFrames,  U"BarkSpectrogram analysis: frame ",
-					iframe, U" from ", numberOfFrames, U".");
-		}
-		
-		_Spectrogram_windowCorrection ((Spectrogram) thee.get(), window -> nx);
-
+		/*
+			The frames are analysed independently of each other, possibly in parallel.
+		*/
+		autoSoundToBandFilterSpectrogramWorkspace ws = SoundToBandFilterSpectrogramWorkspace_create (me, thee.get(), windowDuration);
+		SoundToBandFilterSpectrogramWorkspace_initBarkFilters (ws.get(), numberOfFilters, f1_bark, df_bark);
+		SampledToSampledWorkspace_analyseThreaded (ws.get());
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": no BarkSpectrogram created.");
 	}
 }
 
-static void Sound_into_MelSpectrogram_frame (Sound me, MelSpectrogram thee, integer frame) {
-	autoSpectrum him = Sound_to_Spectrum_power (me);
+integer Sound_getMelFilterbankParameters (Sound me, double *inout_f1_mel, double *inout_fmax_mel, double *inout_df_mel) {
+	const double samplingFrequency = 1.0 / my dx, nyquist = 0.5 * samplingFrequency;
+	const double fbottom = NUMhertzToMel2 (100.0), fceiling = NUMhertzToMel2 (nyquist);
+	double f1_mel = *inout_f1_mel, fmax_mel = *inout_fmax_mel, df_mel = *inout_df_mel;
 
-	for (integer ifilter = 1; ifilter <= thy ny; ifilter ++) {
-		longdouble power = 0.0;
-		const double fc_mel = thy y1 + (ifilter - 1) * thy dy;
-		const double fc_hz = thy v_frequencyToHertz (fc_mel);
-		const double fl_hz = thy v_frequencyToHertz (std::max (fc_mel - thy dy, 0.0));
-		const double fh_hz =  thy v_frequencyToHertz (std::min (fc_mel + thy dy, his xmax));
-		integer ifrom, ito;
-		Sampled_getWindowSamples (him.get(), fl_hz, fh_hz, & ifrom, & ito);
-		for (integer i = ifrom; i <= ito; i ++) {
-			/*
-				Bin with a triangular filter the power (= amplitude-squared)
-			*/
-			const double f = his x1 + (i - 1) * his dx;
-			const double a = NUMtriangularfilter_amplitude (fl_hz, fc_hz, fh_hz, f);
-			power += a * his z [1] [i];
-		}
-		thy z [ifilter] [frame] = double (power);
+	// Check defaults.
+
+	if (fmax_mel <= 0.0 || fmax_mel > fceiling)
+		fmax_mel = fceiling;
+	if (fmax_mel <= f1_mel) {
+		f1_mel = fbottom;
+		fmax_mel = fceiling;
 	}
+	if (f1_mel <= 0.0)
+		f1_mel = fbottom;
+	if (df_mel <= 0.0)
+		df_mel = 100.0;
+	*inout_f1_mel = f1_mel;
+	*inout_fmax_mel = fmax_mel;
+	*inout_df_mel = df_mel;
+
+	// Determine the number of filters.
+
+	return Melder_iround ((fmax_mel - f1_mel) / df_mel);
 }
 
 autoMelSpectrogram Sound_to_MelSpectrogram (Sound me, double analysisWidth, double dt, double f1_mel, double fmax_mel, double df_mel) {
 	try {
-		const double samplingFrequency = 1.0 / my dx, nyquist = 0.5 * samplingFrequency;
 		const double windowDuration = 2.0 * analysisWidth;   // Gaussian window
-		double fmin_mel = 0.0;
-		const double fbottom = NUMhertzToMel2 (100.0), fceiling = NUMhertzToMel2 (nyquist);
-
-		// Check defaults.
-
-		if (fmax_mel <= 0.0 || fmax_mel > fceiling)
-			fmax_mel = fceiling;
-		if (fmax_mel <= f1_mel) {
-			f1_mel = fbottom;
-			fmax_mel = fceiling;
-		}
-		if (f1_mel <= 0.0)
-			f1_mel = fbottom;
-		if (df_mel <= 0.0)
-			df_mel = 100.0;
-
-		// Determine the number of filters.
-
-		const integer numberOfFilters = Melder_iround ((fmax_mel - f1_mel) / df_mel);
-
+		const double fmin_mel = 0.0;
+		const integer numberOfFilters = Sound_getMelFilterbankParameters (me, & f1_mel, & fmax_mel, & df_mel);
 
 		integer numberOfFrames;
 		double t1;
 		Sampled_shortTermAnalysis (me, windowDuration, dt, & numberOfFrames, & t1);
-		autoSound sframe = Sound_createSimple (1, windowDuration, samplingFrequency);
-		autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
 		autoMelSpectrogram thee = MelSpectrogram_create (my xmin, my xmax, numberOfFrames, dt, t1, fmin_mel, fmax_mel, numberOfFilters, df_mel, f1_mel);
-
-		autoMelderProgress progress (U"MelSpectrogram analysis");
-
-		for (integer iframe = 1; iframe <= numberOfFrames; iframe ++) {
-			const double t = Sampled_indexToX (thee.get(), iframe);
-			Sound_into_Sound (me, sframe.get(), t - windowDuration / 2.0);
-			Sounds_multiply (sframe.get(), window.get());
-			Sound_into_MelSpectrogram_frame (sframe.get(), thee.get(), iframe);
-			
-			if (iframe % 10 == 1)
-				Melder_progress ((double) iframe / numberOfFrames, U"Frame ", iframe, U" out of ", numberOfFrames, U".");
-		}
-		
-		_Spectrogram_windowCorrection ((Spectrogram) thee.get(), window -> nx);
-
+		/*
+			The frames are analysed independently of each other, possibly in parallel.
+		*/
+		autoSoundToBandFilterSpectrogramWorkspace ws = SoundToBandFilterSpectrogramWorkspace_create (me, thee.get(), windowDuration);
+		SoundToBandFilterSpectrogramWorkspace_initMelFilters (ws.get(), numberOfFilters, f1_mel, df_mel);
+		SampledToSampledWorkspace_analyseThreaded (ws.get());
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": No MelSpectrogram created.");
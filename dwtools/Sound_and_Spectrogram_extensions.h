@@ -40,6 +40,18 @@ autoBarkSpectrogram Sound_to_BarkSpectrogram (Sound me, double analysisWidth, do
 autoMelSpectrogram Sound_to_MelSpectrogram (Sound me, double analysisWidth, double dt,
 	double f1_mel, double fmax_mel, double df_mel);
 
+integer Sound_getMelFilterbankParameters (Sound me, double *inout_f1_mel, double *inout_fmax_mel, double *inout_df_mel);
+/*
+	Replaces invalid filter bank parameters by the defaults of Sound_to_MelSpectrogram,
+	and returns the number of filters.
+*/
+
+double Spectrogram_getGaussianWindowCorrection (integer numberOfSamples_window);
+/*
+	The area under the square of the Gaussian window of Sound_createGaussian,
+	divided by that of a rectangular window of the same width.
+*/
+
 autoSpectrogram Sound_to_Spectrogram_pitchDependent (Sound me, double analysisWidth,
 	double dt, double f1_hz, double fmax_hz, double df_hz, double relative_bw,
 	double pitchFloor, double pitchCeiling);
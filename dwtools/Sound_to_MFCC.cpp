@@ -1,6 +1,6 @@
 /* Sound_to_MFCC.cpp
  *
- * Copyright (C) 1993-2017 David Weenink
+ * Copyright (C) 1993-2026 David Weenink
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -23,12 +23,30 @@
 
 #include "Sound_to_MFCC.h"
 #include "Sound_and_Spectrogram_extensions.h"
+#include "SoundToMFCCWorkspace.h"
 
+/*
+	The same as MelSpectrogram_to_MFCC (Sound_to_MelSpectrogram (...)), but without the MelSpectrogram:
+	each frame goes from the window to the cepstral coefficients in one pass, possibly in parallel.
+*/
 autoMFCC Sound_to_MFCC (Sound me, integer numberOfCoefficients, double analysisWidth, double dt, double f1_mel, double fmax_mel, double df_mel) {
 	try {
-		autoMelSpectrogram mf = Sound_to_MelSpectrogram (me, analysisWidth, dt, f1_mel, fmax_mel, df_mel);
-		autoMFCC mfcc = MelSpectrogram_to_MFCC (mf.get(), numberOfCoefficients);
-		return mfcc;
+		const double windowDuration = 2.0 * analysisWidth;   // Gaussian window
+		const double fmin_mel = 0.0;
+		const integer numberOfFilters = Sound_getMelFilterbankParameters (me, & f1_mel, & fmax_mel, & df_mel);
+		Melder_require (numberOfFilters > 1,
+			U"The combination of filter parameters is not valid: there should be more than one filter.");
+		if (numberOfCoefficients <= 0 || numberOfCoefficients > numberOfFilters - 1)
+			numberOfCoefficients = numberOfFilters - 1;
+
+		integer numberOfFrames;
+		double t1;
+		Sampled_shortTermAnalysis (me, windowDuration, dt, & numberOfFrames, & t1);
+		autoMFCC thee = MFCC_create (my xmin, my xmax, numberOfFrames, dt, t1, numberOfFilters - 1, fmin_mel, fmax_mel);
+		autoSoundToMFCCWorkspace ws = SoundToMFCCWorkspace_create (me, thee.get(), windowDuration,
+				numberOfFilters, f1_mel, df_mel, numberOfCoefficients);
+		SampledToSampledWorkspace_analyseThreaded (ws.get());
+		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": no MFCC created.");
 	}
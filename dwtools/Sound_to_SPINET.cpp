@@ -19,10 +19,12 @@
 /*
  djmw 20020813 GPL header
  djmw 20070103 Sound interface changes
+ djmw 20261018 Filters and frames on several threads
 */
 
 #include "Sound_to_SPINET.h"
 #include "NUM2.h"
+#include "MelderThread.h"
 
 static double fgamma (double x, integer n) {
 	const double x2p1 = 1.0 + x * x;
@@ -51,11 +53,12 @@ autoSPINET Sound_to_SPINET (Sound me, double timeStep, double windowDuration, do
 		Sampled_shortTermAnalysis (me, windowDuration, timeStep, & numberOfFrames, & firstTime);
 		autoSPINET thee = SPINET_create (my xmin, my xmax, numberOfFrames, timeStep, firstTime, minimumFrequencyHz, maximumFrequencyHz, numberOfGammaFilters, excitationErbProportion, inhibitionErbProportion);
 		autoSound window = Sound_createGaussian (windowDuration, samplingFrequency);
-		autoSound frame = Sound_createSimple (1, windowDuration, samplingFrequency);
+		const integer frameSize = window -> nx;
+		const double frameDx = window -> dx, frameDuration = window -> xmax - window -> xmin;
 		autoVEC f = raw_VEC (numberOfGammaFilters);
 		autoVEC bw = raw_VEC (numberOfGammaFilters);
-		autoVEC aex = raw_VEC (numberOfGammaFilters);
-		autoVEC ain = raw_VEC (numberOfGammaFilters);
+		autoVEC aex = zero_VEC (numberOfGammaFilters);
+		autoVEC ain = zero_VEC (numberOfGammaFilters);
 		/*
 			Cochlear filterbank: gammatone.
 		*/
@@ -63,30 +66,68 @@ autoSPINET Sound_to_SPINET (Sound me, double timeStep, double windowDuration, do
 			f [i] = NUMerbToHertz (thy y1 + (i - 1) * thy dy);
 			bw [i] = NUM2pi * b * (f [i] * (6.23e-6 * f [i] + 93.39e-3) + 28.52);
 		}
+		/*
+			The gammatones all have the same duration, so the convolutions of the (first channel of the) sound
+			with the gammatones can share the Fourier transform of the sound, as in Sounds_convolve.
+		*/
+		autoSound gammaToneTemplate = Sound_createGammaTone (0.0, 0.1, samplingFrequency, thy gamma, b, f [1], 0.0, 0.0, false);
+		const integer n1 = my nx, n2 = gammaToneTemplate -> nx, n3 = n1 + n2 - 1;
+		const integer nfft = Melder_iroundUpToPowerOfTwo (n3);
+		const double filteredX1 = my x1 + gammaToneTemplate -> x1;
+		autoVEC soundSpectrum = zero_VEC (nfft);
+		soundSpectrum.part (1, n1)  <<=  my z.row (1);
+		NUMrealft (soundSpectrum.get(), 1);
 
 		autoMelderProgress progress (U"SPINET analysis");
+		/*
+			The filters are independent of each other; they are computed on several threads,
+			in rounds, so that the progress can be shown in between.
+		*/
+		const integer numberOfFiltersPerRound = ( Melder_debug == -8 ? 1 : 2 * MelderThread_getNumberOfThreads () );
+		for (integer firstFilter = 1; firstFilter <= numberOfGammaFilters; firstFilter += numberOfFiltersPerRound) {
+			const integer lastFilter = std::min (firstFilter + numberOfFiltersPerRound - 1, numberOfGammaFilters);
+			MelderThread_runTasks (lastFilter - firstFilter + 1, [&] (integer itask) {
+				const integer i = firstFilter - 1 + itask;
+				const double bb = (f [i] / 1000.0) * exp (- f [i] / 1000.0); // outer & middle ear and phase locking
+				const double tgammaMax = (thy gamma - 1) / bw [i]; // the time where the gamma function envelope has its maximum
+				const double gammaMaxAmplitude = pow ((thy gamma - 1) / (NUMe * bw [i]), thy gamma - 1);
+				const double timeCorrection = tgammaMax - windowDuration / 2.0;
 
-		for (integer i = 1; i <= numberOfGammaFilters; i ++) {
-			const double bb = (f [i] / 1000.0) * exp (- f [i] / 1000.0); // outer & middle ear and phase locking
-			const double tgammaMax = (thy gamma - 1) / bw [i]; // the time where the gamma function envelope has its maximum
-			const double gammaMaxAmplitude = pow ((thy gamma - 1) / (NUMe * bw [i]), thy gamma - 1);
-			const double timeCorrection = tgammaMax - windowDuration / 2.0;
-
-			autoSound gammaTone = Sound_createGammaTone (0.0, 0.1, samplingFrequency, thy gamma, b, f [i], 0.0, 0.0, false);
-			autoSound filtered = Sounds_convolve (me, gammaTone.get(), kSounds_convolve_scaling::SUM, kSounds_convolve_signalOutsideTimeDomain::ZERO);
-			/*
-				To energy measure: weigh with broad-band transfer function.
-			*/
-			for (integer j = 1; j <= numberOfFrames; j ++) {
-				Sound_into_Sound (filtered.get(), frame.get(), Sampled_indexToX (thee.get(), j) + timeCorrection);
-				Sounds_multiply (frame.get(), window.get());
-				thy y [i] [j] = Sound_power (frame.get()) * bb / gammaMaxAmplitude;
-			}
-			Melder_progress ((double) i / numberOfGammaFilters, U"SPINET: filter ", i, U" from ", numberOfGammaFilters, U".");
+				autoSound gammaTone = Sound_createGammaTone (0.0, 0.1, samplingFrequency, thy gamma, b, f [i], 0.0, 0.0, false);
+				Melder_assert (gammaTone -> nx == n2);
+				autoVEC filtered = zero_VEC (nfft);
+				filtered.part (1, n2)  <<=  gammaTone -> z.row (1);
+				NUMrealft (filtered.get(), 1);
+				filtered [1] *= soundSpectrum [1];
+				filtered [2] *= soundSpectrum [2];
+				for (integer k = 3; k <= nfft; k += 2) {
+					const double temp = soundSpectrum [k] * filtered [k] - soundSpectrum [k + 1] * filtered [k + 1];
+					filtered [k + 1] = soundSpectrum [k] * filtered [k + 1] + soundSpectrum [k + 1] * filtered [k];
+					filtered [k] = temp;
+				}
+				NUMrealft (filtered.get(), -1);
+				filtered.part (1, n3)  *=  1.0 / nfft;
+				/*
+					To energy measure: weigh with broad-band transfer function.
+				*/
+				autoVEC frame = raw_VEC (frameSize);
+				for (integer j = 1; j <= numberOfFrames; j ++) {
+					const double startTime = Sampled_indexToX (thee.get(), j) + timeCorrection;
+					const integer index = Melder_iround ((startTime - filteredX1) / my dx + 1.0);   // Sampled_xToNearestIndex
+					for (integer k = 1; k <= frameSize; k ++) {
+						const integer isample = index - 1 + k;
+						frame [k] = ( isample < 1 || isample > n3 ? 0.0 : filtered [isample] ) * window -> z [1] [k];
+					}
+					const double power = sqrt (NUMsum2 (frame.get())) * frameDx / frameDuration;   // Sound_power
+					thy y [i] [j] = power * bb / gammaMaxAmplitude;
+				}
+			});
+			Melder_progress ((double) lastFilter / numberOfGammaFilters, U"SPINET: filter ", lastFilter, U" from ", numberOfGammaFilters, U".");
 		}
 		/*
 			Excitatory and inhibitory area functions.
 		*/
+		autoMAT weights = raw_MAT (numberOfGammaFilters, numberOfGammaFilters);
 		for (integer i = 1; i <= numberOfGammaFilters; i ++) {
 			for (integer k = 1; k <= numberOfGammaFilters; k ++) {
 				const double fr = (f [k] - f [i]) / bw [i];
@@ -95,19 +136,29 @@ autoSPINET Sound_to_SPINET (Sound me, double timeStep, double windowDuration, do
 			}
 		}
 		/*
-			On-center off-surround interactions
+			On-center off-surround interactions. The weights do not depend on the frame.
 		*/
-		for (integer j = 1; j <= numberOfFrames; j ++)
-			for (integer i = 1; i <= numberOfGammaFilters; i ++) {
-				longdouble a = 0.0;
-				for (integer k = 1; k <= numberOfGammaFilters; k ++) {
-					const double fr = (f [k] - f [i]) / bw [i];
-					const double hexsq = fgamma (fr / thy excitationErbProportion, thy gamma);
-					const double hinsq = fgamma (fr / thy inhibitionErbProportion, thy gamma);
-					a += thy y [k] [j] * (hexsq / aex [i] - hinsq / ain [i]);
-				}
-				thy s [i] [j] = a > 0.0 ? (double) a : 0.0;
+		for (integer i = 1; i <= numberOfGammaFilters; i ++)
+			for (integer k = 1; k <= numberOfGammaFilters; k ++) {
+				const double fr = (f [k] - f [i]) / bw [i];
+				const double hexsq = fgamma (fr / thy excitationErbProportion, thy gamma);
+				const double hinsq = fgamma (fr / thy inhibitionErbProportion, thy gamma);
+				weights [i] [k] = hexsq / aex [i] - hinsq / ain [i];
 			}
+		constexpr integer minimumNumberOfFramesPerTask = 20;
+		integer numberOfTasks = ( Melder_debug == -8 ? 1 : numberOfFrames / minimumNumberOfFramesPerTask );
+		Melder_clip (1_integer, & numberOfTasks, 2 * MelderThread_getNumberOfThreads ());
+		MelderThread_runTasks (numberOfTasks, [&] (integer itask) {
+			const integer firstFrame = 1 + (itask - 1) * numberOfFrames / numberOfTasks;
+			const integer lastFrame = itask * numberOfFrames / numberOfTasks;
+			for (integer j = firstFrame; j <= lastFrame; j ++)
+				for (integer i = 1; i <= numberOfGammaFilters; i ++) {
+					longdouble a = 0.0;
+					for (integer k = 1; k <= numberOfGammaFilters; k ++)
+						a += thy y [k] [j] * weights [i] [k];
+					thy s [i] [j] = a > 0.0 ? (double) a : 0.0;
+				}
+		});
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U":  no SPINET created.");
@@ -43,4 +43,25 @@ trace(6);
 	}
 }
 
+autoTable Sound_Sounds_to_Table_dtw (Sound me, OrderedOf<structSound>* thee, double analysisWidth, double dt, double band, int slope,
+	integer numberOfBestMatches)
+{
+	try {
+		constexpr integer numberOfCoefficients = 12;
+		constexpr double fmin_mel = 100.0, df_mel = 100.0, fmax_mel = 0.0;
+		autoMFCC query = Sound_to_MFCC (me, numberOfCoefficients, analysisWidth, dt, fmin_mel, fmax_mel, df_mel);
+		OrderedOf<structCC> templates;
+		for (integer isound = 1; isound <= thy size; isound ++) {
+			const Sound sound = thy at [isound];
+			autoMFCC mfcc = Sound_to_MFCC (sound, numberOfCoefficients, analysisWidth, dt, fmin_mel, fmax_mel, df_mel);
+			Thing_setName (mfcc.get(), sound -> name.get());
+			templates. addItem_move (mfcc.move());
+		}
+		constexpr double wc = 1.0, wle = 0.0, wr = 0.0, wer = 0.0, dtr = 0.0;
+		return CC_CCs_to_Table_dtw (query.get(), & templates, wc, wle, wr, wer, dtr, band, slope, numberOfBestMatches);
+	} catch (MelderError) {
+		Melder_throw (me, U": no Table with DTW distances created.");
+	}
+}
+
 /* End of file Sounds_to_DTW.cpp */
@@ -24,8 +24,16 @@
 
 #include "DTW.h"
 #include "Sound.h"
+#include "Table.h"
 
 
 autoDTW Sounds_to_DTW (Sound me, Sound thee, double analysisWidth, double dt, double band, int slope);
 
+autoTable Sound_Sounds_to_Table_dtw (Sound me, OrderedOf<structSound>* thee, double analysisWidth, double dt, double band, int slope,
+	integer numberOfBestMatches);
+/*
+	As Sounds_to_DTW () for the query (me) and each of the templates (thee), but computes the MFCCs of each Sound only once;
+	see CC_CCs_to_Table_dtw ().
+*/
+
 #endif /* _Sounds_to_DTW_h_ */
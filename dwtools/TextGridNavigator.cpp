@@ -359,10 +359,10 @@ integer TextGridNavigator_getNumberOfMatchesForTier (TextGridNavigator me, integ
 
 integer TextGridNavigator_getNumberOfMatches (TextGridNavigator me) {
 	try {
-		const TextGridTierNavigator tn = my tierNavigators.at [1];
+		const constINTVEC topicTierMatches = TextGridTierNavigator_peekMatches (my tierNavigators.at [1]);
 		integer numberOfMatches = 0;
-		for (integer index = 1; index <= tn -> v_getSize (); index ++)
-			if (TextGridNavigator_isMatch (me, index, nullptr, nullptr))
+		for (integer imatch = 1; imatch <= topicTierMatches.size; imatch ++)
+			if (TextGridNavigator_isMatch (me, topicTierMatches [imatch], nullptr, nullptr))
 				numberOfMatches ++;
 		return numberOfMatches;
 	} catch (MelderError) {
@@ -421,54 +421,54 @@ bool TextGridNavigator_isMatch (TextGridNavigator me, integer topicIndex, intege
 	for (integer inum = 2; inum <= my tierNavigators.size; inum ++) {
 		const TextGridTierNavigator tni = my tierNavigators.at [inum];
 		const integer referenceIndex = tni -> v_timeToIndex (midTime);
-		const integer tierSize = tni -> v_getSize ();
 		integer beforeIndex_sub, afterIndex_sub;
 		double startTime_sub, endTime_sub;
 		
 		tni -> currentTopicIndex = 0;
-		const integer startIndex = 1;
-		const integer endIndex =  tierSize;
+		/*
+			Instead of testing every item of the tier, we visit only the items that match,
+			starting from the one nearest to the reference index.
+		*/
+		const constINTVEC matches = TextGridTierNavigator_peekMatches (tni);
+		const integer numberOfMatchesUpToReference = std::upper_bound (matches.begin(), matches.end(), referenceIndex) - matches.begin();
+		const integer firstMatchFromReference = std::lower_bound (matches.begin(), matches.end(), referenceIndex) - matches.begin() + 1;
 		const kMatchDomainAlignment matchDomainAlignment = tni -> matchDomainAlignment;
 		const kMatchDomain matchDomain = tni -> matchDomain;
 		if (matchDomainAlignment == kMatchDomainAlignment::IS_ANYWHERE) {
-			for (integer index = startIndex; index <= endIndex; index ++) {
-				if (TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub)) {
+			if (matches.size > 0)
+				tni -> currentTopicIndex = matches [1];
+		} else if (matchDomainAlignment == kMatchDomainAlignment::IS_BEFORE) {
+			for (integer imatch = numberOfMatchesUpToReference; imatch >= 1; imatch --) {
+				const integer index = matches [imatch];
+				TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub);
+				TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, nullptr, & endTime_sub);
+				if (endTime_sub <= startTime) {
 					tni -> currentTopicIndex = index;
 					break;
 				}
 			}
-		} else if (matchDomainAlignment == kMatchDomainAlignment::IS_BEFORE) {
-			for (integer index = referenceIndex; index >= startIndex; index --) {
-				if (TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub)) {
-					TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, nullptr, & endTime_sub);
-					if (endTime_sub <= startTime) {
-						tni -> currentTopicIndex = index;
-						break;
-					}
-				}
-			}
 		} else if (matchDomainAlignment == kMatchDomainAlignment::TOUCHES_BEFORE) {
-			for (integer index = referenceIndex; index >= startIndex; index --) {
-				if (TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub)) {
-					TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, nullptr, & endTime_sub);
-					if (endTime_sub == startTime) {
-						tni -> currentTopicIndex = index;
-						break;
-					} else if (endTime_sub < startTime)
-						break;
-				}
+			for (integer imatch = numberOfMatchesUpToReference; imatch >= 1; imatch --) {
+				const integer index = matches [imatch];
+				TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub);
+				TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, nullptr, & endTime_sub);
+				if (endTime_sub == startTime) {
+					tni -> currentTopicIndex = index;
+					break;
+				} else if (endTime_sub < startTime)
+					break;
 			}
 		} else if (matchDomainAlignment == kMatchDomainAlignment::OVERLAPS_BEFORE) {
 			// OVERLAPS_BEFORE	tmin2 < tmin && tmax2 <= tmax
-			for (integer index = referenceIndex; index >= startIndex; index --) {
-				if (TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub)) {
-					TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, & startTime_sub, & endTime_sub);
-					if (startTime_sub < startTime && endTime_sub <= endTime ) {
-						tni -> currentTopicIndex = index;
-						break;
-					} else if (endTime_sub < startTime)
-						break;
-				}
+			for (integer imatch = numberOfMatchesUpToReference; imatch >= 1; imatch --) {
+				const integer index = matches [imatch];
+				TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub);
+				TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, & startTime_sub, & endTime_sub);
+				if (startTime_sub < startTime && endTime_sub <= endTime ) {
+					tni -> currentTopicIndex = index;
+					break;
+				} else if (endTime_sub < startTime)
+					break;
 			}
 		} else if (matchDomainAlignment == kMatchDomainAlignment::IS_INSIDE) { // TODO checken of tmid correct is
 			if (TextGridTierNavigator_isMatch (tni, referenceIndex, & beforeIndex_sub, & afterIndex_sub)) {
@@ -478,35 +478,35 @@ bool TextGridNavigator_isMatch (TextGridNavigator me, integer topicIndex, intege
 			}
 		} else if (matchDomainAlignment == kMatchDomainAlignment::OVERLAPS_AFTER) {
 			// OVERLAPS_AFTER	tmin2 >= tmin && tmax2 > tmax
-			for (integer index = referenceIndex; index <= endIndex; index ++) {
-				if (TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub)) {
-					TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, & startTime_sub, & endTime_sub);
-					if (startTime_sub >= startTime && endTime_sub > endTime) {
-						tni -> currentTopicIndex = index;
-						break;
-					} else if (startTime_sub >= endTime)
-						break;
-				}
+			for (integer imatch = firstMatchFromReference; imatch <= matches.size; imatch ++) {
+				const integer index = matches [imatch];
+				TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub);
+				TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, & startTime_sub, & endTime_sub);
+				if (startTime_sub >= startTime && endTime_sub > endTime) {
+					tni -> currentTopicIndex = index;
+					break;
+				} else if (startTime_sub >= endTime)
+					break;
 			}
 		} else if (matchDomainAlignment == kMatchDomainAlignment::TOUCHES_AFTER) {
-			for (integer index = referenceIndex; index <= endIndex; index ++) {
-				if (TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub)) {
-					TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, & startTime_sub, nullptr);
-					if (startTime_sub == endTime) {
-						tni -> currentTopicIndex = index;
-						break;
-					} else if (startTime_sub > endTime)
-						break;
-				}
+			for (integer imatch = firstMatchFromReference; imatch <= matches.size; imatch ++) {
+				const integer index = matches [imatch];
+				TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub);
+				TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, & startTime_sub, nullptr);
+				if (startTime_sub == endTime) {
+					tni -> currentTopicIndex = index;
+					break;
+				} else if (startTime_sub > endTime)
+					break;
 			}
 		} else if (matchDomainAlignment == kMatchDomainAlignment::IS_AFTER) {
-			for (integer index = referenceIndex; index <= endIndex; index ++) {
-				if (TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub)) {
-					TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, & startTime_sub, nullptr);
-					if (startTime_sub >= endTime) {
-						tni -> currentTopicIndex = index;
-						break;
-					}
+			for (integer imatch = firstMatchFromReference; imatch <= matches.size; imatch ++) {
+				const integer index = matches [imatch];
+				TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub);
+				TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, & startTime_sub, nullptr);
+				if (startTime_sub >= endTime) {
+					tni -> currentTopicIndex = index;
+					break;
 				}
 			}
 		} else if (matchDomainAlignment == kMatchDomainAlignment::OVERLAPS_BEFORE_AND_AFTER) {
@@ -522,13 +522,13 @@ bool TextGridNavigator_isMatch (TextGridNavigator me, integer topicIndex, intege
 					tni -> currentTopicIndex = referenceIndex;
 			}
 		} else if (matchDomainAlignment == kMatchDomainAlignment::IS_OUTSIDE) {
-			for (integer index = startIndex; index <= endIndex; index ++) {
-				if (TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub)) {
+			for (integer imatch = 1; imatch <= matches.size; imatch ++) {
+				const integer index = matches [imatch];
+				TextGridTierNavigator_isMatch (tni, index, & beforeIndex_sub, & afterIndex_sub);
 				TextGridTierNavigator_getMatchDomain (tni, matchDomain, index, beforeIndex_sub, afterIndex_sub, & startTime_sub, & endTime_sub);
-					if (endTime_sub <= startTime || startTime_sub >= endTime) {
-						tni -> currentTopicIndex = index;
-						break;
-					}
+				if (endTime_sub <= startTime || startTime_sub >= endTime) {
+					tni -> currentTopicIndex = index;
+					break;
 				}
 			}
 		}
@@ -562,8 +562,11 @@ static integer TextGridNavigator_timeToHighIndex (TextGridNavigator me, double t
 
 integer TextGridNavigator_findNext (TextGridNavigator me) {
 	const TextGridTierNavigator tn = my tierNavigators. at [1];
+	const constINTVEC topicTierMatches = TextGridTierNavigator_peekMatches (tn);
 	const integer currentTopicIndex = tn -> currentTopicIndex, size = tn -> v_getSize ();
-	for (integer index = currentTopicIndex + 1; index <= size; index ++) {
+	const integer firstMatchAfterCurrent = std::upper_bound (topicTierMatches.begin(), topicTierMatches.end(), currentTopicIndex) - topicTierMatches.begin() + 1;
+	for (integer imatch = firstMatchAfterCurrent; imatch <= topicTierMatches.size; imatch ++) {
+		const integer index = topicTierMatches [imatch];
 		if (TextGridNavigator_isMatch (me, index, nullptr, nullptr)) {
 			tn -> currentTopicIndex = index;
 			return index;
@@ -580,8 +583,11 @@ integer TextGridNavigator_findNextAfterTime (TextGridNavigator me, double time)
 
 integer TextGridNavigator_findPrevious (TextGridNavigator me) {
 	const TextGridTierNavigator tn = my tierNavigators. at [1];
+	const constINTVEC topicTierMatches = TextGridTierNavigator_peekMatches (tn);
 	const integer currentTopicIndex = tn -> currentTopicIndex;
-	for (integer index = currentTopicIndex - 1; index > 0; index --) {
+	const integer lastMatchBeforeCurrent = std::lower_bound (topicTierMatches.begin(), topicTierMatches.end(), currentTopicIndex) - topicTierMatches.begin();
+	for (integer imatch = lastMatchBeforeCurrent; imatch >= 1; imatch --) {
+		const integer index = topicTierMatches [imatch];
 		if (TextGridNavigator_isMatch (me, index, nullptr, nullptr)) {
 			tn -> currentTopicIndex = index;
 			return index;
@@ -626,10 +632,11 @@ integer TextGridNavigator_getIndex (TextGridNavigator me, integer tierNumber, kC
 
 autoINTVEC TextGridNavigator_listIndices (TextGridNavigator me, kContext_where where) {
 	try {
-		TextGridTierNavigator tn = my tierNavigators.at [1];
+		const constINTVEC topicTierMatches = TextGridTierNavigator_peekMatches (my tierNavigators.at [1]);
 		autoINTVEC indices;
 		integer position = 0;
-		for (integer index = 1; index <= tn -> v_getSize(); index ++) {
+		for (integer imatch = 1; imatch <= topicTierMatches.size; imatch ++) {
+			const integer index = topicTierMatches [imatch];
 			integer beforeIndex, afterIndex;
 			if (TextGridNavigator_isMatch (me, index, & beforeIndex, & afterIndex)) {
 				integer iwhere = (where == kContext_where::TOPIC ? index :
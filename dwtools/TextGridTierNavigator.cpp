@@ -235,6 +235,7 @@ void TextGridTierNavigator_replaceNavigationContext (TextGridTierNavigator me, N
 		my navigationContext -> afterMatchBoolean = thy afterMatchBoolean;
 		my navigationContext -> combinationCriterion = thy combinationCriterion;
 		my navigationContext -> excludeTopicMatch = thy excludeTopicMatch;		
+		my matchesAreValid = false;
 	} catch (MelderError) {
 		Melder_throw (me, U": could not replace navigation context.");
 	}
@@ -269,6 +270,7 @@ void TextGridTierNavigator_replaceTier (TextGridTierNavigator me, TextGrid thee,
 		my xmin = thy xmin;
 		my xmax = thy xmax;
 		my currentTopicIndex = 0; // offLeft
+		my matchesAreValid = false;
 	} catch (MelderError) {
 		Melder_throw (me, U": cannot replace the tier.");
 	}
@@ -279,6 +281,7 @@ void TextGridTierNavigator_modifyBeforeRange (TextGridTierNavigator me, integer
 		U"Both numbers in the Before range should be positive.");
 	my beforeRange.first = std::min (from, to);
 	my beforeRange.last = std::max (from, to);
+	my matchesAreValid = false;
 }
 
 void TextGridTierNavigator_modifyAfterRange (TextGridTierNavigator me, integer from, integer to) {
@@ -286,22 +289,27 @@ void TextGridTierNavigator_modifyAfterRange (TextGridTierNavigator me, integer f
 		U"Both numbers in the after range should be positive.");
 	my afterRange.first = std::min (from, to);
 	my afterRange.last = std::max (from, to);
+	my matchesAreValid = false;
 }
 
 void TextGridTierNavigator_modifyTopicCriterion (TextGridTierNavigator me, kMelder_string newCriterion, kMatchBoolean matchBoolean) {
 	NavigationContext_modifyTopicCriterion (my navigationContext.get(), newCriterion, matchBoolean);
+	my matchesAreValid = false;
 }
 
 void TextGridTierNavigator_modifyBeforeCriterion (TextGridTierNavigator me, kMelder_string newCriterion, kMatchBoolean matchBoolean) {
 	NavigationContext_modifyBeforeCriterion (my navigationContext.get(), newCriterion, matchBoolean);
+	my matchesAreValid = false;
 }
 
 void TextGridTierNavigator_modifyAfterCriterion (TextGridTierNavigator me, kMelder_string newCriterion, kMatchBoolean matchBoolean) {
 	NavigationContext_modifyAfterCriterion (my navigationContext.get(), newCriterion, matchBoolean);
+	my matchesAreValid = false;
 }
 
 void TextGridTierNavigator_modifyUseCriterion (TextGridTierNavigator me, kContext_combination newUse, bool excludeTopicMatch) {
 	NavigationContext_modifyUseCriterion (my navigationContext.get(), newUse, excludeTopicMatch);
+	my matchesAreValid = false;
 }
 
 static bool TextGridTierNavigator_isTopicMatch (TextGridTierNavigator me, integer index) {
@@ -409,12 +417,22 @@ bool TextGridTierNavigator_isMatch (TextGridTierNavigator me, integer topicIndex
 	return isMatch;
 }
 
+constINTVEC TextGridTierNavigator_peekMatches (TextGridTierNavigator me) {
+	if (! my matchesAreValid) {
+		autoINTVEC matches = raw_INTVEC (my v_getSize ());
+		integer numberOfMatches = 0;
+		for (integer index = 1; index <= matches.size; index ++)
+			if (TextGridTierNavigator_isMatch (me, index, nullptr, nullptr))
+				matches [++ numberOfMatches] = index;
+		matches.resize (numberOfMatches);
+		my matches = matches.move();
+		my matchesAreValid = true;
+	}
+	return my matches.get();
+}
+
 integer TextGridTierNavigator_getNumberOfMatches (TextGridTierNavigator me) {
-	integer numberOfMatches = 0;
-	for (integer index = 1; index <= my v_getSize (); index ++)
-		if (TextGridTierNavigator_isMatch (me, index, nullptr, nullptr))
-			numberOfMatches ++;
-	return numberOfMatches;
+	return TextGridTierNavigator_peekMatches (me).size;
 }
 
 integer TextGridTierNavigator_getNumberOfTopicMatches (TextGridTierNavigator me) {
@@ -492,14 +510,9 @@ static integer TextGridTierNavigator_setCurrentAtTime (TextGridTierNavigator me,
 }
 
 integer TextGridTierNavigator_findNext (TextGridTierNavigator me) {
-	const integer currentTopicIndex = my currentTopicIndex, size = my v_getSize ();
-	for (integer index = currentTopicIndex + 1; index <= size; index ++) {
-		if (TextGridTierNavigator_isMatch (me, index, nullptr, nullptr)) {
-			my currentTopicIndex = index;
-			return index;
-		}
-	}
-	my currentTopicIndex = size + 1; // offRight
+	const constINTVEC matches = TextGridTierNavigator_peekMatches (me);
+	const integer *next = std::upper_bound (matches.begin(), matches.end(), my currentTopicIndex);
+	my currentTopicIndex = ( next != matches.end() ? *next : my v_getSize () + 1 ); // offRight
 	return my currentTopicIndex;
 }
 
@@ -509,15 +522,10 @@ integer TextGridTierNavigator_findNextAfterTime (TextGridTierNavigator me, doubl
 }
 
 integer TextGridTierNavigator_findPrevious (TextGridTierNavigator me) {
-	const integer currentTopicIndex = my currentTopicIndex;
-	for (integer index = currentTopicIndex - 1; index > 0; index --) {
-		if (TextGridTierNavigator_isMatch (me, index, nullptr, nullptr)) {
-			my currentTopicIndex = index;
-			return index;
-		}
-	}
-	my currentTopicIndex = 0;
-	return 0;
+	const constINTVEC matches = TextGridTierNavigator_peekMatches (me);
+	const integer *firstNotBefore = std::lower_bound (matches.begin(), matches.end(), my currentTopicIndex);
+	my currentTopicIndex = ( firstNotBefore != matches.begin() ? firstNotBefore [-1] : 0 );
+	return my currentTopicIndex;
 }
 
 integer TextGridTierNavigator_findPreviousBeforeTime (TextGridTierNavigator me, double time) {
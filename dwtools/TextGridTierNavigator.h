@@ -59,6 +59,12 @@ void TextGridTierNavigator_modifyMatchingRange (TextGridTierNavigator me, intege
 
 bool TextGridTierNavigator_isMatch (TextGridTierNavigator me, integer topicIndex, integer *out_beforeIndex, integer *out_afterIndex);
 
+constINTVEC TextGridTierNavigator_peekMatches (TextGridTierNavigator me);
+/*
+	The indices of all the items for which TextGridTierNavigator_isMatch () is true, in increasing order.
+	The result is valid until the next change of the tier, the navigation context or the ranges.
+*/
+
 integer TextGridTierNavigator_getNumberOfMatches (TextGridTierNavigator me);
 integer TextGridTierNavigator_getNumberOfTopicMatches (TextGridTierNavigator me);
 integer TextGridTierNavigator_getNumberOfBeforeMatches (TextGridTierNavigator me);
@@ -52,6 +52,13 @@ oo_DEFINE_CLASS (TextGridTierNavigator, Function)
 		virtual double v_getStartTime (integer index);
 		virtual double v_getEndTime (integer index);
 		virtual conststring32 v_getLabel (integer index);
+
+		/*
+			The indices of the items that match, in increasing order;
+			made when first needed, and thrown away whenever the tier, the context or the ranges change.
+		*/
+		autoINTVEC matches;
+		bool matchesAreValid;
 	#endif
 
 oo_END_CLASS (TextGridTierNavigator)
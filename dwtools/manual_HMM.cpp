@@ -120,7 +120,7 @@ NORMAL (U"2. According to the procedure described in @@Covariance: To TableOfRea
 	"data point will be generated.")
 MAN_END
 
-MAN_BEGIN (U"TableOfReal: To GaussianMixture...", U"djmw", 20150930)
+MAN_BEGIN (U"TableOfReal: To GaussianMixture...", U"djmw", 20261018)
 INTRO (U"Creates a @@GaussianMixture@ from the selected @@TableOfReal@ by an @@expectation-maximization|"
 	"expectation-maximization@ procedure.")
 ENTRY (U"Settings")
@@ -157,6 +157,9 @@ NORMAL (U"The EM iteration has to start with a sensible initial guess for all th
 	"Initially all mixing probabilities will be chosen equal.")
 NORMAL (U"How to proceed from the initial guess with the EM to find the optimal values for all the parameters "
 	"in the Gaussian mixture is explained in great detail by @@Bishop (2006)@.")
+NORMAL (U"In both the expectation and the maximization steps, the rows of the TableOfReal are divided into blocks "
+	"that are handled on several threads at the same time. The number of blocks depends only on the number of rows, "
+	"so the outcome does not depend on the number of threads.")
 MAN_END
 
 MAN_BEGIN (U"GaussianMixture & TableOfReal: Get likelihood value...", U"djmw", 20190711)
@@ -413,10 +416,16 @@ INTRO (U"Get a table with bigrams form the selected @HMMObservationSequence.")
 NORMAL (U"See also @@HMM & HMMObservationSequence: To TableOfReal (bigrams)...@.")
 MAN_END
 
-MAN_BEGIN (U"HMM & HMMObservationSequences: Learn...", U"djmw", 20111130)
+MAN_BEGIN (U"HMM & HMMObservationSequences: Learn...", U"djmw", 20261018)
 INTRO (U"Train the transition and emission probabilities of the @HMM from the observations.")
 ENTRY (U"Algorithm")
 NORMAL (U"The Baum-Welch @@expectation-maximization@ procedure. It uses the forward and backward procedures to (re)estimate the parameters until convergence is reached.")
+NORMAL (U"An observation that is not one of the symbols of the HMM ends an observation sequence; "
+	"the next known observation starts a new one. The forward and backward procedures use scaled probabilities "
+	"(@@Rabiner (1989)@), and only the forward probabilities are stored, "
+	"so that very long observation sequences can be used.")
+NORMAL (U"The observation sequences are processed in blocks on several threads at the same time. "
+	"Because the blocks depend only on the observations, the outcome does not depend on the number of threads.")
 MAN_END
 
 MAN_BEGIN (U"Bishop (2006)", U"djmw", 20101026)
@@ -152,6 +152,9 @@ we turn off the formants in the parallel section.
 	... "Powers in tiers", "yes", "yes", "yes",
 	... "Cascade", 1, 5, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, "yes"
 }
+If you select several KlattGrids, ##To Sound# synthesizes them at the same time, on several threads.
+The resulting Sounds are the same as when you synthesize the KlattGrids one by one,
+also when the KlattGrids generate noise.
 Changes
 =======
 In Praat versions before 5.1.05 the values for the %%oral / nasal / tracheal formant amplitudes% and
@@ -439,6 +439,26 @@ MAN_BEGIN (U"CC: Get c0 value in frame...", U"djmw", 20140926)
 INTRO (U"Get the zeroth cepstral coefficient value in the specified frame. For a @MFCC object this value relates to energy.")
 MAN_END
 
+MAN_BEGIN (U"CC: To Table (DTW distances)...", U"djmw", 20261018)
+INTRO (U"Computes the weighted @DTW distance between the first of the selected @MFCC objects (the query) "
+	"and each of the other selected objects (the templates), as with @@DTW: Find path (band & slope)...@ "
+	"after ##To DTW...#. The result is a @Table with one row per template.")
+ENTRY (U"Settings")
+NORMAL (U"The weights and the regression window length define the distance between two frames, as in ##To DTW...#. "
+	"The Sakoe-Chiba band and the slope constraint are as in @@DTW: Find path (band & slope)...@.")
+TERM (U"##Number of best matches")
+DEFINITION (U"if 0, the distances to all templates are computed. "
+	"If larger than 0, say %k, only the %k templates closest to the query are guaranteed to get their distance; "
+	"the templates are searched in the order of their lower bounds, and the search stops as soon as the lower bound "
+	"of the next template is larger than the distance of the %%k%-th best match found so far. "
+	"The distances of the templates that were not searched are undefined.")
+ENTRY (U"Algorithm")
+NORMAL (U"The features of every frame are computed only once. For each template, a lower bound for the distance "
+	"is computed from the envelope of the query within the Sakoe-Chiba band (@@Keogh & Ratanamahatana (2005)@); "
+	"this lower bound is in the column ##lowerBound#. Only the templates that are searched get a DTW, "
+	"of which only the distances within the band are computed; the templates are searched on several threads at the same time.")
+MAN_END
+
 MAN_BEGIN (U"CCA", U"djmw", 20020323)
 INTRO (U"One of the @@types of objects@ in Praat. ")
 NORMAL (U"An object of type CCA represents the @@Canonical correlation "
@@ -1940,6 +1960,22 @@ DEFINITION (U"determines the maximum and minimum local slopes in the optimal pat
 NORMAL (U"For more information see the article of @@Sakoe & Chiba (1978)@.")
 MAN_END
 
+MAN_BEGIN (U"DTW: Find path (multiscale)...", U"djmw", 20261018)
+INTRO (U"Finds an approximately optimal path for the selected @DTW by first finding the path in a DTW with half as many frames in both directions, "
+	"and then searching only the cells near that coarse path. The coarse path itself is found in the same way, down to about 20 frames.")
+NORMAL (U"For long sounds this is much faster than @@DTW: Find path (band & slope)...@, and the search needs much less memory, "
+	"because the number of cells searched grows linearly with the durations instead of with their product.")
+ENTRY (U"Settings")
+TERM (U"##Radius (frames)")
+DEFINITION (U"the number of frames around the coarse path that are searched at the finer resolution. "
+	"If the radius is at least as large as the number of frames, the result is the same as that of "
+	"@@DTW: Find path (band & slope)...@ with a band of 0.")
+TERM (U"##Slope constraint")
+DEFINITION (U"as in @@DTW: Find path (band & slope)...@.")
+ENTRY (U"Algorithm")
+NORMAL (U"This is the FastDTW algorithm of @@Salvador & Chan (2007)@.")
+MAN_END
+
 MAN_BEGIN (U"DTW: Get maximum consecutive steps...", U"djmw", 20050307)
 INTRO (U"Get the maximum number of consecutive steps in the chosen direction along the optimal path from the selected @DTW.")
 MAN_END
@@ -2807,6 +2843,25 @@ INTRO (U"Convert the selected @@MFCC@ object to a @@TableOfReal@ object. Each MF
 	"coefficient will be saved in the first column.")
 MAN_END
 
+MAN_BEGIN (U"MFCC: To TableOfReal (deltas)...", U"djmw", 20261018)
+INTRO (U"Convert the selected @@MFCC@ object to a @@TableOfReal@ object with the coefficients, their deltas "
+	"and optionally their accelerations, as is usual for speech recognition. Each MFCC frame results in one row in the TableOfReal.")
+ENTRY (U"Settings")
+TERM (U"##Include energy")
+DEFINITION (U"if on, the zeroth MFCC coefficient will be in the first column, as in @@MFCC: To TableOfReal...@.")
+TERM (U"##Number of frames around")
+DEFINITION (U"the number of frames %N on either side of a frame that determine its deltas.")
+TERM (U"##Include accelerations")
+DEFINITION (U"if on, the deltas of the deltas are appended as well.")
+ENTRY (U"Algorithm")
+NORMAL (U"The delta of a coefficient %c in frame %t is the slope of the regression line through the %c values of frames "
+	"%t-%N to %t+%N:")
+EQUATION (U"%d__%t_ = \\Si__%n=1..%N_ %n (%c__%t+%n_ - %c__%t-%n_) / (2 \\Si__%n=1..%N_ %n^2)")
+NORMAL (U"where the first and the last frame take the place of the frames before the first and after the last frame. "
+	"The columns of the deltas are labelled by a \"d\" before the label of their coefficient, "
+	"those of the accelerations by \"dd\".")
+MAN_END
+
 MAN_BEGIN (U"MSpline", U"djmw", 19990627)
 INTRO (U"One of the @@types of objects@ in Praat. ")
 NORMAL (U"An object of type MSpline represents a linear combination of basis "
@@ -4320,6 +4375,14 @@ SCRIPT (8, 5,
 	"removeObject: s\n")
 MAN_END
 
+MAN_BEGIN (U"Sounds: To Table (DTW distances)...", U"djmw", 20261018)
+INTRO (U"Computes the weighted @DTW distance between the first of the selected @@Sound@s (the query) "
+	"and each of the other selected Sounds (the templates), as ##Sounds: To DTW...# would do for each pair. "
+	"The result is a @Table with one row per template.")
+NORMAL (U"The @MFCC of each Sound is computed only once, with 12 coefficients; "
+	"see @@CC: To Table (DTW distances)...@ for the other settings and the algorithm.")
+MAN_END
+
 MAN_BEGIN (U"Sounds: Paint enclosed...", U"djmw", 20170829)
 INTRO (U"Paints the area between the two selected @@Sound@s. ")
 ENTRY (U"Settings")
@@ -4677,6 +4740,7 @@ EQUATION (U"%#H(%f) = 0 for %f \\<_ %f__%l_ and %f \\>_ %f__%h_")
 EQUATION (U"%#H(%f) = (%f - %f__%l_) / (%f__%c_ - %f__%l_) for %f__%l_ \\<_ %f \\<_ %f__%c_")
 EQUATION (U"%#H(%f) = (%f__%h_ - %f) / (%f__%h_ - %f__%c_) for %f__%c_ \\<_ %f \\<_ %f__%h_")
 NORMAL (U"In general the number of filter values stored in each frame of the MelSpectrogram is an order of magnitude smaller than the number of sound samples in the corresponding analysis frame.")
+NORMAL (U"The filter functions are computed only once for all frames, and the frames may be analysed in parallel.")
 MAN_END
 
 MAN_BEGIN (U"Sound: To Pitch (shs)...", U"djmw", 19970402)   // 2023
@@ -4697,6 +4761,9 @@ NORMAL (U"The spectral compression consists of the summation of a sequence of "
 	"of the compression. The maximum of the resulting sum spectrum is the "
 	"estimate of the pitch. Details of the algorithm can be "
 	"found in @@Hermes (1988)@")
+NORMAL (U"The frames are analysed independently of each other, and may be analysed in parallel. "
+	"The interpolation onto the logarithmic frequency scale only depends on the settings; it is computed once, "
+	"and is reused by later analyses with the same settings.")
 ENTRY (U"Settings")
 TERM (U"##Time step (s)# (standard value: 0.01 s)")
 DEFINITION (U"the measurement interval (frame duration), in seconds.")
@@ -6424,6 +6491,11 @@ MAN_BEGIN (U"Keating & Esposito (2006)", U"djmw", 20130620)
 NORMAL (U"P.A. Keating & C. Esposito (2006): \"Linguistic voice quality.\" %%UCLA Working Papers in Phonetics% #105: 85\\--91.")
 MAN_END
 
+MAN_BEGIN (U"Keogh & Ratanamahatana (2005)", U"djmw", 20261018)
+NORMAL (U"E. Keogh & C.A. Ratanamahatana (2005): \"Exact indexing of dynamic time warping.\" "
+	"%%Knowledge and Information Systems% #7: 358\\--386.")
+MAN_END
+
 MAN_BEGIN (U"Khuri (1998)", U"djmw", 20120702)
 NORMAL (U"A. Khuri (1998): \"Unweighted sums of squares in unbalanced analysis of variance.\", %%Journal of Statistical Planning "
 	"and Inference% #74: 135\\--147.")
@@ -6496,6 +6568,11 @@ NORMAL (U"H. Sakoe & S. Chiba (1978): \"Dynamic programming algorithm optimizati
 	"%%Transactions on ASSP% #26: 43\\--49.")
 MAN_END
 
+MAN_BEGIN (U"Salvador & Chan (2007)", U"djmw", 20261018)
+NORMAL (U"S. Salvador & P. Chan (2007): \"Toward accurate dynamic time warping in linear time and space.\" "
+	"%%Intelligent Data Analysis% #11: 561\\--580.")
+MAN_END
+
 MAN_BEGIN (U"Sandwell (1987)", U"djmw", 20170915)
 NORMAL (U"D.T. Sandwell (1987): \"Biharmonic spline interpolation of GEOS-3 and SEASAT altimeter data.\", "
 		"%%Geophysica Research Letters% #14: 139\\--142.")
@@ -484,6 +484,34 @@ DO
 	CONVERT_TWO_TO_ONE_END (my name.get(), U"_", your name.get());
 }
 
+FORM (COMBINE_ALL_TO_ONE__CCs_to_Table_dtw, U"CC: To Table (DTW distances)", U"CC: To Table (DTW distances)...") {
+	COMMENT (U"Distance  between cepstral coefficients")
+	REAL (cepstralWeight, U"Cepstral weight", U"1.0")
+	REAL (logEnergyWeight, U"Log energy weight", U"0.0")
+	REAL (regressionWeight, U"Regression weight", U"0.0")
+	REAL (regressionLogEnergyWeight, U"Regression log energy weight", U"0.0")
+	REAL (regressionWindowLength, U"Regression window length (s)", U"0.056")
+	REAL (sakoeChibaBand, U"Sakoe-Chiba band (s)", U"0.0")
+	CHOICE (slopeConstraint, U"Slope constraint", 1)
+		OPTION (U"no restriction")
+		OPTION (U"1/3 < slope < 3")
+		OPTION (U"1/2 < slope < 2")
+		OPTION (U"2/3 < slope < 3/2")
+	INTEGER (numberOfBestMatches, U"Number of best matches", U"0 (= all)")
+	OK
+DO
+	COMBINE_ALL_TO_ONE (CC)
+		Melder_require (list.size > 1,
+			U"Select the query and at least one template.");
+		OrderedOf<structCC> templates;
+		for (integer itemplate = 2; itemplate <= list.size; itemplate ++)
+			templates. addItem_ref (list.at [itemplate]);
+		autoTable result = CC_CCs_to_Table_dtw (list.at [1], & templates, cepstralWeight, logEnergyWeight, regressionWeight,
+			regressionLogEnergyWeight, regressionWindowLength, sakoeChibaBand, slopeConstraint, numberOfBestMatches
+		);
+	COMBINE_ALL_TO_ONE_END (list.at [1] -> name.get(), U"_dtw")
+}
+
 DIRECT (CONVERT_EACH_TO_ONE__CC_to_Matrix) {
 	CONVERT_EACH_TO_ONE (CC)
 		autoMatrix result = CC_to_Matrix (me);
@@ -1963,6 +1991,20 @@ DO
 	MODIFY_EACH_END
 }
 
+FORM (MODIFY_DTW_findPath_multiscale, U"DTW: Find path (multiscale)", U"DTW: Find path (multiscale)...") {
+	NATURAL (radius, U"Radius (frames)", U"10")
+	CHOICE (slopeConstraint, U"Slope constraint", 1)
+		OPTION (U"no restriction")
+		OPTION (U"1/3 < slope < 3")
+		OPTION (U"1/2 < slope < 2")
+		OPTION (U"2/3 < slope < 3/2")
+	OK
+DO
+	MODIFY_EACH (DTW)
+		DTW_findPath_multiscale (me, radius, slopeConstraint, nullptr);
+	MODIFY_EACH_END
+}
+
 FORM (CONVERT_EACH_TO_ONE__DTW_to_Matrix_cumulativeDistances, U"DTW: To Matrix", nullptr) {
     REAL (sakoeChibaBand, U"Sakoe-Chiba band (s)", U"0.05")
     CHOICE (slopeConstraint, U"Slope constraint", 1)
@@ -4172,6 +4214,17 @@ DO
 	CONVERT_EACH_TO_ONE_END (my name.get())
 }
 
+FORM (CONVERT_EACH_TO_ONE__MFCC_to_TableOfReal_deltas, U"MFCC: To TableOfReal (deltas)", U"MFCC: To TableOfReal (deltas)...") {
+	BOOLEAN (includeEnergy, U"Include energy", false)
+	NATURAL (numberOfFramesAround, U"Number of frames around", U"2")
+	BOOLEAN (includeAccelerations, U"Include accelerations", true)
+	OK
+DO
+	CONVERT_EACH_TO_ONE (MFCC)
+		autoTableOfReal result = MFCC_to_TableOfReal_deltas (me, includeEnergy, numberOfFramesAround, includeAccelerations);
+	CONVERT_EACH_TO_ONE_END (my name.get())
+}
+
 FORM (CONVERT_EACH_TO_ONE__MFCC_to_Matrix_features, U"MFCC: To Matrix (features)", nullptr) {
 	POSITIVE (windowLength, U"Window length (s)", U"0.025")
 	BOOLEAN (includeEnergy, U"Include energy", false)
@@ -5682,6 +5735,30 @@ DO
 	CONVERT_TWO_TO_ONE_END (my name.get(), U"_", your name.get())
 }
 
+FORM (COMBINE_ALL_TO_ONE__Sounds_to_Table_dtw, U"Sounds: To Table (DTW distances)", U"Sounds: To Table (DTW distances)...") {
+	POSITIVE (windowLength, U"Window length (s)", U"0.015")
+	POSITIVE (timeStep, U"Time step (s)", U"0.005")
+	COMMENT (U"")
+	REAL (sakoeChibaBand, U"Sakoe-Chiba band (s)", U"0.1")
+	CHOICE (slopeConstraint, U"Slope constraint", 1)
+		OPTION (U"no restriction")
+		OPTION (U"1/3 < slope < 3")
+		OPTION (U"1/2 < slope < 2")
+		OPTION (U"2/3 < slope < 3/2")
+	INTEGER (numberOfBestMatches, U"Number of best matches", U"0 (= all)")
+	OK
+DO
+	COMBINE_ALL_TO_ONE (Sound)
+		Melder_require (list.size > 1,
+			U"Select the query and at least one template.");
+		OrderedOf<structSound> templates;
+		for (integer itemplate = 2; itemplate <= list.size; itemplate ++)
+			templates. addItem_ref (list.at [itemplate]);
+		autoTable result = Sound_Sounds_to_Table_dtw (list.at [1], & templates, windowLength, timeStep, sakoeChibaBand,
+				slopeConstraint, numberOfBestMatches);
+	COMBINE_ALL_TO_ONE_END (list.at [1] -> name.get(), U"_dtw")
+}
+
 FORM (CONVERT_EACH_TO_ONE__Sound_to_TextGrid_detectSilences, U"Sound: To TextGrid (silences)", U"Sound: To TextGrid (silences)...") {
 	COMMENT (U"Parameters for the intensity analysis")
 	POSITIVE (pitchFloor, U"Pitch floor (Hz)", U"100")
@@ -8709,6 +8786,8 @@ void praat_CC_init (ClassInfo klas) {
 			CONVERT_EACH_TO_ONE__CC_to_Matrix);
 	praat_addAction1 (klas, 2, U"To DTW...", nullptr, 0, 
 			CONVERT_TWO_TO_ONE__CCs_to_DTW);
+	praat_addAction1 (klas, 0, U"To Table (DTW distances)...", nullptr, 0,
+			COMBINE_ALL_TO_ONE__CCs_to_Table_dtw);
 }
 
 static void praat_Eigen_Matrix_project (ClassInfo klase, ClassInfo klasm); // deprecated 2014
@@ -9556,6 +9635,8 @@ void praat_David_init () {
 			MODIFY_DTW_findPath);
     praat_addAction1 (classDTW, 0, U"Find path (band & slope)...", nullptr, 0, 
 			MODIFY_DTW_findPath_bandAndSlope);
+	praat_addAction1 (classDTW, 0, U"Find path (multiscale)...", nullptr, 0,
+			MODIFY_DTW_findPath_multiscale);
     praat_addAction1 (classDTW, 0, U"To Polygon...", nullptr, 1, 
 			CONVERT_EACH_TO_ONE__DTW_to_Polygon);
 	praat_addAction1 (classDTW, 0, U"To Matrix (distances)", nullptr, 0, 
@@ -9915,6 +9996,8 @@ void praat_David_init () {
 			CONVERT_EACH_TO_ONE__MFCC_to_MelSpectrogram);
 	praat_addAction1 (classMFCC, 0, U"To TableOfReal...", nullptr, 0,
 			CONVERT_EACH_TO_ONE__MFCC_to_TableOfReal);
+	praat_addAction1 (classMFCC, 0, U"To TableOfReal (deltas)...", nullptr, 0,
+			CONVERT_EACH_TO_ONE__MFCC_to_TableOfReal_deltas);
 	praat_addAction1 (classMFCC, 0, U"To Matrix (features)...", nullptr, GuiMenu_HIDDEN,
 			CONVERT_EACH_TO_ONE__MFCC_to_Matrix_features);
 	praat_addAction1 (classMFCC, 0, U"To Sound", nullptr, GuiMenu_HIDDEN,
@@ -10256,6 +10339,8 @@ void praat_David_init () {
 			CONVERT_TWO_TO_ONE__Sounds_to_Polygon_enclosed);
     praat_addAction1 (classSound, 2, U"To DTW...", U"Cross-correlate...", GuiMenu_DEPTH_1,
 			CONVERT_TWO_TO_ONE__Sounds_to_DTW);
+	praat_addAction1 (classSound, 0, U"To Table (DTW distances)...", U"To DTW...", GuiMenu_DEPTH_1,
+			COMBINE_ALL_TO_ONE__Sounds_to_Table_dtw);
 
 	praat_addAction1 (classSound, 1, U"Filter (gammatone)...", U"Filter (de-emphasis)...", 1, 
 			CONVERT_EACH_TO_ONE__Sound_filterByGammaToneFilter4);
@@ -782,11 +782,14 @@ DO
 	CONVERT_EACH_TO_ONE_END (my name.get())
 }
 
-DIRECT (CONVERT_EACH_TO_ONE__KlattGrid_to_Sound) {
-	CONVERT_EACH_TO_ONE (KlattGrid)
-		KlattGrid_setDefaultPlayOptions (me);
-		autoSound result = KlattGrid_to_Sound (me);
-	CONVERT_EACH_TO_ONE_END (my name.get())
+DIRECT (CONVERT_ALL_TO_MULTIPLE__KlattGrids_to_Sounds) {
+	CONVERT_ALL_TO_MULTIPLE (KlattGrid)
+		for (integer igrid = 1; igrid <= list.size; igrid ++)
+			KlattGrid_setDefaultPlayOptions (list.at [igrid]);
+		autoSoundList sounds = KlattGrids_to_Sounds (& list);
+		for (integer igrid = 1; igrid <= list.size; igrid ++)
+			praat_new (sounds -> subtractItem_move (1), list.at [igrid] -> name.get());
+	CONVERT_ALL_TO_MULTIPLE_END
 }
 
 FORM (PLAY_KlattGrid_playSpecial, U"KlattGrid: Play special", U"KlattGrid: Play special...") {
@@ -1007,7 +1010,7 @@ void praat_KlattGrid_init () {
 	praat_addAction1 (classKlattGrid, 0, U"Play special...", nullptr, 0,
 			PLAY_KlattGrid_playSpecial);
 	praat_addAction1 (classKlattGrid, 0, U"To Sound", nullptr, 0,
-			CONVERT_EACH_TO_ONE__KlattGrid_to_Sound);
+			CONVERT_ALL_TO_MULTIPLE__KlattGrids_to_Sounds);
 	praat_addAction1 (classKlattGrid, 0, U"To Sound (special)...", nullptr, 0,
 			CONVERT_EACH_TO_ONE__KlattGrid_to_Sound_special);
 	praat_addAction1 (classKlattGrid, 0, U"To Sound (phonation)...", nullptr, 0,
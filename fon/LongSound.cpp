@@ -43,9 +43,14 @@
 
 #include "LongSound.h"
 #include "Preferences.h"
+#include "SoundResampler.h"
 #define FLAC__NO_DLL
 #include "../external/flac/flac_FLAC_stream_decoder.h"
 #include "../external/mp3/mp3.h"
+#if defined (UNIX) || defined (macintosh)
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
 
 Thing_implement (LongSound, SampledXY, 0);
 Thing_implement (SoundAndLongSoundList, Ordered, 0);
@@ -58,9 +63,11 @@ constexpr integer defaultBufferDuration = 600;   // seconds
 constexpr integer maximumBufferDuration = 10000;   // seconds
 
 static integer prefs_bufferLength;
+static bool prefs_saveOverviewFiles;
 
 void LongSound_preferences () {
 	Preferences_addInteger (U"LongSound.bufferLength2", & prefs_bufferLength, defaultBufferDuration);
+	Preferences_addBool (U"LongSound.saveOverviewFiles", & prefs_saveOverviewFiles, false);
 }
 
 integer LongSound_getBufferSizePref_seconds () {
@@ -71,12 +78,60 @@ void LongSound_setBufferSizePref_seconds (const integer size) {
 	prefs_bufferLength = Melder_clipped (minimumBufferDuration, size, maximumBufferDuration);
 }
 
+bool LongSound_getSaveOverviewFilesPref () {
+	return prefs_saveOverviewFiles;
+}
+
+void LongSound_setSaveOverviewFilesPref (const bool save) {
+	prefs_saveOverviewFiles = save;
+}
+
+/*
+	Drawing an overview of a long window, or scaling it, requires the extrema of very many samples.
+	To make this fast, we maintain a pyramid of block extrema per LongSound.
+	On level 1, each block contains `peaks_BASE_BLOCK_SIZE` samples (the last block may be shorter);
+	each block on a higher level contains two blocks of the level below,
+	so that the top level consists of a single block that contains the whole sound.
+	For each block and channel, the pyramid stores the minimum and maximum 16-bit sample value.
+	These are computed only when first needed:
+	on level 1 from the samples, on the higher levels from the two blocks underneath.
+
+	The extrema of any stretch of samples can then be combined from at most two blocks per level,
+	plus fewer than two blocks' worth of samples at the edges.
+
+	If the user prefers so, the level-1 extrema are saved into an "overview file"
+	next to the sound file, as soon as all of them have been computed;
+	this file is read back when the sound file is opened again.
+*/
+constexpr integer peaks_BASE_BLOCK_SIZE = 1024;   // samples
+constexpr integer peaks_MAXIMUM_NUMBER_OF_LEVELS = 64;
+constexpr integer peaks_MAXIMUM_NUMBER_OF_BLOCKS_PER_READ = 256;
+static const char peaks_FILE_HEADER [] = "PraatOverviewFile 1\n";
+
+struct LongSound_PeakPyramid {
+	integer numberOfLevels;
+	integer numberOfBlocks [1+peaks_MAXIMUM_NUMBER_OF_LEVELS];
+	/*
+		The extrema of block `iblock` in channel `ichan`
+		are at index (iblock - 1) * numberOfChannels + ichan.
+	*/
+	autovector <int16> minima [1+peaks_MAXIMUM_NUMBER_OF_LEVELS], maxima [1+peaks_MAXIMUM_NUMBER_OF_LEVELS];
+	autoBOOLVEC isComputed [1+peaks_MAXIMUM_NUMBER_OF_LEVELS];
+	integer numberOfComputedBaseBlocks;
+	bool hasBeenSaved;
+};
+
 void structLongSound :: v9_destroy () noexcept {
 	/*
 		The play callback may contain a pointer to my buffer.
 		That pointer is about to dangle, so kill the playback.
 	*/
 	MelderAudio_stopPlaying (MelderAudio_IMPLICIT);
+	delete peaks;
+	#if defined (UNIX) || defined (macintosh)
+		if (mappedFile)
+			munmap ((void *) mappedFile, size_t (mappedFileSize));
+	#endif
 	if (mp3f)
 		mp3f_delete (mp3f);
 	if (flacDecoder) {
@@ -107,6 +162,7 @@ void structLongSound :: v1_info () {
 	MelderInfo_writeLine (U"Sampling frequency: ", sampleRate, U" Hz");
 	MelderInfo_writeLine (U"Size: ", nx, U" samples");
 	MelderInfo_writeLine (U"Start of sample data: ", startOfData, U" bytes from the start of the file");
+	MelderInfo_writeLine (U"Read from memory-mapped file: ", Melder_boolean (!! mappedFile));
 }
 
 static void _LongSound_FLAC_convertFloats (LongSound me, const int32 * const samples[], const integer bitsPerSample, const integer numberOfSamples) {
@@ -205,6 +261,38 @@ static void _LongSound_MP3_convert (const MP3F_SAMPLE *channels [MP3F_MAX_CHANNE
 	my compressedSamplesLeft -= numberOfSamples;
 }
 
+/*
+	Map the whole file if all its samples can be decoded from memory.
+	Failure is not an error: the samples are then read from the open file as before.
+	A file that is shorter than its header claims is not mapped either,
+	so that reading it still warns about the missing samples.
+*/
+static void _LongSound_MAPPED_open (LongSound me) {
+	my mappedFile = nullptr;
+	my mappedFileSize = 0;
+	if (! Melder_canDecodeAudioFromMemory (my encoding))
+		return;
+	#if defined (UNIX) || defined (macintosh)
+		const integer numberOfBytesNeeded = my startOfData + my nx * my numberOfChannels * my numberOfBytesPerSamplePoint;
+		const int fileDescriptor = fileno (my f);
+		struct stat fileStatus;
+		if (fstat (fileDescriptor, & fileStatus) != 0 || fileStatus.st_size < numberOfBytesNeeded)
+			return;
+		if ((double) numberOfBytesNeeded > (double) SIZE_MAX)
+			return;   // a 32-bit edition cannot map files of more than 4 gigabytes
+		void *mapping = mmap (nullptr, size_t (numberOfBytesNeeded), PROT_READ, MAP_SHARED, fileDescriptor, 0);
+		if (mapping == MAP_FAILED)
+			return;
+		my mappedFile = (const uint8 *) mapping;
+		my mappedFileSize = numberOfBytesNeeded;
+	#endif
+}
+
+static const uint8 *_LongSound_MAPPED_samplePointer (LongSound me, const integer firstSample, const integer numberOfSamples) {
+	Melder_assert (firstSample >= 1 && firstSample + numberOfSamples - 1 <= my nx);
+	return my mappedFile + my startOfData + (firstSample - 1) * my numberOfChannels * my numberOfBytesPerSamplePoint;
+}
+
 static void LongSound_init (LongSound me, constMelderFile file) {
 	MelderFile_copy (file, & my file);
 	MelderFile_open (& my file);
@@ -226,6 +314,7 @@ static void LongSound_init (LongSound me, constMelderFile file) {
 	my dy = 1.0;
 	my y1 = 1.0;
 	my numberOfBytesPerSamplePoint = Melder_bytesPerSamplePoint (my encoding);
+	_LongSound_MAPPED_open (me);
 	my bufferLength = prefs_bufferLength;
 	for (;;) {
 		my nmax = my bufferLength * my sampleRate * (1 + 3 * MARGIN);
@@ -261,6 +350,8 @@ static void LongSound_init (LongSound me, constMelderFile file) {
 void structLongSound :: v1_copy (Daata thee_Daata) const {
 	LongSound thee = static_cast <LongSound> (thee_Daata);
 	thy f = nullptr;
+	thy mappedFile = nullptr;   // this may have been shallow-copied; the copy maps the file itself
+	thy peaks = nullptr;   // this may have been shallow-copied; the copy computes its own peaks
 	thy buffer.releaseToAmbiguousOwner();   // this may have been shallow-copied, so undangle and nullify
 	LongSound_init (thee, & our file);   // this recreates a new buffer
 }
@@ -326,6 +417,8 @@ void LongSound_readAudioToFloat (LongSound me, const MAT buffer, const integer f
 			my compressedFloats [ichan - 1] = & buffer [ichan] [1];
 		}
 		_LongSound_MP3_process (me, firstSample, buffer.ncol);
+	} else if (my mappedFile) {
+		Melder_decodeAudioToFloat (_LongSound_MAPPED_samplePointer (me, firstSample, buffer.ncol), my encoding, buffer);
 	} else {
 		_LongSound_FILE_seekSample (me, firstSample);
 		Melder_readAudioToFloat (& my file, my encoding, buffer);
@@ -337,6 +430,9 @@ void LongSound_readAudioToShort (LongSound me, int16 *buffer, const integer firs
 		_LongSound_FLAC_readAudioToShort (me, buffer, firstSample, numberOfSamples);
 	} else if (my encoding == Melder_MPEG_COMPRESSION_16) {
 		_LongSound_MP3_readAudioToShort (me, buffer, firstSample, numberOfSamples);
+	} else if (my mappedFile) {
+		Melder_decodeAudioToShort (_LongSound_MAPPED_samplePointer (me, firstSample, numberOfSamples),
+				my numberOfChannels, my encoding, buffer, numberOfSamples);
 	} else {
 		_LongSound_FILE_seekSample (me, firstSample);
 		Melder_readAudioToShort (& my file, my numberOfChannels, my encoding, buffer, numberOfSamples);
@@ -422,6 +518,54 @@ void LongSound_saveChannelAsAudioFile (LongSound me, int audioFileType, integer
 	}
 }
 
+void LongSound_saveAsResampledAudioFile (LongSound me, int audioFileType, double samplingFrequency, integer precision,
+	MelderFile file, int numberOfBitsPerSamplePoint)
+{
+	try {
+		if (! SoundResampler_canResample (my sampleRate, samplingFrequency, precision))
+			Melder_throw (U"Cannot resample from ", my sampleRate, U" Hz to ", samplingFrequency, U" Hz with precision ", precision,
+				U". The ratio of the sampling frequencies should be a simple fraction, and the precision should be at least 3.");
+		const integer numberOfSamples = Melder_iround ((my xmax - my xmin) * samplingFrequency);
+		if (numberOfSamples < 1)
+			Melder_throw (U"The resampled sound would have no samples.");
+		const double firstTime = 0.5 * (my xmin + my xmax - (numberOfSamples - 1) / samplingFrequency);
+		autoSoundResampler resampler = SoundResampler_create (my numberOfChannels, my sampleRate, samplingFrequency, precision,
+				Sampled_xToIndex (me, firstTime));
+		const integer blockSize = my nmax;
+		autoMAT input = raw_MAT (my numberOfChannels, blockSize);
+		autoMAT output = raw_MAT (my numberOfChannels, blockSize);
+		const int encoding = Melder_defaultAudioFileEncoding (audioFileType, numberOfBitsPerSamplePoint);
+		autoMelderFile mfile = MelderFile_create (file);
+		MelderFile_writeAudioFileHeader (file, audioFileType, Melder_iround (samplingFrequency), numberOfSamples, my numberOfChannels, numberOfBitsPerSamplePoint);
+		integer numberOfSamplesWritten = 0;
+		auto writeAvailableOutput = [&] () {
+			while (numberOfSamplesWritten < numberOfSamples) {
+				const integer numberOfWantedSamples = std::min (blockSize, numberOfSamples - numberOfSamplesWritten);
+				const integer numberOfOutputSamples = SoundResampler_getOutput (resampler.get(), output.verticalBand (1, numberOfWantedSamples));
+				if (numberOfOutputSamples == 0)
+					break;
+				MelderFile_writeFloatToAudio (file, output.verticalBand (1, numberOfOutputSamples), encoding, true);
+				numberOfSamplesWritten += numberOfOutputSamples;
+			}
+		};
+		for (integer firstSample = 1; firstSample <= my nx; firstSample += blockSize) {
+			const integer numberOfInputSamples = std::min (blockSize, my nx - firstSample + 1);
+			if (numberOfInputSamples < blockSize)
+				input = raw_MAT (my numberOfChannels, numberOfInputSamples);   // LongSound_readAudioToFloat reads input.ncol samples
+			LongSound_readAudioToFloat (me, input.get(), firstSample);
+			SoundResampler_putInput (resampler.get(), input.all());
+			writeAvailableOutput ();
+		}
+		SoundResampler_endInput (resampler.get());
+		writeAvailableOutput ();
+		Melder_assert (numberOfSamplesWritten == numberOfSamples);
+		MelderFile_writeAudioFileTrailer (file, audioFileType, Melder_iround (samplingFrequency), numberOfSamples, my numberOfChannels, numberOfBitsPerSamplePoint);
+		mfile.close ();
+	} catch (MelderError) {
+		Melder_throw (me, U": not written to resampled sound file ", file, U".");
+	}
+}
+
 static void _LongSound_haveSamples (LongSound me, integer imin, integer imax) {
 	integer n = imax - imin + 1;
 	Melder_assert (n <= my nmax);
@@ -516,27 +660,304 @@ bool LongSound_haveWindow (LongSound me, double tmin, double tmax) {
 	return true;
 }
 
+/*
+	Call `action (isample, value)` for each sample imin..imax in one channel,
+	taking the samples from the buffer if they are there, and reading them in chunks otherwise.
+*/
+template <typename Action>
+static void _LongSound_forEachSample (LongSound me, const integer channel, const integer imin, const integer imax, Action action) {
+	if (imin >= my imin && imax <= my imax) {
+		for (integer isample = imin; isample <= imax; isample ++)
+			action (isample, my buffer [(isample - my imin) * my numberOfChannels + channel]);
+		return;
+	}
+	const integer numberOfSamplesPerChunk = std::max (1_integer, 65536 / my numberOfChannels);
+	autovector <int16> chunk = newvectorraw <int16> (numberOfSamplesPerChunk * my numberOfChannels);
+	for (integer ifirst = imin; ifirst <= imax; ifirst += numberOfSamplesPerChunk) {
+		const integer numberOfSamples = std::min (numberOfSamplesPerChunk, imax - ifirst + 1);
+		LongSound_readAudioToShort (me, chunk.asArgumentToFunctionThatExpectsZeroBasedArray(), ifirst, numberOfSamples);
+		for (integer i = 0; i < numberOfSamples; i ++)
+			action (ifirst + i, chunk [i * my numberOfChannels + channel]);
+	}
+}
+
+static void _LongSound_getSampleExtrema (LongSound me, const integer channel, const integer imin, const integer imax,
+	integer *minimum, integer *maximum)
+{
+	_LongSound_forEachSample (me, channel, imin, imax, [&] (integer /* isample */, const integer value) {
+		if (value < *minimum)
+			*minimum = value;
+		if (value > *maximum)
+			*maximum = value;
+	});
+}
+
+static void _LongSound_PEAKS_save (LongSound me, LongSound_PeakPyramid *peaks, MelderFile peakFile) {
+	autofile f = Melder_fopen (peakFile, "wb");
+	fwrite (peaks_FILE_HEADER, 1, strlen (peaks_FILE_HEADER), f);
+	binputr64 (my nx, f);
+	binputi32 (my numberOfChannels, f);
+	binputr64 (my sampleRate, f);
+	binputi32 (my encoding, f);
+	binputr64 (my startOfData, f);
+	binputi32 (peaks_BASE_BLOCK_SIZE, f);
+	const integer numberOfValues = peaks -> numberOfBlocks [1] * my numberOfChannels;
+	for (integer ivalue = 1; ivalue <= numberOfValues; ivalue ++) {
+		binputi16 (peaks -> minima [1] [ivalue], f);
+		binputi16 (peaks -> maxima [1] [ivalue], f);
+	}
+	f.close (peakFile);
+}
+
+static void _LongSound_PEAKS_getFile (LongSound me, MelderFile peakFile) {
+	Melder_pathToFile (Melder_cat (Melder_fileToPath (& my file), U".overview"), peakFile);
+}
+
+static void _LongSound_PEAKS_computeBaseBlocks (LongSound me, LongSound_PeakPyramid *peaks, const integer firstBlock, const integer lastBlock) {
+	const integer firstSample = (firstBlock - 1) * peaks_BASE_BLOCK_SIZE + 1;
+	const integer lastSample = std::min (lastBlock * peaks_BASE_BLOCK_SIZE, my nx);
+	const integer numberOfSamples = lastSample - firstSample + 1;
+	autovector <int16> samples = newvectorraw <int16> (numberOfSamples * my numberOfChannels);
+	LongSound_readAudioToShort (me, samples.asArgumentToFunctionThatExpectsZeroBasedArray(), firstSample, numberOfSamples);
+	for (integer iblock = firstBlock; iblock <= lastBlock; iblock ++) {
+		const integer firstSampleInBlock = (iblock - firstBlock) * peaks_BASE_BLOCK_SIZE;   // base-0
+		const integer endOfBlock = std::min (firstSampleInBlock + peaks_BASE_BLOCK_SIZE, numberOfSamples);
+		for (integer ichan = 1; ichan <= my numberOfChannels; ichan ++) {
+			int16 minimum = 32767, maximum = -32768;
+			for (integer isample = firstSampleInBlock; isample < endOfBlock; isample ++) {
+				const int16 value = samples [isample * my numberOfChannels + ichan];
+				if (value < minimum)
+					minimum = value;
+				if (value > maximum)
+					maximum = value;
+			}
+			peaks -> minima [1] [(iblock - 1) * my numberOfChannels + ichan] = minimum;
+			peaks -> maxima [1] [(iblock - 1) * my numberOfChannels + ichan] = maximum;
+		}
+		if (! peaks -> isComputed [1] [iblock]) {
+			peaks -> isComputed [1] [iblock] = true;
+			peaks -> numberOfComputedBaseBlocks += 1;
+		}
+	}
+	if (prefs_saveOverviewFiles && ! peaks -> hasBeenSaved && peaks -> numberOfComputedBaseBlocks == peaks -> numberOfBlocks [1]) {
+		peaks -> hasBeenSaved = true;   // even if saving fails, because we should not try again at every redraw
+		try {
+			structMelderFile peakFile { };
+			_LongSound_PEAKS_getFile (me, & peakFile);
+			_LongSound_PEAKS_save (me, peaks, & peakFile);
+		} catch (MelderError) {
+			Melder_clearError ();   // e.g. a read-only folder; the overview file is only a convenience
+		}
+	}
+}
+
+/*
+	Read the level-1 extrema from an overview file, if there is one that belongs to this sound file.
+	As a check that the sound file has not been replaced, the first and last blocks are recomputed.
+*/
+static void _LongSound_PEAKS_tryToRead (LongSound me, LongSound_PeakPyramid *peaks) {
+	structMelderFile peakFile { };
+	_LongSound_PEAKS_getFile (me, & peakFile);
+	if (! MelderFile_exists (& peakFile))
+		return;
+	try {
+		autofile f = Melder_fopen (& peakFile, "rb");
+		char header [sizeof peaks_FILE_HEADER];
+		const size_t headerLength = strlen (peaks_FILE_HEADER);
+		if (fread (header, 1, headerLength, f) != headerLength || strncmp (header, peaks_FILE_HEADER, headerLength) != 0)
+			return;
+		if (bingetr64 (f) != my nx || bingeti32 (f) != my numberOfChannels || bingetr64 (f) != my sampleRate ||
+			bingeti32 (f) != my encoding || bingetr64 (f) != my startOfData || bingeti32 (f) != peaks_BASE_BLOCK_SIZE)
+			return;
+		const integer numberOfValues = peaks -> numberOfBlocks [1] * my numberOfChannels;
+		for (integer ivalue = 1; ivalue <= numberOfValues; ivalue ++) {
+			peaks -> minima [1] [ivalue] = bingeti16 (f);
+			peaks -> maxima [1] [ivalue] = bingeti16 (f);
+		}
+		f.close (& peakFile);
+		const integer lastBlock = peaks -> numberOfBlocks [1];
+		autovector <int16> savedExtrema = newvectorraw <int16> (4 * my numberOfChannels);
+		for (integer ichan = 1; ichan <= my numberOfChannels; ichan ++) {
+			savedExtrema [ichan] = peaks -> minima [1] [ichan];
+			savedExtrema [my numberOfChannels + ichan] = peaks -> maxima [1] [ichan];
+			savedExtrema [2 * my numberOfChannels + ichan] = peaks -> minima [1] [(lastBlock - 1) * my numberOfChannels + ichan];
+			savedExtrema [3 * my numberOfChannels + ichan] = peaks -> maxima [1] [(lastBlock - 1) * my numberOfChannels + ichan];
+		}
+		peaks -> hasBeenSaved = true;   // so that recomputing the check blocks does not save the file again
+		_LongSound_PEAKS_computeBaseBlocks (me, peaks, 1, 1);
+		_LongSound_PEAKS_computeBaseBlocks (me, peaks, lastBlock, lastBlock);
+		for (integer ichan = 1; ichan <= my numberOfChannels; ichan ++) {
+			if (savedExtrema [ichan] != peaks -> minima [1] [ichan] ||
+				savedExtrema [my numberOfChannels + ichan] != peaks -> maxima [1] [ichan] ||
+				savedExtrema [2 * my numberOfChannels + ichan] != peaks -> minima [1] [(lastBlock - 1) * my numberOfChannels + ichan] ||
+				savedExtrema [3 * my numberOfChannels + ichan] != peaks -> maxima [1] [(lastBlock - 1) * my numberOfChannels + ichan])
+			{
+				peaks -> isComputed [1] [1] = peaks -> isComputed [1] [lastBlock] = false;
+				peaks -> numberOfComputedBaseBlocks = 0;
+				peaks -> hasBeenSaved = false;   // so that the stale file will be replaced
+				return;
+			}
+		}
+		for (integer iblock = 1; iblock <= lastBlock; iblock ++)
+			peaks -> isComputed [1] [iblock] = true;
+		peaks -> numberOfComputedBaseBlocks = lastBlock;
+	} catch (MelderError) {
+		Melder_clearError ();   // a damaged overview file is simply ignored
+		for (integer iblock = 1; iblock <= peaks -> numberOfBlocks [1]; iblock ++)
+			peaks -> isComputed [1] [iblock] = false;
+		peaks -> numberOfComputedBaseBlocks = 0;
+		peaks -> hasBeenSaved = false;
+	}
+}
+
+static LongSound_PeakPyramid *_LongSound_PEAKS_get (LongSound me) {
+	if (my peaks)
+		return my peaks;
+	std::unique_ptr <LongSound_PeakPyramid> peaks (new LongSound_PeakPyramid ());
+	integer numberOfBlocks = (my nx - 1) / peaks_BASE_BLOCK_SIZE + 1;
+	for (integer ilevel = 1; ilevel <= peaks_MAXIMUM_NUMBER_OF_LEVELS; ilevel ++) {
+		peaks -> numberOfLevels = ilevel;
+		peaks -> numberOfBlocks [ilevel] = numberOfBlocks;
+		peaks -> minima [ilevel] = newvectorraw <int16> (numberOfBlocks * my numberOfChannels);
+		peaks -> maxima [ilevel] = newvectorraw <int16> (numberOfBlocks * my numberOfChannels);
+		peaks -> isComputed [ilevel] = zero_BOOLVEC (numberOfBlocks);
+		if (numberOfBlocks == 1)
+			break;
+		numberOfBlocks = (numberOfBlocks + 1) / 2;
+	}
+	if (prefs_saveOverviewFiles)
+		_LongSound_PEAKS_tryToRead (me, peaks.get());
+	my peaks = peaks.release();
+	return my peaks;
+}
+
+static void _LongSound_PEAKS_haveBlock (LongSound me, LongSound_PeakPyramid *peaks, const integer level, const integer iblock) {
+	if (peaks -> isComputed [level] [iblock])
+		return;
+	if (level == 1) {
+		/*
+			Compute a stretch of blocks at once,
+			because reading the samples of single blocks would be slow for compressed files.
+		*/
+		const integer lastBlockToRead = std::min (iblock + peaks_MAXIMUM_NUMBER_OF_BLOCKS_PER_READ - 1, peaks -> numberOfBlocks [1]);
+		integer lastBlock = iblock;
+		while (lastBlock < lastBlockToRead && ! peaks -> isComputed [1] [lastBlock + 1])
+			lastBlock ++;
+		_LongSound_PEAKS_computeBaseBlocks (me, peaks, iblock, lastBlock);
+		return;
+	}
+	const integer firstChild = 2 * iblock - 1, lastChild = std::min (2 * iblock, peaks -> numberOfBlocks [level - 1]);
+	for (integer ichild = firstChild; ichild <= lastChild; ichild ++)
+		_LongSound_PEAKS_haveBlock (me, peaks, level - 1, ichild);
+	for (integer ichan = 1; ichan <= my numberOfChannels; ichan ++) {
+		int16 minimum = 32767, maximum = -32768;
+		for (integer ichild = firstChild; ichild <= lastChild; ichild ++) {
+			const integer childIndex = (ichild - 1) * my numberOfChannels + ichan;
+			if (peaks -> minima [level - 1] [childIndex] < minimum)
+				minimum = peaks -> minima [level - 1] [childIndex];
+			if (peaks -> maxima [level - 1] [childIndex] > maximum)
+				maximum = peaks -> maxima [level - 1] [childIndex];
+		}
+		peaks -> minima [level] [(iblock - 1) * my numberOfChannels + ichan] = minimum;
+		peaks -> maxima [level] [(iblock - 1) * my numberOfChannels + ichan] = maximum;
+	}
+	peaks -> isComputed [level] [iblock] = true;
+}
+
+/*
+	The extrema of the level-1 blocks firstBlock..lastBlock,
+	combined from the largest blocks that fit: at most two per level.
+*/
+static void _LongSound_PEAKS_getBlockExtrema (LongSound me, const integer channel, integer firstBlock, integer lastBlock,
+	integer *minimum, integer *maximum)
+{
+	LongSound_PeakPyramid *peaks = _LongSound_PEAKS_get (me);
+	auto include = [&] (const integer level, const integer iblock) {
+		_LongSound_PEAKS_haveBlock (me, peaks, level, iblock);
+		const integer index = (iblock - 1) * my numberOfChannels + channel;
+		if (peaks -> minima [level] [index] < *minimum)
+			*minimum = peaks -> minima [level] [index];
+		if (peaks -> maxima [level] [index] > *maximum)
+			*maximum = peaks -> maxima [level] [index];
+	};
+	for (integer level = 1; firstBlock <= lastBlock; level ++) {
+		Melder_assert (level <= peaks -> numberOfLevels);
+		if (firstBlock % 2 == 0)   // the second half of its parent, so the parent would stick out on the left
+			include (level, firstBlock ++);
+		if (lastBlock % 2 == 1 && lastBlock >= firstBlock)   // the first half of its parent, so the parent would stick out on the right
+			include (level, lastBlock --);
+		firstBlock = (firstBlock + 1) / 2;
+		lastBlock = lastBlock / 2;
+	}
+}
+
+/*
+	The exact extrema of samples imin..imax in one channel.
+*/
+static void _LongSound_getExtrema (LongSound me, const integer channel, const integer imin, const integer imax,
+	integer *minimum, integer *maximum)
+{
+	*minimum = 32767;
+	*maximum = -32768;
+	const integer firstWholeBlock = (imin + peaks_BASE_BLOCK_SIZE - 2) / peaks_BASE_BLOCK_SIZE + 1;
+	const integer lastWholeBlock = ( imax == my nx ? (my nx - 1) / peaks_BASE_BLOCK_SIZE + 1 : imax / peaks_BASE_BLOCK_SIZE );
+	if (lastWholeBlock - firstWholeBlock < 2) {
+		_LongSound_getSampleExtrema (me, channel, imin, imax, minimum, maximum);
+		return;
+	}
+	_LongSound_getSampleExtrema (me, channel, imin, (firstWholeBlock - 1) * peaks_BASE_BLOCK_SIZE, minimum, maximum);
+	_LongSound_PEAKS_getBlockExtrema (me, channel, firstWholeBlock, lastWholeBlock, minimum, maximum);
+	_LongSound_getSampleExtrema (me, channel, std::min (lastWholeBlock * peaks_BASE_BLOCK_SIZE, my nx) + 1, imax, minimum, maximum);
+}
+
 void LongSound_getWindowExtrema (LongSound me, double tmin, double tmax, const integer channel, double *minimum, double *maximum) {
 	integer imin, imax;
 	(void) Sampled_getWindowSamples (me, tmin, tmax, & imin, & imax);
 	*minimum = 1.0;
 	*maximum = -1.0;
 	try {
-		LongSound_haveWindow (me, tmin, tmax);
+		integer minimum_int, maximum_int;
+		_LongSound_getExtrema (me, channel, imin, imax, & minimum_int, & maximum_int);
+		*minimum = minimum_int / 32768.0;
+		*maximum = maximum_int / 32768.0;
 	} catch (MelderError) {
 		Melder_clearError ();
+	}
+}
+
+void LongSound_getOverview (LongSound me, const integer channel, const integer imin, const integer imax, INTVEC const& minima, INTVEC const& maxima) {
+	Melder_assert (minima.size == maxima.size);
+	const integer numberOfColumns = minima.size, numberOfSamples = imax - imin + 1;
+	Melder_assert (numberOfColumns >= 1 && numberOfSamples >= numberOfColumns);
+	for (integer icol = 1; icol <= numberOfColumns; icol ++) {
+		minima [icol] = 32767;
+		maxima [icol] = -32768;
+	}
+	if (numberOfSamples < 4 * peaks_BASE_BLOCK_SIZE * numberOfColumns) {
+		/*
+			Few samples per column: these are cheaper to read than the blocks are to compute.
+		*/
+		_LongSound_forEachSample (me, channel, imin, imax, [&] (const integer isample, const integer value) {
+			const integer icol = 1 + (isample - imin) * numberOfColumns / numberOfSamples;
+			if (value < minima [icol])
+				minima [icol] = value;
+			if (value > maxima [icol])
+				maxima [icol] = value;
+		});
 		return;
 	}
-	integer minimum_int = 32767, maximum_int = -32768;
-	for (integer i = imin; i <= imax; i ++) {
-		const integer value = my buffer [(i - my imin) * my numberOfChannels + channel];
-		if (value < minimum_int)
-			minimum_int = value;
-		if (value > maximum_int)
-			maximum_int = value;
+	/*
+		At least four blocks per column:
+		round the column edges to the nearest block edges, so that each column spans three or more whole blocks.
+	*/
+	const integer numberOfBlocks = (my nx - 1) / peaks_BASE_BLOCK_SIZE + 1;
+	for (integer icol = 1; icol <= numberOfColumns; icol ++) {
+		const integer firstSample = imin + (icol - 1) * numberOfSamples / numberOfColumns;
+		const integer lastSample = imin + icol * numberOfSamples / numberOfColumns - 1;
+		const integer firstBlock = (firstSample - 1 + peaks_BASE_BLOCK_SIZE / 2) / peaks_BASE_BLOCK_SIZE + 1;
+		const integer lastBlock = std::min ((lastSample + peaks_BASE_BLOCK_SIZE / 2) / peaks_BASE_BLOCK_SIZE, numberOfBlocks);
+		_LongSound_PEAKS_getBlockExtrema (me, channel, firstBlock, lastBlock, & minima [icol], & maxima [icol]);
 	}
-	*minimum = minimum_int / 32768.0;
-	*maximum = maximum_int / 32768.0;
 }
 
 static struct LongSoundPlay {
@@ -567,7 +988,13 @@ void LongSound_playPart (LongSound me, double startTime, double endTime, Sound_P
 	MelderAudio_stopPlaying (MelderAudio_IMPLICIT);
 	Melder_free (thy resampledBuffer);   // just in case, and after playing has stopped
 	try {
-		const bool fits = LongSound_haveWindow (me, startTime, endTime);
+		/*
+			The whole part goes into a single play buffer, so a memory-mapped file obeys the same size limit
+			as the buffer of the LongSound, although its samples need not be read into that buffer.
+		*/
+		integer i1, i2;
+		const integer n = Sampled_getWindowSamples (me, startTime, endTime, & i1, & i2);
+		const bool fits = ( my mappedFile ? (1.0 + 2 * MARGIN) * n + 1 <= my nmax : LongSound_haveWindow (me, startTime, endTime) );
 		if (! fits)
 			Melder_throw (U"Sound too long (", endTime - startTime, U" seconds).");
 		/*
@@ -577,8 +1004,6 @@ void LongSound_playPart (LongSound me, double startTime, double endTime, Sound_P
 		thy endTime = endTime;
 		thy playCallback = playCallback;
 		thy playBoss = playBoss;
-		integer i1, i2;
-		const integer n = Sampled_getWindowSamples (me, startTime, endTime, & i1, & i2);
 		if (n < 2)
 			return;
 		const integer bestSampleRate = MelderAudio_getOutputBestSampleRate (my sampleRate);
@@ -594,9 +1019,13 @@ void LongSound_playPart (LongSound me, double startTime, double endTime, Sound_P
 				thy playCallback (thy playBoss, 1, startTime, endTime, startTime);
 			if (thy silenceBefore > 0 || thy silenceAfter > 0 || 1) {
 				thy resampledBuffer = Melder_calloc (int16, (thy silenceBefore + thy numberOfSamples + thy silenceAfter) * my numberOfChannels);
-				memcpy (& thy resampledBuffer [thy silenceBefore * my numberOfChannels],
-						my buffer.asArgumentToFunctionThatExpectsZeroBasedArray() + (i1 - my imin) * my numberOfChannels,
-						thy numberOfSamples * sizeof (int16) * my numberOfChannels);
+				if (my mappedFile)
+					Melder_decodeAudioToShort (_LongSound_MAPPED_samplePointer (me, i1, thy numberOfSamples), my numberOfChannels, my encoding,
+							& thy resampledBuffer [thy silenceBefore * my numberOfChannels], thy numberOfSamples);
+				else
+					memcpy (& thy resampledBuffer [thy silenceBefore * my numberOfChannels],
+							my buffer.asArgumentToFunctionThatExpectsZeroBasedArray() + (i1 - my imin) * my numberOfChannels,
+							thy numberOfSamples * sizeof (int16) * my numberOfChannels);
 				MelderAudio_play16 (thy resampledBuffer, my sampleRate, thy silenceBefore + thy numberOfSamples + thy silenceAfter,
 						my numberOfChannels, melderPlayCallback, thee);
 			} else {
@@ -609,7 +1038,20 @@ void LongSound_playPart (LongSound me, double startTime, double endTime, Sound_P
 			const integer silenceBefore = Melder_iroundTowardsZero (newSampleRate * MelderAudio_getOutputSilenceBefore ());
 			const integer silenceAfter = Melder_iroundTowardsZero (newSampleRate * MelderAudio_getOutputSilenceAfter ());
 			int16 *resampledBuffer = Melder_calloc (int16, (silenceBefore + newN + silenceAfter) * my numberOfChannels);
-			int16 *from = my buffer.asArgumentToFunctionThatExpectsZeroBasedArray() + (i1 - my imin) * my numberOfChannels;   // guaranteed: from [0 .. (my imax - my imin + 1) * nchan]
+			autovector <int16> decodedSamples;
+			const int16 *from;
+			if (my mappedFile) {
+				/*
+					Decode one sample beyond the window if there is one, because the interpolation may look there.
+				*/
+				const integer numberOfSamplesToDecode = std::min (n + 1, my nx - i1 + 1);
+				decodedSamples = newvectorzero <int16> ((n + 1) * my numberOfChannels);
+				Melder_decodeAudioToShort (_LongSound_MAPPED_samplePointer (me, i1, numberOfSamplesToDecode), my numberOfChannels, my encoding,
+						decodedSamples.asArgumentToFunctionThatExpectsZeroBasedArray(), numberOfSamplesToDecode);
+				from = decodedSamples.asArgumentToFunctionThatExpectsZeroBasedArray();
+			} else {
+				from = my buffer.asArgumentToFunctionThatExpectsZeroBasedArray() + (i1 - my imin) * my numberOfChannels;   // guaranteed: from [0 .. (my imax - my imin + 1) * nchan]
+			}
 			const double t1 = my x1, dt = 1.0 / newSampleRate;
 			thy numberOfSamples = newN;
 			thy dt = dt;
@@ -27,6 +27,7 @@
 struct FLAC__StreamDecoder;
 struct FLAC__StreamEncoder;
 struct _MP3_FILE;
+struct LongSound_PeakPyramid;
 
 Thing_define (LongSound, SampledXY) {
 	structMelderFile file;
@@ -42,6 +43,19 @@ Thing_define (LongSound, SampledXY) {
 	integer imin, imax;
 	void invalidateBuffer () noexcept { our imin = 1; our imax = 0; }
 
+	/*
+		An uncompressed file is mapped into memory if the platform allows,
+		so that its samples can be decoded straight from the file's pages.
+	*/
+	const uint8 *mappedFile;   // null if the file is not mapped
+	integer mappedFileSize;   // in bytes
+
+	/*
+		Minima and maxima of blocks of samples, for drawing overviews of long windows;
+		null until the first overview or extremum of a long window is requested.
+	*/
+	struct LongSound_PeakPyramid *peaks;
+
 	struct FLAC__StreamDecoder *flacDecoder;
 	struct _MP3_FILE *mp3f;
 	int compressedMode;
@@ -72,10 +86,26 @@ bool LongSound_haveWindow (LongSound me, double tmin, double tmax);
 
 void LongSound_getWindowExtrema (LongSound me, double tmin, double tmax, integer channel, double *minimum, double *maximum);
 
+void LongSound_getOverview (LongSound me, integer channel, integer imin, integer imax, INTVEC const& minima, INTVEC const& maxima);
+/*
+	For drawing samples imin..imax of one channel in `minima.size` columns:
+	the minimum and maximum 16-bit sample value in each column.
+	For windows with many samples per column, the time taken is proportional to the number of columns,
+	not to the number of samples, because the extrema come from a pyramid of block extrema
+	that is computed once, when first needed.
+	The columns may then be stretched or shrunk to whole blocks, i.e. by a few thousandths of a second.
+*/
+
 void LongSound_playPart (LongSound me, double startTime, double endTime, Sound_PlayCallback playCallback, Thing playBoss);
 
 void LongSound_savePartAsAudioFile (LongSound me, int audioFileType, double tmin, double tmax, MelderFile file, int numberOfBitsPerSamplePoint);
 void LongSound_saveChannelAsAudioFile (LongSound me, int audioFileType, integer channel, MelderFile file);
+void LongSound_saveAsResampledAudioFile (LongSound me, int audioFileType, double samplingFrequency, integer precision,
+	MelderFile file, int numberOfBitsPerSamplePoint);
+/*
+	Streams the whole LongSound through a SoundResampler, so that the result does not have to fit into memory.
+	The resampled samples lie at the same times as those of Sound_resample ().
+*/
 
 void LongSound_readAudioToFloat (LongSound me, MAT buffer, integer firstSample);
 void LongSound_readAudioToShort (LongSound me, int16 *buffer, integer firstSample, integer numberOfSamples);
@@ -88,6 +118,8 @@ void LongSound_concatenate (SoundAndLongSoundList collection, MelderFile file, i
 void LongSound_preferences ();
 integer LongSound_getBufferSizePref_seconds ();
 void LongSound_setBufferSizePref_seconds (integer size);
+bool LongSound_getSaveOverviewFilesPref ();
+void LongSound_setSaveOverviewFilesPref (bool save);
 
 /* End of file LongSound.h */
 #endif
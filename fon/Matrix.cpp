@@ -20,6 +20,7 @@
 #include "NUM2.h"
 #include "Formula.h"
 #include "Eigen.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "Matrix_def.h"
@@ -733,6 +734,32 @@ void Matrix_writeToHeaderlessSpreadsheetFile (const constMatrix me, MelderFile f
 	}
 }
 
+/*
+	A cellwise formula does not depend on the order in which the cells are computed,
+	so the cells can be distributed over threads, in row-major order, in contiguous chunks.
+*/
+static void Matrix_formula_cellwise (mutableMatrix target, integer rowmin, integer rowmax, integer colmin, integer colmax) {
+	if (rowmax < rowmin || colmax < colmin)
+		return;
+	const integer numberOfColumns = colmax - colmin + 1;
+	const integer numberOfCells = (rowmax - rowmin + 1) * numberOfColumns;
+	constexpr integer minimumNumberOfCellsPerTask = 10'000;
+	integer numberOfTasks = ( Melder_debug == -8 ? 1 : numberOfCells / minimumNumberOfCellsPerTask );
+	Melder_clip (1_integer, & numberOfTasks, 2 * MelderThread_getNumberOfThreads ());
+	MelderThread_runTasks (numberOfTasks, [&] (integer itask) {
+		const integer firstCell = (itask - 1) * numberOfCells / numberOfTasks;   // zero-based
+		const integer endCell = itask * numberOfCells / numberOfTasks;
+		integer irow = rowmin + firstCell / numberOfColumns, icol = colmin + firstCell % numberOfColumns;
+		for (integer icell = firstCell; icell < endCell; icell ++) {
+			target -> z [irow] [icol] = Formula_runCellwise (irow, icol);
+			if (++ icol > colmax) {
+				icol = colmin;
+				irow ++;
+			}
+		}
+	});
+}
+
 void Matrix_formula (const mutableMatrix me,
 	conststring32 expression, Interpreter interpreter, /* mutable default */ mutableMatrix target)
 {
@@ -741,6 +768,10 @@ void Matrix_formula (const mutableMatrix me,
 		Formula_Result result;
 		if (! target)
 			target = me;
+		if (Formula_isCellwise ()) {
+			Matrix_formula_cellwise (target, 1, my ny, 1, my nx);
+			return;
+		}
 		for (integer irow = 1; irow <= my ny; irow ++) {
 			for (integer icol = 1; icol <= my nx; icol ++) {
 				Formula_run (irow, icol, & result);
@@ -768,6 +799,10 @@ void Matrix_formula_part (const mutableMatrix me, double xmin, double xmax, doub
 		Formula_Result result;
 		if (! target)
 			target = me;
+		if (Formula_isCellwise ()) {
+			Matrix_formula_cellwise (target, iymin, iymax, ixmin, ixmax);
+			return;
+		}
 		for (integer irow = iymin; irow <= iymax; irow ++) {
 			for (integer icol = ixmin; icol <= ixmax; icol ++) {
 				Formula_run (irow, icol, & result);
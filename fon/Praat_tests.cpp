@@ -29,6 +29,7 @@
 #include "praat.h"
 #include "NUM2.h"
 #include "Sound.h"
+#include "LongSound.h"
 
 #include "enums_getText.h"
 #include "Praat_tests_enums.h"
@@ -61,6 +62,272 @@ static autoMAT constantHH (integer nrow, integer ncol, double value) {
 	return result;
 }
 
+/*
+	The extrema of a LongSound should be those found by scanning the samples of the same file read as a Sound.
+	With 16-bit files, the LongSound's values are exactly the Sound's values times 32768.
+*/
+static void checkLongSoundExtrema (LongSound me, Sound sound, integer numberOfWindows) {
+	constexpr integer blockSize = 1024;   // the smallest blocks of the overview (see LongSound.cpp)
+	auto scan = [&] (integer channel, integer imin, integer imax, integer *minimum, integer *maximum) {
+		const constVECVU samples = sound -> z.row (channel).part (imin, imax);
+		*minimum = Melder_iround (NUMmin_e (samples) * 32768.0);
+		*maximum = Melder_iround (NUMmax_e (samples) * 32768.0);
+	};
+	const integer numberOfWholeBlocks = my nx / blockSize;
+	for (integer iwindow = 1; iwindow <= numberOfWindows; iwindow ++) {
+		const integer channel = NUMrandomInteger (1, my numberOfChannels);
+		integer imin, imax;
+		switch (iwindow % 4) {
+			case 0: {   // anywhere
+				imin = NUMrandomInteger (1, my nx);
+				imax = NUMrandomInteger (imin, my nx);
+			} break;
+			case 1: {   // shorter than three blocks
+				imin = NUMrandomInteger (1, my nx);
+				imax = std::min (imin + NUMrandomInteger (0, 3 * blockSize - 1), my nx);
+			} break;
+			case 2: {   // up to the end, which lies in a partial last block
+				imin = NUMrandomInteger (1, my nx);
+				imax = my nx;
+			} break;
+			default: {   // starting and ending halfway a block
+				const integer firstBlock = NUMrandomInteger (1, numberOfWholeBlocks);
+				const integer lastBlock = NUMrandomInteger (firstBlock, numberOfWholeBlocks);
+				imin = (firstBlock - 1) * blockSize + NUMrandomInteger (2, blockSize);
+				imax = std::max (imin, (lastBlock - 1) * blockSize + NUMrandomInteger (1, blockSize - 1));
+			}
+		}
+		const double tmin = Sampled_indexToX (me, imin) - 0.5 * my dx, tmax = Sampled_indexToX (me, imax) + 0.5 * my dx;
+		integer windowImin, windowImax;
+		Sampled_getWindowSamples (me, tmin, tmax, & windowImin, & windowImax);
+		Melder_assert (windowImin == imin && windowImax == imax);
+		double minimum, maximum;
+		LongSound_getWindowExtrema (me, tmin, tmax, channel, & minimum, & maximum);
+		integer expectedMinimum, expectedMaximum;
+		scan (channel, imin, imax, & expectedMinimum, & expectedMaximum);
+		Melder_require (minimum * 32768.0 == expectedMinimum && maximum * 32768.0 == expectedMaximum,
+			U"The extrema of samples ", imin, U"..", imax, U" in channel ", channel, U" should be ",
+			expectedMinimum, U" and ", expectedMaximum, U", not ", minimum * 32768.0, U" and ", maximum * 32768.0, U".");
+	}
+	/*
+		Overviews with few samples per column are scanned;
+		with many samples per column, the column edges are rounded to the nearest block edges.
+	*/
+	const integer numbersOfColumns [] = { 1, 7, 50, 333 };
+	for (const integer numberOfColumns : numbersOfColumns) {
+		for (integer itry = 1; itry <= 4; itry ++) {
+			const integer channel = NUMrandomInteger (1, my numberOfChannels);
+			const integer imin = ( itry == 1 ? 1 : NUMrandomInteger (1, my nx - numberOfColumns + 1) );
+			const integer imax = ( itry <= 2 ? my nx : NUMrandomInteger (imin + numberOfColumns - 1, my nx) );
+			const integer numberOfSamples = imax - imin + 1;
+			autoINTVEC minima = raw_INTVEC (numberOfColumns), maxima = raw_INTVEC (numberOfColumns);
+			LongSound_getOverview (me, channel, imin, imax, minima.get(), maxima.get());
+			for (integer icol = 1; icol <= numberOfColumns; icol ++) {
+				integer firstSample, lastSample;
+				if (numberOfSamples < 4 * blockSize * numberOfColumns) {
+					/*
+						Sample `isample` goes to column 1 + (isample - imin) * numberOfColumns / numberOfSamples.
+					*/
+					firstSample = imin + ((icol - 1) * numberOfSamples + numberOfColumns - 1) / numberOfColumns;
+					lastSample = imin + (icol * numberOfSamples + numberOfColumns - 1) / numberOfColumns - 1;
+				} else {
+					const integer firstBlock = ((icol - 1) * numberOfSamples / numberOfColumns + imin - 1 + blockSize / 2) / blockSize + 1;
+					const integer lastBlock = std::min ((icol * numberOfSamples / numberOfColumns + imin - 1 + blockSize / 2) / blockSize,
+							(my nx - 1) / blockSize + 1);
+					firstSample = (firstBlock - 1) * blockSize + 1;
+					lastSample = std::min (lastBlock * blockSize, my nx);
+				}
+				integer expectedMinimum, expectedMaximum;
+				scan (channel, firstSample, lastSample, & expectedMinimum, & expectedMaximum);
+				Melder_require (minima [icol] == expectedMinimum && maxima [icol] == expectedMaximum,
+					U"Column ", icol, U" of the ", numberOfColumns, U"-column overview of samples ", imin, U"..", imax,
+					U" in channel ", channel, U" should have extrema ", expectedMinimum, U" and ", expectedMaximum,
+					U", not ", minima [icol], U" and ", maxima [icol], U".");
+			}
+		}
+	}
+}
+
+static autoBYTEVEC readBytes (MelderFile file) {
+	autofile f = Melder_fopen (file, "rb");
+	fseek (f, 0, SEEK_END);
+	const integer numberOfBytes = ftell (f);
+	rewind (f);
+	autoBYTEVEC bytes = raw_BYTEVEC (numberOfBytes);
+	if (numberOfBytes > 0 && (integer) fread (& bytes [1], 1, uinteger (numberOfBytes), f) != numberOfBytes)
+		Melder_throw (U"Cannot read ", file, U".");
+	f.close (file);
+	return bytes;
+}
+
+static void writeBytes (MelderFile file, constBYTEVEC const& bytes) {
+	autofile f = Melder_fopen (file, "wb");
+	if (bytes.size > 0)
+		fwrite (& bytes [1], 1, uinteger (bytes.size), f);
+	f.close (file);
+}
+
+static bool equalBytes (constBYTEVEC const& x, constBYTEVEC const& y) {
+	return x.size == y.size && (x.size == 0 || memcmp (& x [1], & y [1], uinteger (x.size)) == 0);
+}
+
+static void test_LongSound_overview (MelderFile soundFile, integer numberOfWindows) {
+	autoSound sound = Sound_readFromSoundFile (soundFile);
+	{
+		autoLongSound longSound = LongSound_open (soundFile);
+		Melder_require (longSound -> nx == sound -> nx && longSound -> numberOfChannels == sound -> ny && longSound -> nx > 4 * 1024,
+			U"The test needs a sound file of more than four blocks.");
+		checkLongSoundExtrema (longSound.get(), sound.get(), numberOfWindows);
+	}
+	/*
+		The overview file: a 56-byte header, followed by big-endian 16-bit minimum-maximum pairs,
+		block by block and within each block channel by channel.
+	*/
+	structMelderFile overviewFile { };
+	Melder_pathToFile (Melder_cat (Melder_fileToPath (soundFile), U".overview"), & overviewFile);
+	const integer numberOfChannels = sound -> ny, numberOfBlocks = (sound -> nx - 1) / 1024 + 1;
+	auto setExtremumInFile = [&] (BYTEVEC const& bytes, integer iblock, bool maximum, int16 value) {
+		const integer firstByte = 56 + (iblock - 1) * numberOfChannels * 4 + ( maximum ? 2 : 0 ) + 1;
+		bytes [firstByte] = byte (uint16 (value) >> 8);
+		bytes [firstByte + 1] = byte (uint16 (value) & 0xFF);
+	};
+	auto getExtremaOfWholeFirstChannel = [] (LongSound me, double *minimum, double *maximum) {
+		LongSound_getWindowExtrema (me, my xmin, my xmax, 1, minimum, maximum);
+	};
+	const integer expectedMinimum = Melder_iround (NUMmin_e (sound -> z.row (1)) * 32768.0);
+	const integer expectedMaximum = Melder_iround (NUMmax_e (sound -> z.row (1)) * 32768.0);
+	Melder_require (expectedMaximum < 32767,
+		U"The test sound should not be clipped.");
+	const bool savedPref = LongSound_getSaveOverviewFilesPref ();
+	LongSound_setSaveOverviewFilesPref (true);
+	try {
+		if (MelderFile_exists (& overviewFile))
+			MelderFile_delete (& overviewFile);
+		{
+			autoLongSound longSound = LongSound_open (soundFile);
+			double minimum, maximum;
+			getExtremaOfWholeFirstChannel (longSound.get(), & minimum, & maximum);   // computes all the blocks, and therefore saves them
+		}
+		Melder_require (MelderFile_exists (& overviewFile),
+			U"The overview file should have been saved.");
+		autoBYTEVEC const savedBytes = readBytes (& overviewFile);
+		Melder_require (savedBytes.size == 56 + numberOfBlocks * numberOfChannels * 4,
+			U"The overview file should have ", 56 + numberOfBlocks * numberOfChannels * 4, U" bytes, not ", savedBytes.size, U".");
+		/*
+			Round trip: the blocks come from the file if its first and last blocks are right,
+			as we see from a block in the middle that we change.
+		*/
+		autoBYTEVEC changedBytes = copy_BYTEVEC (savedBytes.get());
+		setExtremumInFile (changedBytes.get(), numberOfBlocks / 2, true, 32767);
+		writeBytes (& overviewFile, changedBytes.get());
+		{
+			autoLongSound longSound = LongSound_open (soundFile);
+			double minimum, maximum;
+			getExtremaOfWholeFirstChannel (longSound.get(), & minimum, & maximum);
+			Melder_require (minimum * 32768.0 == expectedMinimum && maximum * 32768.0 == 32767.0,
+				U"The extrema should have come from the overview file.");
+		}
+		Melder_require (equalBytes (readBytes (& overviewFile).get(), changedBytes.get()),
+			U"An overview file that is up to date should not be rewritten.");
+		/*
+			A stale file, i.e. one whose first block does not match the sound file, should be ignored and replaced.
+		*/
+		setExtremumInFile (changedBytes.get(), 1, false, -32768);
+		writeBytes (& overviewFile, changedBytes.get());
+		{
+			autoLongSound longSound = LongSound_open (soundFile);
+			checkLongSoundExtrema (longSound.get(), sound.get(), numberOfWindows / 4);
+			double minimum, maximum;
+			getExtremaOfWholeFirstChannel (longSound.get(), & minimum, & maximum);
+			Melder_require (minimum * 32768.0 == expectedMinimum && maximum * 32768.0 == expectedMaximum,
+				U"The extrema should not have come from a stale overview file.");
+		}
+		Melder_require (equalBytes (readBytes (& overviewFile).get(), savedBytes.get()),
+			U"A stale overview file should have been replaced.");
+		/*
+			A truncated file should be ignored and replaced.
+		*/
+		writeBytes (& overviewFile, savedBytes.part (1, savedBytes.size / 2));
+		{
+			autoLongSound longSound = LongSound_open (soundFile);
+			checkLongSoundExtrema (longSound.get(), sound.get(), numberOfWindows / 4);
+			double minimum, maximum;
+			getExtremaOfWholeFirstChannel (longSound.get(), & minimum, & maximum);
+			Melder_require (minimum * 32768.0 == expectedMinimum && maximum * 32768.0 == expectedMaximum,
+				U"The extrema should not have come from a truncated overview file.");
+		}
+		Melder_require (equalBytes (readBytes (& overviewFile).get(), savedBytes.get()),
+			U"A truncated overview file should have been replaced.");
+		MelderFile_delete (& overviewFile);
+		LongSound_setSaveOverviewFilesPref (savedPref);
+	} catch (MelderError) {
+		LongSound_setSaveOverviewFilesPref (savedPref);
+		throw;
+	}
+	MelderInfo_writeLine (U"LongSound extrema and overview file OK");
+}
+
+static void test_NUMfft_planCache () {
+	const integer savedMaximumMemoryUse = NUMfft_getPlanCacheMaximumMemoryUse ();
+	try {
+		integer numberOfPlans, memoryUse, numberOfHits, numberOfMisses, numberOfEvictions;
+		NUMfft_clearPlanCache ();
+		NUMfft_getPlanCacheStatistics (& numberOfPlans, & memoryUse, & numberOfHits, & numberOfMisses, & numberOfEvictions);
+		Melder_require (numberOfPlans == 0 && memoryUse == 0 && numberOfHits == 0 && numberOfMisses == 0 && numberOfEvictions == 0,
+			U"Clearing the plan cache should reset its statistics.");
+		/*
+			Repeated transforms of the same size compute the plan only once,
+			and give the same result as transforms with the cache switched off.
+		*/
+		const integer sizes [] = { 1000, 1001, 1002 };
+		autoVEC const data = randomGauss_VEC (sizes [0], 0.0, 1.0);
+		autoVEC cached = copy_VEC (data.get());
+		constexpr integer numberOfRepetitions = 10;
+		for (integer irep = 1; irep <= numberOfRepetitions; irep ++) {
+			cached.all()  <<=  data.all();
+			NUMforwardRealFastFourierTransform (cached.get());
+		}
+		NUMfft_getPlanCacheStatistics (& numberOfPlans, & memoryUse, & numberOfHits, & numberOfMisses, & numberOfEvictions);
+		Melder_require (numberOfPlans == 1 && numberOfMisses == 1 && numberOfHits == numberOfRepetitions - 1 && numberOfEvictions == 0,
+			U"Repeated transforms of the same size should compute the plan only once.");
+		const integer memoryUsePerPlan = memoryUse;
+		NUMfft_setPlanCacheMaximumMemoryUse (0);
+		autoVEC uncached = copy_VEC (data.get());
+		NUMforwardRealFastFourierTransform (uncached.get());
+		Melder_require (NUMequal (cached.get(), uncached.get()),
+			U"The cached plan should give the same transform as a new plan.");
+		NUMfft_getPlanCacheStatistics (& numberOfPlans, & memoryUse, nullptr, nullptr, & numberOfEvictions);
+		Melder_require (numberOfPlans == 0 && memoryUse == 0 && numberOfEvictions == 1,
+			U"Switching the cache off should evict its plan.");
+		/*
+			With room for two plans, a third size evicts the least recently used plan.
+		*/
+		NUMfft_clearPlanCache ();
+		NUMfft_setPlanCacheMaximumMemoryUse (2 * memoryUsePerPlan + memoryUsePerPlan / 2);
+		for (const integer size : sizes) {
+			autoVEC frame = randomGauss_VEC (size, 0.0, 1.0);
+			NUMforwardRealFastFourierTransform (frame.get());
+		}
+		NUMfft_getPlanCacheStatistics (& numberOfPlans, & memoryUse, & numberOfHits, & numberOfMisses, & numberOfEvictions);
+		Melder_require (numberOfPlans == 2 && numberOfHits == 0 && numberOfMisses == 3 && numberOfEvictions == 1,
+			U"A small cache should evict plans: ", numberOfPlans, U" plans, ", numberOfEvictions, U" evictions.");
+		for (integer i = 2; i >= 0; i --) {   // 1002 and 1001 are cached, 1000 was evicted
+			autoVEC frame = randomGauss_VEC (sizes [i], 0.0, 1.0);
+			NUMforwardRealFastFourierTransform (frame.get());
+		}
+		NUMfft_getPlanCacheStatistics (& numberOfPlans, nullptr, & numberOfHits, & numberOfMisses, & numberOfEvictions);
+		Melder_require (numberOfPlans == 2 && numberOfHits == 2 && numberOfMisses == 4 && numberOfEvictions == 2,
+			U"The least recently used plan should have been evicted.");
+		MelderInfo_writeLine (U"Memory use per plan of size ", sizes [0], U": ", memoryUsePerPlan, U" bytes");
+		NUMfft_clearPlanCache ();
+		NUMfft_setPlanCacheMaximumMemoryUse (savedMaximumMemoryUse);
+	} catch (MelderError) {
+		NUMfft_clearPlanCache ();
+		NUMfft_setPlanCacheMaximumMemoryUse (savedMaximumMemoryUse);
+		throw;
+	}
+}
+
 int Praat_tests (kPraatTests itest, conststring32 arg1, conststring32 arg2, conststring32 arg3, conststring32 arg4) {
 	int64 n = Melder_atoi (arg1);
 	double t = 0.0;
@@ -662,6 +929,116 @@ int Praat_tests (kPraatTests itest, conststring32 arg1, conststring32 arg2, cons
 		case kPraatTests::FILEINMEMORYMANAGER_IO: {
 			test_FileInMemoryManager_io ();
 		} break;
+		case kPraatTests::TIME_FFT_BATCH: {
+			const integer frameSize = Melder_atoi (arg2);
+			const integer numberOfFrames = Melder_atoi (arg3);
+			autoNUMfft_Table table;
+			NUMfft_Table_init (& table, frameSize);
+			autoMAT const frames = randomGauss_MAT (numberOfFrames, frameSize, 0.0, 1.0);
+			autoMAT const batched = copy_MAT (frames.get());
+			autoMAT const oneByOne = copy_MAT (frames.get());
+			NUMfft_forward (& table, batched.get());
+			for (integer iframe = 1; iframe <= numberOfFrames; iframe ++)
+				NUMfft_forward (& table, oneByOne.row (iframe));
+			Melder_require (NUMequal (batched.get(), oneByOne.get()),
+				U"The batched forward transform should give the same result as the one-frame transform.");
+			NUMfft_backward (& table, batched.get());
+			for (integer iframe = 1; iframe <= numberOfFrames; iframe ++)
+				NUMfft_backward (& table, oneByOne.row (iframe));
+			Melder_require (NUMequal (batched.get(), oneByOne.get()),
+				U"The batched backward transform should give the same result as the one-frame transform.");
+			double maximumError = 0.0;
+			for (integer iframe = 1; iframe <= numberOfFrames; iframe ++)
+				for (integer i = 1; i <= frameSize; i ++)
+					maximumError = std::max (maximumError, fabs (batched [iframe] [i] / frameSize - frames [iframe] [i]));
+			MelderInfo_writeLine (maximumError, U" maximum round-trip error");
+			Melder_stopwatch ();
+			for (integer iteration = 1; iteration <= n; iteration ++)
+				NUMfft_forward (& table, batched.get());
+			t = Melder_stopwatch () / numberOfFrames;
+		} break;
+		case kPraatTests::TIME_MATRIX_FORMULA: {
+			const integer numberOfRows = 100, numberOfColumns = 10000, numberOfCells = numberOfRows * numberOfColumns;
+			const conststring32 formula = U"if row mod 3 = 0 then self * 0.5 + sin (x) * exp (-y) else self [row, col - 1] - 1 / (col + 1) fi";
+			autoMatrix numeric = Matrix_create (0.0, 1.0, numberOfColumns, 1.0 / numberOfColumns, 0.5 / numberOfColumns,
+					0.0, 1.0, numberOfRows, 1.0 / numberOfRows, 0.5 / numberOfRows);
+			autoMatrix general = Data_copy (numeric.get());
+			Melder_stopwatch ();
+			Matrix_formula (numeric.get(), formula, nullptr, nullptr);
+			const double numericTime = Melder_stopwatch ();
+			const integer savedDebug = Melder_debug;
+			Melder_debug = 58;   // no numeric formula programs
+			try {
+				Matrix_formula (general.get(), formula, nullptr, nullptr);
+				Melder_debug = savedDebug;
+			} catch (MelderError) {
+				Melder_debug = savedDebug;
+				throw;
+			}
+			const double generalTime = Melder_stopwatch ();
+			Melder_require (NUMequal (numeric -> z.get(), general -> z.get()),
+				U"The numeric program should give the same result as the general program.");
+			MelderInfo_writeLine (Melder_single (generalTime / numberOfCells * 1e9), U" ns per cell (general program)");
+			MelderInfo_writeLine (Melder_single (numericTime / numberOfCells * 1e9), U" ns per cell (numeric program)");
+			Melder_stopwatch ();
+			for (integer iteration = 1; iteration <= n; iteration ++)
+				Matrix_formula (numeric.get(), formula, nullptr, nullptr);
+			t = Melder_stopwatch () / numberOfCells;
+		} break;
+		case kPraatTests::TIME_RESAMPLE: {
+			/*
+				One minute of stereo sound, from 44.1 to 48 kHz and to 16 kHz,
+				with the polyphase filter bank and with the old interpolation (Melder_debug 59).
+			*/
+			const integer precision = 50;
+			autoSound sound = Sound_create (2, 0.0, 60.0, 60 * 44100, 1.0 / 44100, 0.5 / 44100);
+			for (integer ichan = 1; ichan <= 2; ichan ++)
+				for (integer isamp = 1; isamp <= sound -> nx; isamp ++)
+					sound -> z [ichan] [isamp] = sin (2.0 * NUMpi * (377.0 + 100.0 * ichan) * Sampled_indexToX (sound.get(), isamp))
+							+ 0.1 * NUMrandomGauss (0.0, 1.0);
+			const double newSamplingFrequencies [] = { 48000.0, 16000.0 };
+			for (const double newSamplingFrequency : newSamplingFrequencies) {
+				Melder_stopwatch ();
+				autoSound polyphase = Sound_resample (sound.get(), newSamplingFrequency, precision);
+				const double polyphaseTime = Melder_stopwatch ();
+				const integer savedDebug = Melder_debug;
+				Melder_debug = 59;   // no polyphase resampling
+				autoSound old;
+				try {
+					old = Sound_resample (sound.get(), newSamplingFrequency, precision);
+					Melder_debug = savedDebug;
+				} catch (MelderError) {
+					Melder_debug = savedDebug;
+					throw;
+				}
+				const double oldTime = Melder_stopwatch ();
+				Melder_require (polyphase -> nx == old -> nx && polyphase -> x1 == old -> x1,
+					U"The polyphase resampler should give the same time sampling as the old resampler.");
+				/*
+					Compare away from the edges, where the two methods treat the zeroes outside the sound differently.
+				*/
+				const integer margin = Melder_iround (0.01 * newSamplingFrequency);
+				double maximumDifference = 0.0;
+				for (integer ichan = 1; ichan <= 2; ichan ++)
+					for (integer isamp = 1 + margin; isamp <= polyphase -> nx - margin; isamp ++)
+						maximumDifference = std::max (maximumDifference, fabs (polyphase -> z [ichan] [isamp] - old -> z [ichan] [isamp]));
+				MelderInfo_writeLine (U"44100 -> ", newSamplingFrequency, U" Hz: ",
+						Melder_fixed (oldTime, 3), U" s (old), ", Melder_fixed (polyphaseTime, 3), U" s (polyphase), maximum difference ",
+						Melder_single (maximumDifference));
+			}
+			Melder_stopwatch ();
+			for (integer iteration = 1; iteration <= n; iteration ++)
+				(void) Sound_resample (sound.get(), 48000.0, precision);
+			t = Melder_stopwatch () / (2 * 60 * 48000 * 2 * precision);
+		} break;
+		case kPraatTests::LONG_SOUND_OVERVIEW: {
+			structMelderFile soundFile { };
+			Melder_pathToFile (arg2, & soundFile);
+			test_LongSound_overview (& soundFile, n);
+		} break;
+		case kPraatTests::FFT_PLAN_CACHE: {
+			test_NUMfft_planCache ();
+		} break;
 	}
 	MelderInfo_writeLine (Melder_single (n / t * 1e-9), U" Gflop/s");
 	MelderInfo_close ();
@@ -62,6 +62,11 @@ enums_begin (kPraatTests, 0)
 	enums_add (kPraatTests, 42, TIME_MATMUL, U"TimeMatMul")
 	enums_add (kPraatTests, 43, THING_AUTO, U"ThingAuto")
 	enums_add (kPraatTests, 44, FILEINMEMORYMANAGER_IO, U"FileInMemoryManager_io")
-enums_end (kPraatTests, 44, CHECK_RANDOM_1009_2009)
+	enums_add (kPraatTests, 45, TIME_FFT_BATCH, U"TimeFftBatch")
+	enums_add (kPraatTests, 46, TIME_MATRIX_FORMULA, U"TimeMatrixFormula")
+	enums_add (kPraatTests, 47, TIME_RESAMPLE, U"TimeResample")
+	enums_add (kPraatTests, 48, LONG_SOUND_OVERVIEW, U"LongSoundOverview")
+	enums_add (kPraatTests, 49, FFT_PLAN_CACHE, U"FftPlanCache")
+enums_end (kPraatTests, 49, CHECK_RANDOM_1009_2009)
 
 /* End of file Praat_tests_enums.h */
@@ -25,6 +25,7 @@
 #include "Sound.h"
 #include "Sound_extensions.h"
 #include "NUM2.h"
+#include "SoundResampler.h"
 
 #include "enums_getText.h"
 #include "Sound_enums.h"
@@ -406,6 +407,19 @@ autoSound Sound_resample (constSound me, double samplingFrequency, integer preci
 		const integer numberOfSamples = Melder_iround ((my xmax - my xmin) * samplingFrequency);
 		if (numberOfSamples < 1)
 			Melder_throw (U"The resampled Sound would have no samples.");
+		if (SoundResampler_canResample (1.0 / my dx, samplingFrequency, precision) && Melder_debug != 59) {
+			/*
+				The fast way: a polyphase filter bank, which takes care of the anti-aliasing as well.
+			*/
+			autoSound thee = Sound_create (my ny, my xmin, my xmax, numberOfSamples, 1.0 / samplingFrequency,
+					0.5 * (my xmin + my xmax - (numberOfSamples - 1) / samplingFrequency));
+			autoSoundResampler resampler = SoundResampler_create (my ny, 1.0 / my dx, samplingFrequency, precision,
+					Sampled_xToIndex (me, thy x1));
+			SoundResampler_putInput (resampler.get(), my z.all());
+			SoundResampler_endInput (resampler.get());
+			SoundResampler_getOutput (resampler.get(), thy z.all());
+			return thee;
+		}
 		autoSound filtered;
 		const bool weNeedAnAntiAliasingFilter = ( upfactor < 1.0 );
 		if (weNeedAnAntiAliasingFilter) {
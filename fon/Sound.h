@@ -115,6 +115,8 @@ autoSound Sound_resample (constSound me, double samplingFrequency, integer preci
 	Method:
 		precision <= 1: linear interpolation.
 		precision >= 2: sinx/x interpolation with maximum depth equal to 'precision'.
+		If precision >= 3 and the ratio of the sampling frequencies is a simple fraction (e.g. 44100 -> 48000),
+		a polyphase filter bank (SoundResampler) is used instead, with 'precision' zero crossings on either side.
 */
 
 autoSound Sounds_append (constSound me, double silenceDuration, constSound thee);
@@ -0,0 +1,197 @@
+/* SoundResampler.cpp
+ *
+ * Copyright (C) 2024 Paul Boersma
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SoundResampler.h"
+
+Thing_implement (SoundResampler, Thing, 0);
+
+constexpr integer MAXIMUM_RESAMPLING_FACTOR = 1000;
+constexpr integer MAXIMUM_FILTER_BANK_SIZE = 10'000'000;   // 80 megabytes
+
+static bool SoundResampler_findFactors (const double oldSamplingFrequency, const double newSamplingFrequency,
+	integer *out_upsamplingFactor, integer *out_downsamplingFactor)
+{
+	if (! (oldSamplingFrequency > 0.0) || ! (newSamplingFrequency > 0.0))
+		return false;
+	const double ratio = newSamplingFrequency / oldSamplingFrequency;
+	for (integer downsamplingFactor = 1; downsamplingFactor <= MAXIMUM_RESAMPLING_FACTOR; downsamplingFactor ++) {
+		const integer upsamplingFactor = Melder_iround (ratio * downsamplingFactor);
+		if (upsamplingFactor < 1 || upsamplingFactor > MAXIMUM_RESAMPLING_FACTOR)
+			continue;
+		if (fabs ((double) upsamplingFactor / downsamplingFactor - ratio) < 1e-9 * ratio) {
+			if (out_upsamplingFactor)
+				*out_upsamplingFactor = upsamplingFactor;
+			if (out_downsamplingFactor)
+				*out_downsamplingFactor = downsamplingFactor;
+			return true;
+		}
+	}
+	return false;
+}
+
+static double SoundResampler_getCutoff (const integer upsamplingFactor, const integer downsamplingFactor) {
+	return std::min (1.0, (double) upsamplingFactor / downsamplingFactor);   // relative to the old Nyquist frequency
+}
+
+bool SoundResampler_canResample (const double oldSamplingFrequency, const double newSamplingFrequency, const integer precision) {
+	integer upsamplingFactor, downsamplingFactor;
+	if (precision < 3 || ! SoundResampler_findFactors (oldSamplingFrequency, newSamplingFrequency, & upsamplingFactor, & downsamplingFactor))
+		return false;
+	const double halfFilterLength = precision / SoundResampler_getCutoff (upsamplingFactor, downsamplingFactor);
+	return upsamplingFactor * 2.0 * (halfFilterLength + 1.0) <= MAXIMUM_FILTER_BANK_SIZE;
+}
+
+autoSoundResampler SoundResampler_create (const integer numberOfChannels,
+	const double oldSamplingFrequency, const double newSamplingFrequency, const integer precision, const double firstOutputPosition)
+{
+	try {
+		Melder_assert (SoundResampler_canResample (oldSamplingFrequency, newSamplingFrequency, precision));
+		autoSoundResampler me = Thing_new (SoundResampler);
+		my numberOfChannels = numberOfChannels;
+		SoundResampler_findFactors (oldSamplingFrequency, newSamplingFrequency, & my upsamplingFactor, & my downsamplingFactor);
+		const double cutoff = SoundResampler_getCutoff (my upsamplingFactor, my downsamplingFactor);
+		const double windowHalfWidth = precision / cutoff;   // in input samples
+		my halfFilterLength = Melder_iroundUp (windowHalfWidth);
+		const integer filterLength = 2 * my halfFilterLength;
+		my filters = raw_MAT (my upsamplingFactor, filterLength);
+		my phaseShifts = raw_INTVEC (my upsamplingFactor);
+		my inputIndex = Melder_ifloor (firstOutputPosition);
+		const double firstFraction = firstOutputPosition - my inputIndex;
+		for (integer phase = 0; phase < my upsamplingFactor; phase ++) {
+			const double position = firstFraction + (double) phase / my upsamplingFactor;
+			const integer shift = Melder_ifloor (position);
+			const double fraction = position - shift;
+			my phaseShifts [1 + phase] = shift;
+			/*
+				Tap number `itap` multiplies the input sample that lies `distance` samples to the left of the output sample.
+			*/
+			const VEC filter = my filters.row (1 + phase);
+			double sum = 0.0;
+			for (integer itap = 1; itap <= filterLength; itap ++) {
+				const double distance = fraction + my halfFilterLength - itap;
+				if (fabs (distance) >= windowHalfWidth) {
+					filter [itap] = 0.0;
+					continue;
+				}
+				const double phi = NUMpi * cutoff * distance;
+				const double sinc = ( phi == 0.0 ? 1.0 : sin (phi) / phi );
+				filter [itap] = cutoff * sinc * (0.5 + 0.5 * cos (NUMpi * distance / windowHalfWidth));
+				sum += filter [itap];
+			}
+			filter  /=  sum;   // unity gain at zero frequency
+		}
+		/*
+			The buffer starts with the leftmost input sample needed for the first output sample,
+			or with input sample 1 if that is further to the left.
+		*/
+		my bufferFirstIndex = std::min (1_integer, my inputIndex + my phaseShifts [1] - my halfFilterLength + 1);
+		my bufferLastIndex = 0;
+		my buffer = zero_MAT (numberOfChannels, (1 - my bufferFirstIndex) + 2 * filterLength + 1000);   // zeroes before sample 1
+		return me;
+	} catch (MelderError) {
+		Melder_throw (U"SoundResampler not created.");
+	}
+}
+
+static integer SoundResampler_getFirstNeededIndex (SoundResampler me) {
+	return my inputIndex + my phaseShifts [1 + my phase] - my halfFilterLength + 1;
+}
+
+/*
+	Appends `numberOfSamples` samples to the buffer: the samples of `input`, or zeroes if `input` is null.
+*/
+static void SoundResampler_append (SoundResampler me, constMATVU const *input, const integer numberOfSamples) {
+	/*
+		Remove the samples that no future output sample needs.
+	*/
+	const integer firstKeptIndex = std::min (SoundResampler_getFirstNeededIndex (me), my bufferLastIndex + 1);
+	const integer numberOfSamplesToRemove = firstKeptIndex - my bufferFirstIndex;
+	const integer numberOfSamplesToKeep = my bufferLastIndex - firstKeptIndex + 1;
+	if (numberOfSamplesToRemove > 0) {
+		for (integer ichan = 1; ichan <= my numberOfChannels; ichan ++) {
+			double * const row = & my buffer [ichan] [1];
+			for (integer i = 0; i < numberOfSamplesToKeep; i ++)
+				row [i] = row [i + numberOfSamplesToRemove];
+		}
+		my bufferFirstIndex = firstKeptIndex;
+	}
+	if (numberOfSamplesToKeep + numberOfSamples > my buffer.ncol) {
+		autoMAT newBuffer = raw_MAT (my numberOfChannels, 2 * (numberOfSamplesToKeep + numberOfSamples));
+		newBuffer.verticalBand (1, numberOfSamplesToKeep)  <<=  my buffer.verticalBand (1, numberOfSamplesToKeep);
+		my buffer = newBuffer.move();
+	}
+	const MATVU destination = my buffer.verticalBand (numberOfSamplesToKeep + 1, numberOfSamplesToKeep + numberOfSamples);
+	if (input)
+		destination  <<=  *input;
+	else
+		destination  <<=  0.0;
+	my bufferLastIndex += numberOfSamples;
+}
+
+void SoundResampler_putInput (SoundResampler me, constMATVU const& input) {
+	Melder_assert (input.nrow == my numberOfChannels);
+	Melder_assert (! my inputHasEnded);
+	const integer firstNewIndex = my numberOfInputSamples + 1;
+	my numberOfInputSamples += input.ncol;
+	/*
+		If the first output sample lies far to the right of the start of the input,
+		the buffer may not need the first input samples at all.
+	*/
+	const integer firstUsefulIndex = std::max (firstNewIndex, SoundResampler_getFirstNeededIndex (me));
+	if (my bufferLastIndex < firstUsefulIndex - 1) {
+		my bufferLastIndex = std::min (firstUsefulIndex - 1, my numberOfInputSamples);
+		my bufferFirstIndex = my bufferLastIndex + 1;   // empty
+	}
+	if (my numberOfInputSamples > my bufferLastIndex) {
+		const constMATVU useful = input.verticalBand (my bufferLastIndex + 1 - firstNewIndex + 1, input.ncol);
+		SoundResampler_append (me, & useful, useful.ncol);
+	}
+}
+
+void SoundResampler_endInput (SoundResampler me) {
+	my inputHasEnded = true;
+}
+
+integer SoundResampler_getOutput (SoundResampler me, MATVU const& output) {
+	Melder_assert (output.nrow == my numberOfChannels);
+	const integer filterLength = 2 * my halfFilterLength;
+	for (integer isample = 1; isample <= output.ncol; isample ++) {
+		const integer firstNeededIndex = SoundResampler_getFirstNeededIndex (me);
+		const integer lastNeededIndex = firstNeededIndex + filterLength - 1;
+		if (lastNeededIndex > my bufferLastIndex) {
+			if (! my inputHasEnded)
+				return isample - 1;
+			SoundResampler_append (me, nullptr, std::max (lastNeededIndex - my bufferLastIndex, filterLength + 1000_integer));
+		}
+		const constVEC filter = my filters.row (1 + my phase);
+		const integer offset = firstNeededIndex - my bufferFirstIndex;
+		for (integer ichan = 1; ichan <= my numberOfChannels; ichan ++) {
+			const double * const samples = & my buffer [ichan] [1 + offset];
+			double sum = 0.0;
+			for (integer itap = 0; itap < filterLength; itap ++)
+				sum += filter [1 + itap] * samples [itap];
+			output [ichan] [isample] = sum;
+		}
+		my phase += my downsamplingFactor;
+		my inputIndex += my phase / my upsamplingFactor;
+		my phase %= my upsamplingFactor;
+	}
+	return output.ncol;
+}
+
+/* End of file SoundResampler.cpp */
@@ -0,0 +1,93 @@
+#ifndef _SoundResampler_h_
+#define _SoundResampler_h_
+/* SoundResampler.h
+ *
+ * Copyright (C) 2024 Paul Boersma
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Thing.h"
+
+/*
+	A streaming polyphase resampler for sampling frequencies whose ratio is a simple fraction L / M,
+	such as 44100 -> 48000 (L / M = 160 / 147) or 48000 -> 16000 (L / M = 1 / 3).
+
+	The input is a sequence of blocks of samples (one row per channel), which need not have equal sizes;
+	output sample k (k = 0, 1, 2...) lies at the (fractional) input sample index firstOutputPosition + k * M / L.
+	Input samples before sample 1 and after the end of the input are taken to be zero.
+
+	Every output sample is a weighted sum of the 2 * halfFilterLength input samples around it.
+	Since the output positions cycle through only L different fractional positions between input samples,
+	the weights are computed beforehand, as a bank of L filters (the "phases").
+	The weights form a Hann-windowed sinc function with `precision` zero crossings on either side;
+	when the sampling frequency goes down, the sinc is stretched, so that it also filters away
+	the frequencies above the new Nyquist frequency.
+*/
+
+Thing_define (SoundResampler, Thing) {
+	integer numberOfChannels;
+	integer upsamplingFactor, downsamplingFactor;   // L and M
+	integer halfFilterLength;
+	autoMAT filters;   // L x (2 * halfFilterLength)
+	autoINTVEC phaseShifts;   // for each phase, 0 or 1: the distance from `inputIndex` to the input sample just left of the output sample
+
+	integer inputIndex;   // with `phase`, the position of the next output sample
+	integer phase;   // 0 .. L - 1
+	integer numberOfInputSamples;   // received so far
+	bool inputHasEnded;
+
+	/*
+		The buffer contains the input samples bufferFirstIndex .. bufferLastIndex
+		(possibly including zeroes before sample 1 and after the end of the input).
+	*/
+	autoMAT buffer;
+	integer bufferFirstIndex, bufferLastIndex;
+};
+
+bool SoundResampler_canResample (double oldSamplingFrequency, double newSamplingFrequency, integer precision);
+/*
+	Whether the ratio of the new and old sampling frequency is a fraction L / M with L and M at most 1000,
+	and precision is at least 3, and the filter bank would not be unreasonably large.
+*/
+
+autoSoundResampler SoundResampler_create (integer numberOfChannels,
+	double oldSamplingFrequency, double newSamplingFrequency, integer precision, double firstOutputPosition);
+/*
+	Precondition:
+		SoundResampler_canResample (oldSamplingFrequency, newSamplingFrequency, precision)
+*/
+
+void SoundResampler_putInput (SoundResampler me, constMATVU const& input);
+/*
+	Append input.ncol samples to the input.
+	Precondition:
+		input.nrow == my numberOfChannels
+*/
+
+void SoundResampler_endInput (SoundResampler me);
+/*
+	From now on, the input is regarded as followed by an infinite number of zeroes.
+*/
+
+integer SoundResampler_getOutput (SoundResampler me, MATVU const& output);
+/*
+	Write as many output samples into the columns of `output` as the input received so far allows,
+	and return their number. This is output.ncol if the input has ended.
+	Precondition:
+		output.nrow == my numberOfChannels
+*/
+
+/* End of file SoundResampler.h */
+#endif
@@ -18,6 +18,7 @@
 
 #include "Sound_and_Spectrogram.h"
 #include "NUM2.h"
+#include "SoundToSpectrogramWorkspace.h"
 
 #include "enums_getText.h"
 #include "Sound_and_Spectrogram_enums.h"
@@ -66,7 +67,6 @@ autoSpectrogram Sound_to_Spectrogram (Sound me, double effectiveAnalysisWidth, d
 		integer nsampFFT = 1;
 		while (nsampFFT < nsamp_window || nsampFFT < 2 * numberOfFreqs * (nyquist / fmax))
 			nsampFFT *= 2;
-		const integer half_nsampFFT = nsampFFT / 2;
 
 		/*
 			Compute the frequency sampling of the spectrogram.
@@ -118,69 +118,13 @@ autoSpectrogram Sound_to_Spectrogram (Sound me, double effectiveAnalysisWidth, d
 		}
 		const double oneByBinWidth = 1.0 / double (windowssq) / binWidth_samples;
 
-		autoVEC data = zero_VEC (nsampFFT);
-		autoVEC spectrum = zero_VEC (half_nsampFFT + 1);
-		autoNUMfft_Table fftTable;
-		NUMfft_Table_init (& fftTable, nsampFFT);
-
-		autoMelderProgress progress (U"Sound to Spectrogram...");
-
-		for (integer iframe = 1; iframe <= numberOfTimes; iframe ++) {
-			const double t = Sampled_indexToX (thee.get(), iframe);
-			const integer leftSample = Sampled_xToLowIndex (me, t), rightSample = leftSample + 1;
-			const integer startSample = rightSample - halfnsamp_window;
-			const integer endSample = leftSample + halfnsamp_window;
-			Melder_assert (startSample >= 1);
-			Melder_assert (endSample <= my nx);
-
-			spectrum.all()  <<=  0.0;
-			/*
-				For multichannel sounds, the power spectrogram should represent the
-				average power in the channels,
-				so that the result for a stereo sound in which the
-				left channel has the same waveform as the right channel,
-				is identical to the result for the corresponding mono (= averaged) sound.
-				Averaging starts by adding up the powers of the channels.
-			*/
-			for (integer channel = 1; channel <= my ny; channel ++) {
-				for (integer j = 1, i = startSample; j <= nsamp_window; j ++)
-					data [j] = my z [channel] [i ++] * window [j];
-				for (integer j = nsamp_window + 1; j <= nsampFFT; j ++)
-					data [j] = 0.0f;
-
-				Melder_progress (iframe / (numberOfTimes + 1.0),
-					U"Sound to Spectrogram: analysis of frame ", iframe, U" out of ", numberOfTimes);
-
-				/*
-					Compute the Fast Fourier Transform of the frame.
-				*/
-				NUMfft_forward (& fftTable, data.get());   // data := complex spectrum
-
-				/*
-					Convert from complex to power spectrum,
-					accumulating the power spectra of the channels.
-				*/
-				spectrum [1] += data [1] * data [1];   // DC component
-				for (integer i = 2; i <= half_nsampFFT; i ++)
-					spectrum [i] += data [i + i - 2] * data [i + i - 2] + data [i + i - 1] * data [i + i - 1];
-				spectrum [half_nsampFFT + 1] += data [nsampFFT] * data [nsampFFT];   // Nyquist frequency. Correct??
-			}
-			/*
-				Power averaging ends by dividing the summed power by the number of channels,
-			*/
-			if (my ny > 1 )
-				spectrum.all()  /=  my ny;
-
-			/*
-				Binning.
-			*/
-			for (integer iband = 1; iband <= numberOfFreqs; iband ++) {
-				const integer lowerSample = (iband - 1) * binWidth_samples + 1;
-				const integer higherSample = lowerSample + binWidth_samples;
-				const double power = NUMsum (spectrum.part (lowerSample, higherSample - 1));
-				thy z [iband] [iframe] = power * oneByBinWidth;
-			}
-		}
+		/*
+			The frames are analysed independently of each other, possibly in parallel;
+			each thread has its own FFT table and work vectors.
+		*/
+		autoSoundToSpectrogramWorkspace ws = SoundToSpectrogramWorkspace_create (me, thee.get(),
+				window.get(), nsampFFT, binWidth_samples, oneByBinWidth);
+		SampledToSampledWorkspace_analyseThreaded (ws.get(), U"Sound to Spectrogram");
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": spectrogram analysis not performed.");
@@ -26,11 +26,14 @@
  * pb 2007/01/28 made compatible with stereo sounds
  * pb 2008/01/19 double
  * pb 2011/06/08 C++
+ * pb 2026/10/18 frames and channels on several threads
  */
 
 #include "Sound_to_Cochleagram.h"
 #include "Sound_and_Spectrum.h"
 #include "Spectrum_to_Excitation.h"
+#include "NUM2.h"
+#include "MelderThread.h"
 
 autoCochleagram Sound_to_Cochleagram (Sound me, double dt, double df, double dt_window, double forwardMaskingTime) {
 	try {
@@ -45,7 +48,14 @@ autoCochleagram Sound_to_Cochleagram (Sound me, double dt, double df, double dt_
 		if (nFrames < 2) return autoCochleagram ();
 		double t1 = my x1 + 0.5 * (duration - my dx - (nFrames - 1) * dt);   // centre of first frame
 		autoCochleagram thee = Cochleagram_create (my xmin, my xmax, nFrames, dt, t1, df, nf);
-		autoSound window = Sound_createSimple (1, nsamp_window * my dx, 1.0 / my dx);
+		/*
+			The frames are windowed and converted to excitations independently of each other,
+			on several threads; only the forward masking connects the frames, afterwards.
+		*/
+		autoINTVEC startSamples = raw_INTVEC (nFrames);
+		autoVEC hann = raw_VEC (nsamp_window);
+		for (integer i = 1; i <= nsamp_window; i ++)
+			hann [i] = 0.5 - 0.5 * cos (2.0 * NUMpi * i / (nsamp_window + 1));
 		for (integer iframe = 1; iframe <= nFrames; iframe ++) {
 			double t = Sampled_indexToX (thee.get(), iframe);
 			integer leftSample = Sampled_xToLowIndex (me, t);
@@ -63,17 +73,31 @@ autoCochleagram Sound_to_Cochleagram (Sound me, double dt, double df, double dt_
 					U".");
 				endSample = my nx;
 			}
-
-			/* Copy a window to a frame. */
-			for (integer i = 1; i <= nsamp_window; i ++)
-				window -> z [1] [i] =
-					( my ny == 1 ? my z [1] [i+startSample-1] : 0.5 * (my z [1] [i+startSample-1] + my z [2] [i+startSample-1]) ) *
-					(0.5 - 0.5 * cos (2.0 * NUMpi * i / (nsamp_window + 1)));
-			autoSpectrum spec = Sound_to_Spectrum (window.get(), true);
-			autoExcitation excitation = Spectrum_to_Excitation (spec.get(), df);
-			for (integer ifreq = 1; ifreq <= nf; ifreq ++)
-				thy z [ifreq] [iframe] = excitation -> z [1] [ifreq] + ( iframe > 1 ? dampingFactor * thy z [ifreq] [iframe - 1] : 0 );
+			startSamples [iframe] = startSample;
 		}
+		constexpr integer minimumNumberOfFramesPerTask = 20;
+		integer numberOfTasks = ( Melder_debug == -8 ? 1 : nFrames / minimumNumberOfFramesPerTask );
+		Melder_clip (1_integer, & numberOfTasks, 2 * MelderThread_getNumberOfThreads ());
+		MelderThread_runTasks (numberOfTasks, [&] (integer itask) {
+			const integer firstFrame = 1 + (itask - 1) * nFrames / numberOfTasks;
+			const integer lastFrame = itask * nFrames / numberOfTasks;
+			autoSound window = Sound_createSimple (1, nsamp_window * my dx, 1.0 / my dx);
+			for (integer iframe = firstFrame; iframe <= lastFrame; iframe ++) {
+				const integer startSample = startSamples [iframe];
+
+				/* Copy a window to a frame. */
+				for (integer i = 1; i <= nsamp_window; i ++)
+					window -> z [1] [i] =
+						( my ny == 1 ? my z [1] [i+startSample-1] : 0.5 * (my z [1] [i+startSample-1] + my z [2] [i+startSample-1]) ) * hann [i];
+				autoSpectrum spec = Sound_to_Spectrum (window.get(), true);
+				autoExcitation excitation = Spectrum_to_Excitation (spec.get(), df);
+				for (integer ifreq = 1; ifreq <= nf; ifreq ++)
+					thy z [ifreq] [iframe] = excitation -> z [1] [ifreq];
+			}
+		});
+		for (integer ifreq = 1; ifreq <= nf; ifreq ++)
+			for (integer iframe = 2; iframe <= nFrames; iframe ++)
+				thy z [ifreq] [iframe] += dampingFactor * thy z [ifreq] [iframe - 1];
 		for (integer iframe = 1; iframe <= nFrames; iframe ++)
 			for (integer ifreq = 1; ifreq <= nf; ifreq ++)
 				thy z [ifreq] [iframe] *= integrationCorrection;
@@ -120,88 +144,145 @@ autoCochleagram Sound_to_Cochleagram_edb
 		/* Stages 1 and 2: outer- and middle-ear filtering. */
 		/* From acoustic sound to oval window. */
 
-		for (integer ifreq = 1; ifreq <= nfreq; ifreq ++) {
-			double *response = & thy z [ifreq] [0];
-
-			/* Stage 3: basilar membrane filtering by gammatones. */
-			/* From oval window to basilar membrane response. */
-
-			double midFrequency_Bark = (ifreq - 0.5) * dfreq;
-			double midFrequency_Hertz = NUMbarkToHertz (midFrequency_Bark);
-			autoSound gammatone = createGammatone (midFrequency_Hertz, 1.0 / my dx);
-			autoSound basil = Sounds_convolve (me, gammatone.get(), kSounds_convolve_scaling::SUM, kSounds_convolve_signalOutsideTimeDomain::ZERO);
-
-			/* Stage 4: detection = rectify + integrate + low-pass 500 Hz. */
-			/* From basilar membrane response to firing rate. */
-
-			if (hasSynapse) {
-				double dt = my dx;
-				double M = 1.0;   // maximum free transmitter
-				double A = 5.0, B = 300.0, g = 2000.0;   // determine permeability
-				double y = replenishmentRate;            // Meddis: 5.05
-				double l = lossRate, r = returnRate;     // Meddis: 2500, 6580
-				double x = reprocessingRate;             // Meddis: 66.31
-				double h = 50000;   // convert cleft contents to firing rate
-				double gdt = 1.0 - exp (- g * dt);
-				double ydt = 1.0 - exp (- y * dt);
-				double ldt = (1.0 - exp (- (l + r) * dt)) * l / (l + r);
-				double rdt = (1.0 - exp (- (l + r) * dt)) * r / (l + r);
-				double xdt = 1.0 - exp (- x * dt);
-				double kt = g * A / (A + B);   // membrane permeability
-				double c = M * y * kt / (l * kt + y * (l + r));   // cleft contents
-				double q = c * (l + r) / kt;   // free transmitter
-				double w = c * r / x;   // reprocessing store
-				for (integer itime = 1; itime <= basil -> nx; itime ++) {
-					double splusA = basil -> z [1] [itime] * 10.0 + A;
-					double replenish = ( M > q ? ydt * (M - q) : 0.0 );
-					kt = ( splusA > 0.0 ? gdt * splusA / (splusA + B) : 0.0 );
-					double eject = kt * q;
-					double loss = ldt * c;
-					double reuptake = rdt * c;
-					double reprocess = xdt * w;
-					q = q + replenish - eject + reprocess;
-					c = c + eject - loss - reuptake;
-					w = w + reuptake - reprocess;
-					basil -> z [1] [itime] = h * c;
+		/*
+			The channels are independent of each other, so they are computed on several threads.
+			The threads do not write to the console, but count the samples that fall outside the sound.
+		*/
+		/*
+			Only the first channel of the convolution of the sound with the gammatone is used.
+			Its Fourier transform is computed once for each FFT size; the gammatones become shorter
+			with increasing frequency, so the largest size is needed for the first channel.
+		*/
+		const integer longestGammatoneSize = createGammatone (NUMbarkToHertz (0.5 * dfreq), 1.0 / my dx) -> nx;
+		const integer shortestGammatoneSize = createGammatone (NUMbarkToHertz ((nfreq - 0.5) * dfreq), 1.0 / my dx) -> nx;
+		const integer largestFftSize = Melder_iroundUpToPowerOfTwo (my nx + longestGammatoneSize - 1);
+		const integer smallestFftSize = Melder_iroundUpToPowerOfTwo (my nx + shortestGammatoneSize - 1);
+		integer numberOfFftSizes = 1;
+		while ((largestFftSize >> numberOfFftSizes) >= smallestFftSize)
+			numberOfFftSizes ++;
+		autoMAT soundSpectra = zero_MAT (numberOfFftSizes, largestFftSize);
+		for (integer isize = 1; isize <= numberOfFftSizes; isize ++) {
+			const integer fftSize = largestFftSize >> (isize - 1);
+			soundSpectra [isize].part (1, my nx)  <<=  my z.row (1);
+			NUMrealft (soundSpectra [isize].part (1, fftSize), 1);
+		}
+
+		integer numberOfTasks = ( Melder_debug == -8 ? 1 : nfreq );
+		Melder_clip (1_integer, & numberOfTasks, 2 * MelderThread_getNumberOfThreads ());
+		autoINTVEC numberOfSamplesOutside = zero_INTVEC (numberOfTasks);
+		MelderThread_runTasks (numberOfTasks, [&] (integer itask) {
+			const integer firstChannel = 1 + (itask - 1) * nfreq / numberOfTasks;
+			const integer lastChannel = itask * nfreq / numberOfTasks;
+			for (integer ifreq = firstChannel; ifreq <= lastChannel; ifreq ++) {
+				double *response = & thy z [ifreq] [0];
+
+				/* Stage 3: basilar membrane filtering by gammatones. */
+				/* From oval window to basilar membrane response. */
+
+				double midFrequency_Bark = (ifreq - 0.5) * dfreq;
+				double midFrequency_Hertz = NUMbarkToHertz (midFrequency_Bark);
+				autoSound gammatone = createGammatone (midFrequency_Hertz, 1.0 / my dx);
+				const integer basilSize = my nx + gammatone -> nx - 1;
+				const integer fftSize = Melder_iroundUpToPowerOfTwo (basilSize);
+				integer isize = 1;
+				while ((largestFftSize >> (isize - 1)) > fftSize)
+					isize ++;
+				Melder_assert (isize <= numberOfFftSizes && (largestFftSize >> (isize - 1)) == fftSize);
+				constVEC soundSpectrum = soundSpectra [isize].part (1, fftSize);
+				autoVEC data = zero_VEC (fftSize);
+				data.part (1, gammatone -> nx)  <<=  gammatone -> z.row (1);
+				NUMrealft (data.get(), 1);
+				data [1] *= soundSpectrum [1];
+				data [2] *= soundSpectrum [2];
+				for (integer i = 3; i <= fftSize; i += 2) {
+					const double temp = soundSpectrum [i] * data [i] - soundSpectrum [i + 1] * data [i + 1];
+					data [i + 1] = soundSpectrum [i] * data [i + 1] + soundSpectrum [i + 1] * data [i];
+					data [i] = temp;
+				}
+				NUMrealft (data.get(), -1);
+				autoSound basil = Sound_create (1, my xmin + gammatone -> xmin, my xmax + gammatone -> xmax,
+						basilSize, my dx, my x1 + gammatone -> x1);   // as in Sounds_convolve, with "sum" scaling
+				basil -> z.row (1)  <<=  data.part (1, basilSize);
+				basil -> z.row (1)  *=  1.0 / fftSize;
+
+				/* Stage 4: detection = rectify + integrate + low-pass 500 Hz. */
+				/* From basilar membrane response to firing rate. */
+
+				if (hasSynapse) {
+					double dt = my dx;
+					double M = 1.0;   // maximum free transmitter
+					double A = 5.0, B = 300.0, g = 2000.0;   // determine permeability
+					double y = replenishmentRate;            // Meddis: 5.05
+					double l = lossRate, r = returnRate;     // Meddis: 2500, 6580
+					double x = reprocessingRate;             // Meddis: 66.31
+					double h = 50000;   // convert cleft contents to firing rate
+					double gdt = 1.0 - exp (- g * dt);
+					double ydt = 1.0 - exp (- y * dt);
+					double ldt = (1.0 - exp (- (l + r) * dt)) * l / (l + r);
+					double rdt = (1.0 - exp (- (l + r) * dt)) * r / (l + r);
+					double xdt = 1.0 - exp (- x * dt);
+					double kt = g * A / (A + B);   // membrane permeability
+					double c = M * y * kt / (l * kt + y * (l + r));   // cleft contents
+					double q = c * (l + r) / kt;   // free transmitter
+					double w = c * r / x;   // reprocessing store
+					for (integer itime = 1; itime <= basil -> nx; itime ++) {
+						double splusA = basil -> z [1] [itime] * 10.0 + A;
+						double replenish = ( M > q ? ydt * (M - q) : 0.0 );
+						kt = ( splusA > 0.0 ? gdt * splusA / (splusA + B) : 0.0 );
+						double eject = kt * q;
+						double loss = ldt * c;
+						double reuptake = rdt * c;
+						double reprocess = xdt * w;
+						q = q + replenish - eject + reprocess;
+						c = c + eject - loss - reuptake;
+						w = w + reuptake - reprocess;
+						basil -> z [1] [itime] = h * c;
+					}
 				}
-			}
 			
-			if (dtime == my dx) {
-				for (integer itime = 1; itime <= ntime; itime ++)
-					response [itime] = basil -> z [1] [itime];
-			} else {
-				double d = dtime / basil -> dx / 2.0;
-				double factor = -6 / d / d;
-				double area = d * sqrt (NUMpi / 6);
-				double expmin6 = exp (-6), onebyoneminexpmin6 = 1 / (1 - expmin6);
-				for (integer itime = 1; itime <= ntime; itime ++) {
-					double t1 = (itime - 1) * dtime;
-					double t2 = t1 + dtime;
-					double mean = 0.0;
-					integer i1, i2;
-					integer n = Matrix_getWindowSamplesX (basil.get(), t1, t2, & i1, & i2);
-					Melder_assert (n >= 1);
-					if (n <= 2) {
-						for (integer isamp = i1; isamp <= i2; isamp ++)
-							mean += basil -> z [1] [isamp];
-						mean /= n;
-					} else {
-						integer muint = Melder_ifloor ((i1 + i2) / 2.0), dint = Melder_ifloor (d);
-						for (integer isamp = muint - dint; isamp <= muint + dint; isamp ++) {
-							double y = 0;
-							if (isamp < 1 || isamp > basil -> nx)
-								Melder_casual (U"isamp ", isamp);
-							else
-								y = basil -> z [1] [isamp];
-							mean += y * onebyoneminexpmin6 * (exp (factor * (isamp - muint) *
-								(isamp - muint)) - expmin6);
+				if (dtime == my dx) {
+					for (integer itime = 1; itime <= ntime; itime ++)
+						response [itime] = basil -> z [1] [itime];
+				} else {
+					double d = dtime / basil -> dx / 2.0;
+					double factor = -6 / d / d;
+					double area = d * sqrt (NUMpi / 6);
+					double expmin6 = exp (-6), onebyoneminexpmin6 = 1 / (1 - expmin6);
+					for (integer itime = 1; itime <= ntime; itime ++) {
+						double t1 = (itime - 1) * dtime;
+						double t2 = t1 + dtime;
+						double mean = 0.0;
+						integer i1, i2;
+						integer n = Matrix_getWindowSamplesX (basil.get(), t1, t2, & i1, & i2);
+						Melder_assert (n >= 1);
+						if (n <= 2) {
+							for (integer isamp = i1; isamp <= i2; isamp ++)
+								mean += basil -> z [1] [isamp];
+							mean /= n;
+						} else {
+							integer muint = Melder_ifloor ((i1 + i2) / 2.0), dint = Melder_ifloor (d);
+							for (integer isamp = muint - dint; isamp <= muint + dint; isamp ++) {
+								double y = 0;
+								if (isamp < 1 || isamp > basil -> nx)
+									numberOfSamplesOutside [itask] ++;
+								else
+									y = basil -> z [1] [isamp];
+								mean += y * onebyoneminexpmin6 * (exp (factor * (isamp - muint) *
+									(isamp - muint)) - expmin6);
+							}
+							mean /= area;
 						}
-						mean /= area;
+						response [itime] = mean;
 					}
-					response [itime] = mean;
 				}
 			}
-		}
+		});
+		integer totalNumberOfSamplesOutside = 0;
+		for (integer itask = 1; itask <= numberOfTasks; itask ++)
+			totalNumberOfSamplesOutside += numberOfSamplesOutside [itask];
+		if (totalNumberOfSamplesOutside > 0)
+			Melder_casual (U"Sound_to_Cochleagram_edb: ", totalNumberOfSamplesOutside,
+					U" samples outside the sound were taken as zero.");
 		return thee;
 	} catch (MelderError) {
 		Melder_throw (me, U": not converted to Cochleagram (edb).");
@@ -42,7 +42,12 @@
 #define FCC_NORMAL  2
 #define FCC_ACCURATE  3
 
-static void Sound_into_PitchFrame (Sound me, Pitch_Frame pitchFrame, double t,
+/*
+	`me` contains the samples sampleOffset + 1 .. sampleOffset + my nx of `sampling`;
+	times are converted to sample numbers in `sampling`, so that a block of a LongSound
+	gives exactly the same frames as the whole sound would.
+*/
+static void Sound_into_PitchFrame (Sound me, Sampled sampling, integer sampleOffset, Pitch_Frame pitchFrame, double t,
 	double pitchFloor, int maxnCandidates, int method, double voicingThreshold, double octaveCost,
 	NUMfft_Table fftTable, double dt_window, integer nsamp_window, integer halfnsamp_window,
 	integer maximumLag, integer nsampFFT, integer nsamp_period, integer halfnsamp_period,
@@ -50,7 +55,7 @@ static void Sound_into_PitchFrame (Sound me, Pitch_Frame pitchFrame, double t,
 	MAT const& frame, VEC const& ac, VEC const& window, VEC const& windowR,
 	double *r, INTVEC const& imax, VEC const& localMean)
 {
-	integer leftSample = Sampled_xToLowIndex (me, t), rightSample = leftSample + 1;
+	integer leftSample = Sampled_xToLowIndex (sampling, t) - sampleOffset, rightSample = leftSample + 1;
 	integer startSample, endSample;
 
 	for (integer channel = 1; channel <= my ny; channel ++) {
@@ -108,7 +113,7 @@ static void Sound_into_PitchFrame (Sound me, Pitch_Frame pitchFrame, double t,
 	if (method >= FCC_NORMAL) {
 		const double startTime = t - 0.5 * (1.0 / pitchFloor + dt_window);
 		integer localSpan = maximumLag + nsamp_window;
-		if ((startSample = Sampled_xToLowIndex (me, startTime)) < 1)
+		if ((startSample = Sampled_xToLowIndex (sampling, startTime) - sampleOffset) < 1)
 			startSample = 1;
 		if (localSpan > my nx + 1 - startSample)
 			localSpan = my nx + 1 - startSample;
@@ -261,6 +266,8 @@ static void Sound_into_PitchFrame (Sound me, Pitch_Frame pitchFrame, double t,
 
 Thing_define (Sound_into_Pitch_Args, Thing) { public:
 	Sound sound;
+	Sampled sampling;
+	integer sampleOffset;
 	Pitch pitch;
 	integer firstFrame, lastFrame;
 	double pitchFloor;
@@ -270,6 +277,7 @@ Thing_define (Sound_into_Pitch_Args, Thing) { public:
 	double globalPeak;
 	VEC window, windowR;
 	bool isMainThread;
+	double progressFrom, progressTo;
 	volatile int *cancelled;
 	autoNUMfft_Table fftTable;
 	autoMAT frame;
@@ -287,8 +295,8 @@ static void Sound_into_Pitch (Sound_into_Pitch_Args me)
 		const double t = Sampled_indexToX (my pitch, iframe);
 		if (my isMainThread) {
 			try {
-				Melder_progress (0.1 + 0.8 * (iframe - my firstFrame) / (my lastFrame - my firstFrame),
-					U"Sound to Pitch: analysing ", my lastFrame, U" frames");
+				Melder_progress (my progressFrom + (my progressTo - my progressFrom) * (iframe - my firstFrame) / (my lastFrame - my firstFrame),
+					U"Sound to Pitch: analysing ", my pitch -> nx, U" frames");
 			} catch (MelderError) {
 				*my cancelled = 1;
 				throw;
@@ -296,7 +304,7 @@ static void Sound_into_Pitch (Sound_into_Pitch_Args me)
 		} else if (*my cancelled) {
 			return;
 		}
-		Sound_into_PitchFrame (my sound, pitchFrame, t,
+		Sound_into_PitchFrame (my sound, my sampling, my sampleOffset, pitchFrame, t,
 			my pitchFloor, my maxnCandidates, my method, my voicingThreshold, my octaveCost,
 			& my fftTable, my dt_window, my nsamp_window, my halfnsamp_window,
 			my maximumLag, my nsampFFT, my nsamp_period, my halfnsamp_period,
@@ -307,13 +315,55 @@ static void Sound_into_Pitch (Sound_into_Pitch_Args me)
 	}
 }
 
-autoPitch Sound_to_Pitch_any (Sound me,
+/*
+	Computes the largest absolute deviation from the mean, over all channels,
+	reading the LongSound in blocks of at most `blockSize` samples.
+*/
+static double LongSound_getAbsolutePeakAroundMean (LongSound me, integer blockSize) {
+	autoVEC minimum = raw_VEC (my ny), maximum = raw_VEC (my ny);
+	minimum.all()  <<=  undefined;
+	maximum.all()  <<=  undefined;
+	autovector <longdouble> channelSum = newvectorzero <longdouble> (my ny);
+	for (integer firstSample = 1; firstSample <= my nx; firstSample += blockSize) {
+		const integer numberOfSamples = std::min (blockSize, my nx - firstSample + 1);
+		autoMAT block = raw_MAT (my ny, numberOfSamples);
+		LongSound_readAudioToFloat (me, block.get(), firstSample);
+		for (integer ichan = 1; ichan <= my ny; ichan ++) {
+			for (integer i = 1; i <= numberOfSamples; i ++) {
+				const double value = block [ichan] [i];
+				channelSum [ichan] += value;
+				if (isundef (minimum [ichan]) || value < minimum [ichan])
+					minimum [ichan] = value;
+				if (isundef (maximum [ichan]) || value > maximum [ichan])
+					maximum [ichan] = value;
+			}
+		}
+	}
+	double peak = 0.0;
+	for (integer ichan = 1; ichan <= my ny; ichan ++) {
+		const double mean = double (channelSum [ichan] / my nx);
+		Melder_clipLeft (fabs (maximum [ichan] - mean), & peak);
+		Melder_clipLeft (fabs (minimum [ichan] - mean), & peak);
+	}
+	return peak;
+}
+
+/*
+	A Sound is analysed in one piece.
+	A LongSound is read in blocks of about the length of its buffer,
+	each with enough margin for the analysis windows of its first and last frames,
+	so that the memory use does not grow with the duration of the file.
+	In both cases the path finder runs on the whole Pitch, so that the result is the same.
+*/
+static autoPitch Sound_or_LongSound_to_Pitch_any (Sound sound, LongSound longSound,
 	int method, double periodsPerWindow,
 	double dt, double pitchFloor, double pitchCeiling,
 	integer maxnCandidates,
 	double silenceThreshold, double voicingThreshold,
 	double octaveCost, double octaveJumpCost, double voicedUnvoicedCost)
 {
+	Melder_assert (!! sound != !! longSound);
+	const SampledXY me = ( sound ? static_cast <SampledXY> (sound) : static_cast <SampledXY> (longSound) );
 	try {
 		autoNUMfft_Table fftTable;
 		double t1;
@@ -409,14 +459,19 @@ autoPitch Sound_to_Pitch_any (Sound me,
 		/*
 			Compute the global absolute peak for determination of silence threshold.
 		*/
-		globalPeak = 0.0;
-		for (integer ichan = 1; ichan <= my ny; ichan ++) {
-			const double mean = NUMmean (my z.row (ichan));
-			for (integer i = 1; i <= my nx; i ++) {
-				double value = fabs (my z [ichan] [i] - mean);
-				if (value > globalPeak)
-					globalPeak = value;
+		const integer maximumBlockSize = ( longSound ? Melder_ifloor (longSound -> bufferLength / my dx) : my nx );
+		if (sound) {
+			globalPeak = 0.0;
+			for (integer ichan = 1; ichan <= sound -> ny; ichan ++) {
+				const double mean = NUMmean (sound -> z.row (ichan));
+				for (integer i = 1; i <= sound -> nx; i ++) {
+					double value = fabs (sound -> z [ichan] [i] - mean);
+					if (value > globalPeak)
+						globalPeak = value;
+				}
 			}
+		} else {
+			globalPeak = LongSound_getAbsolutePeakAroundMean (longSound, maximumBlockSize);
 		}
 		if (globalPeak == 0.0)
 			return thee;
@@ -483,60 +538,92 @@ autoPitch Sound_to_Pitch_any (Sound me,
 
 		autoMelderProgress progress (U"Sound to Pitch...");
 
-		integer numberOfFramesPerThread = 20;
-		integer numberOfThreads = (numberOfFrames - 1) / numberOfFramesPerThread + 1;
-		const integer numberOfProcessors = MelderThread_getNumberOfProcessors ();
-		trace (numberOfProcessors, U" processors");
-		Melder_clipRight (& numberOfThreads, numberOfProcessors);
-		Melder_clip (1_integer, & numberOfThreads, 16_integer);
-		numberOfFramesPerThread = (numberOfFrames - 1) / numberOfThreads + 1;
-
-		autoSound_into_Pitch_Args args [16];
-		integer firstFrame = 1, lastFrame = numberOfFramesPerThread;
-		volatile int cancelled = 0;
-		for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
-			if (ithread == numberOfThreads)
-				lastFrame = numberOfFrames;
-			autoSound_into_Pitch_Args arg = Thing_new (Sound_into_Pitch_Args);
-			arg -> sound = me;
-			arg -> pitch = thee.get();
-			arg -> firstFrame = firstFrame;
-			arg -> lastFrame = lastFrame;
-			arg -> pitchFloor = pitchFloor;
-			arg -> maxnCandidates = maxnCandidates;
-			arg -> method = method;
-			arg -> voicingThreshold = voicingThreshold;
-			arg -> octaveCost = octaveCost;
-			arg -> dt_window = dt_window;
-			arg -> nsamp_window = nsamp_window;
-			arg -> halfnsamp_window = halfnsamp_window;
-			arg -> maximumLag = maximumLag;
-			arg -> nsampFFT = nsampFFT;
-			arg -> nsamp_period = nsamp_period;
-			arg -> halfnsamp_period = halfnsamp_period;
-			arg -> brent_ixmax = brent_ixmax;
-			arg -> brent_depth = brent_depth;
-			arg -> globalPeak = globalPeak;
-			arg -> window = window.get();
-			arg -> windowR = windowR.get();
-			arg -> isMainThread = ( ithread == numberOfThreads );
-			arg -> cancelled = & cancelled;
-			if (method >= FCC_NORMAL) {   // cross-correlation
-				arg -> frame = zero_MAT (my ny, nsamp_window);
-			} else {   // autocorrelation
-				NUMfft_Table_init (& arg -> fftTable, nsampFFT);
-				arg -> frame = zero_MAT (my ny, nsampFFT);
-				arg -> ac = zero_VEC (nsampFFT);
+		auto analyseFrames = [&] (Sound part, integer sampleOffset, integer firstFrameOfPart, integer lastFrameOfPart, double progressFrom, double progressTo) {
+			const integer numberOfFramesInPart = lastFrameOfPart - firstFrameOfPart + 1;
+			integer numberOfFramesPerThread = 20;
+			integer numberOfThreads = (numberOfFramesInPart - 1) / numberOfFramesPerThread + 1;
+			const integer numberOfPoolThreads = MelderThread_getNumberOfThreads ();
+			trace (numberOfPoolThreads, U" threads");
+			Melder_clipRight (& numberOfThreads, numberOfPoolThreads);
+			Melder_clip (1_integer, & numberOfThreads, 16_integer);
+			numberOfFramesPerThread = (numberOfFramesInPart - 1) / numberOfThreads + 1;
+
+			autoSound_into_Pitch_Args args [16];
+			integer firstFrame = firstFrameOfPart, lastFrame = firstFrameOfPart - 1 + numberOfFramesPerThread;
+			volatile int cancelled = 0;
+			for (int ithread = 1; ithread <= numberOfThreads; ithread ++) {
+				if (ithread == numberOfThreads)
+					lastFrame = lastFrameOfPart;
+				autoSound_into_Pitch_Args arg = Thing_new (Sound_into_Pitch_Args);
+				arg -> sound = part;
+				arg -> sampling = me;
+				arg -> sampleOffset = sampleOffset;
+				arg -> pitch = thee.get();
+				arg -> firstFrame = firstFrame;
+				arg -> lastFrame = lastFrame;
+				arg -> pitchFloor = pitchFloor;
+				arg -> maxnCandidates = maxnCandidates;
+				arg -> method = method;
+				arg -> voicingThreshold = voicingThreshold;
+				arg -> octaveCost = octaveCost;
+				arg -> dt_window = dt_window;
+				arg -> nsamp_window = nsamp_window;
+				arg -> halfnsamp_window = halfnsamp_window;
+				arg -> maximumLag = maximumLag;
+				arg -> nsampFFT = nsampFFT;
+				arg -> nsamp_period = nsamp_period;
+				arg -> halfnsamp_period = halfnsamp_period;
+				arg -> brent_ixmax = brent_ixmax;
+				arg -> brent_depth = brent_depth;
+				arg -> globalPeak = globalPeak;
+				arg -> window = window.get();
+				arg -> windowR = windowR.get();
+				arg -> isMainThread = ( ithread == numberOfThreads );
+				arg -> progressFrom = progressFrom;
+				arg -> progressTo = progressTo;
+				arg -> cancelled = & cancelled;
+				if (method >= FCC_NORMAL) {   // cross-correlation
+					arg -> frame = zero_MAT (my ny, nsamp_window);
+				} else {   // autocorrelation
+					NUMfft_Table_init (& arg -> fftTable, nsampFFT);
+					arg -> frame = zero_MAT (my ny, nsampFFT);
+					arg -> ac = zero_VEC (nsampFFT);
+				}
+				arg -> rbuffer = zero_VEC (2 * nsamp_window + 1);
+				arg -> r = & arg -> rbuffer [1 + nsamp_window];
+				arg -> imax = zero_INTVEC (maxnCandidates);
+				arg -> localMean = zero_VEC (my ny);
+				args [ithread - 1] = std::move (arg);
+				firstFrame = lastFrame + 1;
+				lastFrame += numberOfFramesPerThread;
+			}
+			MelderThread_run (Sound_into_Pitch, args, numberOfThreads);
+		};
+
+		if (sound) {
+			analyseFrames (sound, 0, 1, numberOfFrames, 0.1, 0.9);
+		} else {
+			/*
+				The first and last samples that a frame can look at are within this distance from its centre
+				(the cross-correlation method looks furthest ahead).
+			*/
+			const integer marginInSamples = nsamp_period + halfnsamp_window + maximumLag + nsamp_window +
+					Melder_iceiling (0.5 * (1.0 / pitchFloor + dt_window) / my dx) + 2;
+			const integer numberOfFramesPerBlock = std::max (1_integer, Melder_ifloor ((maximumBlockSize - 2 * marginInSamples) * my dx / dt));
+			for (integer firstFrame = 1; firstFrame <= numberOfFrames; firstFrame += numberOfFramesPerBlock) {
+				const integer lastFrame = std::min (firstFrame + numberOfFramesPerBlock - 1, numberOfFrames);
+				const integer firstSample = std::max (1_integer,
+						Sampled_xToLowIndex (me, Sampled_indexToX (thee.get(), firstFrame)) - marginInSamples);
+				const integer lastSample = std::min (my nx,
+						Sampled_xToLowIndex (me, Sampled_indexToX (thee.get(), lastFrame)) + 1 + marginInSamples);
+				autoSound block = Sound_create (my ny,
+						Sampled_indexToX (me, firstSample) - 0.5 * my dx, Sampled_indexToX (me, lastSample) + 0.5 * my dx,
+						lastSample - firstSample + 1, my dx, Sampled_indexToX (me, firstSample));
+				LongSound_readAudioToFloat (longSound, block -> z.get(), firstSample);
+				analyseFrames (block.get(), firstSample - 1, firstFrame, lastFrame,
+						0.1 + 0.8 * (firstFrame - 1) / numberOfFrames, 0.1 + 0.8 * lastFrame / numberOfFrames);
 			}
-			arg -> rbuffer = zero_VEC (2 * nsamp_window + 1);
-			arg -> r = & arg -> rbuffer [1 + nsamp_window];
-			arg -> imax = zero_INTVEC (maxnCandidates);
-			arg -> localMean = zero_VEC (my ny);
-			args [ithread - 1] = std::move (arg);
-			firstFrame = lastFrame + 1;
-			lastFrame += numberOfFramesPerThread;
 		}
-		MelderThread_run (Sound_into_Pitch, args, numberOfThreads);
 
 		Melder_progress (0.95, U"Sound to Pitch: path finder");
 		Pitch_pathFinder (thee.get(), silenceThreshold, voicingThreshold,
@@ -548,6 +635,34 @@ autoPitch Sound_to_Pitch_any (Sound me,
 	}
 }
 
+autoPitch Sound_to_Pitch_any (Sound me,
+	int method, double periodsPerWindow,
+	double dt, double pitchFloor, double pitchCeiling,
+	integer maxnCandidates,
+	double silenceThreshold, double voicingThreshold,
+	double octaveCost, double octaveJumpCost, double voicedUnvoicedCost)
+{
+	return Sound_or_LongSound_to_Pitch_any (me, nullptr, method, periodsPerWindow,
+		dt, pitchFloor, pitchCeiling,
+		maxnCandidates,
+		silenceThreshold, voicingThreshold, octaveCost, octaveJumpCost, voicedUnvoicedCost
+	);
+}
+
+autoPitch LongSound_to_Pitch_any (LongSound me,
+	int method, double periodsPerWindow,
+	double dt, double pitchFloor, double pitchCeiling,
+	integer maxnCandidates,
+	double silenceThreshold, double voicingThreshold,
+	double octaveCost, double octaveJumpCost, double voicedUnvoicedCost)
+{
+	return Sound_or_LongSound_to_Pitch_any (nullptr, me, method, periodsPerWindow,
+		dt, pitchFloor, pitchCeiling,
+		maxnCandidates,
+		silenceThreshold, voicingThreshold, octaveCost, octaveJumpCost, voicedUnvoicedCost
+	);
+}
+
 autoPitch Sound_to_Pitch (Sound me, double timeStep, double pitchFloor, double pitchCeiling) {
 	return Sound_to_Pitch_rawAc (me, timeStep, pitchFloor, pitchCeiling,
 			15, false, 0.03, 0.45, 0.01, 0.35, 0.14);
@@ -566,6 +681,24 @@ autoPitch Sound_to_Pitch_rawAc (Sound me,
 	);
 }
 
+autoPitch LongSound_to_Pitch (LongSound me, double timeStep, double pitchFloor, double pitchCeiling) {
+	return LongSound_to_Pitch_rawAc (me, timeStep, pitchFloor, pitchCeiling,
+			15, false, 0.03, 0.45, 0.01, 0.35, 0.14);
+}
+
+autoPitch LongSound_to_Pitch_rawAc (LongSound me,
+	double timeStep, double pitchFloor, double pitchCeiling,
+	integer maxnCandidates, bool veryAccurate,
+	double silenceThreshold, double voicingThreshold,
+	double octaveCost, double octaveJumpCost, double voicedUnvoicedCost)
+{
+	return LongSound_to_Pitch_any (me, (int) veryAccurate, 3.0,
+		timeStep, pitchFloor, pitchCeiling,
+		maxnCandidates,
+		silenceThreshold, voicingThreshold, octaveCost, octaveJumpCost, voicedUnvoicedCost
+	);
+}
+
 autoPitch Sound_to_Pitch_rawCc (Sound me,
 	double timeStep, double pitchFloor, double pitchCeiling,
 	integer maxnCandidates, bool veryAccurate,
@@ -16,7 +16,7 @@
  * along with this work. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "Sound.h"
+#include "LongSound.h"
 #include "Pitch.h"
 
 autoPitch Sound_to_Pitch (Sound me, double timeStep,
@@ -100,4 +100,27 @@ autoPitch Sound_to_Pitch_filteredCc (Sound me,
 	double silenceThreshold, double voicingThreshold,
 	double octaveCost, double octaveJumpCost, double voicedUnvoicedCost);
 
+autoPitch LongSound_to_Pitch (LongSound me, double timeStep,
+	double pitchFloor, double pitchCeiling);
+/* Calls LongSound_to_Pitch_rawAc with default arguments. */
+
+autoPitch LongSound_to_Pitch_rawAc (LongSound me,
+	double timeStep, double pitchFloor, double pitchCeiling,
+	integer maxnCandidates, bool veryAccurate,
+	double silenceThreshold, double voicingThreshold, double octaveCost,
+	double octaveJumpCost, double voicedUnvoicedCost);
+/* Calls LongSound_to_Pitch_any with AC method. */
+
+autoPitch LongSound_to_Pitch_any (LongSound me,
+	int method, double periodsPerWindow,
+	double timeStep, double pitchFloor, double pitchCeiling,
+	integer maxnCandidates,
+	double silenceThreshold, double voicingThreshold, double octaveCost,
+	double octaveJumpCost, double voicedUnvoicedCost);
+/*
+	Gives the same result as Sound_to_Pitch_any on the whole LongSound,
+	but reads the file in blocks of the length of the LongSound's buffer,
+	so that the memory needed for the samples does not depend on the duration of the file.
+*/
+
 /* End of file Sound_to_Pitch.h */
@@ -249,6 +249,28 @@ integer IntervalTier_hasBoundary (IntervalTier me, double t) {
 	return 0;   // not found
 }
 
+autoINTVEC IntervalTier_timesToIndices (IntervalTier me, constVECVU const& times) {
+	autoINTVEC result = zero_INTVEC (times.size);
+	const integer numberOfIntervals = my intervals.size;
+	if (numberOfIntervals < 1)
+		return result;   // empty tier
+	/*
+		Search through a contiguous array of end times, rather than through the intervals themselves.
+	*/
+	autoVEC endTimes = raw_VEC (numberOfIntervals);
+	for (integer iinterval = 1; iinterval <= numberOfIntervals; iinterval ++)
+		endTimes [iinterval] = my intervals.at [iinterval] -> xmax;
+	const double startTime = my intervals.at [1] -> xmin, endTime = endTimes [numberOfIntervals];
+	for (integer itime = 1; itime <= times.size; itime ++) {
+		const double t = times [itime];
+		if (! (t >= startTime && t <= endTime))
+			continue;   // outside the tier, or undefined
+		const integer firstIntervalEndingAfterT = std::upper_bound (endTimes.begin(), endTimes.end(), t) - endTimes.begin() + 1;
+		result [itime] = std::min (firstIntervalEndingAfterT, numberOfIntervals);   // t at the end of the tier belongs to the last interval
+	}
+	return result;
+}
+
 void structTextGrid :: v1_info () {
 	structDaata :: v1_info ();
 
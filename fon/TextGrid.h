@@ -52,6 +52,11 @@ integer IntervalTier_timeToIndex (IntervalTier me, double t);   // obsolete
 integer IntervalTier_timeToHighIndex (IntervalTier me, double t);
 integer IntervalTier_hasTime (IntervalTier me, double t);
 integer IntervalTier_hasBoundary (IntervalTier me, double t);
+autoINTVEC IntervalTier_timesToIndices (IntervalTier me, constVECVU const& times);
+/*
+	For each of the times, the same number as IntervalTier_timeToIndex () would give,
+	i.e. 0 for times outside the tier; much faster than repeated calls if there are many times.
+*/
 autoPointProcess IntervalTier_getStartingPoints (IntervalTier me, conststring32 text);
 autoPointProcess IntervalTier_getEndPoints (IntervalTier me, conststring32 text);
 autoPointProcess IntervalTier_getCentrePoints (IntervalTier me, conststring32 text);
@@ -132,6 +132,23 @@ DO
 	SAVE_ONE_END
 }
 
+FORM (SAVE_ONE__LongSound_saveAsResampledAudioFile, U"LongSound: Save as resampled audio file", nullptr) {
+	OUTFILE (audioFile, U"Audio file", U"")
+	CHOICE (type, U"Type", 3)
+	{ int i; for (i = 1; i <= Melder_NUMBER_OF_AUDIO_FILE_TYPES; i ++) {
+		OPTION (Melder_audioFileTypeString (i))
+	}}
+	POSITIVE (newSamplingFrequency, U"New sampling frequency (Hz)", U"16000.0")
+	NATURAL (precision, U"Precision (samples)", U"50")
+	OK
+DO
+	SAVE_ONE (LongSound)
+		structMelderFile file { };
+		Melder_relativePathToFile (audioFile, & file);
+		LongSound_saveAsResampledAudioFile (me, type, newSamplingFrequency, precision, & file, 16);
+	SAVE_ONE_END
+}
+
 FORM (NEW_LongSound_to_TextGrid, U"LongSound: To TextGrid...", U"LongSound: To TextGrid...") {
 	SENTENCE (tierNames, U"Tier names", U"Mary John bell")
 	SENTENCE (pointTiers, U"Point tiers", U"bell")
@@ -142,6 +159,44 @@ DO
 	CONVERT_EACH_TO_ONE_END (my name.get())
 }
 
+FORM (CONVERT_EACH_TO_ONE__LongSound_to_Pitch, U"LongSound: To Pitch", U"Sound: To Pitch...") {
+	REAL (timeStep, U"Time step (s)", U"0.0 (= auto)")
+	POSITIVE (pitchFloor, U"Pitch floor (Hz)", U"75.0")
+	POSITIVE (pitchCeiling, U"Pitch ceiling (Hz)", U"600.0")
+	OK
+DO
+	CONVERT_EACH_TO_ONE (LongSound)
+		autoPitch result = LongSound_to_Pitch (me, timeStep, pitchFloor, pitchCeiling);
+	CONVERT_EACH_TO_ONE_END (my name.get())
+}
+
+FORM (CONVERT_EACH_TO_ONE__LongSound_to_Pitch_rawAutocorrelation, U"LongSound: To Pitch (raw autocorrelation)", U"Sound: To Pitch (raw autocorrelation)...") {
+	HEADING (U"Where to search...")
+	REAL (timeStep, U"Time step (s)", U"0.0 (= auto)")
+	POSITIVE (pitchFloor, U"left Pitch floor and ceiling (Hz)", U"75.0")
+	POSITIVE (pitchCeiling, U"right Pitch floor and ceiling (Hz)", U"600.0")
+	HEADING (U"How to find the candidates...")
+	NATURAL (maximumNumberOfCandidates, U"Max. number of candidates", U"15")
+	BOOLEAN (veryAccurate, U"Very accurate", false)
+	HEADING (U"How to find a path through the candidates...")
+	REAL (silenceThreshold, U"Silence threshold", U"0.03")
+	REAL (voicingThreshold, U"Voicing threshold", U"0.45")
+	REAL (octaveCost, U"Octave cost", U"0.01")
+	REAL (octaveJumpCost, U"Octave-jump cost", U"0.35")
+	REAL (voicedUnvoicedCost, U"Voiced / unvoiced cost", U"0.14")
+	OK
+DO
+	Melder_require (maximumNumberOfCandidates > 1,
+		U"Your maximum number of candidates should be greater than 1.");
+	CONVERT_EACH_TO_ONE (LongSound)
+		autoPitch result = LongSound_to_Pitch_rawAc (me,
+			timeStep, pitchFloor, pitchCeiling,
+			maximumNumberOfCandidates, veryAccurate,
+			silenceThreshold, voicingThreshold, octaveCost, octaveJumpCost, voicedUnvoicedCost
+		);
+	CONVERT_EACH_TO_ONE_END (my name.get())
+}
+
 DIRECT (EDITOR_ONE__LongSound_view) {
 	EDITOR_ONE (a,LongSound)
 		autoSoundEditor editor = SoundEditor_create (ID_AND_FULL_NAME, me);
@@ -271,6 +326,20 @@ DO
 	PREFS_END
 }
 
+FORM (SETTINGS__LongSoundOverviewSettings, U"LongSound overview settings", U"LongSound") {
+	COMMENT (U"Zoomed-out waveforms of long sound files are drawn from an overview")
+	COMMENT (U"that is computed the first time you need it.")
+	BOOLEAN (saveOverviewFiles, U"Save overview next to sound file", false)
+	COMMENT (U"If on, a file with the extension \".overview\" is saved next to the sound file,")
+	COMMENT (U"so that the overview is available immediately when you open the sound file again.")
+OK
+	SET_BOOLEAN (saveOverviewFiles, LongSound_getSaveOverviewFilesPref ())
+DO
+	PREFS
+		LongSound_setSaveOverviewFilesPref (saveOverviewFiles);
+	PREFS_END
+}
+
 /********** LONGSOUND & SOUND **********/
 
 FORM_SAVE (SAVE_ALL__LongSound_Sound_saveAsAifcFile, U"Save as AIFC file", nullptr, U"aifc") {
@@ -2276,6 +2345,8 @@ void praat_Sound_init () {
 			SETTINGS__SoundPlayingSettings);   // alternative GuiMenu_DEPRECATED_2023
 	praat_addMenuCommand (U"Objects", U"Settings", U"LongSound settings... || LongSound preferences...", nullptr, 0,
 			SETTINGS__LongSoundSettings);   // alternative GuiMenu_DEPRECATED_2023
+	praat_addMenuCommand (U"Objects", U"Settings", U"LongSound overview settings...", nullptr, 0,
+			SETTINGS__LongSoundOverviewSettings);
 #ifdef HAVE_PULSEAUDIO
 	praat_addMenuCommand (U"Objects", U"Technical", U"Report sound server properties", U"Report system properties", 0,
 			INFO_NONE__Praat_reportSoundServerProperties);
@@ -2304,6 +2375,11 @@ void praat_Sound_init () {
 				HELP__AnnotationTutorial);
 		praat_addAction1 (classLongSound, 0, U"-- to text grid --", nullptr, 1, nullptr);
 		praat_addAction1 (classLongSound, 0, U"To TextGrid...", nullptr, 1, NEW_LongSound_to_TextGrid);
+	praat_addAction1 (classLongSound, 0, U"Analyse periodicity -", nullptr, 0, nullptr);
+		praat_addAction1 (classLongSound, 0, U"To Pitch...", nullptr, 1,
+				CONVERT_EACH_TO_ONE__LongSound_to_Pitch);
+		praat_addAction1 (classLongSound, 0, U"To Pitch (raw autocorrelation)...", nullptr, 1,
+				CONVERT_EACH_TO_ONE__LongSound_to_Pitch_rawAutocorrelation);
 	praat_addAction1 (classLongSound, 0, U"Convert to Sound", nullptr, 0, nullptr);
 	praat_addAction1 (classLongSound, 0, U"Extract part...", nullptr, 0, NEW_LongSound_extractPart);
 	praat_addAction1 (classLongSound, 0, U"Concatenate?", nullptr, 0,
@@ -2346,6 +2422,8 @@ void praat_Sound_init () {
 			nullptr, 0, SAVE_ONE__LongSound_saveRightChannelAsFlacFile);
 	praat_addAction1 (classLongSound, 1, U"Save part as audio file... || Write part to audio file...",
 			nullptr, 0, SAVE_ONE__LongSound_savePartAsAudioFile);
+	praat_addAction1 (classLongSound, 1, U"Save as resampled audio file...",
+			nullptr, 0, SAVE_ONE__LongSound_saveAsResampledAudioFile);
 
 	praat_addAction1 (classSound, 0, U"Save as WAV file... || Write to WAV file...",
 			nullptr, 0, SAVE_ALL__Sound_saveAsWavFile);   // alternative COMPATIBILITY <= 2011
@@ -975,6 +975,37 @@ DO
 	QUERY_ONE_FOR_REAL_END (U" (interval number)")
 }
 
+FORM (NUMVEC_TextGrid_listIntervalsAtTimes, U"TextGrid: List intervals at times", nullptr) {
+	NATURAL (tierNumber, STRING_TIER_NUMBER, U"1")
+	REALVECTOR (times, U"Times (s)", WHITESPACE_SEPARATED_, U"0.5 0.7 2.0")
+	OK
+DO
+	QUERY_ONE_FOR_REAL_VECTOR (TextGrid)
+		IntervalTier intervalTier = pr_TextGrid_peekIntervalTier (me, tierNumber);
+		autoINTVEC intervalNumbers = IntervalTier_timesToIndices (intervalTier, times);
+		autoVEC result = raw_VEC (intervalNumbers.size);
+		for (integer itime = 1; itime <= result.size; itime ++)
+			result [itime] = intervalNumbers [itime];
+	QUERY_ONE_FOR_REAL_VECTOR_END
+}
+
+FORM (STRVEC_TextGrid_listLabelsOfIntervalsAtTimes, U"TextGrid: List labels of intervals at times", nullptr) {
+	NATURAL (tierNumber, STRING_TIER_NUMBER, U"1")
+	REALVECTOR (times, U"Times (s)", WHITESPACE_SEPARATED_, U"0.5 0.7 2.0")
+	OK
+DO
+	QUERY_ONE_FOR_STRING_ARRAY (TextGrid)
+		IntervalTier intervalTier = pr_TextGrid_peekIntervalTier (me, tierNumber);
+		autoINTVEC intervalNumbers = IntervalTier_timesToIndices (intervalTier, times);
+		autoSTRVEC result (intervalNumbers.size);
+		for (integer itime = 1; itime <= result.size; itime ++) {
+			const integer intervalNumber = intervalNumbers [itime];
+			const conststring32 label = ( intervalNumber ? intervalTier -> intervals.at [intervalNumber] -> text.get() : nullptr );
+			result [itime] = Melder_dup (label ? label : U"");
+		}
+	QUERY_ONE_FOR_STRING_ARRAY_END
+}
+
 FORM (INTEGER_TextGrid_getLowIntervalAtTime, U"TextGrid: Get low interval at time", nullptr) {
 	NATURAL (tierNumber, STRING_TIER_NUMBER, U"1")
 	REAL (time, U"Time (s)", U"0.5")
@@ -1639,6 +1670,8 @@ void praat_uvafon_TextGrid_init () {
 			praat_addAction1 (classTextGrid, 1, U"Get high interval at time...", nullptr, 2, INTEGER_TextGrid_getHighIntervalAtTime);
 			praat_addAction1 (classTextGrid, 1, U"Get interval edge from time...", nullptr, 2, INTEGER_TextGrid_getIntervalEdgeFromTime);
 			praat_addAction1 (classTextGrid, 1, U"Get interval boundary from time...", nullptr, 2, INTEGER_TextGrid_getIntervalBoundaryFromTime);
+			praat_addAction1 (classTextGrid, 1, U"List intervals at times...", nullptr, 2, NUMVEC_TextGrid_listIntervalsAtTimes);
+			praat_addAction1 (classTextGrid, 1, U"List labels of intervals at times...", nullptr, 2, STRVEC_TextGrid_listLabelsOfIntervalsAtTimes);
 			praat_addAction1 (classTextGrid, 1, U"-- query interval labels --", nullptr, 2, nullptr);
 			praat_addAction1 (classTextGrid, 1, U"Count intervals where...", nullptr, 2, INTEGER_TextGrid_countIntervalsWhere);
 		praat_addAction1 (classTextGrid, 1, U"Query point tier", nullptr, 1, nullptr);
@@ -55,6 +55,36 @@ static void SoundArea_drawCursorFunctionValue (SoundArea me, double yWC, constst
 	Graphics_text (my graphics(), my startWindow(), yWC,   yWC_string, units);
 }
 
+/*
+	Draw the minimum and maximum of each pixel column, connected in a zigzag,
+	as Graphics_function16 would do if all the samples were in the buffer.
+*/
+static void SoundArea_drawLongSoundOverview (SoundArea me, const integer channel, const integer first, const integer last) {
+	LongSound longSound = my longSound();
+	const double xmin = Sampled_indexToX (longSound, first) - 0.5 * longSound -> dx;
+	const double xmax = Sampled_indexToX (longSound, last) + 0.5 * longSound -> dx;
+	const integer numberOfColumns = Melder_clipped (1_integer,
+		Melder_iround (Graphics_dxWCtoMM (my graphics(), xmax - xmin) * Graphics_getResolution (my graphics()) / 25.4),
+		last - first + 1
+	);
+	autoINTVEC minima = raw_INTVEC (numberOfColumns), maxima = raw_INTVEC (numberOfColumns);
+	try {
+		LongSound_getOverview (longSound, channel, first, last, minima.get(), maxima.get());
+	} catch (MelderError) {
+		Melder_clearError ();
+		return;
+	}
+	autoVEC x = raw_VEC (2 * numberOfColumns), y = raw_VEC (2 * numberOfColumns);
+	const double columnWidth = (xmax - xmin) / numberOfColumns;
+	for (integer icol = 1; icol <= numberOfColumns; icol ++) {
+		x [2 * icol - 1] = x [2 * icol] = xmin + (icol - 0.5) * columnWidth;
+		const bool upwards = ( icol % 2 == 1 );
+		y [2 * icol - 1] = ( upwards ? minima [icol] : maxima [icol] );
+		y [2 * icol] = ( upwards ? maxima [icol] : minima [icol] );
+	}
+	Graphics_polyline (my graphics(), 2 * numberOfColumns, & x [1], & y [1]);
+}
+
 void structSoundArea :: v_drawInside () {
 	SoundArea_draw (this);
 }
@@ -74,16 +104,6 @@ void SoundArea_draw (SoundArea me) {
 	const bool cursorVisible = ( my startSelection() == my endSelection() &&
 			my startSelection() >= my startWindow() && my startSelection() <= my endWindow() );
 	Graphics_setColour (my graphics(), Melder_BLACK);
-	if (my longSound() && my endWindow() - my startWindow() > my longSound() -> bufferLength) {
-		Graphics_setWindow (my graphics(), 0.0, 1.0, 0.0, 1.0);
-		Graphics_setColour (my graphics(), Melder_BLACK);
-		Graphics_setTextAlignment (my graphics(), Graphics_CENTRE, Graphics_BOTTOM);
-		Graphics_text (my graphics(), 0.5, 0.5,   U"(window longer than ",
-				Melder_float (Melder_single (my longSound() -> bufferLength)), U" seconds)");
-		Graphics_setTextAlignment (my graphics(), Graphics_CENTRE, Graphics_TOP);
-		Graphics_text (my graphics(), 0.5, 0.5, U"(zoom in to see the samples)");
-		return;
-	}
 	bool fits;
 	try {
 		fits = ( my sound() ? true : LongSound_haveWindow (my longSound(), my startWindow(), my endWindow()) );
@@ -98,12 +118,9 @@ void SoundArea_draw (SoundArea me) {
 		Graphics_text (my graphics(), 0.5, 0.5, outOfMemory ? U"(out of memory)" : U"(cannot read sound file)");
 		return;
 	}
-	if (! fits) {
-		Graphics_setWindow (my graphics(), 0.0, 1.0, 0.0, 1.0);
-		Graphics_setTextAlignment (my graphics(), Graphics_CENTRE, Graphics_HALF);
-		Graphics_text (my graphics(), 0.5, 0.5, U"(window too large; zoom in to see the data)");
-		return;
-	}
+	/*
+		A LongSound window that does not fit in the buffer is drawn as an overview (see below).
+	*/
 	integer first, last;
 	if (Sampled_getWindowSamples (my soundOrLongSound(),
 		my startWindow(), my endWindow(), & first, & last) <= 1)
@@ -250,6 +267,10 @@ void SoundArea_draw (SoundArea me) {
 			Graphics_setColour (my graphics(), DataGui_defaultForegroundColour (me, false));
 			Graphics_function (my graphics(), & my sound() -> z [ichan] [0], first, last,
 					Sampled_indexToX (my sound(), first), Sampled_indexToX (my sound(), last));
+		} else if (! fits) {
+			Graphics_setWindow (my graphics(), my startWindow(), my endWindow(), minimum * 32768, maximum * 32768);
+			Graphics_setColour (my graphics(), DataGui_defaultForegroundColour (me, false));
+			SoundArea_drawLongSoundOverview (me, ichan, first, last);
 		} else {
 			Graphics_setWindow (my graphics(), my startWindow(), my endWindow(), minimum * 32768, maximum * 32768);
 			Graphics_setColour (my graphics(), DataGui_defaultForegroundColour (me, false));
@@ -1,6 +1,6 @@
 /* Network.cpp
  *
- * Copyright (C) 2009,2011-2023 Paul Boersma
+ * Copyright (C) 2009,2011-2023,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -25,11 +25,13 @@
  * pb 2012/03/18 more weight update rules: instar, outstar, inoutstar
  * pb 2012/04/19 more activation clipping rules: linear
  * pb 2012/06/02 activation spreading rules: sudden, gradual
+ * pb 2026/10/18 spreading over compressed rows of connections, on several threads
  */
 
 #include "Network.h"
 #include "Matrix.h"
 #include "Formula.h"
+#include "MelderThread.h"
 
 #include "oo_DESTROY.h"
 #include "Network_def.h"
@@ -189,56 +191,154 @@ void Network_setClamping (Network me, integer nodeNumber, bool clamped) {
 	}
 }
 
+static void Network_updateIncidences (Network me) {
+	if (my incidencesAreUpToDate)
+		return;
+	autoINTVEC starts = zero_INTVEC (my numberOfNodes + 1);
+	for (integer iconn = 1; iconn <= my numberOfConnections; iconn ++) {
+		const NetworkConnection connection = & my connections [iconn];
+		my checkNodeNumber (connection -> nodeFrom);
+		my checkNodeNumber (connection -> nodeTo);
+		starts [connection -> nodeFrom] += 1;
+		starts [connection -> nodeTo] += 1;
+	}
+	integer position = 1;
+	for (integer inode = 1; inode <= my numberOfNodes; inode ++) {
+		const integer numberOfIncidences = starts [inode];
+		starts [inode] = position;
+		position += numberOfIncidences;
+	}
+	starts [my numberOfNodes + 1] = position;
+	Melder_assert (position == 2 * my numberOfConnections + 1);
+	autoINTVEC nodes = raw_INTVEC (2 * my numberOfConnections);
+	autoINTVEC connections = raw_INTVEC (2 * my numberOfConnections);
+	autoINTVEC next = copy_INTVEC (starts.get());
+	for (integer iconn = 1; iconn <= my numberOfConnections; iconn ++) {
+		const NetworkConnection connection = & my connections [iconn];
+		const integer fromIncidence = next [connection -> nodeFrom] ++;
+		nodes [fromIncidence] = connection -> nodeTo;
+		connections [fromIncidence] = iconn;
+		const integer toIncidence = next [connection -> nodeTo] ++;
+		nodes [toIncidence] = connection -> nodeFrom;
+		connections [toIncidence] = iconn;
+	}
+	my incidenceStarts = starts.move();
+	my incidenceNodes = nodes.move();
+	my incidenceConnections = connections.move();
+	my incidenceWeights = raw_VEC (2 * my numberOfConnections);
+	my incidenceShuntings = raw_VEC (2 * my numberOfConnections);
+	my spreadingActivities = raw_VEC (my numberOfNodes);
+	my spreadingNewActivities = raw_VEC (my numberOfNodes);
+	my spreadingExcitations = raw_VEC (my numberOfNodes);
+	my spreadingClamped = raw_BOOLVEC (my numberOfNodes);
+	my incidencesAreUpToDate = true;
+}
+
+static void Network_updateIncidenceWeights (Network me) {
+	const double excitatoryShunting = my shunting;
+	const constINTVEC incidenceConnections = my incidenceConnections.get();
+	const VEC incidenceWeights = my incidenceWeights.get(), incidenceShuntings = my incidenceShuntings.get();
+	for (integer incidence = 1; incidence <= incidenceConnections.size; incidence ++) {
+		const double weight = my connections [incidenceConnections [incidence]]. weight;
+		incidenceWeights [incidence] = weight;
+		incidenceShuntings [incidence] = ( weight >= 0.0 ? excitatoryShunting : 0.0 );   // only for excitatory connections
+	}
+}
+
+static double Network_clipActivity (Network me, double excitation, double activity) {
+	switch (my activityClippingRule) {
+		case kNetwork_activityClippingRule::SIGMOID:
+			return my minimumActivity +
+				(my maximumActivity - my minimumActivity) * NUMsigmoid (excitation - 0.5 * (my minimumActivity + my maximumActivity));
+		case kNetwork_activityClippingRule::LINEAR:
+			if (excitation < my minimumActivity)
+				return my minimumActivity;
+			if (excitation > my maximumActivity)
+				return my maximumActivity;
+			return excitation;
+		case kNetwork_activityClippingRule::TOP_SIGMOID:
+			if (excitation <= my minimumActivity)
+				return my minimumActivity;
+			return my minimumActivity +
+				(my maximumActivity - my minimumActivity) * (2.0 * NUMsigmoid (2.0 * (excitation - my minimumActivity) / (my maximumActivity - my minimumActivity)) - 1.0);
+		case kNetwork_activityClippingRule::UNDEFINED:
+			return activity;
+	}
+	return activity;
+}
+
 void Network_spreadActivities (Network me, integer numberOfSteps) {
-	for (integer istep = 1; istep <= numberOfSteps; istep ++) {
+	try {
+		if (numberOfSteps < 1 || my numberOfNodes < 1)
+			return;
+		Network_updateIncidences (me);
+		const integer numberOfIncidences = 2 * my numberOfConnections;
+		/*
+			The nodes are kept as separate arrays during spreading.
+			The activities of the previous step are kept apart from the new ones, and every node collects
+			the contributions of its own connections in the order of the connection list,
+			so that the nodes can be updated independently of each other (on several threads),
+			with the same result as when the connections are visited one by one.
+		*/
 		for (integer inode = 1; inode <= my numberOfNodes; inode ++) {
-			NetworkNode node = & my nodes [inode];
-			if (! node -> clamped)
-				node -> excitation -= my spreadingRate * my activityLeak * node -> excitation;
+			my spreadingActivities [inode] = my nodes [inode]. activity;
+			my spreadingExcitations [inode] = my nodes [inode]. excitation;
+			my spreadingClamped [inode] = my nodes [inode]. clamped;
 		}
-		for (integer iconn = 1; iconn <= my numberOfConnections; iconn ++) {
-			NetworkConnection connection = & my connections [iconn];
-			NetworkNode nodeFrom = & my nodes [connection -> nodeFrom];
-			NetworkNode nodeTo = & my nodes [connection -> nodeTo];
-			const double shunting = ( my connections [iconn]. weight >= 0.0 ? my shunting : 0.0 );   // only for excitatory connections
-			if (! nodeFrom -> clamped)
-				nodeFrom -> excitation += my spreadingRate * nodeTo -> activity *
-						(my connections [iconn]. weight - shunting * nodeFrom -> excitation);
-			if (! nodeTo -> clamped)
-				nodeTo -> excitation += my spreadingRate * nodeFrom -> activity *
-						(my connections [iconn]. weight - shunting * nodeTo -> excitation);
+		Network_updateIncidenceWeights (me);   // the weights may have changed since the previous call
+		/*
+			Each task gets a range of nodes with about the same number of nodes plus incidences.
+		*/
+		const integer totalWork = my numberOfNodes + numberOfIncidences;
+		constexpr integer minimumWorkPerTask = 10000;
+		integer numberOfTasks = ( Melder_debug == -8 ? 1 : totalWork / minimumWorkPerTask );
+		Melder_clip (1_integer, & numberOfTasks, 2 * MelderThread_getNumberOfThreads ());
+		autoINTVEC firstNodeOfTask = raw_INTVEC (numberOfTasks + 1);
+		integer inode = 1;
+		for (integer itask = 1; itask <= numberOfTasks; itask ++) {
+			const integer workBefore = (itask - 1) * totalWork / numberOfTasks;
+			while (inode <= my numberOfNodes && (inode - 1) + (my incidenceStarts [inode] - 1) < workBefore)
+				inode ++;
+			firstNodeOfTask [itask] = inode;
 		}
-		for (integer inode = 1; inode <= my numberOfNodes; inode ++) {
-			NetworkNode node = & my nodes [inode];
-			if (! node -> clamped) {
-				switch (my activityClippingRule) {
-					case kNetwork_activityClippingRule::SIGMOID:
-						node -> activity = my minimumActivity +
-							(my maximumActivity - my minimumActivity) * NUMsigmoid (node -> excitation - 0.5 * (my minimumActivity + my maximumActivity));
-					break;
-					case kNetwork_activityClippingRule::LINEAR:
-						if (node -> excitation < my minimumActivity) {
-							node -> activity = my minimumActivity;
-						} else if (node -> excitation > my maximumActivity) {
-							node -> activity = my maximumActivity;
-						} else {
-							node -> activity = node -> excitation;
-						}
-					break;
-					case kNetwork_activityClippingRule::TOP_SIGMOID:
-						if (node -> excitation <= my minimumActivity) {
-							node -> activity = my minimumActivity;
-						} else {
-							node -> activity = my minimumActivity +
-								(my maximumActivity - my minimumActivity) * (2.0 * NUMsigmoid (2.0 * (node -> excitation - my minimumActivity) / (my maximumActivity - my minimumActivity)) - 1.0);
-							trace (U"excitation ", node -> excitation, U", activity ", node -> activity);
-						}
-					break;
-					case kNetwork_activityClippingRule::UNDEFINED:
-					break;
+		firstNodeOfTask [numberOfTasks + 1] = my numberOfNodes + 1;
+
+		VEC oldActivity = my spreadingActivities.get(), newActivity = my spreadingNewActivities.get();
+		for (integer istep = 1; istep <= numberOfSteps; istep ++) {
+			MelderThread_runTasks (numberOfTasks, [&] (integer itask) {
+				/*
+					Local copies, so that the compiler can see that the arrays and parameters
+					are not changed by the writes to the excitations.
+				*/
+				const double spreadingRate = my spreadingRate, activityLeak = my activityLeak;
+				const constINTVEC incidenceStarts = my incidenceStarts.get(), incidenceNodes = my incidenceNodes.get();
+				const constVEC incidenceWeights = my incidenceWeights.get(), incidenceShuntings = my incidenceShuntings.get();
+				const constVEC previousActivities = oldActivity;
+				const VEC nextActivities = newActivity, nodeExcitations = my spreadingExcitations.get();
+				const constBOOLVEC nodeIsClamped = my spreadingClamped.get();
+				const integer firstNode = firstNodeOfTask [itask], lastNode = firstNodeOfTask [itask + 1] - 1;
+				for (integer jnode = firstNode; jnode <= lastNode; jnode ++) {
+					if (nodeIsClamped [jnode]) {
+						nextActivities [jnode] = previousActivities [jnode];
+						continue;
+					}
+					double excitation = nodeExcitations [jnode];
+					excitation -= spreadingRate * activityLeak * excitation;
+					for (integer incidence = incidenceStarts [jnode]; incidence < incidenceStarts [jnode + 1]; incidence ++)
+						excitation += spreadingRate * previousActivities [incidenceNodes [incidence]] *
+								(incidenceWeights [incidence] - incidenceShuntings [incidence] * excitation);
+					nodeExcitations [jnode] = excitation;
+					nextActivities [jnode] = Network_clipActivity (me, excitation, previousActivities [jnode]);
 				}
-			}
+			});
+			std::swap (oldActivity, newActivity);
+		}
+		for (integer knode = 1; knode <= my numberOfNodes; knode ++) {
+			my nodes [knode]. activity = oldActivity [knode];
+			my nodes [knode]. excitation = my spreadingExcitations [knode];
 		}
+	} catch (MelderError) {
+		Melder_throw (me, U": activities not spread.");
 	}
 }
 
@@ -461,6 +561,7 @@ void Network_addNode (Network me, double x, double y, double activity, bool clam
 		node -> y = y;
 		node -> activity = node -> excitation = activity;
 		node -> clamped = clamped;
+		my incidencesAreUpToDate = false;
 	} catch (MelderError) {
 		Melder_throw (me, U": node not added.");
 	}
@@ -476,6 +577,7 @@ void Network_addConnection (Network me, integer nodeFrom, integer nodeTo, double
 		connection -> nodeTo = nodeTo;
 		connection -> weight = weight;
 		connection -> plasticity = plasticity;
+		my incidencesAreUpToDate = false;
 	} catch (MelderError) {
 		Melder_throw (me, U": connection not added.");
 	}
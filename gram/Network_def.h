@@ -1,6 +1,6 @@
 /* Network_def.h
  *
- * Copyright (C) 2009-2020,2022 Paul Boersma
+ * Copyright (C) 2009-2020,2022,2026 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -111,6 +111,24 @@ oo_DEFINE_CLASS (Network, Daata)
 	oo_STRUCTVEC (NetworkConnection, connections, numberOfConnections)
 
 	#if oo_DECLARING
+		/*
+			For spreading activities: the connections of each node, in compressed sparse rows
+			(node i has the incidences incidenceStarts [i] .. incidenceStarts [i + 1] - 1,
+			in the order of the connection list; a connection of a node to itself occurs twice).
+			Built from the connection list when needed; not part of the persistent data.
+		*/
+		bool incidencesAreUpToDate = false;
+		autoINTVEC incidenceStarts;   // numberOfNodes + 1
+		autoINTVEC incidenceNodes;   // the node at the other end of the connection
+		autoINTVEC incidenceConnections;   // the connection number
+		/*
+			Work arrays for spreading, kept from one call to the next: the weights and shuntings
+			of the incidences, and the node data as separate arrays.
+		*/
+		autoVEC incidenceWeights, incidenceShuntings;
+		autoVEC spreadingActivities, spreadingNewActivities, spreadingExcitations;
+		autoBOOLVEC spreadingClamped;
+
 		void v1_info ()
 			override;
 		void checkNodeNumber (integer nodeNumber) {
@@ -144,13 +144,23 @@ double Melder_atof (conststring32 string) {
 		return undefined;
 	const integer numberOfCharacters = endOfNumericString - & string [0];
 	Melder_assert (numberOfCharacters > 0);
-	static MelderString buffer;
-	MelderString_ncopy (& buffer, string, numberOfCharacters);
-	const char *string8 = Melder_peek32to8 (buffer.string);
-	const integer string8length = Melder8_length (string8);
-	if (string8length < 1)
-		return undefined;
-	return string8 [string8length - 1] == '%' ? 0.01 * strtod (string8, nullptr) : strtod (string8, nullptr);
+	/*
+		The numeric string consists of ASCII characters only, so we can copy it character by character.
+		We do not use a static buffer, so that this function can be called from several threads at the same time.
+	*/
+	char localBuffer [100];
+	autostring8 longBuffer;
+	char *string8 = localBuffer;
+	if (numberOfCharacters >= (integer) sizeof (localBuffer)) {
+		longBuffer = autostring8 (numberOfCharacters);
+		string8 = longBuffer.get();
+	}
+	for (integer i = 0; i < numberOfCharacters; i ++) {
+		Melder_assert (string [i] <= 0x7F);
+		string8 [i] = (char) string [i];
+	}
+	string8 [numberOfCharacters] = '\0';
+	return string8 [numberOfCharacters - 1] == '%' ? 0.01 * strtod (string8, nullptr) : strtod (string8, nullptr);
 }
 
 int64 Melder_atoi (conststring32 string) {
@@ -2093,6 +2093,125 @@ void Melder_readAudioToShort (MelderFile file, integer numberOfChannels, int enc
 	}
 }
 
+bool Melder_canDecodeAudioFromMemory (int encoding) {
+	return
+		encoding >= Melder_LINEAR_8_SIGNED && encoding <= Melder_ALAW ||
+		encoding >= Melder_IEEE_FLOAT_32_BIG_ENDIAN && encoding <= Melder_IEEE_FLOAT_64_LITTLE_ENDIAN;
+}
+
+/*
+	The linear encodings as a left-aligned 32-bit integer, i.e. scaled to the range -2^31 .. 2^31 - 1,
+	as in Melder_readAudioToFloat.
+*/
+static inline int32 decodeLeftAlignedInteger (const uint8 *p, int encoding) {
+	switch (encoding) {
+		case Melder_LINEAR_16_BIG_ENDIAN:
+			return (int32) ((uint32) p [0] << 24 | (uint32) p [1] << 16);
+		case Melder_LINEAR_16_LITTLE_ENDIAN:
+			return (int32) ((uint32) p [1] << 24 | (uint32) p [0] << 16);
+		case Melder_LINEAR_24_BIG_ENDIAN:
+			return (int32) ((uint32) p [0] << 24 | (uint32) p [1] << 16 | (uint32) p [2] << 8);
+		case Melder_LINEAR_24_LITTLE_ENDIAN:
+			return (int32) ((uint32) p [2] << 24 | (uint32) p [1] << 16 | (uint32) p [0] << 8);
+		case Melder_LINEAR_32_BIG_ENDIAN:
+			return (int32) ((uint32) p [0] << 24 | (uint32) p [1] << 16 | (uint32) p [2] << 8 | (uint32) p [3]);
+		case Melder_LINEAR_32_LITTLE_ENDIAN:
+			return (int32) ((uint32) p [3] << 24 | (uint32) p [2] << 16 | (uint32) p [1] << 8 | (uint32) p [0]);
+		default:
+			Melder_fatal (U"decodeLeftAlignedInteger: unexpected encoding ", encoding, U".");
+	}
+}
+
+static inline double decodeIeeeFloat (const uint8 *p, int encoding) {
+	if (encoding == Melder_IEEE_FLOAT_32_BIG_ENDIAN || encoding == Melder_IEEE_FLOAT_32_LITTLE_ENDIAN) {
+		const bool bigEndian = ( encoding == Melder_IEEE_FLOAT_32_BIG_ENDIAN );
+		uint32 bits = 0;
+		for (int ibyte = 0; ibyte < 4; ibyte ++)
+			bits = bits << 8 | p [bigEndian ? ibyte : 3 - ibyte];
+		float value;
+		memcpy (& value, & bits, 4);
+		return value;
+	} else {
+		const bool bigEndian = ( encoding == Melder_IEEE_FLOAT_64_BIG_ENDIAN );
+		uint64 bits = 0;
+		for (int ibyte = 0; ibyte < 8; ibyte ++)
+			bits = bits << 8 | p [bigEndian ? ibyte : 7 - ibyte];
+		double value;
+		memcpy (& value, & bits, 8);
+		return value;
+	}
+}
+
+void Melder_decodeAudioToFloat (const uint8 *bytes, int encoding, MAT buffer) {
+	const integer numberOfChannels = buffer.nrow, numberOfSamples = buffer.ncol;
+	const int numberOfBytesPerSamplePoint = Melder_bytesPerSamplePoint (encoding);
+	for (integer isamp = 1; isamp <= numberOfSamples; isamp ++) {
+		for (integer ichan = 1; ichan <= numberOfChannels; ichan ++, bytes += numberOfBytesPerSamplePoint) {
+			switch (encoding) {
+				case Melder_LINEAR_8_SIGNED:
+					buffer [ichan] [isamp] = (int8) bytes [0] * (1.0 / 128);
+					break;
+				case Melder_LINEAR_8_UNSIGNED:
+					buffer [ichan] [isamp] = bytes [0] * (1.0 / 128) - 1.0;
+					break;
+				case Melder_LINEAR_16_BIG_ENDIAN:
+				case Melder_LINEAR_16_LITTLE_ENDIAN:
+					buffer [ichan] [isamp] = (decodeLeftAlignedInteger (bytes, encoding) / 65536) * (1.0 / 32768);
+					break;
+				case Melder_LINEAR_24_BIG_ENDIAN:
+				case Melder_LINEAR_24_LITTLE_ENDIAN:
+				case Melder_LINEAR_32_BIG_ENDIAN:
+				case Melder_LINEAR_32_LITTLE_ENDIAN:
+					buffer [ichan] [isamp] = decodeLeftAlignedInteger (bytes, encoding) * (1.0 / 32768 / 65536);
+					break;
+				case Melder_MULAW:
+					buffer [ichan] [isamp] = ulaw2linear [bytes [0]] * (1.0 / 32768);
+					break;
+				case Melder_ALAW:
+					buffer [ichan] [isamp] = alaw2linear [bytes [0]] * (1.0 / 32768);
+					break;
+				default:
+					buffer [ichan] [isamp] = decodeIeeeFloat (bytes, encoding);
+			}
+		}
+	}
+}
+
+void Melder_decodeAudioToShort (const uint8 *bytes, integer numberOfChannels, int encoding, short *buffer, integer numberOfSamples) {
+	const integer n = numberOfSamples * numberOfChannels;
+	const int numberOfBytesPerSamplePoint = Melder_bytesPerSamplePoint (encoding);
+	for (integer i = 0; i < n; i ++, bytes += numberOfBytesPerSamplePoint) {
+		switch (encoding) {
+			case Melder_LINEAR_8_SIGNED:
+				buffer [i] = (int8) bytes [0] * 256;
+				break;
+			case Melder_LINEAR_8_UNSIGNED:
+				buffer [i] = bytes [0] * 256L - 32768;
+				break;
+			case Melder_LINEAR_16_BIG_ENDIAN:
+			case Melder_LINEAR_16_LITTLE_ENDIAN:
+				buffer [i] = (int16) (decodeLeftAlignedInteger (bytes, encoding) / 65536);
+				break;
+			case Melder_LINEAR_24_BIG_ENDIAN:
+			case Melder_LINEAR_24_LITTLE_ENDIAN:
+				buffer [i] = decodeLeftAlignedInteger (bytes, encoding) / 256 / 256;   // the same truncation as in Melder_readAudioToShort
+				break;
+			case Melder_LINEAR_32_BIG_ENDIAN:
+			case Melder_LINEAR_32_LITTLE_ENDIAN:
+				buffer [i] = decodeLeftAlignedInteger (bytes, encoding) / 65536;
+				break;
+			case Melder_MULAW:
+				buffer [i] = ulaw2linear [bytes [0]];
+				break;
+			case Melder_ALAW:
+				buffer [i] = alaw2linear [bytes [0]];
+				break;
+			default:
+				buffer [i] = decodeIeeeFloat (bytes, encoding) * 32768;
+		}
+	}
+}
+
 void MelderFile_writeShortToAudio (MelderFile file, integer numberOfChannels, int encoding, const short *buffer, integer numberOfSamples) {
 	try {
 		FILE *f = file -> filePointer;
@@ -72,6 +72,15 @@ void Melder_readAudioToShort (MelderFile file, integer numberOfChannels, int enc
 /* If stereo, buffer will contain alternating left and right values.
  * Buffer is base-0.
  */
+bool Melder_canDecodeAudioFromMemory (int encoding);
+/* True for the uncompressed encodings (linear, IEEE float, mu-law and A-law).
+ */
+void Melder_decodeAudioToFloat (const uint8 *bytes, int encoding, MAT buffer);
+void Melder_decodeAudioToShort (const uint8 *bytes, integer numberOfChannels, int encoding, short *buffer, integer numberOfSamples);
+/* The same as Melder_readAudioToFloat and Melder_readAudioToShort,
+ * but the interleaved samples are taken from memory (e.g. a mapped file) instead of from an open file.
+ * The caller guarantees that all the bytes are there.
+ */
 void MelderFile_writeFloatToAudio (MelderFile file, constMATVU const& buffer, int encoding, bool warnIfClipped);
 void MelderFile_writeShortToAudio (MelderFile file, integer numberOfChannels, int encoding, const short *buffer, integer numberOfSamples);
 
@@ -20,6 +20,8 @@
 #include "NUM2.h"
 #include "Formula.h"
 #include "SSCP.h"
+#include "MelderThread.h"
+#include <atomic>
 
 #include "oo_DESTROY.h"
 #include "Table_def.h"
@@ -361,13 +363,7 @@ void Table_setNumericValue (Table me, integer rowNumber, integer columnNumber, d
 	}
 }
 
-bool Table_isCellNumeric_ErrorFalse (Table me, integer rowNumber, integer columnNumber) {
-	if (rowNumber < 1 || rowNumber > my rows.size)
-		return false;
-	if (columnNumber < 1 || columnNumber > my numberOfColumns)
-		return false;
-	const TableRow row = my rows.at [rowNumber];
-	conststring32 cell = row -> cells [columnNumber]. string.get();
+static bool isCellStringNumeric (conststring32 cell) {
 	if (! cell)
 		return true;   // namely the value --undefined--
 	/*
@@ -387,6 +383,19 @@ bool Table_isCellNumeric_ErrorFalse (Table me, integer rowNumber, integer column
 	return Melder_isStringNumeric (cell);
 }
 
+static double numberInNumericCell (conststring32 string) {
+	return ! string || string [0] == U'\0' || (string [0] == U'?' && string [1] == U'\0') ? undefined : Melder_atof (string);
+}
+
+bool Table_isCellNumeric_ErrorFalse (Table me, integer rowNumber, integer columnNumber) {
+	if (rowNumber < 1 || rowNumber > my rows.size)
+		return false;
+	if (columnNumber < 1 || columnNumber > my numberOfColumns)
+		return false;
+	const TableRow row = my rows.at [rowNumber];
+	return isCellStringNumeric (row -> cells [columnNumber]. string.get());
+}
+
 bool Table_isColumnNumeric_ErrorFalse (Table me, integer columnNumber) {
 	if (columnNumber < 1 || columnNumber > my numberOfColumns)
 		return false;
@@ -396,23 +405,44 @@ bool Table_isColumnNumeric_ErrorFalse (Table me, integer columnNumber) {
 	return true;
 }
 
-static void sortRowsByStrings_a (Table me, integer columnNumber) {
-	Melder_assert (columnNumber >= 1 && columnNumber <= my numberOfColumns);
-	std::sort (my rows.begin(), my rows.end(),
-		[columnNumber] (TableRow she, TableRow him) {
-			const conststring32 firstString = her cells [columnNumber]. string.get();
-			const conststring32 secondString = his cells [columnNumber]. string.get();
-			return str32cmp (firstString ? firstString : U"", secondString ? secondString : U"") < 0;
+/*
+	The row numbers in the order given by the numbers in the (numericized) columns;
+	rows with equal numbers keep their original order.
+	The numbers are first copied into a contiguous matrix, with the sorting keys of each row next to each other,
+	so that the comparisons do not have to go through the rows and their cells.
+	The table itself is not changed.
+*/
+static autoINTVEC Table_getSortingPermutation (Table me, constINTVECVU const& columnNumbers) {
+	const integer numberOfRows = my rows.size, numberOfKeys = columnNumbers.size;
+	autoMAT keys = raw_MAT (numberOfRows, numberOfKeys);
+	for (integer irow = 1; irow <= numberOfRows; irow ++) {
+		const constTableRow row = my rows.at [irow];
+		for (integer ikey = 1; ikey <= numberOfKeys; ikey ++)
+			keys [irow] [ikey] = row -> cells [columnNumbers [ikey]]. number;
+	}
+	autoINTVEC permutation = to_INTVEC (numberOfRows);
+	std::stable_sort (permutation.begin(), permutation.end(),
+		[& keys, numberOfKeys] (integer irow, integer jrow) -> bool {
+			for (integer ikey = 1; ikey <= numberOfKeys; ikey ++) {
+				if (keys [irow] [ikey] < keys [jrow] [ikey])
+					return true;
+				if (keys [irow] [ikey] > keys [jrow] [ikey])
+					return false;
+			}
+			return false;
 		}
 	);
+	return permutation;
 }
 
-static void sortRowsByIndex_NoError (Table me) {
-	std::sort (my rows.begin(), my rows.end(),
-		[] (TableRow she, TableRow him) {
-			return her sortingIndex < his sortingIndex;
-		}
-	);
+/*
+	The numbers in a (numericized) column, in the order of the permutation of the rows.
+*/
+static autoVEC Table_getPermutedNumbers (Table me, integer columnNumber, constINTVECVU const& permutation) {
+	autoVEC result = raw_VEC (permutation.size);
+	for (integer i = 1; i <= permutation.size; i ++)
+		result [i] = my rows.at [permutation [i]] -> cells [columnNumber]. number;
+	return result;
 }
 
 void Table_numericize_a (Table me, integer columnNumber) {
@@ -422,30 +452,34 @@ void Table_numericize_a (Table me, integer columnNumber) {
 	if (Table_isColumnNumeric_ErrorFalse (me, columnNumber)) {
 		for (integer irow = 1; irow <= my rows.size; irow ++) {
 			TableRow row = my rows.at [irow];
-			const conststring32 string = row -> cells [columnNumber]. string.get();
-			row -> cells [columnNumber]. number =
-					! string || string [0] == U'\0' || (string [0] == U'?' && string [1] == U'\0') ? undefined :
-					Melder_atof (string);
+			row -> cells [columnNumber]. number = numberInNumericCell (row -> cells [columnNumber]. string.get());
 		}
 	} else {
-		integer iunique = 0;
-		conststring32 previousString = nullptr;
+		/*
+			Dictionary-encode the strings: the number of each cell becomes the rank of its string
+			among the different strings in the column.
+			The rows themselves are not moved: we sort a contiguous list of the strings instead.
+		*/
+		autovector <conststring32> strings = newvectorraw <conststring32> (my rows.size);
 		for (integer irow = 1; irow <= my rows.size; irow ++) {
-			TableRow row = my rows.at [irow];
-			row -> sortingIndex = irow;
+			const conststring32 string = my rows.at [irow] -> cells [columnNumber]. string.get();
+			strings [irow] = ( string ? string : U"" );
 		}
-		sortRowsByStrings_a (me, columnNumber);
-		for (integer irow = 1; irow <= my rows.size; irow ++) {
-			TableRow row = my rows.at [irow];
-			conststring32 string = row -> cells [columnNumber]. string.get();
-			if (! string)
-				string = U"";
-			if (! previousString || ! str32equ (string, previousString))
+		autoINTVEC permutation = to_INTVEC (my rows.size);
+		std::sort (permutation.begin(), permutation.end(),
+			[& strings] (integer irow, integer jrow) -> bool {
+				return str32cmp (strings [irow], strings [jrow]) < 0;
+			}
+		);
+		/* mutable count */ integer iunique = 0;
+		/* mutable cycle */ conststring32 previousString = nullptr;
+		for (integer i = 1; i <= my rows.size; i ++) {
+			const integer irow = permutation [i];
+			if (! previousString || ! str32equ (strings [irow], previousString))
 				iunique ++;
-			row -> cells [columnNumber]. number = iunique;
-			previousString = string;
+			my rows.at [irow] -> cells [columnNumber]. number = iunique;
+			previousString = strings [irow];
 		}
-		sortRowsByIndex_NoError (me);
 	}
 	my columnHeaders [columnNumber]. numericized = true;
 }
@@ -742,7 +776,6 @@ autoTable Table_collapseRows (Table me, constSTRVEC factors, constSTRVEC columns
 	constSTRVEC columnsToAverage, constSTRVEC columnsToMedianize,
 	constSTRVEC columnsToAverageLogarithmically, constSTRVEC columnsToMedianizeLogarithmically)
 {
-	bool originalChanged = false;
 	try {
 		if (factors.size < 1)
 			Melder_throw (U"In order to pool table data, you must supply at least one independent variable.");
@@ -768,9 +801,6 @@ autoTable Table_collapseRows (Table me, constSTRVEC factors, constSTRVEC columns
 				columnsToAverageLogarithmically.size + columnsToMedianizeLogarithmically.size);
 		Melder_assert (thy numberOfColumns > 0);
 
-		autoVEC sortingColumn;
-		if (columnsToMedianize.size > 0 || columnsToMedianizeLogarithmically.size > 0)
-			sortingColumn = zero_VEC (my rows.size);
 		/*
 			Set the column names. Within the dependent variables, the same name may occur more than once.
 		*/
@@ -809,32 +839,31 @@ autoTable Table_collapseRows (Table me, constSTRVEC factors, constSTRVEC columns
 		for (integer icol = 1; icol <= thy numberOfColumns; icol ++)
 			Table_numericize_checkDefined (me, columns [icol]);
 		/*
-			Remember the present sorting of the original table.
-			(This is safe: the sorting index may change only vacuously when numericizing.)
-			But this cannot be done before the previous block!
+			Find the order of the rows when sorted by the factors (independent variables) only.
+			The original table stays as it is.
 		*/
-		for (integer irow = 1; irow <= my rows.size; irow ++) {
-			const TableRow row = my rows.at [irow];
-			row -> sortingIndex = irow;
-		}
+		autoINTVEC permutation = Table_getSortingPermutation (me, constINTVEC (columns.cells, factors.size));   // this works only because the factors come first
+		const integer numberOfRows = my rows.size;
 		/*
-			We will now sort the original table temporarily, by the factors (independent variables) only.
+			Copy the dependent variables into contiguous columns, in the sorted order,
+			so that the stretches of identical factors can be pooled without going through the rows.
 		*/
-		Table_sortRows_a (me, constINTVEC (columns.cells, factors.size));   // this works only because the factors come first
-		originalChanged = true;
+		autoMAT dependentColumns = raw_MAT (thy numberOfColumns - factors.size, numberOfRows);
+		for (integer icol = factors.size + 1; icol <= thy numberOfColumns; icol ++)
+			dependentColumns.row (icol - factors.size) <<= Table_getPermutedNumbers (me, columns [icol], permutation.get()).get();
 		/*
 			Find stretches of identical factors.
 		*/
-		for (integer irow = 1; irow <= my rows.size; irow ++) {
+		for (integer irow = 1; irow <= numberOfRows; irow ++) {
 			/* mutable search */ integer rowmin = irow, rowmax = irow;
+			const constTableRow firstRowOfStretch = my rows.at [permutation [rowmin]];
 			for (;;) {
 				bool identical = true;
-				if (++ rowmax > my rows.size)
+				if (++ rowmax > numberOfRows)
 					break;
+				const constTableRow row = my rows.at [permutation [rowmax]];
 				for (integer icol = 1; icol <= factors.size; icol ++) {
-					if (my rows.at [rowmax] -> cells [columns [icol]]. number !=
-						my rows.at [rowmin] -> cells [columns [icol]]. number)
-					{
+					if (row -> cells [columns [icol]]. number != firstRowOfStretch -> cells [columns [icol]]. number) {
 						identical = false;
 						break;
 					}
@@ -852,114 +881,94 @@ autoTable Table_collapseRows (Table me, constSTRVEC factors, constSTRVEC columns
 				for (integer i = 1; i <= factors.size; i ++) {
 					++ icol;
 					Table_setStringValue (thee.get(), thy rows.size, icol,
-						my rows.at [rowmin] -> cells [columns [icol]]. string.get());
+						firstRowOfStretch -> cells [columns [icol]]. string.get());
 				}
 				for (integer i = 1; i <= columnsToSum.size; i ++) {
 					++ icol;
+					const constVEC stretch = dependentColumns.row (icol - factors.size).part (rowmin, rowmax);
 					/* mutable accumulator */ longdouble sum = 0.0;
-					for (integer jrow = rowmin; jrow <= rowmax; jrow ++)
-						sum += my rows.at [jrow] -> cells [columns [icol]]. number;
+					for (integer j = 1; j <= stretch.size; j ++)
+						sum += stretch [j];
 					Table_setNumericValue (thee.get(), thy rows.size, icol, double (sum));
 				}
 				for (integer i = 1; i <= columnsToAverage.size; i ++) {
 					++ icol;
+					const constVEC stretch = dependentColumns.row (icol - factors.size).part (rowmin, rowmax);
 					/* mutable accumulator */ longdouble sum = 0.0;
-					for (integer jrow = rowmin; jrow <= rowmax; jrow ++)
-						sum += my rows.at [jrow] -> cells [columns [icol]]. number;
-					Table_setNumericValue (thee.get(), thy rows.size, icol, double (sum) / (rowmax - rowmin + 1));
+					for (integer j = 1; j <= stretch.size; j ++)
+						sum += stretch [j];
+					Table_setNumericValue (thee.get(), thy rows.size, icol, double (sum) / stretch.size);
 				}
 				for (integer i = 1; i <= columnsToMedianize.size; i ++) {
 					++ icol;
-					for (integer jrow = rowmin; jrow <= rowmax; jrow ++)
-						sortingColumn [jrow] = my rows.at [jrow] -> cells [columns [icol]]. number;
-					const VEC part = sortingColumn.part (rowmin, rowmax);
-					sort_e_VEC_inout (part);
-					const double median = NUMquantile (part, 0.5);
+					const VEC stretch = dependentColumns.row (icol - factors.size).part (rowmin, rowmax);
+					sort_e_VEC_inout (stretch);
+					const double median = NUMquantile (stretch, 0.5);
 					Table_setNumericValue (thee.get(), thy rows.size, icol, median);
 				}
 				for (integer i = 1; i <= columnsToAverageLogarithmically.size; i ++) {
 					++ icol;
+					const constVEC stretch = dependentColumns.row (icol - factors.size).part (rowmin, rowmax);
 					/* mutable accumulator */ longdouble sum = 0.0;
-					for (integer jrow = rowmin; jrow <= rowmax; jrow ++) {
-						const double value = my rows.at [jrow] -> cells [columns [icol]]. number;
+					for (integer j = 1; j <= stretch.size; j ++) {
+						const double value = stretch [j];
 						if (value <= 0.0) {
 							Melder_throw (
 								U"The cell in column \"", columnsToAverageLogarithmically [i],
-								U"\" of row ", jrow, U" of ", me,
+								U"\" of row ", permutation [rowmin - 1 + j], U" of ", me,
 								U" is not positive.\nCannot average logarithmically."
 							);
 						}
 						sum += log (value);
 					}
-					Table_setNumericValue (thee.get(), thy rows.size, icol, exp (double (sum / (rowmax - rowmin + 1))));
+					Table_setNumericValue (thee.get(), thy rows.size, icol, exp (double (sum / stretch.size)));
 				}
 				for (integer i = 1; i <= columnsToMedianizeLogarithmically.size; i ++) {
 					++ icol;
-					for (integer jrow = rowmin; jrow <= rowmax; jrow ++) {
-						const double value = my rows.at [jrow] -> cells [columns [icol]]. number;
+					const VEC stretch = dependentColumns.row (icol - factors.size).part (rowmin, rowmax);
+					for (integer j = 1; j <= stretch.size; j ++) {
+						const double value = stretch [j];
 						if (value <= 0.0) {
 							Melder_throw (
 								U"The cell in column \"", columnsToMedianizeLogarithmically [i],
-								U"\" of row ", jrow, U" of ", me,
+								U"\" of row ", permutation [rowmin - 1 + j], U" of ", me,
 								U" is not positive.\nCannot medianize logarithmically."
 							);
 						}
-						sortingColumn [jrow] = log (value);
+						stretch [j] = log (value);
 					}
-					const VEC part = sortingColumn.part (rowmin, rowmax);
-					sort_e_VEC_inout (part);
-					const double median = NUMquantile (part, 0.5);
+					sort_e_VEC_inout (stretch);
+					const double median = NUMquantile (stretch, 0.5);
 					Table_setNumericValue (thee.get(), thy rows.size, icol, exp (median));
 				}
 				Melder_assert (icol == thy numberOfColumns);
 			}
 			irow = rowmax;
 		}
-		if (originalChanged)
-			sortRowsByIndex_NoError (me);   // unsort the original table
 		return thee;
 	} catch (MelderError) {
-		if (originalChanged)
-			sortRowsByIndex_NoError (me);   // unsort the original table   // UGLY
-		throw;
+		Melder_throw (me, U": rows not collapsed.");
 	}
 }
 
 static autoSTRVEC Table_getLevels_ (Table me, integer column) {
-	try {
-		for (integer irow = 1; irow <= my rows.size; irow ++) {
-			const TableRow row = my rows.at [irow];
-			row -> sortingIndex = irow;
-		}
-		const integer sortingColumns [] = { column };
-		Table_sortRows_a (me, ARRAY_TO_INTVEC (sortingColumns));
-		/* mutable count */ integer numberOfLevels = 0;
-		/* mutable search */ integer irow = 1;
-		while (irow <= my rows.size) {
-			const double value = my rows.at [irow] -> cells [column]. number;
+	Table_numericize_a (me, column);
+	const integer sortingColumns [] = { column };
+	autoINTVEC permutation = Table_getSortingPermutation (me, ARRAY_TO_INTVEC (sortingColumns));
+	const autoVEC values = Table_getPermutedNumbers (me, column, permutation.get());
+	/* mutable count */ integer numberOfLevels = 0;
+	for (integer irow = 1; irow <= values.size; irow ++)
+		if (irow == 1 || values [irow] != values [irow - 1])
 			numberOfLevels ++;
-			while (++ irow <= my rows.size && my rows.at [irow] -> cells [column]. number == value)
-				;
-		}
-		autoSTRVEC result (numberOfLevels);
-		numberOfLevels = 0;
-		irow = 1;
-		while (irow <= my rows.size) {
-			const double value = my rows.at [irow] -> cells [column]. number;
-			result [++ numberOfLevels] = Melder_dup (Table_getStringValue_a (me, irow, column));
-			while (++ irow <= my rows.size && my rows.at [irow] -> cells [column]. number == value)
-				;
-		}
-		sortRowsByIndex_NoError (me);   // unsort the original table
-		return result;
-	} catch (MelderError) {
-		sortRowsByIndex_NoError (me);   // unsort the original table   // UGLY
-		throw;
-	}
+	autoSTRVEC result (numberOfLevels);
+	numberOfLevels = 0;
+	for (integer irow = 1; irow <= values.size; irow ++)
+		if (irow == 1 || values [irow] != values [irow - 1])
+			result [++ numberOfLevels] = Melder_dup (Table_getStringValue_a (me, permutation [irow], column));
+	return result;
 }
 
 static autoTable Table_rowsToColumns (Table me, constINTVECVU const& factorColumns, integer columnToTranspose, constINTVECVU const& columnsToExpand) {
-	bool originalChanged = false;
 	try {
 		bool warned = false;
 		/*
@@ -1001,32 +1010,24 @@ static autoTable Table_rowsToColumns (Table me, constINTVECVU const& factorColum
 			}
 		}
 		/*
-			Remember the present sorting of the original table.
-			(This is safe: the sorting index may change only vacuously when numericizing.)
-			But this cannot be done before the previous blocks that numericize!
-		*/
-		for (integer irow = 1; irow <= my rows.size; irow ++) {
-			const TableRow row = my rows.at [irow];
-			row -> sortingIndex = irow;
-		}
-		/*
-			We will now sort the original table temporarily, by the factors (independent variables) only.
+			Find the order of the rows when sorted by the factors (independent variables) only.
+			The original table stays as it is.
 		*/
-		Table_sortRows_a (me, factorColumns);
-		originalChanged = true;
+		autoINTVEC permutation = Table_getSortingPermutation (me, factorColumns);
+		const integer numberOfRows = my rows.size;
 		/*
 			Find stretches of identical factors.
 		*/
-		for (integer irow = 1; irow <= my rows.size; irow ++) {
+		for (integer irow = 1; irow <= numberOfRows; irow ++) {
 			integer rowmin = irow, rowmax = irow;
+			const constTableRow firstRowOfStretch = my rows.at [permutation [rowmin]];
 			for (;;) {
 				bool identical = true;
-				if (++ rowmax > my rows.size)
+				if (++ rowmax > numberOfRows)
 					break;
+				const constTableRow row = my rows.at [permutation [rowmax]];
 				for (integer ifactor = 1; ifactor <= numberOfFactors; ifactor ++) {
-					if (my rows.at [rowmax] -> cells [factorColumns [ifactor]]. number !=
-						my rows.at [rowmin] -> cells [factorColumns [ifactor]]. number)
-					{
+					if (row -> cells [factorColumns [ifactor]]. number != firstRowOfStretch -> cells [factorColumns [ifactor]]. number) {
 						identical = false;
 						break;
 					}
@@ -1049,10 +1050,10 @@ static autoTable Table_rowsToColumns (Table me, constINTVECVU const& factorColum
 			TableRow thyRow = thy rows.at [thy rows.size];
 			for (integer ifactor = 1; ifactor <= numberOfFactors; ifactor ++)
 				Table_setStringValue (thee.get(), thy rows.size, ifactor,
-						my rows.at [rowmin] -> cells [factorColumns [ifactor]]. string.get());
+						firstRowOfStretch -> cells [factorColumns [ifactor]]. string.get());
 			for (integer iexpand = 1; iexpand <= numberToExpand; iexpand ++) {
 				for (integer jrow = rowmin; jrow <= rowmax; jrow ++) {
-					TableRow myRow = my rows.at [jrow];
+					const constTableRow myRow = my rows.at [permutation [jrow]];
 					const double value = myRow -> cells [columnsToExpand [iexpand]]. number;
 					const integer level = Melder_iround (myRow -> cells [columnToTranspose]. number);
 					const integer thyColumn = numberOfFactors + (iexpand - 1) * numberOfLevels + level;
@@ -1066,13 +1067,9 @@ static autoTable Table_rowsToColumns (Table me, constINTVECVU const& factorColum
 			}
 			irow = rowmax;
 		}
-		if (originalChanged)
-			sortRowsByIndex_NoError (me);   // unsort the original table
 		return thee;
 	} catch (MelderError) {
-		if (originalChanged)
-			sortRowsByIndex_NoError (me);   // unsort the original table   // UGLY
-		throw;
+		Melder_throw (me, U": rows not converted to columns.");
 	}
 }
 
@@ -1111,18 +1108,12 @@ autoTable Table_transpose (Table me) {
 void Table_sortRows_a (Table me, constINTVECVU const& columnNumbers) {
 	for (integer icol = 1; icol <= columnNumbers.size; icol ++)
 		Table_numericize_a (me, columnNumbers [icol]);
-	std::sort (my rows.begin(), my rows.end(),
-		[columnNumbers] (TableRow she, TableRow him) -> bool {
-			for (integer icol = 1; icol <= columnNumbers.size; icol ++) {
-				const integer cellNumber = columnNumbers [icol];
-				if (her cells [cellNumber]. number < his cells [cellNumber]. number)
-					return true;
-				if (her cells [cellNumber]. number > his cells [cellNumber]. number)
-					return false;
-			}
-			return false;
-		}
-	);
+	autoINTVEC permutation = Table_getSortingPermutation (me, columnNumbers);
+	autovector <TableRow> sortedRows = newvectorraw <TableRow> (my rows.size);
+	for (integer irow = 1; irow <= my rows.size; irow ++)
+		sortedRows [irow] = my rows.at [permutation [irow]];
+	for (integer irow = 1; irow <= my rows.size; irow ++)
+		my rows.at [irow] = sortedRows [irow];
 }
 
 void Table_sortRows (Table me, constSTRVEC columnNames) {
@@ -2181,9 +2172,280 @@ autoTable Table_readFromTableFile (MelderFile file) {
 	}
 }
 
+/*
+	Reading a large character-separated text file is dominated by decoding the text and creating the cells.
+	If the file is valid UTF-8 (the usual case), we therefore read it directly from its bytes, on several threads:
+	the text is divided into stretches of whole lines, the rows are found by keeping track of the double quotes,
+	and each thread decodes the cells of its own rows, computing the numbers of the cells that look numeric along the way.
+	The result is exactly the same as that of the general reader (Table_readFromCharacterSeparatedTextFile below),
+	which we leave the text to if it is not valid UTF-8 (according to the preferences),
+	if it contains line separators other than newlines,
+	or if it is malformed in any way (so that the general reader can issue the error message or warning).
+*/
+
+/*
+	Checks the bytes from `p` up to the newline or null byte at `end`,
+	by the same rules as Melder_str8IsValidUtf8 ().
+	Form feeds, next-line characters and Unicode line and paragraph separators are refused,
+	because the general reader converts them to newlines.
+	Counts the double quotes, and the newlines that come after an even and after an odd number of double quotes.
+*/
+static bool Table_checkUtf8Stretch (const char8 *p, const char8 *end, bool interpretQuotes,
+	integer *out_numberOfQuotes, integer *out_numberOfNewlinesAfterEvenQuotes, integer *out_numberOfNewlinesAfterOddQuotes)
+{
+	integer numberOfQuotes = 0, numberOfNewlinesAfterEvenQuotes = 0, numberOfNewlinesAfterOddQuotes = 0;
+	for (; p < end; p ++) {
+		const char8 kar = *p;
+		if (kar <= 0x7F) {
+			if (kar == '\"' && interpretQuotes)
+				numberOfQuotes ++;
+			else if (kar == '\n')
+				( numberOfQuotes % 2 == 0 ? numberOfNewlinesAfterEvenQuotes : numberOfNewlinesAfterOddQuotes ) ++;
+			else if (kar == '\f')
+				return false;
+		} else if (kar <= 0xC1) {
+			return false;
+		} else if (kar <= 0xDF) {
+			if ((* ++ p & 0xC0) != 0x80)
+				return false;
+			if (kar == 0xC2 && *p == 0x85)
+				return false;   // next line
+		} else if (kar <= 0xEF) {
+			if ((* ++ p & 0xC0) != 0x80)
+				return false;
+			const char8 secondByte = *p;
+			if ((* ++ p & 0xC0) != 0x80)
+				return false;
+			if (kar == 0xE2 && secondByte == 0x80 && (*p == 0xA8 || *p == 0xA9))
+				return false;   // line separator or paragraph separator
+		} else if (kar <= 0xF4) {
+			if ((* ++ p & 0xC0) != 0x80)
+				return false;
+			if ((* ++ p & 0xC0) != 0x80)
+				return false;
+			if ((* ++ p & 0xC0) != 0x80)
+				return false;
+		} else {
+			return false;
+		}
+	}
+	*out_numberOfQuotes = numberOfQuotes;
+	*out_numberOfNewlinesAfterEvenQuotes = numberOfNewlinesAfterEvenQuotes;
+	*out_numberOfNewlinesAfterOddQuotes = numberOfNewlinesAfterOddQuotes;
+	return true;
+}
+
+/*
+	Decodes valid UTF-8 in the same way as Melder_8to32 (), optionally leaving out the double quotes.
+*/
+static autostring32 Table_decodeUtf8Stretch (const char8 *p, const char8 *end, integer numberOfCharacters, bool leaveOutQuotes) {
+	autostring32 result (numberOfCharacters);
+	char32 *q = & result [0];
+	while (p < end) {
+		const char32 kar1 = * p ++;   // convert up without sign extension
+		if (kar1 <= 0x00'007F) {
+			if (kar1 != U'\"' || ! leaveOutQuotes)
+				*q ++ = kar1;
+		} else if (kar1 <= 0x00'00DF) {
+			const char32 kar2 = * p ++;
+			*q ++ = ((kar1 & 0x00'001F) << 6) | (kar2 & 0x00'003F);
+		} else if (kar1 <= 0x00'00EF) {
+			const char32 kar2 = * p ++, kar3 = * p ++;
+			*q ++ = ((kar1 & 0x00'000F) << 12) | ((kar2 & 0x00'003F) << 6) | (kar3 & 0x00'003F);
+		} else {
+			const char32 kar2 = * p ++, kar3 = * p ++, kar4 = * p ++;
+			*q ++ = ((kar1 & 0x00'0007) << 18) | ((kar2 & 0x00'003F) << 12) | ((kar3 & 0x00'003F) << 6) | (kar4 & 0x00'003F);
+		}
+	}
+	Melder_assert (q - & result [0] == numberOfCharacters);
+	*q = U'\0';
+	return result;
+}
+
+static autoTable Table_readFromCharacterSeparatedUtf8Text (char *text, char32 separator, bool interpretQuotes) {
+	const kMelder_textInputEncoding inputEncoding = Melder_getInputEncoding ();
+	if (inputEncoding != kMelder_textInputEncoding::UTF8 &&
+		inputEncoding != kMelder_textInputEncoding::UTF8_THEN_ISO_LATIN1 &&
+		inputEncoding != kMelder_textInputEncoding::UTF8_THEN_WINDOWS_LATIN1 &&
+		inputEncoding != kMelder_textInputEncoding::UTF8_THEN_MACROMAN &&
+		inputEncoding != kMelder_textInputEncoding::UNDEFINED
+	)
+		return autoTable();
+	if (separator > 0x7F || separator == U'\"' && interpretQuotes)
+		return autoTable();
+	const char8 separator8 = (char8) separator;
+	const char8 *const string = (const char8 *) text;
+	/* mutable */ integer length = Melder8_length (text);
+	/*
+		Kill final new-line symbols.
+	*/
+	while (length > 0 && string [length - 1] == '\n')
+		text [-- length] = '\0';
+	/*
+		The first line contains the column names.
+	*/
+	const char8 *const endOfHeader = (const char8 *) strchr (text, '\n');
+	if (! endOfHeader)
+		return autoTable();   // no rows
+	{// scope
+		integer numberOfQuotes, numberOfNewlinesAfterEvenQuotes, numberOfNewlinesAfterOddQuotes;
+		if (! Table_checkUtf8Stretch (string, endOfHeader, false,
+				& numberOfQuotes, & numberOfNewlinesAfterEvenQuotes, & numberOfNewlinesAfterOddQuotes))
+			return autoTable();
+	}
+	integer numberOfColumns = 1;
+	for (const char8 *p = string; p < endOfHeader; p ++)
+		if (*p == separator8)
+			numberOfColumns ++;
+	/*
+		Divide the rest of the text into stretches of whole lines, one per task.
+	*/
+	const integer startOfBody = endOfHeader + 1 - string;
+	const integer numberOfTasks = Melder_clipped (integer (1), (length - startOfBody) / 100'000, MelderThread_getNumberOfThreads ());
+	autoINTVEC stretchStarts = raw_INTVEC (numberOfTasks + 1);
+	stretchStarts [1] = startOfBody;
+	for (integer itask = 2; itask <= numberOfTasks; itask ++) {
+		/* mutable search */ integer position = Melder_clippedLeft (stretchStarts [itask - 1],
+				startOfBody + (length - startOfBody) * (itask - 1) / numberOfTasks);
+		while (position < length && string [position] != '\n')
+			position ++;
+		stretchStarts [itask] = Melder_clippedRight (position + 1, length);
+	}
+	stretchStarts [numberOfTasks + 1] = length;
+	/*
+		First pass: check the text, and count the double quotes and the line breaks in each stretch.
+	*/
+	autoINTVEC numberOfQuotes = zero_INTVEC (numberOfTasks);
+	autoINTVEC numberOfNewlinesAfterEvenQuotes = zero_INTVEC (numberOfTasks);
+	autoINTVEC numberOfNewlinesAfterOddQuotes = zero_INTVEC (numberOfTasks);
+	std::atomic <bool> textIsPlainUtf8 = true;
+	MelderThread_runTasks (numberOfTasks, [&] (integer itask) {
+		if (! Table_checkUtf8Stretch (string + stretchStarts [itask], string + stretchStarts [itask + 1], interpretQuotes,
+				& numberOfQuotes [itask], & numberOfNewlinesAfterEvenQuotes [itask], & numberOfNewlinesAfterOddQuotes [itask]))
+			textIsPlainUtf8 = false;
+	});
+	if (! textIsPlainUtf8)
+		return autoTable();
+	/*
+		A row ends at each newline outside quotes (as the general reader counts them).
+	*/
+	autoINTVEC firstRowEndInStretch = raw_INTVEC (numberOfTasks);
+	autoBOOLVEC stretchStartsWithinQuotes = raw_BOOLVEC (numberOfTasks);
+	/* mutable count */ integer numberOfRowEnds = 0;
+	/* mutable flip */ bool withinQuotes = false;
+	for (integer itask = 1; itask <= numberOfTasks; itask ++) {
+		stretchStartsWithinQuotes [itask] = withinQuotes;
+		firstRowEndInStretch [itask] = numberOfRowEnds + 1;
+		numberOfRowEnds += ( withinQuotes ? numberOfNewlinesAfterOddQuotes [itask] : numberOfNewlinesAfterEvenQuotes [itask] );
+		if (numberOfQuotes [itask] % 2 != 0)
+			withinQuotes = ! withinQuotes;
+	}
+	if (withinQuotes)
+		return autoTable();   // an unmatched double quote
+	const integer numberOfRows = numberOfRowEnds + 1;
+	/*
+		Second pass: find where each row starts.
+	*/
+	autoINTVEC rowStarts = raw_INTVEC (numberOfRows + 1);
+	rowStarts [1] = startOfBody;
+	rowStarts [numberOfRows + 1] = length + 1;   // one beyond the final null byte, as if there were one more newline
+	MelderThread_runTasks (numberOfTasks, [&] (integer itask) {
+		/* mutable flip */ bool withinQuotes_task = stretchStartsWithinQuotes [itask];
+		/* mutable count */ integer irow = firstRowEndInStretch [itask];
+		for (integer position = stretchStarts [itask]; position < stretchStarts [itask + 1]; position ++) {
+			const char8 kar = string [position];
+			if (kar == '\"' && interpretQuotes)
+				withinQuotes_task = ! withinQuotes_task;
+			else if (kar == '\n' && ! withinQuotes_task)
+				rowStarts [++ irow] = position + 1;
+		}
+	});
+	/*
+		Create the table and read the column names.
+	*/
+	autoTable me = Table_create (numberOfRows, numberOfColumns);
+	{// scope
+		/* mutable */ const char8 *p = string;
+		for (integer icol = 1; icol <= numberOfColumns; icol ++) {
+			const char8 *const startOfName = p;
+			integer numberOfCharacters = 0;
+			for (; *p != separator8 && *p != '\n'; p ++)
+				if ((*p & 0xC0) != 0x80)
+					numberOfCharacters ++;
+			autostring32 name = Table_decodeUtf8Stretch (startOfName, p, numberOfCharacters, false);
+			Table_renameColumn_e (me.get(), icol, name.get());
+			p ++;
+		}
+	}
+	/*
+		Third pass: read the cells, row by row, in the same way as the general reader.
+		A row has to end exactly where it was found to end above; if not, we leave the text to the general reader.
+	*/
+	const integer numberOfRowsPerTask = (numberOfRows + numberOfTasks - 1) / numberOfTasks;
+	autoINTMAT numberOfNonnumericCells = zero_INTMAT (numberOfTasks, numberOfColumns);
+	std::atomic <bool> rowsAreWellFormed = true;
+	MelderThread_runTasks (numberOfTasks, [&] (integer itask) {
+		const integer firstRow = 1 + (itask - 1) * numberOfRowsPerTask;
+		const integer lastRow = std::min (itask * numberOfRowsPerTask, numberOfRows);
+		for (integer irow = firstRow; irow <= lastRow; irow ++) {
+			if (! rowsAreWellFormed)
+				return;
+			const TableRow row = my rows.at [irow];
+			const char8 *const endOfRow = string + rowStarts [irow + 1] - 1;   // a newline, or the final null byte
+			/* mutable */ const char8 *p = string + rowStarts [irow];
+			for (integer icol = 1; icol <= numberOfColumns; icol ++) {
+				const char8 *const startOfCell = p;
+				/* mutable count */ integer numberOfCharacters = 0;
+				/* mutable flip */ bool withinQuotes_cell = false;
+				while (*p != '\0' && (*p != separator8 && *p != '\n' || withinQuotes_cell)) {
+					if (interpretQuotes && *p == '\"')
+						withinQuotes_cell = ! withinQuotes_cell;
+					else if ((*p & 0xC0) != 0x80)
+						numberOfCharacters ++;
+					p ++;
+				}
+				const bool cellEndsAtEndOfRow = ( p == endOfRow && ! withinQuotes_cell );
+				if (icol < numberOfColumns ? p >= endOfRow || *p != separator8 : ! cellEndsAtEndOfRow) {
+					rowsAreWellFormed = false;
+					return;
+				}
+				autostring32 cell = Table_decodeUtf8Stretch (startOfCell, p, numberOfCharacters, interpretQuotes);
+				if (numberOfNonnumericCells [itask] [icol] == 0) {
+					if (isCellStringNumeric (cell.get()))
+						row -> cells [icol]. number = numberInNumericCell (cell.get());
+					else
+						numberOfNonnumericCells [itask] [icol] ++;
+				}
+				row -> cells [icol]. string = cell.move();
+				p ++;
+			}
+		}
+	});
+	if (! rowsAreWellFormed)
+		return autoTable();
+	/*
+		The columns whose cells are all numeric are now numericized already.
+	*/
+	for (integer icol = 1; icol <= numberOfColumns; icol ++) {
+		bool columnIsNumeric = true;
+		for (integer itask = 1; itask <= numberOfTasks; itask ++)
+			if (numberOfNonnumericCells [itask] [icol] > 0)
+				columnIsNumeric = false;
+		my columnHeaders [icol]. numericized = columnIsNumeric;
+	}
+	return me;
+}
+
 autoTable Table_readFromCharacterSeparatedTextFile (MelderFile file, char32 separator, bool interpretQuotes) {
 	try {
-		autostring32 string = MelderFile_readText (file);
+		autostring8 string8;
+		autostring32 string = MelderFile_readText (file, & string8);
+		if (string8) {
+			autoTable me = Table_readFromCharacterSeparatedUtf8Text (string8.get(), separator, interpretQuotes);
+			if (me)
+				return me;
+			string = Melder_8to32 (string8.get(), kMelder_textInputEncoding::UNDEFINED);
+		}
 
 		/*
 			Kill final new-line symbols.
@@ -36,10 +36,6 @@ oo_DEFINE_CLASS (TableRow, Daata)
 	oo_INTEGER (numberOfColumns)
 	oo_STRUCTVEC (TableCell, cells, numberOfColumns)
 
-	#if oo_DECLARING || oo_COPYING
-		oo_INTEGER (sortingIndex)
-	#endif
-
 oo_END_CLASS (TableRow)
 #undef ooSTRUCT
 
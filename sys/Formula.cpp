@@ -51,8 +51,10 @@ typedef struct structFormulaInstruction {
 	} content;
 } *FormulaInstruction;
 
-static FormulaInstruction lexan, parse;
+static FormulaInstruction lexan, parse;   // either the work buffers below, or the arrays of a reused FormulaProgram
+static FormulaInstruction theLexanBuffer, theParseBuffer;
 static integer ilabel, ilexan, iparse, numberOfInstructions, numberOfStringConstants;
+static bool theProgramCanBeReused;   // false if the program refers to objects, which can disappear before the next run
 
 enum { NO_SYMBOL_,
 
@@ -435,7 +437,7 @@ static void Formula_lexan () {
 	integer itok = 0;   // position of most recent symbol in "lexan"
 #define newtok(s)  { lexan [++ itok]. symbol = s; lexan [itok]. position = ikar; }
 #define toknumber(g)  lexan [itok]. content.number = (g)
-#define tokmatrix(m)  lexan [itok]. content.object = (m)
+#define tokmatrix(m)  (lexan [itok]. content.object = (m), theProgramCanBeReused = false)
 
 	static MelderString token;   // string to collect a symbol name in
 #define stringtokon MelderString_empty (& token);
@@ -2285,24 +2287,170 @@ static void Formula_print (FormulaInstruction f) {
 	} while (symbol != END_);
 }
 
+/*
+	Numeric programs.
+
+	Most formulas that are applied to all the cells of a Matrix or Sound are purely numeric:
+	they combine numbers, `row`, `col`, `x`, `y` and `self` with arithmetic, comparisons,
+	if-then-else, and numeric functions of one or two arguments.
+	After compiling such a formula, Formula_compile () translates the program in `parse`
+	into a program for a simple register machine.
+	Because the depth of the stack is known in advance for every instruction of such a program,
+	stack element k can become register k, which is a plain double that needs no tag, no reset and no type check.
+	During the translation, constant subexpressions are folded,
+	and a constant right operand of +, -, * or / is folded into the instruction that uses it.
+	The way `self` is to be accessed (as a cell, a vector or a matrix) is determined at compile time.
+
+	The numeric program computes exactly what the general program computes
+	(including the replacement of infinities by `undefined` wherever pushNumber () does that).
+	If the numeric program finds itself in a situation in which the general program would throw an error
+	(e.g. `self` without a column index outside a loop over columns),
+	it gives up, and Formula_run () runs the general program, which then reports the error.
+
+	Set Melder_debug to 58 to compile only general programs.
+*/
+#define Formula_MAXIMUM_NUMBER_OF_REGISTERS  100
+
+enum {
+	NUMERIC_CONSTANT_, NUMERIC_ROW_, NUMERIC_COL_, NUMERIC_X_, NUMERIC_Y_,
+	NUMERIC_SELF_CELL_, NUMERIC_SELF_VECTOR_, NUMERIC_SELF_MATRIX_,
+	NUMERIC_SELF_VECTOR_1_, NUMERIC_SELF_MATRIX_1_, NUMERIC_SELF_MATRIX_2_,
+	NUMERIC_ADD_, NUMERIC_SUB_, NUMERIC_MUL_, NUMERIC_RDIV_, NUMERIC_IDIV_, NUMERIC_MOD_, NUMERIC_POWER_,
+	NUMERIC_EQ_, NUMERIC_NE_, NUMERIC_LE_, NUMERIC_LT_, NUMERIC_GE_, NUMERIC_GT_,
+	NUMERIC_ADD_CONSTANT_, NUMERIC_SUB_CONSTANT_, NUMERIC_MUL_CONSTANT_, NUMERIC_RDIV_CONSTANT_,
+	NUMERIC_MINUS_, NUMERIC_SQR_, NUMERIC_NOT_,
+	NUMERIC_FUNCTION_1_, NUMERIC_FUNCTION_1_UNCHECKED_, NUMERIC_FUNCTION_2_,
+	NUMERIC_IFTRUE_, NUMERIC_IFFALSE_, NUMERIC_GOTO_
+};
+
+typedef struct structFormulaNumericInstruction {
+	int opcode;
+	integer registerNumber;   // the result goes here; the operands are in this register and the next
+	double constant;
+	integer label;   // for jumps: the number of the instruction to continue with
+	double (*function1) (double);
+	double (*function2) (double, double);
+} *FormulaNumericInstruction;
+
+static autovector <structFormulaNumericInstruction> theNumericProgram;   // empty if the formula is not purely numeric
+static bool theNumericProgramIsCellwise;
+
+static void Formula_compileNumericProgram ();
+
+/*
+	Reusable programs.
+
+	The expressions in a script are compiled with an interpreter but without a current object or optimization,
+	and their programs depend only on the expression text, on the procedure that they occur in
+	(which determines the meaning of local variables like `.x`) and on which variables exist.
+	So if an expression occurs in a loop, the interpreter can keep its program and run it again the next time,
+	as long as no variable has been created or removed since (Interpreter::variablesMapVersion).
+	Each program owns the strings in its `lexan`, which the instructions in its `parse` refer to.
+	Programs that refer to objects (`Sound_hello`) are not kept, because those objects could be removed.
+
+	Set Melder_debug to 60 to always compile anew.
+*/
+#define Formula_MAXIMUM_NUMBER_OF_REUSABLE_PROGRAMS  10'000
+
+struct structFormulaProgram {
+	FormulaInstruction lexan, parse;
+	integer numberOfInstructions;
+	integer variablesMapVersion;
+};
+
+static bool isSymbolWithOwnedString (const integer symbol) {
+	return symbol == STRING_ || symbol == VARIABLE_NAME_ ||
+			symbol == INDEXED_NUMERIC_VARIABLE_ || symbol == INDEXED_STRING_VARIABLE_ || symbol == CALL_;
+}
+
+void FormulaProgram_delete (FormulaProgram me) {
+	for (integer i = 1; my lexan [i]. symbol != END_; i ++)
+		if (isSymbolWithOwnedString (my lexan [i]. symbol))
+			Melder_free (my lexan [i]. content.string);
+	Melder_free (my lexan);
+	Melder_free (my parse);
+	delete me;
+}
+
+static std::u32string Formula_programKey (Interpreter interpreter, conststring32 expression) {
+	std::u32string key (interpreter -> procedureNames [interpreter -> callDepth]);
+	key += U'\n';   // cannot occur in a procedure name or an expression
+	key += expression;
+	return key;
+}
+
+/*
+	Move the program that has just been compiled into the work buffers to the interpreter,
+	and run it from there.
+*/
+static void Formula_keepProgram (Interpreter interpreter, std::u32string const& key) {
+	auto it = interpreter -> formulaPrograms. find (key);
+	if (it == interpreter -> formulaPrograms. end() &&
+			interpreter -> formulaPrograms. size() >= Formula_MAXIMUM_NUMBER_OF_REUSABLE_PROGRAMS)
+		return;
+	integer lexanLength = 1;
+	while (lexan [lexanLength]. symbol != END_)
+		lexanLength ++;
+	FormulaProgram program = new structFormulaProgram;
+	program -> lexan = Melder_malloc_f (structFormulaInstruction, 1 + lexanLength);
+	memcpy (program -> lexan, lexan, (1 + lexanLength) * sizeof (structFormulaInstruction));
+	program -> parse = Melder_malloc_f (structFormulaInstruction, 1 + numberOfInstructions + 1);
+	memcpy (program -> parse, parse, (1 + numberOfInstructions + 1) * sizeof (structFormulaInstruction));
+	program -> numberOfInstructions = numberOfInstructions;
+	program -> variablesMapVersion = interpreter -> variablesMapVersion;
+	/*
+		The strings now belong to the program.
+	*/
+	lexan [1]. symbol = END_;
+	numberOfStringConstants = 0;
+	if (it != interpreter -> formulaPrograms. end()) {
+		FormulaProgram_delete (it -> second);
+		it -> second = program;
+	} else
+		interpreter -> formulaPrograms [key] = program;
+	lexan = program -> lexan;
+	parse = program -> parse;
+}
+
 void Formula_compile (Interpreter interpreter, Daata data, conststring32 expression, int expressionType, bool optimize) {
+	theNumericProgram. resize (0);
+	theNumericProgramIsCellwise = false;
 	theInterpreter = interpreter;
 	if (! theInterpreter) {
 		if (! theLocalInterpreter)
 			theLocalInterpreter = Interpreter_create ();
 		theInterpreter = theLocalInterpreter.get();
 		theInterpreter -> variablesMap. clear ();
+		theInterpreter -> variablesMapVersion += 1;
 	}
 	theSource = data;
 	theExpression = expression;
 	theExpressionType [theLevel] = expressionType;
 	theOptimize = optimize;
-	if (! lexan) {
-		lexan = Melder_calloc_f (structFormulaInstruction, Formula_MAXIMUM_STACK_SIZE);
-		lexan [Formula_MAXIMUM_STACK_SIZE - 1]. symbol = END_;   // make sure that cleaning up always terminates
+
+	const bool programCanBeKept = ( interpreter && ! data && ! optimize &&
+			! interpreter -> currentLineHasSubstitutions && Melder_debug != 60 );
+	std::u32string key;
+	if (programCanBeKept) {
+		key = Formula_programKey (interpreter, expression);
+		auto it = interpreter -> formulaPrograms. find (key);
+		if (it != interpreter -> formulaPrograms. end() && it -> second -> variablesMapVersion == interpreter -> variablesMapVersion) {
+			lexan = it -> second -> lexan;
+			parse = it -> second -> parse;
+			numberOfInstructions = it -> second -> numberOfInstructions;
+			return;
+		}
 	}
-	if (! parse)
-		parse = Melder_calloc_f (structFormulaInstruction, Formula_MAXIMUM_STACK_SIZE);
+
+	if (! theLexanBuffer) {
+		theLexanBuffer = Melder_calloc_f (structFormulaInstruction, Formula_MAXIMUM_STACK_SIZE);
+		theLexanBuffer [Formula_MAXIMUM_STACK_SIZE - 1]. symbol = END_;   // make sure that cleaning up always terminates
+	}
+	if (! theParseBuffer)
+		theParseBuffer = Melder_calloc_f (structFormulaInstruction, Formula_MAXIMUM_STACK_SIZE);
+	lexan = theLexanBuffer;
+	parse = theParseBuffer;
+	theProgramCanBeReused = true;
 
 	/*
 		Clean up strings from the previous call.
@@ -2312,14 +2460,8 @@ void Formula_compile (Interpreter interpreter, Daata data, conststring32 express
 		ilexan = 1;
 		for (;;) {
 			integer symbol = lexan [ilexan]. symbol;
-			if (symbol == STRING_ ||
-				symbol == VARIABLE_NAME_ ||
-				symbol == INDEXED_NUMERIC_VARIABLE_ ||
-				symbol == INDEXED_STRING_VARIABLE_ ||
-				symbol == CALL_
-			) {
+			if (isSymbolWithOwnedString (symbol))
 				Melder_free (lexan [ilexan]. content.string);
-			}
 			else if (symbol == END_) break;   // either the end of a formula, or the end of lexan
 			ilexan ++;
 		}
@@ -2338,6 +2480,9 @@ void Formula_compile (Interpreter interpreter, Daata data, conststring32 express
 	}
 	Formula_removeLabels ();
 	if (Melder_debug == 17) Formula_print (parse);
+	Formula_compileNumericProgram ();
+	if (programCanBeKept && theProgramCanBeReused)
+		Formula_keepProgram (interpreter, key);
 }
 
 /*
@@ -3461,11 +3606,13 @@ static void do_softmaxPerRow_MAT () {
 }
 
 #define DO_NUM_WITH_TENSORS(function, formula, message)  \
+static double numeric_##function (const double xvalue) { \
+	return formula; \
+} \
 static void do_##function () { \
 	const Stackel x = pop; \
 	if (x->which == Stackel_NUMBER) { \
-		const double xvalue = x->number; \
-		pushNumber (formula); \
+		pushNumber (numeric_##function (x->number)); \
 	} else if (x->which == Stackel_NUMERIC_VECTOR) { \
 		Melder_throw (U"The function " #function " requires a numeric argument, " \
 				"not a vector. Did you mean to use " #function "# instead?"); \
@@ -8262,7 +8409,383 @@ static double NUMerf (double x) {
 	return 1.0 - NUMerfcc (x);
 }
 
+static inline double numeric_normalize (const double x) {
+	return isdefined (x) ? x : undefined;
+}
+static double numeric_unary (const int opcode, double (*function) (double), const double x) {
+	switch (opcode) {
+		case NUMERIC_MINUS_: return numeric_normalize (- x);
+		case NUMERIC_SQR_: return isundef (x) ? undefined : numeric_normalize (x * x);
+		case NUMERIC_NOT_: return isundef (x) ? undefined : x == 0.0 ? 1.0 : 0.0;
+		case NUMERIC_FUNCTION_1_: return isundef (x) ? undefined : numeric_normalize (function (x));
+		case NUMERIC_FUNCTION_1_UNCHECKED_: return numeric_normalize (function (x));
+	}
+	Melder_fatal (U"numeric_unary: unknown opcode ", opcode, U".");
+}
+static inline double numeric_le (const double x, const double y) {
+	return isdefined (x) ? ( isdefined (y) ? ( x <= y ? 1.0 : 0.0 ) : 0.0 ) : ( isdefined (y) ? 0.0 : 1.0 );
+}
+static inline double numeric_lt (const double x, const double y) {
+	return isdefined (x) && isdefined (y) && x < y ? 1.0 : 0.0;
+}
+static double numeric_binary (const int opcode, double (*function) (double, double), const double x, const double y) {
+	switch (opcode) {
+		case NUMERIC_ADD_: return x + y;
+		case NUMERIC_SUB_: return x - y;
+		case NUMERIC_MUL_: return x * y;
+		case NUMERIC_RDIV_: return numeric_normalize (x / y);
+		case NUMERIC_IDIV_: return numeric_normalize (floor (x / y));
+		case NUMERIC_MOD_: return numeric_normalize (x - floor (x / y) * y);
+		case NUMERIC_POWER_: return isundef (x) || isundef (y) ? undefined : numeric_normalize (pow (x, y));
+		case NUMERIC_EQ_: return NUMequal (x, y) ? 1.0 : 0.0;
+		case NUMERIC_NE_: return NUMequal (x, y) ? 0.0 : 1.0;
+		case NUMERIC_LE_: return numeric_le (x, y);
+		case NUMERIC_LT_: return numeric_lt (x, y);
+		case NUMERIC_GE_: return numeric_le (y, x);
+		case NUMERIC_GT_: return numeric_lt (y, x);
+		case NUMERIC_FUNCTION_2_: return isundef (x) || isundef (y) ? undefined : numeric_normalize (function (x, y));
+	}
+	Melder_fatal (U"numeric_binary: unknown opcode ", opcode, U".");
+}
+
+static void Formula_compileNumericProgram () {
+	theNumericProgram. resize (0);
+	theNumericProgramIsCellwise = false;
+	if (! theOptimize || theExpressionType [theLevel] != kFormula_EXPRESSION_TYPE_NUMERIC || Melder_debug == 58)
+		return;
+	const Daata me = theSource;
+	const FormulaInstruction f = parse;
+	/*
+		Every instruction of the general program translates to at most one numeric instruction.
+	*/
+	autovector <structFormulaNumericInstruction> program = newvectorzero <structFormulaNumericInstruction> (numberOfInstructions);
+	integer numberOfNumericInstructions = 0;
+	/*
+		Jumps go forward only (we give up otherwise),
+		so that the stack depth at a label is known when the translation arrives at that label.
+	*/
+	autoBOOLVEC isLabel = zero_BOOLVEC (numberOfInstructions + 1);
+	autoINTVEC depthAtLabel = zero_INTVEC (numberOfInstructions + 1);
+	autoINTVEC numericInstructionAtLabel = zero_INTVEC (numberOfInstructions + 1);
+	/*
+		For each register, the numeric instruction that loaded a known constant into it
+		(0 if the content of the register is not known at compile time).
+		A constant can be folded into the instruction that uses it only if it was loaded by one of the last instructions.
+	*/
+	integer constantInstructionOfRegister [1 + Formula_MAXIMUM_NUMBER_OF_REGISTERS] = { };
+	integer depth = 0;
+	bool isReachable = true, isCellwise = true;
+
+	auto emit = [&] (const int opcode, const integer registerNumber) -> structFormulaNumericInstruction& {
+		structFormulaNumericInstruction& instruction = program [++ numberOfNumericInstructions];
+		instruction = structFormulaNumericInstruction { };
+		instruction. opcode = opcode;
+		instruction. registerNumber = registerNumber;
+		constantInstructionOfRegister [registerNumber] = 0;
+		return instruction;
+	};
+	auto isConstantFrom = [&] (const integer registerNumber, const integer numericInstruction) -> bool {
+		return numericInstruction >= 1 && constantInstructionOfRegister [registerNumber] == numericInstruction;
+	};
+	auto push = [&] (const int opcode) -> structFormulaNumericInstruction * {
+		if (++ depth > Formula_MAXIMUM_NUMBER_OF_REGISTERS)
+			return nullptr;
+		return & emit (opcode, depth);
+	};
+	auto pushConstant = [&] (const double value) -> bool {
+		const FormulaNumericInstruction instruction = push (NUMERIC_CONSTANT_);
+		if (! instruction)
+			return false;
+		instruction -> constant = numeric_normalize (value);
+		constantInstructionOfRegister [depth] = numberOfNumericInstructions;
+		return true;
+	};
+	auto unary = [&] (const int opcode, double (*function) (double), const bool isRandom) {
+		const integer last = numberOfNumericInstructions;
+		if (isRandom)
+			isCellwise = false;
+		if (! isRandom && isConstantFrom (depth, last))
+			program [last]. constant = numeric_unary (opcode, function, program [last]. constant);
+		else
+			emit (opcode, depth). function1 = function;
+	};
+	auto binary = [&] (const int opcode, const int opcodeWithConstant, double (*function) (double, double), const bool isRandom) {
+		const integer last = numberOfNumericInstructions;
+		if (isRandom)
+			isCellwise = false;
+		if (! isRandom && isConstantFrom (depth - 1, last - 1) && isConstantFrom (depth, last)) {
+			const double value = numeric_binary (opcode, function, program [last - 1]. constant, program [last]. constant);
+			numberOfNumericInstructions -= 2;
+			depth -= 2;
+			pushConstant (value);   // cannot overflow
+		} else if (opcodeWithConstant >= 0 && isConstantFrom (depth, last)) {
+			const double constant = program [last]. constant;
+			numberOfNumericInstructions -= 1;
+			depth -= 1;
+			emit (opcodeWithConstant, depth). constant = constant;
+		} else {
+			depth -= 1;
+			structFormulaNumericInstruction& instruction = emit (opcode, depth);
+			instruction. function2 = function;
+		}
+	};
+	auto jump = [&] (const int opcode, const integer label, const integer iparseInstruction, const bool popsCondition) -> bool {
+		if (label <= iparseInstruction || label > numberOfInstructions + 1 || depth < 1)
+			return false;
+		emit (opcode, depth). label = label;
+		if (popsCondition)
+			depth -= 1;
+		if (isLabel [label])
+			return depthAtLabel [label] == depth;
+		isLabel [label] = true;
+		depthAtLabel [label] = depth;
+		return true;
+	};
+
+	for (integer i = 1; i <= numberOfInstructions + 1; i ++) {
+		if (isLabel [i]) {
+			if (isReachable && depth != depthAtLabel [i])
+				return;
+			depth = depthAtLabel [i];
+			isReachable = true;
+			for (integer iregister = 1; iregister <= Formula_MAXIMUM_NUMBER_OF_REGISTERS; iregister ++)
+				constantInstructionOfRegister [iregister] = 0;
+			numericInstructionAtLabel [i] = numberOfNumericInstructions + 1;
+		}
+		if (i > numberOfInstructions)
+			break;
+		if (! isReachable)
+			return;
+		bool ok = true;
+		switch (f [i]. symbol) {
+
+case NUMBER_: { ok = pushConstant (f [i]. content.number);
+} break; case TRUE_: { ok = pushConstant (1.0);
+} break; case FALSE_: { ok = pushConstant (0.0);
+} break; case ROW_: { ok = !! push (NUMERIC_ROW_);
+} break; case COL_: { ok = !! push (NUMERIC_COL_);
+} break; case X_: { ok = me && my v_hasGetX () && push (NUMERIC_X_);
+} break; case Y_: { ok = me && my v_hasGetY () && push (NUMERIC_Y_);
+} break; case SELF0_: {
+	const int opcode =
+		! me ? -1 :
+		my v_hasGetCell () ? NUMERIC_SELF_CELL_ :
+		my v_hasGetVector () ? NUMERIC_SELF_VECTOR_ :
+		my v_hasGetMatrix () ? NUMERIC_SELF_MATRIX_ : -1;
+	ok = opcode >= 0 && push (opcode);
+} break; case SELFMATRIX1_: {
+	ok = me && depth >= 1 && ( my v_hasGetVector () || my v_hasGetMatrix () );
+	if (ok)
+		emit (my v_hasGetVector () ? NUMERIC_SELF_VECTOR_1_ : NUMERIC_SELF_MATRIX_1_, depth);
+	isCellwise = false;
+} break; case SELFMATRIX2_: {
+	ok = me && depth >= 2 && my v_hasGetMatrix ();
+	if (ok)
+		emit (NUMERIC_SELF_MATRIX_2_, -- depth);
+	isCellwise = false;
+} break; case NOT_: { unary (NUMERIC_NOT_, nullptr, false);
+} break; case MINUS_: { unary (NUMERIC_MINUS_, nullptr, false);
+} break; case SQR_: { unary (NUMERIC_SQR_, nullptr, false);
+} break; case EQ_: { binary (NUMERIC_EQ_, -1, nullptr, false);
+} break; case NE_: { binary (NUMERIC_NE_, -1, nullptr, false);
+} break; case LE_: { binary (NUMERIC_LE_, -1, nullptr, false);
+} break; case LT_: { binary (NUMERIC_LT_, -1, nullptr, false);
+} break; case GE_: { binary (NUMERIC_GE_, -1, nullptr, false);
+} break; case GT_: { binary (NUMERIC_GT_, -1, nullptr, false);
+} break; case ADD_: { binary (NUMERIC_ADD_, NUMERIC_ADD_CONSTANT_, nullptr, false);
+} break; case SUB_: { binary (NUMERIC_SUB_, NUMERIC_SUB_CONSTANT_, nullptr, false);
+} break; case MUL_: { binary (NUMERIC_MUL_, NUMERIC_MUL_CONSTANT_, nullptr, false);
+} break; case RDIV_: { binary (NUMERIC_RDIV_, NUMERIC_RDIV_CONSTANT_, nullptr, false);
+} break; case IDIV_: { binary (NUMERIC_IDIV_, -1, nullptr, false);
+} break; case MOD_: { binary (NUMERIC_MOD_, -1, nullptr, false);
+} break; case POWER_: { binary (NUMERIC_POWER_, -1, nullptr, false);
+/********** Functions of 1 variable: **********/
+#define CASE_NUMERIC(label, function)  \
+} break; case label: { unary (NUMERIC_FUNCTION_1_UNCHECKED_, numeric_##function, false);
+CASE_NUMERIC (ABS_, abs)
+CASE_NUMERIC (ROUND_, round)
+CASE_NUMERIC (FLOOR_, floor)
+CASE_NUMERIC (CEILING_, ceiling)
+CASE_NUMERIC (RECTIFY_, rectify)
+CASE_NUMERIC (SQRT_, sqrt)
+CASE_NUMERIC (SIN_, sin)
+CASE_NUMERIC (COS_, cos)
+CASE_NUMERIC (TAN_, tan)
+CASE_NUMERIC (ARCSIN_, arcsin)
+CASE_NUMERIC (ARCCOS_, arccos)
+CASE_NUMERIC (ARCTAN_, arctan)
+CASE_NUMERIC (EXP_, exp)
+CASE_NUMERIC (SINH_, sinh)
+CASE_NUMERIC (COSH_, cosh)
+CASE_NUMERIC (TANH_, tanh)
+CASE_NUMERIC (ARCSINH_, arcsinh)
+CASE_NUMERIC (ARCCOSH_, arccosh)
+CASE_NUMERIC (ARCTANH_, arctanh)
+CASE_NUMERIC (SIGMOID_, sigmoid)
+CASE_NUMERIC (INV_SIGMOID_, invSigmoid)
+CASE_NUMERIC (LOG2_, log2)
+CASE_NUMERIC (LN_, ln)
+CASE_NUMERIC (LOG10_, log10)
+#undef CASE_NUMERIC
+} break; case SINC_: { unary (NUMERIC_FUNCTION_1_, NUMsinc, false);
+} break; case SINCPI_: { unary (NUMERIC_FUNCTION_1_, NUMsincpi, false);
+} break; case ERF_: { unary (NUMERIC_FUNCTION_1_, NUMerf, false);
+} break; case ERFC_: { unary (NUMERIC_FUNCTION_1_, NUMerfcc, false);
+} break; case GAUSS_P_: { unary (NUMERIC_FUNCTION_1_, NUMgaussP, false);
+} break; case GAUSS_Q_: { unary (NUMERIC_FUNCTION_1_, NUMgaussQ, false);
+} break; case INV_GAUSS_Q_: { unary (NUMERIC_FUNCTION_1_, NUMinvGaussQ, false);
+} break; case RANDOM_BERNOULLI_: { unary (NUMERIC_FUNCTION_1_, NUMrandomBernoulli_real, true);
+} break; case RANDOM_POISSON_: { unary (NUMERIC_FUNCTION_1_, NUMrandomPoisson, true);
+} break; case LN_GAMMA_: { unary (NUMERIC_FUNCTION_1_, NUMlnGamma, false);
+} break; case HERTZ_TO_BARK_: { unary (NUMERIC_FUNCTION_1_, NUMhertzToBark, false);
+} break; case BARK_TO_HERTZ_: { unary (NUMERIC_FUNCTION_1_, NUMbarkToHertz, false);
+} break; case PHON_TO_DIFFERENCE_LIMENS_: { unary (NUMERIC_FUNCTION_1_, NUMphonToDifferenceLimens, false);
+} break; case DIFFERENCE_LIMENS_TO_PHON_: { unary (NUMERIC_FUNCTION_1_, NUMdifferenceLimensToPhon, false);
+} break; case HERTZ_TO_MEL_: { unary (NUMERIC_FUNCTION_1_, NUMhertzToMel, false);
+} break; case MEL_TO_HERTZ_: { unary (NUMERIC_FUNCTION_1_, NUMmelToHertz, false);
+} break; case HERTZ_TO_SEMITONES_: { unary (NUMERIC_FUNCTION_1_, NUMhertzToSemitones, false);
+} break; case SEMITONES_TO_HERTZ_: { unary (NUMERIC_FUNCTION_1_, NUMsemitonesToHertz, false);
+} break; case ERB_: { unary (NUMERIC_FUNCTION_1_, NUMerb, false);
+} break; case HERTZ_TO_ERB_: { unary (NUMERIC_FUNCTION_1_, NUMhertzToErb, false);
+} break; case ERB_TO_HERTZ_: { unary (NUMERIC_FUNCTION_1_, NUMerbToHertz, false);
+/********** Functions of 2 numerical variables: **********/
+} break; case ARCTAN2_: { binary (NUMERIC_FUNCTION_2_, -1, atan2, false);
+} break; case RANDOM_UNIFORM_: { binary (NUMERIC_FUNCTION_2_, -1, NUMrandomUniform, true);
+} break; case RANDOM_GAUSS_: { binary (NUMERIC_FUNCTION_2_, -1, NUMrandomGauss, true);
+} break; case RANDOM_GAMMA_: { binary (NUMERIC_FUNCTION_2_, -1, NUMrandomGamma, true);
+} break; case CHI_SQUARE_P_: { binary (NUMERIC_FUNCTION_2_, -1, NUMchiSquareP, false);
+} break; case CHI_SQUARE_Q_: { binary (NUMERIC_FUNCTION_2_, -1, NUMchiSquareQ, false);
+} break; case INCOMPLETE_GAMMAP_: { binary (NUMERIC_FUNCTION_2_, -1, NUMincompleteGammaP, false);
+} break; case INV_CHI_SQUARE_Q_: { binary (NUMERIC_FUNCTION_2_, -1, NUMinvChiSquareQ, false);
+} break; case STUDENT_P_: { binary (NUMERIC_FUNCTION_2_, -1, NUMstudentP, false);
+} break; case STUDENT_Q_: { binary (NUMERIC_FUNCTION_2_, -1, NUMstudentQ, false);
+} break; case INV_STUDENT_Q_: { binary (NUMERIC_FUNCTION_2_, -1, NUMinvStudentQ, false);
+} break; case BETA_: { binary (NUMERIC_FUNCTION_2_, -1, NUMbeta, false);
+} break; case BETA2_: { binary (NUMERIC_FUNCTION_2_, -1, NUMbeta2, false);
+} break; case LN_BETA_: { binary (NUMERIC_FUNCTION_2_, -1, NUMlnBeta, false);
+} break; case SOUND_PRESSURE_TO_PHON_: { binary (NUMERIC_FUNCTION_2_, -1, NUMsoundPressureToPhon, false);
+/********** Flow: **********/
+} break; case IFTRUE_: { ok = jump (NUMERIC_IFTRUE_, f [i]. content.label, i, true);
+} break; case IFFALSE_: { ok = jump (NUMERIC_IFFALSE_, f [i]. content.label, i, true);
+} break; case GOTO_: {
+	ok = jump (NUMERIC_GOTO_, f [i]. content.label, i, false);
+	isReachable = false;
+} break; default: return;   // not purely numeric
+		} // endswitch
+		if (! ok)
+			return;
+	}
+	if (! isReachable || depth != 1)
+		return;
+	for (integer inumeric = 1; inumeric <= numberOfNumericInstructions; inumeric ++) {
+		const int opcode = program [inumeric]. opcode;
+		if (opcode == NUMERIC_IFTRUE_ || opcode == NUMERIC_IFFALSE_ || opcode == NUMERIC_GOTO_)
+			program [inumeric]. label = numericInstructionAtLabel [program [inumeric]. label];
+	}
+	program. resize (numberOfNumericInstructions);
+	theNumericProgram = program.move();
+	theNumericProgramIsCellwise = isCellwise;
+}
+
+static inline bool numeric_isIndex (const double x) {
+	return x > -1e15 && x < 1e15;   // false for undefined; otherwise Melder_iround () will succeed
+}
+
+/*
+	Returns false if the general program would throw an error;
+	can be called from several threads at the same time, as long as the formula contains no random functions.
+*/
+static bool Formula_runNumericProgram (const integer row, const integer col, double *out_value) {
+	const Daata me = theSource;
+	const integer numberOfNumericInstructions = theNumericProgram.size;
+	double registers [1 + Formula_MAXIMUM_NUMBER_OF_REGISTERS];
+	integer instructionPointer = 1;
+	while (instructionPointer <= numberOfNumericInstructions) {
+		const structFormulaNumericInstruction& instruction = theNumericProgram [instructionPointer ++];
+		double * const x = & registers [instruction. registerNumber];   // x [1] is the second operand, if any
+		switch (instruction. opcode) {
+
+case NUMERIC_CONSTANT_: { x [0] = instruction. constant;
+} break; case NUMERIC_ROW_: { x [0] = row;
+} break; case NUMERIC_COL_: { x [0] = col;
+} break; case NUMERIC_X_: { x [0] = numeric_normalize (my v_getX (col));
+} break; case NUMERIC_Y_: { x [0] = numeric_normalize (my v_getY (row));
+} break; case NUMERIC_SELF_CELL_: { x [0] = numeric_normalize (my v_getCell ());
+} break; case NUMERIC_SELF_VECTOR_: {
+	if (col == 0)
+		return false;
+	x [0] = numeric_normalize (my v_getVector (row, col));
+} break; case NUMERIC_SELF_MATRIX_: {
+	if (row == 0)
+		return false;
+	x [0] = numeric_normalize (my v_getMatrix (row, col));
+} break; case NUMERIC_SELF_VECTOR_1_: {
+	if (! numeric_isIndex (x [0]))
+		return false;
+	x [0] = numeric_normalize (my v_getVector (row, Melder_iround (x [0])));
+} break; case NUMERIC_SELF_MATRIX_1_: {
+	if (row == 0 || ! numeric_isIndex (x [0]))
+		return false;
+	x [0] = numeric_normalize (my v_getMatrix (row, Melder_iround (x [0])));
+} break; case NUMERIC_SELF_MATRIX_2_: {
+	if (! numeric_isIndex (x [0]) || ! numeric_isIndex (x [1]))
+		return false;
+	x [0] = numeric_normalize (my v_getMatrix (Melder_iround (x [0]), Melder_iround (x [1])));
+} break; case NUMERIC_ADD_: { x [0] += x [1];
+} break; case NUMERIC_SUB_: { x [0] -= x [1];
+} break; case NUMERIC_MUL_: { x [0] *= x [1];
+} break; case NUMERIC_ADD_CONSTANT_: { x [0] += instruction. constant;
+} break; case NUMERIC_SUB_CONSTANT_: { x [0] -= instruction. constant;
+} break; case NUMERIC_MUL_CONSTANT_: { x [0] *= instruction. constant;
+} break; case NUMERIC_RDIV_CONSTANT_: { x [0] = numeric_normalize (x [0] / instruction. constant);
+} break; case NUMERIC_RDIV_: case NUMERIC_IDIV_: case NUMERIC_MOD_: case NUMERIC_POWER_:
+		case NUMERIC_EQ_: case NUMERIC_NE_: case NUMERIC_LE_: case NUMERIC_LT_: case NUMERIC_GE_: case NUMERIC_GT_:
+		case NUMERIC_FUNCTION_2_: {
+	x [0] = numeric_binary (instruction. opcode, instruction. function2, x [0], x [1]);
+} break; case NUMERIC_MINUS_: case NUMERIC_SQR_: case NUMERIC_NOT_: case NUMERIC_FUNCTION_1_: {
+	x [0] = numeric_unary (instruction. opcode, instruction. function1, x [0]);
+} break; case NUMERIC_FUNCTION_1_UNCHECKED_: { x [0] = numeric_normalize (instruction. function1 (x [0]));
+} break; case NUMERIC_IFTRUE_: {
+	if (x [0] != 0.0)
+		instructionPointer = instruction. label;
+} break; case NUMERIC_IFFALSE_: {
+	if (x [0] == 0.0)
+		instructionPointer = instruction. label;
+} break; case NUMERIC_GOTO_: { instructionPointer = instruction. label;
+} break; default: Melder_fatal (U"Numeric formula program: unknown opcode ", instruction. opcode, U".");
+		} // endswitch
+	} // endwhile
+	*out_value = registers [1];
+	return true;
+}
+
+bool Formula_isCellwise () {
+	return theNumericProgramIsCellwise;
+}
+
+double Formula_runCellwise (const integer row, const integer col) {
+	Melder_assert (theNumericProgramIsCellwise);
+	Melder_assert (row >= 1 && col >= 1);
+	/*
+		A numeric program can fail only if `self` needs an implicit row or column index that is 0,
+		which the preconditions exclude.
+	*/
+	double value;
+	if (! Formula_runNumericProgram (row, col, & value))
+		Melder_fatal (U"Formula_runCellwise: cannot compute row ", row, U", column ", col, U".");
+	return value;
+}
+
 void Formula_run (integer row, integer col, Formula_Result *result) {
+	if (theNumericProgram.size > 0) {
+		double value;
+		if (Formula_runNumericProgram (row, col, & value)) {
+			result -> reset();
+			result -> expressionType = kFormula_EXPRESSION_TYPE_NUMERIC;
+			result -> numericResult = value;
+			return;
+		}
+	}
 	FormulaInstruction f = parse;
 	programPointer = 1;   // first symbol of the program
 	if (! theStack) {
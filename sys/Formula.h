@@ -32,6 +32,12 @@
 
 Thing_declare (InterpreterVariable);
 
+/*
+	A compiled expression, kept by an Interpreter for reuse (see Formula_compile).
+*/
+typedef struct structFormulaProgram *FormulaProgram;
+void FormulaProgram_delete (FormulaProgram me);
+
 /*
 	A stack element may be 32 bytes large, so with a stack size of 1'000'000
 	we have 32 MB for the stack. A formula instruction may be 16 bytes large,
@@ -191,5 +197,20 @@ void Formula_compile (Interpreter interpreter, Daata data, conststring32 express
 
 void Formula_run (integer row, integer col, Formula_Result *result);
 
+bool Formula_isCellwise ();
+/*
+	Whether the formula that was compiled last is a purely numeric function of `self`, `x`, `y`, `row` and `col`
+	that contains no random functions and refers to no other cells of `self` than [row, col].
+	If so, the results for different cells do not depend on the order in which the cells are computed,
+	and Formula_runCellwise () can be called for different cells from several threads at the same time.
+*/
+
+double Formula_runCellwise (integer row, integer col);
+/*
+	Preconditions:
+		Formula_isCellwise ();
+		row >= 1 && col >= 1;
+*/
+
 /* End of file Formula.h */
 #endif
@@ -106,6 +106,8 @@ static CollectionOf <structInterpreter> theReferencesToAllLivingInterpreters;
 
 void structInterpreter :: v9_destroy () noexcept {
 	theReferencesToAllLivingInterpreters. undangleItem (this);
+	for (const auto& it : our formulaPrograms)
+		FormulaProgram_delete (it. second);
 	our Interpreter_Parent :: v9_destroy ();
 }
 
@@ -1120,6 +1122,7 @@ static void Interpreter_addNumericVariable (Interpreter me, conststring32 key, d
 	autoInterpreterVariable variable = InterpreterVariable_create (key);
 	variable -> numericValue = value;
 	my variablesMap [key] = variable.move();
+	my variablesMapVersion += 1;
 	variable.releaseToAmbiguousOwner();
 }
 
@@ -1127,6 +1130,7 @@ static void Interpreter_addStringVariable (Interpreter me, conststring32 key, co
 	autoInterpreterVariable variable = InterpreterVariable_create (key);
 	variable -> stringValue = Melder_dup (value);
 	my variablesMap [key] = variable.move();
+	my variablesMapVersion += 1;
 	variable.releaseToAmbiguousOwner();
 }
 
@@ -1134,12 +1138,25 @@ static void Interpreter_addNumericVectorVariable (Interpreter me, conststring32
 	autoInterpreterVariable variable = InterpreterVariable_create (key);
 	variable -> numericVectorValue = splitByWhitespace_VEC (value);
 	my variablesMap [key] = variable.move();
+	my variablesMapVersion += 1;
 	variable.releaseToAmbiguousOwner();
 }
 
+/*
+	The name under which a variable is stored: a local variable such as `.x` is stored as `procedureName.x`.
+	The name is built in a buffer that is reused, so that looking up a variable does not allocate any memory.
+*/
+static std::u32string const& Interpreter_getFullVariableName (Interpreter me, conststring32 key) {
+	if (key [0] == U'.')
+		my fullVariableName.assign (my procedureNames [my callDepth]).append (key);
+	else
+		my fullVariableName.assign (key);
+	return my fullVariableName;
+}
+
 InterpreterVariable Interpreter_hasVariable (Interpreter me, conststring32 key) {
 	Melder_assert (key);
-	auto it = my variablesMap. find (key [0] == U'.' ? Melder_cat (my procedureNames [my callDepth], key) : key);
+	auto it = my variablesMap. find (Interpreter_getFullVariableName (me, key));
 	if (it != my variablesMap.end())
 		return it -> second.get();
 	else
@@ -1148,17 +1165,17 @@ InterpreterVariable Interpreter_hasVariable (Interpreter me, conststring32 key)
 
 InterpreterVariable Interpreter_lookUpVariable (Interpreter me, conststring32 key) {
 	Melder_assert (key);
-	conststring32 variableNameIncludingProcedureName =
-		key [0] == U'.' ? Melder_cat (my procedureNames [my callDepth], key) : key;
+	std::u32string const& variableNameIncludingProcedureName = Interpreter_getFullVariableName (me, key);
 	auto it = my variablesMap. find (variableNameIncludingProcedureName);
 	if (it != my variablesMap.end())
 		return it -> second.get();
 	/*
 		The variable doesn't yet exist: create a new one.
 	*/
-	autoInterpreterVariable variable = InterpreterVariable_create (variableNameIncludingProcedureName);
+	autoInterpreterVariable variable = InterpreterVariable_create (variableNameIncludingProcedureName.c_str());
 	InterpreterVariable variable_ref = variable.get();
 	my variablesMap [variableNameIncludingProcedureName] = variable.move();
+	my variablesMapVersion += 1;
 	return variable_ref;
 }
 
@@ -1399,7 +1416,7 @@ inline static void NumericMatrixVariable_divide (InterpreterVariable variable, c
 }
 
 static void Interpreter_do_procedureCall (Interpreter me, char32 *command,
-	constvector <mutablestring32> const& lines, integer& lineNumber, integer callStack [], int& callDepth)
+	constvector <mutablestring32> const& lines, integer& lineNumber, integer callStack [], int& callDepth, integer& procedureLine)
 {
 	/*
 		Modern type of procedure calls, with comma separation, quoted strings, and array support.
@@ -1429,7 +1446,11 @@ static void Interpreter_do_procedureCall (Interpreter me, char32 *command,
 		p ++;   // step over parenthesis or colon
 	}
 	const integer callLength = Melder_length (callName);
-	integer iline = 1;
+	/*
+		If we called the same procedure from here before, we can start searching at its definition line,
+		which `procedureLine` then contains.
+	*/
+	integer iline = ( procedureLine > 0 ? procedureLine : 1 );
 	for (; iline <= lines.size; iline ++) {
 		if (! str32nequ (lines [iline], U"procedure ", 10))
 			continue;
@@ -1593,6 +1614,7 @@ static void Interpreter_do_procedureCall (Interpreter me, char32 *command,
 				Melder_throw (U"Call depth greater than ", Interpreter_MAX_CALL_DEPTH, U".");
 			callStack [++ callDepth] = lineNumber;
 			lineNumber = iline;
+			procedureLine = iline;
 			break;
 		}
 	}
@@ -2094,6 +2116,25 @@ void Interpreter_run (Interpreter me, char32 *text, const bool reuseVariables) {
 				my labelLines [my numberOfLabels] = lineNumber;
 			}
 		}
+		/*
+			What we find out about a line once, we don't have to find out again the next time we get there in a loop:
+			the line that an `endfor` or `endwhile` jumps back to,
+			and the variable that a line assigns to (valid as long as my variablesMapVersion does not change).
+		*/
+		autoINTVEC matchingLines = zero_INTVEC (numberOfLines);
+		autovector <InterpreterVariable> lineVariables = newvectorzero <InterpreterVariable> (numberOfLines);
+		autoINTVEC lineVariablesVersions = zero_INTVEC (numberOfLines);
+		auto findLineVariable = [&] (conststring32 variableName, bool create) -> InterpreterVariable {
+			const bool lineCanBeCached = ! my currentLineHasSubstitutions;
+			if (lineCanBeCached && lineVariables [lineNumber] && lineVariablesVersions [lineNumber] == my variablesMapVersion)
+				return lineVariables [lineNumber];
+			InterpreterVariable var = ( create ? Interpreter_lookUpVariable (me, variableName) : Interpreter_hasVariable (me, variableName) );
+			if (lineCanBeCached) {
+				lineVariables [lineNumber] = var;
+				lineVariablesVersions [lineNumber] = my variablesMapVersion;
+			}
+			return var;
+		};
 		/*
 			Connect continuation lines.
 		*/
@@ -2113,6 +2154,7 @@ void Interpreter_run (Interpreter me, char32 *text, const bool reuseVariables) {
 		*/
 		if (! reuseVariables) {
 			my variablesMap. clear ();
+			my variablesMapVersion += 1;
 			for (ipar = 1; ipar <= my numberOfParameters; ipar ++) {
 				char32 parameter [1+Interpreter_MAX_PARAMETER_LENGTH];
 				/*
@@ -2204,6 +2246,7 @@ void Interpreter_run (Interpreter me, char32 *text, const bool reuseVariables) {
 					Substitute variables.
 				*/
 				trace (U"substituting variables");
+				my currentLineHasSubstitutions = false;
 				for (char32 *p = & command2. string [0]; *p != U'\0'; p ++) if (*p == U'\'') {
 					/*
 						Found a left quote. Search for a matching right quote.
@@ -2246,6 +2289,7 @@ void Interpreter_run (Interpreter me, char32 *text, const bool reuseVariables) {
 						MelderString_append (& buffer, string, q + 1);
 						MelderString_copy (& command2, buffer.string);   // This invalidates p!! (really bad bug 20070203)
 						p = command2.string + headlen + arglen - 1;
+						my currentLineHasSubstitutions = true;
 					} else {
 						p = q - 1;   // go to before next quote
 					}
@@ -2263,9 +2307,17 @@ void Interpreter_run (Interpreter me, char32 *text, const bool reuseVariables) {
 					case U'.':
 						fail = true;
 						break;
-					case U'@':
-						Interpreter_do_procedureCall (me, command2.string + 1, lines.get(), lineNumber, callStack, callDepth);
-						break;
+					case U'@': {
+						/*
+							The procedure definition that a call jumps to is remembered in `matchingLines`,
+							unless the name of the procedure could have come from a substitution.
+						*/
+						const integer callLineNumber = lineNumber;
+						integer procedureLine = ( my currentLineHasSubstitutions ? 0 : matchingLines [callLineNumber] );
+						Interpreter_do_procedureCall (me, command2.string + 1, lines.get(), lineNumber, callStack, callDepth, procedureLine);
+						if (! my currentLineHasSubstitutions)
+							matchingLines [callLineNumber] = procedureLine;
+					} break;
 					case U'a':
 						if (str32nequ (command2.string, U"assert ", 7)) {
 							double value;
@@ -2312,42 +2364,50 @@ void Interpreter_run (Interpreter me, char32 *text, const bool reuseVariables) {
 								const char32 *startOfInk = Melder_findInk (command2.string + 6);
 								if (startOfInk && *startOfInk != U';')
 									Melder_throw (U"Stray text after 'endfor'.");
-								int depth = 0;
-								integer iline;
-								for (iline = lineNumber - 1; iline > 0; iline --) {
-									char32 *line = lines [iline];
-									if (line [0] == U'f' && line [1] == U'o' && line [2] == U'r' && line [3] == U' ') {
-										if (depth == 0) { lineNumber = iline - 1; fromendfor = true; break; }   // go before 'for'
-										else depth --;
-									} else if (str32nequ (lines [iline], U"endfor", 6) &&
-											(! Melder_staysWithinInk (lines [iline] [6]) || lines [iline] [6] == U';'))
-									{
-										depth ++;
+								integer iline = matchingLines [lineNumber];
+								if (iline == 0) {
+									int depth = 0;
+									for (iline = lineNumber - 1; iline > 0; iline --) {
+										char32 *line = lines [iline];
+										if (line [0] == U'f' && line [1] == U'o' && line [2] == U'r' && line [3] == U' ') {
+											if (depth == 0) break;
+											else depth --;
+										} else if (str32nequ (lines [iline], U"endfor", 6) &&
+												(! Melder_staysWithinInk (lines [iline] [6]) || lines [iline] [6] == U';'))
+										{
+											depth ++;
+										}
 									}
+									if (iline <= 0) Melder_throw (U"Unmatched 'endfor'.");
+									matchingLines [lineNumber] = iline;
 								}
-								if (iline <= 0) Melder_throw (U"Unmatched 'endfor'.");
+								lineNumber = iline - 1;   // go before 'for'
+								fromendfor = true;
 							} else if (str32nequ (command2.string, U"endwhile", 8) &&
 									(! Melder_staysWithinInk (command2.string [8]) || command2.string [8] == U';'))
 							{
 								const char32 *startOfInk = Melder_findInk (command2.string + 8);
 								if (startOfInk && *startOfInk != U';')
 									Melder_throw (U"Stray text after 'endwhile'.");
-								int depth = 0;
-								integer iline;
-								for (iline = lineNumber - 1; iline > 0; iline --) {
-									if (str32nequ (lines [iline], U"while ", 6)) {
-										if (depth == 0) {
-											lineNumber = iline - 1;
-											break;   // go before 'while'
-										} else
-											depth --;
-									} else if (str32nequ (lines [iline], U"endwhile", 8) &&
-											(! Melder_staysWithinInk (lines [iline] [8]) || lines [iline] [8] == U';'))
-									{
-										depth ++;
+								integer iline = matchingLines [lineNumber];
+								if (iline == 0) {
+									int depth = 0;
+									for (iline = lineNumber - 1; iline > 0; iline --) {
+										if (str32nequ (lines [iline], U"while ", 6)) {
+											if (depth == 0)
+												break;
+											else
+												depth --;
+										} else if (str32nequ (lines [iline], U"endwhile", 8) &&
+												(! Melder_staysWithinInk (lines [iline] [8]) || lines [iline] [8] == U';'))
+										{
+											depth ++;
+										}
 									}
+									if (iline <= 0) Melder_throw (U"Unmatched 'endwhile'.");
+									matchingLines [lineNumber] = iline;
 								}
-								if (iline <= 0) Melder_throw (U"Unmatched 'endwhile'.");
+								lineNumber = iline - 1;   // go before 'while'
 							} else if (str32nequ (command2.string, U"endproc", 7) &&
 									(! Melder_staysWithinInk (command2.string [7]) || command2.string [7] == U';'))
 							{
@@ -2488,7 +2548,7 @@ void Interpreter_run (Interpreter me, char32 *text, const bool reuseVariables) {
 								varpos ++;
 							if (endvar - varpos < 0)
 								Melder_throw (U"Missing loop variable after \'for\'.");
-							InterpreterVariable var = Interpreter_lookUpVariable (me, varpos);
+							InterpreterVariable var = findLineVariable (varpos, true);
 							Interpreter_numericExpression (me, topos + 4, & toValue);
 							if (fromendfor) {
 								fromendfor = false;
@@ -2975,7 +3035,8 @@ void Interpreter_run (Interpreter me, char32 *text, const bool reuseVariables) {
 								autostring32 stringValue = Interpreter_stringExpression (me, p);
 								trace (U"assigning to string variable ", variableName);
 								if (typeOfAssignment == 1) {
-									InterpreterVariable var = Interpreter_hasVariable (me, variableName);
+									InterpreterVariable var = ( variableName == command2.string ?
+											findLineVariable (variableName, false) : Interpreter_hasVariable (me, variableName) );
 									if (! var)
 										Melder_throw (U"The string ", variableName, U" does not exist.\n"
 													  U"You can increment (+=) only existing strings.");
@@ -2986,7 +3047,8 @@ void Interpreter_run (Interpreter me, char32 *text, const bool reuseVariables) {
 									str32cpy (newString.get() + oldLength, stringValue.get());
 									var -> stringValue = newString.move();
 								} else {
-									InterpreterVariable var = Interpreter_lookUpVariable (me, variableName);
+									InterpreterVariable var = ( variableName == command2.string ?
+											findLineVariable (variableName, true) : Interpreter_lookUpVariable (me, variableName) );
 									var -> stringValue = stringValue.move();
 								}
 							}
@@ -3384,13 +3446,15 @@ void Interpreter_run (Interpreter me, char32 *text, const bool reuseVariables) {
 								Use an existing variable, or create a new one.
 							*/
 							//Melder_casual (U"looking up variable ", variableName);
-							InterpreterVariable var = Interpreter_lookUpVariable (me, variableName);
+							InterpreterVariable var = ( variableName == command2.string ?
+									findLineVariable (variableName, true) : Interpreter_lookUpVariable (me, variableName) );
 							var -> numericValue = value;
 						} else {
 							/*
 								Modify an existing variable.
 							*/
-							InterpreterVariable var = Interpreter_hasVariable (me, variableName);
+							InterpreterVariable var = ( variableName == command2.string ?
+									findLineVariable (variableName, false) : Interpreter_hasVariable (me, variableName) );
 							if (! var)
 								Melder_throw (U"The variable ", variableName, U" does not exist. You can modify only existing variables.");
 							if (isundef (var -> numericValue)) {
@@ -160,6 +160,16 @@ Thing_define (Interpreter, Thing) {
 	autostring32 dialogTitle;
 	char32 procedureNames [1+Interpreter_MAX_CALL_DEPTH] [100];
 	std::unordered_map <std::u32string, autoInterpreterVariable> variablesMap;
+	integer variablesMapVersion;   // increases whenever a variable is created, replaced or removed
+	std::u32string fullVariableName;   // buffer for looking up a variable by its name including the procedure name, without allocations
+	/*
+		The programs that Formula_compile () made of the expressions in this script,
+		by procedure name and expression text, so that the expressions in a loop are compiled only once.
+		A program is reused only if `variablesMapVersion` has not changed since it was compiled.
+		Expressions in lines with 'variable' substitutions are not kept here, because their text can change all the time.
+	*/
+	std::unordered_map <std::u32string, FormulaProgram> formulaPrograms;
+	bool currentLineHasSubstitutions;
 	bool running, stopped;
 
 	kInterpreter_ReturnType returnType;   // automatically initialized as kInterpreter_ReturnType::VOID_
@@ -0,0 +1,161 @@
+/* MelderThread.cpp
+ *
+ * Copyright (C) 2024 Paul Boersma
+ *
+ * This code is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this work. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MelderThread.h"
+#include "Preferences.h"
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <vector>
+#include <algorithm>
+
+static integer thePreferredNumberOfThreads;   // 0 means: use the number of processors
+
+void MelderThread_prefs () {
+	Preferences_addInteger (U"MelderThread.numberOfThreads", & thePreferredNumberOfThreads, 0);
+}
+
+integer MelderThread_getNumberOfThreads () {
+	static const integer numberOfThreads = [] () {
+		integer result = 0;
+		const conststring32 environmentSetting = Melder_getenv (U"PRAAT_NUMBER_OF_THREADS");
+		if (environmentSetting)
+			result = Melder_atoi (environmentSetting);
+		if (result <= 0)
+			result = thePreferredNumberOfThreads;
+		if (result <= 0)
+			result = MelderThread_getNumberOfProcessors ();
+		Melder_clip (1_integer, & result, 256_integer);
+		return result;
+	} ();
+	return numberOfThreads;
+}
+
+/*
+	A job consists of the tasks 1 .. numberOfPoolTasks that any thread can perform;
+	the job lives on the stack of the thread that called MelderThread_runTasks,
+	which does not return before all these tasks have finished.
+	All members are guarded by the mutex of the pool, except `task`, which is constant.
+*/
+struct MelderThread_Job {
+	std::function <void (integer)> const *task;
+	integer numberOfPoolTasks;
+	integer nextTask = 1;
+	integer numberOfFinishedTasks = 0;
+	std::exception_ptr firstException;
+};
+
+struct MelderThread_Pool {
+	std::mutex mutex;
+	std::condition_variable workIsAvailable, aTaskHasFinished;
+	std::vector <MelderThread_Job *> jobsWithUnclaimedTasks;   // the most recent (i.e. most deeply nested) job is at the back
+
+	/*
+		Precondition: the mutex is locked and `job` has unclaimed tasks.
+	*/
+	integer claimTask (MelderThread_Job *job) {
+		const integer itask = job -> nextTask ++;
+		if (job -> nextTask > job -> numberOfPoolTasks)
+			jobsWithUnclaimedTasks. erase (std::find (jobsWithUnclaimedTasks. begin (), jobsWithUnclaimedTasks. end (), job));
+		return itask;
+	}
+
+	void performTask (MelderThread_Job *job, integer itask) {
+		std::exception_ptr exception;
+		try {
+			(*job -> task) (itask);
+		} catch (...) {
+			exception = std::current_exception ();
+		}
+		{
+			std::lock_guard <std::mutex> lock (mutex);
+			if (exception && ! job -> firstException)
+				job -> firstException = exception;
+			job -> numberOfFinishedTasks += 1;
+		}
+		aTaskHasFinished. notify_all ();
+	}
+
+	void work () {
+		for (;;) {
+			MelderThread_Job *job;
+			integer itask;
+			{
+				std::unique_lock <std::mutex> lock (mutex);
+				workIsAvailable. wait (lock, [this] { return ! jobsWithUnclaimedTasks. empty (); });
+				job = jobsWithUnclaimedTasks. back ();
+				itask = claimTask (job);
+			}
+			performTask (job, itask);
+		}
+	}
+
+	MelderThread_Pool (integer numberOfWorkers) {
+		/*
+			The workers live as long as the process does,
+			so they are detached and the pool is never destroyed.
+		*/
+		for (integer iworker = 1; iworker <= numberOfWorkers; iworker ++)
+			std::thread (& MelderThread_Pool::work, this). detach ();
+	}
+};
+
+static MelderThread_Pool *MelderThread_getPool () {
+	static MelderThread_Pool *thePool = new MelderThread_Pool (MelderThread_getNumberOfThreads () - 1);
+	return thePool;
+}
+
+void MelderThread_runTasks (integer numberOfTasks, std::function <void (integer itask)> const& task) {
+	if (numberOfTasks <= 0)
+		return;
+	MelderThread_Pool *pool = MelderThread_getPool ();
+	MelderThread_Job job;
+	job. task = & task;
+	job. numberOfPoolTasks = numberOfTasks - 1;
+	if (job. numberOfPoolTasks > 0) {
+		{
+			std::lock_guard <std::mutex> lock (pool -> mutex);
+			pool -> jobsWithUnclaimedTasks. push_back (& job);
+		}
+		pool -> workIsAvailable. notify_all ();
+	}
+	std::exception_ptr exceptionOnCallingThread;
+	try {
+		task (numberOfTasks);
+	} catch (...) {
+		exceptionOnCallingThread = std::current_exception ();
+	}
+	/*
+		Help performing the tasks that no worker has claimed yet,
+		then wait until the workers have finished their tasks of this job.
+	*/
+	std::unique_lock <std::mutex> lock (pool -> mutex);
+	while (job. nextTask <= job. numberOfPoolTasks) {
+		const integer itask = pool -> claimTask (& job);
+		lock. unlock ();
+		pool -> performTask (& job, itask);
+		lock. lock ();
+	}
+	pool -> aTaskHasFinished. wait (lock, [& job] { return job. numberOfFinishedTasks == job. numberOfPoolTasks; });
+	if (exceptionOnCallingThread)
+		std::rethrow_exception (exceptionOnCallingThread);
+	if (job. firstException)
+		std::rethrow_exception (job. firstException);
+}
+
+/* End of file MelderThread.cpp */
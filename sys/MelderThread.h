@@ -2,7 +2,7 @@
 #define _MelderThread_h_
 /* MelderThread.h
  *
- * Copyright (C) 2014-2018,2020 Paul Boersma
+ * Copyright (C) 2014-2018,2020,2024 Paul Boersma
  *
  * This code is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,7 +18,7 @@
  * along with this work. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <vector>
+#include <functional>
 #include "Thing.h"
 #include <thread>
 
@@ -26,25 +26,33 @@ inline integer MelderThread_getNumberOfProcessors () {
 	return uinteger_to_integer (std::thread::hardware_concurrency ());
 }
 
+void MelderThread_prefs ();
+
+integer MelderThread_getNumberOfThreads ();
+/*
+	The number of threads that the process-wide thread pool uses, including the calling thread.
+	The number is determined when the pool is first used:
+	the environment variable PRAAT_NUMBER_OF_THREADS if it is set to a positive number,
+	otherwise the preference MelderThread.numberOfThreads if it is positive,
+	otherwise the number of processors.
+*/
+
+void MelderThread_runTasks (integer numberOfTasks, std::function <void (integer itask)> const& task);
+/*
+	Performs task (1), task (2) ... task (numberOfTasks) and returns when all of them have finished.
+	Task `numberOfTasks` is always performed on the calling thread, so that it can e.g. show progress.
+	The other tasks are performed by the threads of the process-wide pool that happen to be idle,
+	and by the calling thread itself, so a task can call MelderThread_runTasks again
+	without the risk of a deadlock.
+	If some tasks throw an exception, the first one is rethrown on the calling thread,
+	after all tasks have finished.
+*/
+
 template <class T> void MelderThread_run (void (*func) (T *), autoSomeThing <T> *args, integer numberOfThreads) {
-	uinteger unsignedNumberOfThreads = integer_to_uinteger (numberOfThreads);
-	if (unsignedNumberOfThreads == 1) {
+	if (numberOfThreads == 1)
 		func (args [0].get());
-	} else {
-		std::vector <std::thread> thread (unsignedNumberOfThreads);
-		try {
-			for (uinteger ithread = 1; ithread < unsignedNumberOfThreads; ithread ++)
-				thread [ithread - 1] = std::thread (func, args [ithread - 1].get());
-			func (args [unsignedNumberOfThreads - 1].get());
-		} catch (MelderError) {
-			for (uinteger ithread = 1; ithread < unsignedNumberOfThreads; ithread ++)
-				if (thread [ithread - 1]. joinable ())
-					thread [ithread - 1]. join ();
-			throw;
-		}
-		for (uinteger ithread = 1; ithread < unsignedNumberOfThreads; ithread ++)
-			thread [ithread - 1]. join ();
-	}
+	else
+		MelderThread_runTasks (numberOfThreads, [func, args] (integer itask) { func (args [itask - 1].get()); });
 }
 
 /* End of file MelderThread.h */
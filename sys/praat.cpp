@@ -41,6 +41,7 @@
 #include "site.h"
 #include "machine.h"
 #include "Printer.h"
+#include "MelderThread.h"
 #include "ScriptEditor.h"
 #include "NotebookEditor.h"
 #include "Strings_.h"
@@ -1064,6 +1065,7 @@ static void installPraatShellPreferences () {
 	Melder_audio_prefs ();   // asynchronicity, silence after...
 	Melder_textEncoding_prefs ();
 	Printer_prefs ();   // paper size, printer command...
+	MelderThread_prefs ();   // number of threads...
 	structTextEditor :: f_preferences ();   // font size...
 }
 
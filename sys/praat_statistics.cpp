@@ -24,6 +24,8 @@
 #endif
 #include "praatP.h"
 #include "GraphicsP.h"
+#include "MelderThread.h"
+#include "NUM2.h"
 
 static struct {
 	integer batchSessions, interactiveSessions;
@@ -169,6 +171,7 @@ void praat_reportSystemProperties () {
 		MelderInfo_writeLine (U"linux is \"" stringize(linux) "\".");
 	#endif
 	MelderInfo_writeLine (U"The number of processors is ", std::thread::hardware_concurrency(), U".");
+	MelderInfo_writeLine (U"The number of threads for parallel analyses is ", MelderThread_getNumberOfThreads (), U".");
 	#ifdef macintosh
 		MelderInfo_writeLine (U"system version is ", Melder_systemVersion, U".");
 	#endif
@@ -280,7 +283,7 @@ void praat_reportMemoryUse () {
 	MelderInfo_writeLine (
 			U"   Arrays: ", MelderArray_allocationCount () - MelderArray_deallocationCount (),
 			U" (", Melder_bigInteger (MelderArray_cellAllocationCount () - MelderArray_cellDeallocationCount ()), U" cells)");
-	MelderInfo_writeLine (U"   Things: ", theTotalNumberOfThings,
+	MelderInfo_writeLine (U"   Things: ", theTotalNumberOfThings. load (),
 		U" (objects in list: ", Melder_bigInteger (theCurrentPraatObjects -> n), U")");
 	integer numberOfMotifWidgets =
 	#if motif
@@ -296,6 +299,12 @@ void praat_reportMemoryUse () {
 		- (MelderArray_allocationCount () - MelderArray_deallocationCount ())
 		- numberOfMotifWidgets
 	);
+	integer numberOfFftPlans, fftPlanMemoryUse, numberOfFftPlanHits, numberOfFftPlanMisses, numberOfFftPlanEvictions;
+	NUMfft_getPlanCacheStatistics (& numberOfFftPlans, & fftPlanMemoryUse,
+			& numberOfFftPlanHits, & numberOfFftPlanMisses, & numberOfFftPlanEvictions);
+	MelderInfo_writeLine (U"   Cached FFT plans: ", numberOfFftPlans, U" (", Melder_bigInteger (fftPlanMemoryUse), U" bytes; ",
+			Melder_bigInteger (numberOfFftPlanHits), U" hits, ", Melder_bigInteger (numberOfFftPlanMisses), U" misses, ",
+			Melder_bigInteger (numberOfFftPlanEvictions), U" evictions)");
 	MelderInfo_writeLine (
 		U"\nMemory history of this session:\n"
 		U"   Total created: ", Melder_bigInteger (Melder_allocationCount ()), U" (", Melder_bigInteger (Melder_allocationSize ()), U" bytes)");